@@ -176,4 +176,116 @@ public:
    size_t size(){ return pq.size(); }
 };
 
+//! Distance Priority Queue in caller owned buffers
+/*!
+  Implements the interface of qknn as a bounded max heap that is
+  stored in two caller owned arrays of at least k elements, so that
+  a search does not allocate memory.  The squared distances are
+  stored as floats.
+*/
+
+class qknn_buffer
+{
+private:
+  long unsigned int K;
+  long unsigned int n;
+  long unsigned int *idx;
+  float *dist;
+
+  void swap(long unsigned int a, long unsigned int b)
+  {
+    std::swap(idx[a], idx[b]);
+    std::swap(dist[a], dist[b]);
+  }
+
+  void sift_down(long unsigned int i, long unsigned int size)
+  {
+    for(;;)
+      {
+	long unsigned int l = 2*i+1, r = l+1, m = i;
+	if(l < size && dist[l] > dist[m]) m = l;
+	if(r < size && dist[r] > dist[m]) m = r;
+	if(m == i) return;
+	swap(i, m);
+	i = m;
+      }
+  }
+
+public:
+
+  //! Constructor
+  /*!
+    Creates an empty queue in the given buffers
+    \param pl Buffer for the point indices
+    \param pd Buffer for the squared distances
+  */
+  qknn_buffer(long unsigned int *pl, float *pd) : K(0), n(0), idx(pl), dist(pd) {};
+
+  //! Largest distance
+  double topdist(void)
+  {
+    return dist[0];
+  }
+
+  //! Set Size
+  /*!
+    Sets the size of the queue and empties it
+    \param k The maximum number of elements to be stored in the queue.
+  */
+  void set_size(long unsigned int k)
+  {
+    K = k;
+    n = 0;
+  }
+
+  //! Update queue
+  /*!
+    Updates the queue with the given distance and point
+    \param d Distance of point to be added
+    \param p index of point to be added
+    \return True if a point was added to the queue
+  */
+  bool update(double d, long int p)
+  {
+    if(n < K)
+      {
+	long unsigned int i = n++;
+	idx[i] = p;
+	dist[i] = d;
+	while(i > 0 && dist[(i-1)/2] < dist[i])
+	  {
+	    swap(i, (i-1)/2);
+	    i = (i-1)/2;
+	  }
+	return true;
+      }
+    else if(dist[0] > d)
+      {
+	idx[0] = p;
+	dist[0] = d;
+	sift_down(0, n);
+	return true;
+      }
+    return false;
+  }
+
+  //! Create answer
+  /*!
+    Sorts the buffers by increasing distance
+    \return Number of points in the answer
+  */
+  size_t answer()
+  {
+    for(long unsigned int i = n; i > 1; --i)
+      {
+	swap(0, i-1);
+	sift_down(0, i-1);
+      }
+    return n;
+  }
+
+  //! Size function
+  size_t size(){ return n; }
+};
+
 #endif
@@ -88,6 +88,7 @@ private:
   */
   void ksearch(Point q, unsigned int k, std::vector<long unsigned int> &nn_idx, float eps = 0);
   void ksearch(Point q, unsigned int k, std::vector<long unsigned int> &nn_idx, std::vector<double> &dist, float eps = 0);
+  size_t ksearch(Point q, unsigned int k, long unsigned int *nn_idx, float *dist, float eps = 0);
 
   std::vector<Point> points;
   std::vector<long unsigned int> pointers;
@@ -101,10 +102,12 @@ private:
   void compute_bounding_box(Point q, Point &q1, Point &q2, double r);
   void sfcnn_work_init(int num_threads);
 
-  void ksearch_common(Point q, unsigned int k, long unsigned int j, qknn &que, float Eps);	
+  template<typename Queue>
+  void ksearch_common(Point q, unsigned int k, long unsigned int j, Queue &que, float Eps);	
   
+  template<typename Queue>
   inline void recurse(long unsigned int s, long unsigned int n, Point q, 
-		      qknn &ans, Point &q1, Point &q2, long unsigned int bb, long unsigned int bt);
+		      Queue &ans, Point &q1, Point &q2, long unsigned int bb, long unsigned int bt);
 	
 };
 
@@ -137,10 +140,11 @@ sfcnn_work<Point, Ptype>::~sfcnn_work()
 }
 
 template<typename Point, typename Ptype>
+template<typename Queue>
 void sfcnn_work<Point, Ptype>::recurse(long unsigned int s,     // Starting index
 				long unsigned int n,     // Number of points
 				Point q,  // Query point
-				qknn &ans, // Answer que
+				Queue &ans, // Answer que
 				Point &bound_box_lower_corner,
 				Point &bound_box_upper_corner,
 				long unsigned int initial_scan_lower_range,
@@ -220,7 +224,8 @@ void sfcnn_work<Point, Ptype>::compute_bounding_box(Point q, Point &q1, Point &q
 }
 
 template<typename Point, typename Ptype>
-void sfcnn_work<Point, Ptype>::ksearch_common(Point q, unsigned int k, long unsigned int query_point_index, qknn &que, float Eps)
+template<typename Queue>
+void sfcnn_work<Point, Ptype>::ksearch_common(Point q, unsigned int k, long unsigned int query_point_index, Queue &que, float Eps)
 {
   Point bound_box_lower_corner, bound_box_upper_corner;
   Point low, high;
@@ -282,6 +287,17 @@ void sfcnn_work<Point, Ptype>::ksearch(Point q, unsigned int k,
   que.answer(nn_idx, dist);
 }
 
+template<typename Point, typename Ptype>
+size_t sfcnn_work<Point, Ptype>::ksearch(Point q, unsigned int k, 
+				long unsigned int *nn_idx, float *dist, float Eps)
+{
+  long unsigned int query_point_index;  
+  qknn_buffer que(nn_idx, dist);
+  query_point_index = BinarySearch(points, q, lt);
+  ksearch_common(q, k, query_point_index, que, Eps);
+  return que.answer();
+}
+
 /*!
   \brief Nearest Neighbor search class
   
@@ -390,6 +406,27 @@ public:
       Q[i] = q[i];
     NN.ksearch(Q,k,nn_idx,dist,eps);
   };
+  /*!
+    \brief Nearest Neighbor search function
+    
+    Searches for the k nearest neighbors to the point q and writes
+    their indexes and square distances into the given buffers of
+    at least k elements, sorted by distance.  No memory is
+    allocated.  This function is thread-safe.
+    \param q The query point
+    \param k The number of neighbors to return
+    \param nn_idx Answer buffer
+    \param dist Distance buffer
+    \param eps Error tolerence, default of 0.0.
+    \return The number of neighbors found
+  */
+  size_t ksearch(Point q, unsigned int k, long unsigned int *nn_idx, float *dist, float eps=0)
+  {
+    reviver::dpoint<sep_float<float>, Dim> Q;
+    for(unsigned int i=0;i < Dim;++i)
+      Q[i] = q[i];
+    return NN.ksearch(Q,k,nn_idx,dist,eps);
+  };
 
 private:
   sfcnn_work<reviver::dpoint<sep_float<float>, Dim> > NN;
@@ -77,19 +77,6 @@ public:
 		this->b = _b;
 	}
 
-	/**
-	 * @brief	Copy Ctor.
-	 */
-	ColorVertex(const ColorVertex &o)
-	{
-		this->x = o.x;
-		this->y = o.y;
-		this->z = o.z;
-		this->r = o.r;
-		this->g = o.g;
-		this->b = o.b;
-	}
-
 	/**
 	 * @brief	Copy Ctor.
 	 */
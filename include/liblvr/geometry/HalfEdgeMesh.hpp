@@ -43,6 +43,7 @@
 #include <math.h>
 #include <algorithm>
 #include <queue>
+#include <atomic>
 
 #include <GL/glu.h>
 #include <GL/glut.h>
@@ -68,6 +69,9 @@ using namespace std;
 #include "ColorVertex.hpp"
 
 #include "VertexCosts.hpp"
+#include "Quadric.hpp"
+#include "IndexedHeap.hpp"
+#include "ObjectPool.hpp"
 
 #include "reconstruction/PointsetSurface.hpp"
 #include "classification/ClassifierFactory.hpp"
@@ -183,8 +187,13 @@ public:
 	 * @param smallRegionSize	The size up to which a region is considered as small
 	 *
 	 * @param remove_flickering	Whether to remove flickering faces or not
+	 *
+	 * @param parallel			If true, the regions are found and the
+	 * 							regression planes are calculated in parallel
+	 * 							(see parallelRegionGrowing()). The result does
+	 * 							not depend on the number of threads.
 	 */
-	virtual void optimizePlanes(int iterations, float normalThreshold, int minRegionSize = 50, int smallRegionSize = 0, bool remove_flickering = true);
+	virtual void optimizePlanes(int iterations, float normalThreshold, int minRegionSize = 50, int smallRegionSize = 0, bool remove_flickering = true, bool parallel = false);
 
 	/**
 	 * @brief	Removes artifacts in the mesh that are not connected to the main mesh
@@ -278,12 +287,20 @@ public:
 
 	/**
 	 * Simplyfys the mesh by collapsing the @ref n_collapses edges with the
-	 * lowest costs according to the given costs function
-	 *
-	 * @param n_collapses		Number of edges to collapse
+	 * lowest quadric errors (Garland and Heckbert). The face planes are
+	 * weighted by the given costs function. The merged vertex is placed at
+	 * the position with the minimal error. Vertices on mesh borders, on
+	 * region borders and non manifold vertices are kept. Collapses that
+	 * would change the topology or flip faces are skipped.
+	 *
+	 * @param n_collapses		Number of edges to collapse. Every collapse
+	 * 							removes two faces.
 	 * @param c					The costs function for edge removal
+	 * @param maxError			Stop if the error of the next collapse is
+	 * 							larger than this value
 	 */
-	void reduceMeshByCollapse(int n_collapses, VertexCosts<VertexT, NormalT> &c);
+	void reduceMeshByCollapse(int n_collapses, VertexCosts<VertexT, NormalT> &c,
+			float maxError = numeric_limits<float>::max());
 
 	/**
 	 * @brief returns the RegionVector
@@ -334,6 +351,9 @@ private:
 	 * @param next  The end vertex of an edge
 	 * @return      A pointer to an existing edge, or null if no suitable
 	 *              edge was found.
+	 *
+	 * The incoming edges of v are searched linearly, so the cost grows
+	 * with the valence of v, not with the size of the mesh.
 	 */
 	EdgePtr halfEdgeToVertex(VertexPtr v, VertexPtr next);
 
@@ -399,6 +419,32 @@ private:
 	 */
 	virtual int stackSafeRegionGrowing(FacePtr start_face, NormalT &normal, float &angle, RegionPtr region);
 
+	/**
+	 * @brief	Splits the mesh into regions in parallel. First, the mesh is
+	 * 			split into components of connected faces whose normals differ
+	 * 			by less than the given threshold from their neighbors. Then
+	 * 			the components are split into regions whose normals differ by
+	 * 			less than the threshold from the normal of their first face.
+	 * 			The regions are numbered in the order of their first face.
+	 *
+	 * @param	angle		the minimal absolute dot product of the normals of
+	 * 						two neighbored faces in the same region
+	 * @param	regions		the created regions
+	 */
+	void parallelRegionGrowing(float angle, vector<RegionPtr> &regions);
+
+	/**
+	 * @brief	Returns the root of the given element in a union find forest
+	 */
+	static int findRoot(vector<std::atomic<int> > &parents, int i);
+
+	/**
+	 * @brief	Joins the trees of the given elements in a union find forest.
+	 * 			The larger root is linked to the smaller one, so each root is
+	 * 			the smallest element of its tree. Can be called concurrently.
+	 */
+	static void unite(vector<std::atomic<int> > &parents, int i, int j);
+
 	/**
 	 * @brief	Starts a region growing wrt the angle between the faces and returns the
 	 * 			number of connected faces. Faces are connected means they share a common
@@ -455,6 +501,56 @@ private:
 	virtual bool safeCollapseEdge(EdgePtr edge);
 
 
+	/// State of the edge collapse simplification
+	struct CollapseData
+	{
+		/// The accumulated quadrics of all vertices
+		vector<Quadric>     quadrics;
+
+		/// Flags of the vertices that must not be moved
+		vector<char>        locked;
+
+		/// Marks of all vertices used by the topology test
+		vector<size_t>      marks;
+
+		/// The last used mark
+		size_t              stamp;
+
+		/// Edges, errors and vertex positions of the collapse candidates
+		vector<EdgePtr>     edges;
+		vector<double>      errors;
+		vector<double>      positions;
+	};
+
+	/**
+	 * @brief	Finds the collapse of an edge of v with the lowest quadric
+	 * 			error
+	 *
+	 * @param	v			A vertex that is not locked
+	 * @param	data		The simplification state
+	 * @param	target		The neighbor of v that is merged into v
+	 * @param	position	The new position of v
+	 * @param	cost		The quadric error of the collapse
+	 *
+	 * @return	false if no edge of v can be collapsed
+	 */
+	bool bestCollapse(VertexPtr v, CollapseData &data, VertexPtr &target, VertexT &position, float &cost);
+
+	/**
+	 * @brief	Checks if the start and end vertex of an inner edge can be
+	 * 			merged at the given position without changing the topology
+	 * 			of the mesh and without flipping faces
+	 */
+	bool isCollapsible(EdgePtr edge, const float position[3], CollapseData &data);
+
+	/**
+	 * @brief	Merges the end vertex of an inner edge into its start vertex,
+	 * 			which is moved to the given position. The two faces of the
+	 * 			edge are marked as invalid and the removed vertex is left
+	 * 			without edges. Both have to be removed by the caller.
+	 */
+	void collapseInnerEdge(EdgePtr edge, const VertexT &position, vector<FacePtr> &removedFaces);
+
 	/**
 	 * @brief	Calculates costs for every vertex in the mesh
 	 */
@@ -476,8 +572,12 @@ private:
 
 
 
-	set<EdgePtr>        m_garbageEdges;
-	set<HFace*>         m_garbageFaces;
+	/// Storage of all edges, faces and vertices of the mesh. Deleted
+	/// edges and faces are kept until the mesh is destroyed.
+	ObjectPool<HEdge>   m_edgePool;
+	ObjectPool<HFace>   m_facePool;
+	ObjectPool<HVertex> m_vertexPool;
+
 	set<RegionPtr>      m_garbageRegions;
 };
 
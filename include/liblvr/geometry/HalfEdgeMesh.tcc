@@ -87,13 +87,7 @@ HalfEdgeMesh<VertexT, NormalT>::~HalfEdgeMesh()
     if(this->m_pointCloudManager != NULL)
 		this->m_pointCloudManager.reset();
 
-    typename set<EdgePtr>::iterator e_it = m_garbageEdges.begin();
-    for(; e_it != m_garbageEdges.end(); e_it++)
-    {
-        EdgePtr e = *e_it;
-        delete e;
-    }
-    m_garbageEdges.clear();
+    m_edgePool.clear();
 
 
     if(this->m_regionClassifier != 0)
@@ -102,11 +96,8 @@ HalfEdgeMesh<VertexT, NormalT>::~HalfEdgeMesh()
         this->m_regionClassifier = 0;
     }
 
-    for (int i = 0 ; i < m_vertices.size() ; i++)
-    {
-        delete m_vertices[i];
-    }
     this->m_vertices.clear();
+    m_vertexPool.clear();
 
     typename set<Region<VertexT, NormalT>*>::iterator r_it;
     for(r_it = m_garbageRegions.begin(); r_it != m_garbageRegions.end(); r_it++)
@@ -116,13 +107,8 @@ HalfEdgeMesh<VertexT, NormalT>::~HalfEdgeMesh()
     }
     m_garbageRegions.clear();
 
-    typename set<FacePtr>::iterator f_it = m_garbageFaces.begin();
-    for(; f_it != m_garbageFaces.end(); f_it++)
-    {
-        FacePtr f = *f_it;
-        delete f;
-    }
-    m_garbageFaces.clear();
+    m_faces.clear();
+    m_facePool.clear();
 
 }
 
@@ -154,7 +140,7 @@ template<typename VertexT, typename NormalT>
 void HalfEdgeMesh<VertexT, NormalT>::addVertex(VertexT v)
 {
     // Create new HalfEdgeVertex and increase vertex counter
-    m_vertices.push_back(new HVertex(v));
+    m_vertices.push_back(m_vertexPool.create(v));
     m_globalIndex++;
 }
 
@@ -177,32 +163,30 @@ void HalfEdgeMesh<VertexT, NormalT>::addNormal(NormalT n)
 template<typename VertexT, typename NormalT>
 HalfEdge<HalfEdgeVertex<VertexT, NormalT>, HalfEdgeFace<VertexT, NormalT> >* HalfEdgeMesh<VertexT, NormalT>::halfEdgeToVertex(VertexPtr v, VertexPtr next)
 {
-    EdgePtr edge = 0;
     EdgePtr cur;
 
     typename EdgeVector::iterator it;
 
     for(it = v->in.begin(); it != v->in.end(); it++)
     {
-        // Check all incoming edges, if start and end vertex
-        // are the same. If they are, save this edge.
+        // All incoming edges end in v, so only the start
+        // vertex has to be compared.
         cur = *it;
-        if(cur->end() == v && cur->start() == next)
+        if(cur->start() == next)
         {
-            edge = cur;
+            return cur;
         }
     }
 
-    return edge;
+    return 0;
 }
 
 template<typename VertexT, typename NormalT>
 void HalfEdgeMesh<VertexT, NormalT>::addTriangle(uint a, uint b, uint c, FacePtr &f)
 {
     // Create a new face
-    FacePtr face = new HFace;
+    FacePtr face = m_facePool.create();
     m_faces.push_back(face);
-    m_garbageFaces.insert(face);
 
     // Create a list of HalfEdges that will be connected
     // with this here. Here we need only to alloc space for
@@ -253,8 +237,7 @@ void HalfEdgeMesh<VertexT, NormalT>::addTriangle(uint a, uint b, uint c, FacePtr
             catch (HalfEdgeAccessException &e)
             {
                 cout << "HalfEdgeMesg::addTriangle: " << e.what() << endl;
-                EdgePtr edge = new HEdge;
-                m_garbageEdges.insert(edge);
+                EdgePtr edge = m_edgePool.create();
                 edge->setStart(edgeToVertex->end());
                 edge->setEnd(edgeToVertex->start());
                 edges[k] = edge;
@@ -265,14 +248,12 @@ void HalfEdgeMesh<VertexT, NormalT>::addTriangle(uint a, uint b, uint c, FacePtr
         else
         {
             // Create new edge and pair
-            EdgePtr edge = new HEdge;
-            m_garbageEdges.insert(edge);
+            EdgePtr edge = m_edgePool.create();
             edge->setFace(face);
             edge->setStart(current);
             edge->setEnd(next);
 
-            EdgePtr pair = new HEdge;
-            m_garbageEdges.insert(pair);
+            EdgePtr pair = m_edgePool.create();
             pair->setStart(next);
             pair->setEnd(current);
             pair->setFace(0);
@@ -703,8 +684,7 @@ void HalfEdgeMesh<VertexT, NormalT>::flipEdge(EdgePtr edge)
         edge->pair()->next()->next()->setNext(edge->next());
 
         //create the new edge
-        EdgePtr newEdge = new HEdge;
-        m_garbageEdges.insert(newEdge);
+        EdgePtr newEdge = m_edgePool.create();
 
         //set its' start and end vertex
         newEdge->setStart(newEdgeStart);
@@ -722,8 +702,7 @@ void HalfEdgeMesh<VertexT, NormalT>::flipEdge(EdgePtr edge)
         newEdge->end()->in.push_back(newEdge);
 
         //create the new pair
-        EdgePtr newpair = new HEdge;
-        m_garbageEdges.insert(newpair);
+        EdgePtr newpair = m_edgePool.create();
 
         //set its' start and end vertex (complementary to new edge)
         newpair->setStart(newEdgeEnd);
@@ -775,15 +754,13 @@ int HalfEdgeMesh<VertexT, NormalT>::stackSafeRegionGrowing(FacePtr start_face, N
     vector<FacePtr> leafs;
     int regionSize = 0;
     leafs.push_back(start_face);
-    do
+    for(size_t i = 0; i < leafs.size(); i++)
     {
-        if(leafs.front()->m_used == false)
+        if(leafs[i]->m_used == false)
         {
-            regionSize += regionGrowing(leafs.front(), normal, angle, region, leafs, m_depth);
+            regionSize += regionGrowing(leafs[i], normal, angle, region, leafs, m_depth);
         }
-        leafs.erase(leafs.begin());
     }
-    while(!leafs.empty());
 
     return regionSize;
 }
@@ -830,6 +807,190 @@ int HalfEdgeMesh<VertexT, NormalT>::regionGrowing(FacePtr start_face, NormalT &n
     return neighbor_cnt;
 }
 
+template<typename VertexT, typename NormalT>
+void HalfEdgeMesh<VertexT, NormalT>::parallelRegionGrowing(float angle, vector<RegionPtr> &regions)
+{
+    int n = (int)m_faces.size();
+    vector<NormalT> normals(n);
+    vector<int> neighbors(3 * n, -1);
+    vector<std::atomic<int> > parents(n);
+
+    #pragma omp parallel for
+    for(int i = 0; i < n; i++)
+    {
+        m_faces[i]->m_face_index = i;
+        m_faces[i]->m_used = true;
+        normals[i] = m_faces[i]->getFaceNormal();
+        parents[i] = i;
+    }
+
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for(int i = 0; i < n; i++)
+    {
+        for(int k = 0; k < 3; k++)
+        {
+            FacePtr neighbor = 0;
+            try
+            {
+                neighbor = (*m_faces[i])[k]->pair()->face();
+            }
+            catch (HalfEdgeAccessException )
+            {
+                // Border edge
+            }
+
+            if(neighbor)
+            {
+                int j = neighbor->m_face_index;
+                if(j >= 0 && j < n && m_faces[j] == neighbor)
+                {
+                    neighbors[3 * i + k] = j;
+                }
+            }
+        }
+    }
+
+    // Join all neighbored faces with similar normals into components.
+    // Every pair of faces is tested by the face with the larger index.
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for(int i = 0; i < n; i++)
+    {
+        for(int k = 0; k < 3; k++)
+        {
+            int j = neighbors[3 * i + k];
+            if(j >= 0 && j < i && fabs(normals[i] * normals[j]) > angle)
+            {
+                unite(parents, i, j);
+            }
+        }
+    }
+
+    // Sort the faces by component. The faces of each component stay
+    // in the order of their indices.
+    vector<int> roots(n);
+
+    #pragma omp parallel for
+    for(int i = 0; i < n; i++)
+    {
+        roots[i] = findRoot(parents, i);
+    }
+
+    vector<int> componentStart(n + 1, 0);
+    for(int i = 0; i < n; i++)
+    {
+        componentStart[roots[i] + 1]++;
+    }
+    for(int i = 0; i < n; i++)
+    {
+        componentStart[i + 1] += componentStart[i];
+    }
+
+    vector<int> componentFaces(n);
+    vector<int> fill(componentStart.begin(), componentStart.end() - 1);
+    vector<int> componentRoots;
+    for(int i = 0; i < n; i++)
+    {
+        componentFaces[fill[roots[i]]++] = i;
+        if(roots[i] == i)
+        {
+            componentRoots.push_back(i);
+        }
+    }
+
+    // A component may bend too far to be a plane. Within each component
+    // regions are grown from the first unused face by comparing the
+    // normals to the normal of that face, just like the serial region
+    // growing does. The components are processed in parallel.
+    vector<int> seeds(n, -1);
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int r = 0; r < (int)componentRoots.size(); r++)
+    {
+        int c = componentRoots[r];
+        vector<int> queue;
+        for(int f = componentStart[c]; f < componentStart[c + 1]; f++)
+        {
+            int seed = componentFaces[f];
+            if(seeds[seed] != -1)
+            {
+                continue;
+            }
+
+            seeds[seed] = seed;
+            queue.clear();
+            queue.push_back(seed);
+            for(size_t q = 0; q < queue.size(); q++)
+            {
+                for(int k = 0; k < 3; k++)
+                {
+                    int j = neighbors[3 * queue[q] + k];
+                    if(j >= 0 && seeds[j] == -1 && roots[j] == c
+                       && fabs(normals[j] * normals[seed]) > angle)
+                    {
+                        seeds[j] = seed;
+                        queue.push_back(j);
+                    }
+                }
+            }
+        }
+    }
+
+    // Number the regions in the order of their seed faces, which are
+    // the faces with the smallest index of each region
+    vector<int> labels(n, -1);
+    regions.clear();
+    for(int i = 0; i < n; i++)
+    {
+        if(seeds[i] == i)
+        {
+            labels[i] = regions.size();
+            regions.push_back(new Region<VertexT, NormalT>(regions.size()));
+        }
+        regions[labels[seeds[i]]]->addFace(m_faces[i]);
+    }
+}
+
+template<typename VertexT, typename NormalT>
+int HalfEdgeMesh<VertexT, NormalT>::findRoot(vector<std::atomic<int> > &parents, int i)
+{
+    int parent = parents[i];
+    while(parent != i)
+    {
+        // Path halving
+        int grandparent = parents[parent];
+        parents[i].compare_exchange_weak(parent, grandparent);
+        i = grandparent;
+        parent = parents[i];
+    }
+    return i;
+}
+
+template<typename VertexT, typename NormalT>
+void HalfEdgeMesh<VertexT, NormalT>::unite(vector<std::atomic<int> > &parents, int i, int j)
+{
+    while(true)
+    {
+        i = findRoot(parents, i);
+        j = findRoot(parents, j);
+        if(i == j)
+        {
+            return;
+        }
+
+        if(i < j)
+        {
+            std::swap(i, j);
+        }
+
+        // Link the larger root i to j if it is still a root
+        int expected = i;
+        if(parents[i].compare_exchange_strong(expected, j))
+        {
+            return;
+        }
+    }
+}
+
 template<typename VertexT, typename NormalT>
 void HalfEdgeMesh<VertexT, NormalT>::clusterRegions(float angle, int minRegionSize)
 {
@@ -865,7 +1026,8 @@ void HalfEdgeMesh<VertexT, NormalT>::optimizePlanes(
         float angle,
         int min_region_size,
         int small_region_size,
-        bool remove_flickering)
+        bool remove_flickering,
+        bool parallel)
 {
     cout << timestamp << "Starting plane optimization with threshold " << angle << endl;
     cout << timestamp << "Number of faces before optimization: " << m_faces.size() << endl;
@@ -881,6 +1043,58 @@ void HalfEdgeMesh<VertexT, NormalT>::optimizePlanes(
     {
         cout << timestamp << "Optimizing planes. Iteration " <<  j + 1 << " / "  << iterations << endl;
 
+        if(parallel)
+        {
+            vector<RegionPtr> regions;
+            parallelRegionGrowing(angle, regions);
+
+            // Calculate the regression planes of the big regions in
+            // parallel. Each region uses its own random generator.
+            int threshold = max(min_region_size, default_region_threshold);
+            vector<VertexT> points(regions.size());
+            vector<NormalT> normals(regions.size());
+            vector<char> fitted(regions.size(), 0);
+
+            #pragma omp parallel for schedule(dynamic)
+            for(int r = 0; r < (int)regions.size(); r++)
+            {
+                if((int)regions[r]->size() > threshold)
+                {
+                    fitted[r] = regions[r]->calcRegressionPlane(points[r], normals[r], r + 1) ? 1 : 2;
+                }
+            }
+
+            // Drag the vertices into the planes in the order of the
+            // regions, so vertices shared by several regions end up in
+            // the plane of the last one. All planes are fitted to the
+            // unprojected positions. The serial version fits each plane
+            // after the projections of the previous regions, so the
+            // results can differ slightly.
+            for(size_t r = 0; r < regions.size(); r++)
+            {
+                m_garbageRegions.insert(regions[r]);
+
+                if(fitted[r] == 1)
+                {
+                    regions[r]->projectOntoPlane(points[r], normals[r]);
+                }
+                else if(fitted[r] == 2)
+                {
+                    regions[r]->regressionPlane();
+                }
+
+                if(j == iterations - 1)
+                {
+                    if((int)regions[r]->size() < small_region_size)
+                    {
+                        regions[r]->m_toDelete = true;
+                    }
+                    m_regions.push_back(regions[r]);
+                }
+            }
+            continue;
+        }
+
         // Reset all used variables
         for(size_t i = 0; i < m_faces.size(); i++)
         {
@@ -1289,8 +1503,7 @@ void HalfEdgeMesh<VertexT, NormalT>::fillHoles(size_t max_size)
                         {
                             if(current_hole[j]->end() == current_hole.back()->start())
                             {
-                                FacePtr f = new HFace;
-                                m_garbageFaces.insert(f);
+                                FacePtr f = m_facePool.create();
                                 f->m_edge = current_hole.back();
                                 current_hole.back()->setNext(current_hole[i]);
                                 current_hole[i]->setNext(current_hole[j]);
@@ -2028,81 +2241,491 @@ void HalfEdgeMesh<VertexT, NormalT>::finalizeAndRetesselate( bool genTextures, f
 
 
 template<typename VertexT, typename NormalT>
-void HalfEdgeMesh<VertexT, NormalT>::reduceMeshByCollapse(int n_collapses, VertexCosts<VertexT, NormalT> &c)
+void HalfEdgeMesh<VertexT, NormalT>::reduceMeshByCollapse(int n_collapses, VertexCosts<VertexT, NormalT> &c, float maxError)
 {
+    // Try not to collapse more edges than there are face pairs in the mesh
+    size_t numCollapses = n_collapses > 0 ? (size_t)n_collapses : 0;
+    numCollapses = std::min(numCollapses, m_faces.size() / 2);
+
+    // The vertex indices are used to address the per vertex data
+    for(size_t i = 0; i < m_vertices.size(); i++)
+    {
+        m_vertices[i]->m_index = i;
+    }
+
+    CollapseData data;
+    data.quadrics.resize(m_vertices.size());
+    data.locked.resize(m_vertices.size(), 0);
+    data.marks.resize(m_vertices.size(), 0);
+    data.stamp = 0;
+
+    // Sum up the weighted face planes in the quadrics of their vertices.
+    // Vertices on mesh borders and on region borders are locked.
+    vector<long> regions(m_vertices.size(), -2);
+    for(size_t i = 0; i < m_faces.size(); i++)
+    {
+        FacePtr f = m_faces[i];
+        EdgePtr edges[3] = {f->m_edge, f->m_edge->next(), f->m_edge->next()->next()};
+
+        const VertexT &p0 = edges[0]->start()->m_position;
+        const VertexT &p1 = edges[1]->start()->m_position;
+        const VertexT &p2 = edges[2]->start()->m_position;
+        double u[3] = {p1.x - p0.x, p1.y - p0.y, p1.z - p0.z};
+        double v[3] = {p2.x - p0.x, p2.y - p0.y, p2.z - p0.z};
+        double n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+        double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+        Quadric q;
+        if(length > 0)
+        {
+            n[0] /= length;
+            n[1] /= length;
+            n[2] /= length;
+            q = Quadric(n[0], n[1], n[2], -(n[0] * p0.x + n[1] * p0.y + n[2] * p0.z), c.faceWeight(*f));
+        }
+
+        for(int k = 0; k < 3; k++)
+        {
+            size_t index = edges[k]->start()->m_index;
+            data.quadrics[index] += q;
+
+            if(regions[index] == -2)
+            {
+                regions[index] = f->m_region;
+            }
+            else if(regions[index] != f->m_region)
+            {
+                data.locked[index] = 1;
+            }
+
+            try
+            {
+                edges[k]->pair()->face();
+            }
+            catch(HalfEdgeAccessException)
+            {
+                data.locked[edges[k]->start()->m_index] = 1;
+                data.locked[edges[k]->end()->m_index] = 1;
+            }
+        }
+    }
+
+    // Lock vertices whose faces do not form a single closed fan
+    for(size_t i = 0; i < m_vertices.size(); i++)
+    {
+        VertexPtr v = m_vertices[i];
+        if(data.locked[i] || v->out.empty() || v->out.size() != v->in.size())
+        {
+            data.locked[i] = 1;
+            continue;
+        }
+
+        EdgePtr e = v->out[0];
+        size_t count = 0;
+        do
+        {
+            e = e->pair()->next();
+            count++;
+        }
+        while(e != v->out[0] && count <= v->out.size());
+
+        data.locked[i] = count != v->out.size();
+    }
+
+    // Find the best collapse of every vertex
+    IndexedHeap heap(m_vertices.size());
+    vector<VertexPtr> targets(m_vertices.size(), 0);
+    vector<VertexT> positions(m_vertices.size());
+
+    for(size_t i = 0; i < m_vertices.size(); i++)
+    {
+        float cost;
+        if(!data.locked[i] && bestCollapse(m_vertices[i], data, targets[i], positions[i], cost))
+        {
+            heap.update(i, cost);
+        }
+    }
+
     string msg = timestamp.getElapsedTime() + "Collapsing edges...";
-    ProgressBar progress(n_collapses, msg);
-
-    // Try not to collapse more vertices than are in the mesh
-    if(n_collapses >= (int)m_vertices.size())
-    {
-        n_collapses = (int)m_vertices.size();
-    }
-    //    cout << "Collapsing " << n_collapses << endl;
-    //    for(int n = 0; n < n_collapses; n++)
-    //    {
-    //
-    //    	priority_queue<vertexCost_p, vector<vertexCost_p>, cVertexCost> q;
-    //    	for(size_t i = 0; i < this->m_vertices.size(); i++)
-    //    	{
-    //    		q.push(vertexCost_p(m_vertices[i], c(*m_vertices[i])));
-    //    	}
-    //
-    //    	cout << q.size() << endl;
-    //
-    //    	// Try to collapse until a non-border-edges is found. If there are only
-    //    	// borders left, collapse border edge with minimum cost
-    //    	if(!q.empty())
-    //    	{
-    //    		// Save vertex with lowest costs
-    //    		VertexPtr topVertex = q.top().first;
-    //    		VertexPtr toCollapse = topVertex;
-    //
-    //    		// Check for border vertices
-    //    		while(toCollapse->isBorderVertex() && !q.empty())
-//    		{
-//    			q.pop();
-//    			toCollapse = q.top().first;
-//    		}
-//
-//    		// If q is empty, no non-border vertex was found, collapse
-//    		// first border vertex
-//    		if(q.empty())
-//    		{
-//    			EdgePtr e = topVertex->getShortestEdge();
-//    			cout << "E: " << e << endl;
-//    			collapseEdge(e);
-//    		}
-//    		else
-//    		{
-//    			EdgePtr e = toCollapse->getShortestEdge();
-//    			cout << "F: " << e << endl;
-//    			collapseEdge(e);
-//    		}
-//    	}
-//
-//    	++progress;
-//    }
-
-
-  /*  priority_queue<vertexCost_p, vector<vertexCost_p>, cVertexCost> q;
-    for(size_t i = 0; i < this->m_vertices.size(); i++)
-    {
-    	q.push(vertexCost_p(m_vertices[i], c(*m_vertices[i])));
-    }
-
-    for(int i = 0; i < n_collapses && !q.empty(); i++)
-    {
-    	VertexPtr v = q.top().first;
-    	while(v->isBorderVertex() && !q.empty())
-    	{
-    		q.pop();
-    		v = q.top().first;
-    	}
-    	EdgePtr e = v->getShortestEdge();
-    	collapseEdge(e);
-    }*/
+    ProgressBar progress(numCollapses, msg);
+
+    vector<char> removed(m_vertices.size(), 0);
+    vector<FacePtr> removedFaces;
+    vector<VertexPtr> neighbors;
+    size_t collapses = 0;
+
+    while(collapses < numCollapses && !heap.empty() && heap.topKey() <= maxError)
+    {
+        size_t i = heap.top();
+        VertexPtr v = m_vertices[i];
+        VertexPtr w = targets[i];
+        float position[3] = {positions[i].x, positions[i].y, positions[i].z};
+
+        // The stored collapse may be outdated by collapses in the
+        // neighborhood. In this case the vertex is evaluated again.
+        EdgePtr edge = 0;
+        if(!removed[w->m_index])
+        {
+            for(size_t k = 0; k < v->out.size(); k++)
+            {
+                if(v->out[k]->end() == w)
+                {
+                    edge = v->out[k];
+                    break;
+                }
+            }
+        }
+
+        float cost;
+        if(!edge || !isCollapsible(edge, position, data))
+        {
+            if(bestCollapse(v, data, targets[i], positions[i], cost))
+            {
+                heap.update(i, cost);
+            }
+            else
+            {
+                heap.remove(i);
+            }
+            continue;
+        }
+
+        data.quadrics[i] += data.quadrics[w->m_index];
+        collapseInnerEdge(edge, positions[i], removedFaces);
+        removed[w->m_index] = 1;
+        heap.remove(w->m_index);
+
+        // Update the costs of the merged vertex and its neighbors
+        neighbors.clear();
+        neighbors.push_back(v);
+        for(size_t k = 0; k < v->out.size(); k++)
+        {
+            neighbors.push_back(v->out[k]->end());
+        }
+
+        for(size_t k = 0; k < neighbors.size(); k++)
+        {
+            size_t n = neighbors[k]->m_index;
+            if(data.locked[n])
+            {
+                continue;
+            }
+
+            if(bestCollapse(neighbors[k], data, targets[n], positions[n], cost))
+            {
+                heap.update(n, cost);
+            }
+            else
+            {
+                heap.remove(n);
+            }
+        }
+
+        collapses++;
+        if(!timestamp.isQuiet())
+            ++progress;
+    }
+
+    if(!timestamp.isQuiet())
+        cout << endl;
+
+    // Remove the collapsed faces from their regions and from the mesh
+    std::sort(removedFaces.begin(), removedFaces.end());
+
+    vector<char> regionChanged(m_regions.size(), 0);
+    for(size_t i = 0; i < removedFaces.size(); i++)
+    {
+        long r = removedFaces[i]->m_region;
+        if(r >= 0 && r < (long)m_regions.size())
+        {
+            regionChanged[r] = 1;
+        }
+    }
+
+    for(size_t r = 0; r < m_regions.size(); r++)
+    {
+        if(regionChanged[r])
+        {
+            m_regions[r]->deleteInvalidFaces();
+        }
+    }
+
+    size_t numFaces = 0;
+    for(size_t i = 0; i < m_faces.size(); i++)
+    {
+        if(!std::binary_search(removedFaces.begin(), removedFaces.end(), m_faces[i]))
+        {
+            m_faces[numFaces++] = m_faces[i];
+        }
+    }
+    m_faces.resize(numFaces);
+
+    for(size_t i = 0; i < removedFaces.size(); i++)
+    {
+        m_facePool.destroy(removedFaces[i]);
+    }
+
+    size_t numVertices = 0;
+    for(size_t i = 0; i < m_vertices.size(); i++)
+    {
+        if(removed[i])
+        {
+            m_vertexPool.destroy(m_vertices[i]);
+        }
+        else
+        {
+            m_vertices[numVertices] = m_vertices[i];
+            m_vertices[numVertices]->m_index = numVertices;
+            numVertices++;
+        }
+    }
+    m_vertices.resize(numVertices);
+    m_globalIndex = m_vertices.size();
+
+    cout << timestamp << "Collapsed " << collapses << " edges. Mesh has "
+         << m_vertices.size() << " vertices and " << m_faces.size() << " faces." << endl;
+}
+
+template<typename VertexT, typename NormalT>
+bool HalfEdgeMesh<VertexT, NormalT>::bestCollapse(VertexPtr v, CollapseData &data, VertexPtr &target, VertexT &position, float &cost)
+{
+    // Calculate the errors of all edges. The topology tests are only
+    // done for the cheapest ones.
+    data.edges.clear();
+    data.errors.clear();
+    data.positions.clear();
+
+    const VertexT &a = v->m_position;
+    for(size_t k = 0; k < v->out.size(); k++)
+    {
+        VertexPtr w = v->out[k]->end();
+        if(data.locked[w->m_index])
+        {
+            continue;
+        }
+
+        Quadric q = data.quadrics[v->m_index];
+        q += data.quadrics[w->m_index];
+
+        // Use the minimum of the quadric if it is unique and close to the
+        // edge. Otherwise take the best of the end points and the center.
+        const VertexT &b = w->m_position;
+        double mid[3] = {0.5 * (a.x + b.x), 0.5 * (a.y + b.y), 0.5 * (a.z + b.z)};
+        double length2 = (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z);
+
+        double p[3];
+        double error;
+        if(q.minimum(p[0], p[1], p[2])
+           && (p[0] - mid[0]) * (p[0] - mid[0]) + (p[1] - mid[1]) * (p[1] - mid[1]) + (p[2] - mid[2]) * (p[2] - mid[2]) <= length2)
+        {
+            error = q.evaluate(p[0], p[1], p[2]);
+        }
+        else
+        {
+            const double points[3][3] = {{mid[0], mid[1], mid[2]}, {a.x, a.y, a.z}, {b.x, b.y, b.z}};
+            error = numeric_limits<double>::max();
+            for(int i = 0; i < 3; i++)
+            {
+                double e = q.evaluate(points[i][0], points[i][1], points[i][2]);
+                if(e < error)
+                {
+                    error = e;
+                    p[0] = points[i][0];
+                    p[1] = points[i][1];
+                    p[2] = points[i][2];
+                }
+            }
+        }
+
+        data.edges.push_back(v->out[k]);
+        data.errors.push_back(std::max(error, 0.0));
+        data.positions.insert(data.positions.end(), p, p + 3);
+    }
+
+    // Test the candidates in the order of their errors
+    for(size_t n = 0; n < data.edges.size(); n++)
+    {
+        size_t best = 0;
+        for(size_t i = 1; i < data.edges.size(); i++)
+        {
+            if(data.errors[i] < data.errors[best])
+            {
+                best = i;
+            }
+        }
+
+        if(data.errors[best] == numeric_limits<double>::max())
+        {
+            break;
+        }
+
+        float p[3] = {(float)data.positions[3 * best], (float)data.positions[3 * best + 1], (float)data.positions[3 * best + 2]};
+        if(isCollapsible(data.edges[best], p, data))
+        {
+            target = data.edges[best]->end();
+            position = v->m_position;
+            position.x = p[0];
+            position.y = p[1];
+            position.z = p[2];
+            cost = data.errors[best];
+            return true;
+        }
+
+        data.errors[best] = numeric_limits<double>::max();
+    }
+
+    return false;
+}
+
+template<typename VertexT, typename NormalT>
+bool HalfEdgeMesh<VertexT, NormalT>::isCollapsible(EdgePtr edge, const float position[3], CollapseData &data)
+{
+    VertexPtr p1 = edge->start();
+    VertexPtr p2 = edge->end();
+    FacePtr f1 = edge->face();
+    FacePtr f2 = edge->pair()->face();
+
+    // The merged vertex needs at least three neighbors
+    if(p1->out.size() + p2->out.size() < 7)
+    {
+        return false;
+    }
+
+    // Link condition: The only common neighbors of both vertices are the
+    // opposite vertices of the two faces of the edge. Otherwise the
+    // collapse creates non manifold edges.
+    data.stamp++;
+    for(size_t k = 0; k < p1->out.size(); k++)
+    {
+        data.marks[p1->out[k]->end()->m_index] = data.stamp;
+    }
+
+    int common = 0;
+    for(size_t k = 0; k < p2->out.size(); k++)
+    {
+        if(data.marks[p2->out[k]->end()->m_index] == data.stamp)
+        {
+            common++;
+        }
+    }
 
+    if(common != 2)
+    {
+        return false;
+    }
+
+    // Reject the collapse if the normal of a remaining face would change
+    // by more than about 80 degrees
+    VertexPtr vertices[2] = {p1, p2};
+    for(int i = 0; i < 2; i++)
+    {
+        const VertexT &o = vertices[i]->m_position;
+        for(size_t k = 0; k < vertices[i]->out.size(); k++)
+        {
+            EdgePtr e = vertices[i]->out[k];
+            FacePtr f = e->face();
+            if(f == f1 || f == f2)
+            {
+                continue;
+            }
+
+            const VertexT &a = e->end()->m_position;
+            const VertexT &b = e->next()->end()->m_position;
+
+            float ab[3] = {b.x - a.x, b.y - a.y, b.z - a.z};
+            float u[3] = {a.x - o.x, a.y - o.y, a.z - o.z};
+            float v[3] = {a.x - position[0], a.y - position[1], a.z - position[2]};
+            float n0[3] = {u[1] * ab[2] - u[2] * ab[1], u[2] * ab[0] - u[0] * ab[2], u[0] * ab[1] - u[1] * ab[0]};
+            float n1[3] = {v[1] * ab[2] - v[2] * ab[1], v[2] * ab[0] - v[0] * ab[2], v[0] * ab[1] - v[1] * ab[0]};
+
+            float dot = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+            float l0 = n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2];
+            float l1 = n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2];
+            if(dot <= 0 || dot * dot <= 0.04f * l0 * l1)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template<typename VertexT, typename NormalT>
+void HalfEdgeMesh<VertexT, NormalT>::collapseInnerEdge(EdgePtr edge, const VertexT &position, vector<FacePtr> &removedFaces)
+{
+    // The edges of the two faces of the collapsed edge. The faces are
+    // (p1, p2, a) and (p2, p1, b).
+    EdgePtr h0 = edge;
+    EdgePtr h1 = h0->next();
+    EdgePtr h2 = h1->next();
+    EdgePtr g0 = h0->pair();
+    EdgePtr g1 = g0->next();
+    EdgePtr g2 = g1->next();
+
+    VertexPtr p1 = h0->start();
+    VertexPtr p2 = h0->end();
+    VertexPtr a  = h1->end();
+    VertexPtr b  = g1->end();
+
+    // The outer edges of both faces become pairs
+    EdgePtr o1 = h1->pair();
+    EdgePtr o2 = h2->pair();
+    EdgePtr o3 = g1->pair();
+    EdgePtr o4 = g2->pair();
+    o1->setPair(o2);
+    o2->setPair(o1);
+    o3->setPair(o4);
+    o4->setPair(o3);
+
+    // Remove the edges of both faces from their vertices
+    EdgePtr outEdges[6] = {h0, g1, g0, h1, h2, g2};
+    VertexPtr outVertices[6] = {p1, p1, p2, p2, a, b};
+    EdgePtr inEdges[6] = {g0, h2, h0, g2, h1, g1};
+    VertexPtr inVertices[6] = {p1, p1, p2, p2, a, b};
+    for(int i = 0; i < 6; i++)
+    {
+        vector<EdgePtr> &out = outVertices[i]->out;
+        out.erase(std::find(out.begin(), out.end(), outEdges[i]));
+        vector<EdgePtr> &in = inVertices[i]->in;
+        in.erase(std::find(in.begin(), in.end(), inEdges[i]));
+    }
+
+    // Move the remaining edges of p2 to p1
+    for(size_t i = 0; i < p2->out.size(); i++)
+    {
+        p2->out[i]->setStart(p1);
+        p1->out.push_back(p2->out[i]);
+    }
+    for(size_t i = 0; i < p2->in.size(); i++)
+    {
+        p2->in[i]->setEnd(p1);
+        p1->in.push_back(p2->in[i]);
+    }
+    p2->out.clear();
+    p2->in.clear();
+
+    FacePtr f1 = h0->face();
+    FacePtr f2 = g0->face();
+    f1->m_invalid = true;
+    f2->m_invalid = true;
+    removedFaces.push_back(f1);
+    removedFaces.push_back(f2);
+
+    for(int i = 0; i < 6; i++)
+    {
+        m_edgePool.destroy(outEdges[i]);
+    }
+
+    p1->m_position.x = position.x;
+    p1->m_position.y = position.y;
+    p1->m_position.z = position.z;
+    p1->m_normal = NormalT(p1->m_normal + p2->m_normal);
+
+    for(size_t i = 0; i < p1->out.size(); i++)
+    {
+        p1->out[i]->face()->calc_normal();
+    }
 }
 
 template<typename VertexT, typename NormalT>
@@ -0,0 +1,173 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * IndexedHeap.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef INDEXEDHEAP_HPP_
+#define INDEXEDHEAP_HPP_
+
+#include <vector>
+#include <cstddef>
+
+namespace lvr
+{
+
+/**
+ * @brief   A binary min heap over the ids 0..n-1. Each id is contained at
+ *          most once. Since the position of every id in the heap is known,
+ *          the key of a contained id can be changed and the id can be
+ *          removed in logarithmic time.
+ */
+class IndexedHeap
+{
+public:
+
+    /**
+     * @brief   Creates an empty heap for the ids 0..n-1
+     */
+    IndexedHeap(size_t n) : m_keys(n), m_positions(n, npos) {}
+
+    /// Returns true if the heap is empty
+    bool empty() const { return m_heap.empty(); }
+
+    /// Returns the number of contained ids
+    size_t size() const { return m_heap.size(); }
+
+    /// Returns true if the given id is contained in the heap
+    bool contains(size_t id) const { return m_positions[id] != npos; }
+
+    /// Returns the id with the smallest key
+    size_t top() const { return m_heap[0]; }
+
+    /// Returns the smallest key
+    float topKey() const { return m_keys[m_heap[0]]; }
+
+    /**
+     * @brief   Inserts the given id or changes its key if it is already
+     *          contained
+     */
+    void update(size_t id, float key)
+    {
+        if(!contains(id))
+        {
+            m_keys[id] = key;
+            m_positions[id] = m_heap.size();
+            m_heap.push_back(id);
+            up(m_heap.size() - 1);
+        }
+        else if(key < m_keys[id])
+        {
+            m_keys[id] = key;
+            up(m_positions[id]);
+        }
+        else
+        {
+            m_keys[id] = key;
+            down(m_positions[id]);
+        }
+    }
+
+    /**
+     * @brief   Removes the given id if it is contained
+     */
+    void remove(size_t id)
+    {
+        if(!contains(id))
+        {
+            return;
+        }
+
+        size_t pos = m_positions[id];
+        size_t last = m_heap.back();
+        m_heap.pop_back();
+        m_positions[id] = npos;
+
+        if(last != id)
+        {
+            m_heap[pos] = last;
+            m_positions[last] = pos;
+            up(pos);
+            down(m_positions[last]);
+        }
+    }
+
+    /// Removes the id with the smallest key
+    void pop() { remove(m_heap[0]); }
+
+private:
+
+    void up(size_t pos)
+    {
+        size_t id = m_heap[pos];
+        while(pos > 0)
+        {
+            size_t parent = (pos - 1) / 2;
+            if(!(m_keys[id] < m_keys[m_heap[parent]]))
+            {
+                break;
+            }
+            m_heap[pos] = m_heap[parent];
+            m_positions[m_heap[pos]] = pos;
+            pos = parent;
+        }
+        m_heap[pos] = id;
+        m_positions[id] = pos;
+    }
+
+    void down(size_t pos)
+    {
+        size_t id = m_heap[pos];
+        size_t n = m_heap.size();
+        while(2 * pos + 1 < n)
+        {
+            size_t child = 2 * pos + 1;
+            if(child + 1 < n && m_keys[m_heap[child + 1]] < m_keys[m_heap[child]])
+            {
+                child++;
+            }
+            if(!(m_keys[m_heap[child]] < m_keys[id]))
+            {
+                break;
+            }
+            m_heap[pos] = m_heap[child];
+            m_positions[m_heap[pos]] = pos;
+            pos = child;
+        }
+        m_heap[pos] = id;
+        m_positions[id] = pos;
+    }
+
+    static const size_t npos = (size_t)-1;
+
+    /// The contained ids in heap order
+    std::vector<size_t>     m_heap;
+
+    /// The keys of all ids
+    std::vector<float>      m_keys;
+
+    /// The positions of all ids in the heap or npos
+    std::vector<size_t>     m_positions;
+};
+
+} /* namespace lvr */
+
+#endif /* INDEXEDHEAP_HPP_ */
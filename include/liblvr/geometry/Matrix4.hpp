@@ -33,6 +33,7 @@
 
 #include "Vertex.hpp"
 #include "Normal.hpp"
+#include "PointTransform.hpp"
 
 #define _USE_MATH_DEFINES
 #include <cmath>
@@ -325,6 +326,38 @@ public:
         return Normal<T>(x, y, z);
     }
 
+	/**
+	 * @brief	Transforms an array of points in place. See
+	 * 			\ref transformPointArray.
+	 *
+	 * @param	points	The points (three coordinates per point)
+	 * @param	n		The number of points
+	 * @param	bbMin	If not NULL, it is lowered to the minimum of the
+	 * 					transformed points
+	 * @param	bbMax	If not NULL, it is raised to the maximum of the
+	 * 					transformed points
+	 */
+	void transformPoints(float* points, size_t n, float* bbMin = 0, float* bbMax = 0) const
+	{
+		float matrix[16];
+		for(int i = 0; i < 16; i++) matrix[i] = m[i];
+		transformPointArray(matrix, points, n, bbMin, bbMax);
+	}
+
+	/**
+	 * @brief	Transforms and normalizes an array of normals in place. See
+	 * 			\ref transformNormalArray.
+	 *
+	 * @param	normals	The normals (three coordinates per normal)
+	 * @param	n		The number of normals
+	 */
+	void transformNormals(float* normals, size_t n) const
+	{
+		float matrix[16];
+		for(int i = 0; i < 16; i++) matrix[i] = m[i];
+		transformNormalArray(matrix, normals, n);
+	}
+
 	/**
 	 * @brief	Sets the given index of the Matrix's data field
 	 * 			to the provided value.
@@ -80,8 +80,6 @@ public:
 		this->z = other.z;
 	}
 
-	virtual ~Normal(){};
-
 	/**
 	 * @brief	Normalizes the components.
 	 */
@@ -92,7 +90,7 @@ public:
 	    return Normal<CoordType>(this->x + n.x, this->y + n.y, this->z + n.z);
 	}
 
-	virtual Normal<CoordType> operator-(const Normal &n) const
+	Normal<CoordType> operator-(const Normal &n) const
 	{
 		return Normal<CoordType>(this->x - n.x, this->y - n.y, this->z - n.z);
 	}
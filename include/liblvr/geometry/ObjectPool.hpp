@@ -0,0 +1,110 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * ObjectPool.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef OBJECTPOOL_HPP_
+#define OBJECTPOOL_HPP_
+
+#include <vector>
+#include <cstddef>
+
+namespace lvr
+{
+
+/**
+ * @brief   Allocates objects of type T in large blocks. This avoids the
+ *          allocator overhead of many small objects and keeps objects that
+ *          are created one after another close together in memory. Freed
+ *          objects are kept in a free list and their memory is reused by
+ *          the next created objects. All objects that are still alive are
+ *          destroyed with the pool.
+ */
+template<typename T>
+class ObjectPool
+{
+public:
+
+    /**
+     * @brief   Creates an empty pool
+     *
+     * @param   blockSize   Number of objects per allocated block
+     */
+    ObjectPool(size_t blockSize = 4096);
+
+    /**
+     * @brief   Destroys all objects of the pool
+     */
+    ~ObjectPool();
+
+    /**
+     * @brief   Creates a default constructed object
+     */
+    T* create();
+
+    /**
+     * @brief   Creates an object from the given constructor argument
+     */
+    template<typename A>
+    T* create(const A &a);
+
+    /**
+     * @brief   Destroys an object of the pool. Its memory is reused by
+     *          later calls of create().
+     */
+    void destroy(T* object);
+
+    /**
+     * @brief   Destroys all objects and frees the allocated memory
+     */
+    void clear();
+
+    /// Returns the number of living objects
+    size_t size() const { return m_used - m_free.size(); }
+
+private:
+
+    /// Not copyable
+    ObjectPool(const ObjectPool&);
+    ObjectPool& operator=(const ObjectPool&);
+
+    /// Returns memory for a new object
+    void* allocate();
+
+    /// Number of objects per block
+    size_t              m_blockSize;
+
+    /// Number of used slots in all blocks
+    size_t              m_used;
+
+    /// The allocated blocks
+    std::vector<T*>     m_blocks;
+
+    /// Slots of destroyed objects
+    std::vector<T*>     m_free;
+};
+
+} /* namespace lvr */
+
+#include "ObjectPool.tcc"
+
+#endif /* OBJECTPOOL_HPP_ */
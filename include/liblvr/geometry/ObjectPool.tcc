@@ -0,0 +1,107 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * ObjectPool.tcc
+ *
+ *  @date 18.10.2026
+ */
+
+#include <algorithm>
+#include <new>
+
+namespace lvr
+{
+
+template<typename T>
+ObjectPool<T>::ObjectPool(size_t blockSize)
+    : m_blockSize(blockSize), m_used(0)
+{
+}
+
+template<typename T>
+ObjectPool<T>::~ObjectPool()
+{
+    clear();
+}
+
+template<typename T>
+T* ObjectPool<T>::create()
+{
+    return new(allocate()) T();
+}
+
+template<typename T>
+template<typename A>
+T* ObjectPool<T>::create(const A &a)
+{
+    return new(allocate()) T(a);
+}
+
+template<typename T>
+void ObjectPool<T>::destroy(T* object)
+{
+    object->~T();
+    m_free.push_back(object);
+}
+
+template<typename T>
+void ObjectPool<T>::clear()
+{
+    // Destroy all slots that are not in the free list
+    std::sort(m_free.begin(), m_free.end());
+    for(size_t i = 0; i < m_used; i++)
+    {
+        T* object = m_blocks[i / m_blockSize] + i % m_blockSize;
+        if(!std::binary_search(m_free.begin(), m_free.end(), object))
+        {
+            object->~T();
+        }
+    }
+
+    for(size_t i = 0; i < m_blocks.size(); i++)
+    {
+        ::operator delete(m_blocks[i]);
+    }
+
+    m_blocks.clear();
+    m_free.clear();
+    m_used = 0;
+}
+
+template<typename T>
+void* ObjectPool<T>::allocate()
+{
+    if(!m_free.empty())
+    {
+        T* object = m_free.back();
+        m_free.pop_back();
+        return object;
+    }
+
+    if(m_used == m_blocks.size() * m_blockSize)
+    {
+        m_blocks.push_back(static_cast<T*>(::operator new(m_blockSize * sizeof(T))));
+    }
+
+    T* object = m_blocks[m_used / m_blockSize] + m_used % m_blockSize;
+    m_used++;
+    return object;
+}
+
+} /* namespace lvr */
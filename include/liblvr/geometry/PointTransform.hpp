@@ -0,0 +1,83 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * PointTransform.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef POINTTRANSFORM_HPP_
+#define POINTTRANSFORM_HPP_
+
+#include "io/PointBuffer.hpp"
+
+#include <cstddef>
+
+namespace lvr
+{
+
+/**
+ * @brief Applies a transformation to an array of points in place. The
+ *        matrix is stored in column major order as in \ref Matrix4, i.e.
+ *        the translation is stored in the elements 12 to 14. The points
+ *        are processed in parallel with SSE or AVX instructions if the
+ *        CPU supports them.
+ *
+ * @param matrix    A 4x4 transformation matrix (column major)
+ * @param points    The points (three coordinates per point)
+ * @param n         The number of points
+ * @param bbMin     If not NULL, it is lowered to the minimum of the
+ *                  transformed points
+ * @param bbMax     If not NULL, it is raised to the maximum of the
+ *                  transformed points
+ */
+void transformPointArray(const float matrix[16], float* points, size_t n,
+        float* bbMin = 0, float* bbMax = 0);
+
+/**
+ * @brief Applies a transformation to an array of normals in place and
+ *        normalizes them. The normals are transformed with the inverse
+ *        transpose of the upper 3x3 part of the matrix, so they stay
+ *        perpendicular to the transformed surface also for scaling and
+ *        shearing. The translation is ignored.
+ *
+ * @param matrix    A 4x4 transformation matrix (column major)
+ * @param normals   The normals (three coordinates per normal)
+ * @param n         The number of normals
+ */
+void transformNormalArray(const float matrix[16], float* normals, size_t n);
+
+/**
+ * @brief Applies a transformation to the points and the point normals of
+ *        the given buffer in place.
+ *
+ * @param matrix    A 4x4 transformation matrix (column major)
+ * @param buffer    A point buffer
+ * @param bbMin     If not NULL, it is lowered to the minimum of the
+ *                  transformed points
+ * @param bbMax     If not NULL, it is raised to the maximum of the
+ *                  transformed points
+ */
+void transformPointBuffer(const float matrix[16], PointBufferPtr buffer,
+        float* bbMin = 0, float* bbMax = 0);
+
+} /* namespace lvr */
+
+#endif /* POINTTRANSFORM_HPP_ */
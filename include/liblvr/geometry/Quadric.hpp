@@ -0,0 +1,127 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * Quadric.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef QUADRIC_HPP_
+#define QUADRIC_HPP_
+
+#include <cmath>
+
+namespace lvr
+{
+
+/**
+ * @brief   An error quadric as used by Garland and Heckbert's mesh
+ *          simplification. The symmetric 4x4 matrix is stored in its ten
+ *          upper triangle entries. Double precision is used because the
+ *          quadrics of many planes are accumulated during a simplification.
+ */
+class Quadric
+{
+public:
+
+    /// Creates the zero quadric
+    Quadric()
+    {
+        for(int i = 0; i < 10; i++) m_q[i] = 0;
+    }
+
+    /**
+     * @brief   Creates the weighted quadric of the plane ax + by + cz + d = 0.
+     *          (a, b, c) has to be normalized.
+     */
+    Quadric(double a, double b, double c, double d, double w)
+    {
+        m_q[0] = w * a * a; m_q[1] = w * a * b; m_q[2] = w * a * c; m_q[3] = w * a * d;
+        m_q[4] = w * b * b; m_q[5] = w * b * c; m_q[6] = w * b * d;
+        m_q[7] = w * c * c; m_q[8] = w * c * d;
+        m_q[9] = w * d * d;
+    }
+
+    Quadric& operator+=(const Quadric& o)
+    {
+        for(int i = 0; i < 10; i++) m_q[i] += o.m_q[i];
+        return *this;
+    }
+
+    Quadric operator+(const Quadric& o) const
+    {
+        Quadric r(*this);
+        r += o;
+        return r;
+    }
+
+    /**
+     * @brief   Returns the weighted sum of the squared distances of the
+     *          given point to the planes of the quadric
+     */
+    double evaluate(double x, double y, double z) const
+    {
+        return    m_q[0] * x * x + 2 * m_q[1] * x * y + 2 * m_q[2] * x * z + 2 * m_q[3] * x
+                + m_q[4] * y * y + 2 * m_q[5] * y * z + 2 * m_q[6] * y
+                + m_q[7] * z * z + 2 * m_q[8] * z
+                + m_q[9];
+    }
+
+    /**
+     * @brief   Calculates the point that minimizes the quadric.
+     *
+     * @return  False if the minimum is not unique, e.g. if all planes
+     *          are (nearly) parallel
+     */
+    bool minimum(double &x, double &y, double &z) const
+    {
+        double a00 = m_q[0], a01 = m_q[1], a02 = m_q[2];
+        double a11 = m_q[4], a12 = m_q[5], a22 = m_q[7];
+
+        double c00 = a11 * a22 - a12 * a12;
+        double c01 = a02 * a12 - a01 * a22;
+        double c02 = a01 * a12 - a02 * a11;
+        double det = a00 * c00 + a01 * c01 + a02 * c02;
+
+        double trace = a00 + a11 + a22;
+        if(std::fabs(det) <= 1e-6 * trace * trace * trace)
+        {
+            return false;
+        }
+
+        double c11 = a00 * a22 - a02 * a02;
+        double c12 = a01 * a02 - a00 * a12;
+        double c22 = a00 * a11 - a01 * a01;
+
+        double b0 = -m_q[3], b1 = -m_q[6], b2 = -m_q[8];
+        x = (c00 * b0 + c01 * b1 + c02 * b2) / det;
+        y = (c01 * b0 + c11 * b1 + c12 * b2) / det;
+        z = (c02 * b0 + c12 * b1 + c22 * b2) / det;
+        return true;
+    }
+
+private:
+
+    /// The upper triangle of the matrix in row major order
+    double m_q[10];
+};
+
+} /* namespace lvr */
+
+#endif /* QUADRIC_HPP_ */
@@ -61,6 +61,12 @@ public:
 	 */
 	virtual float operator()(HalfEdgeVertex<VertexT, NormalT> &v);
 
+	/**
+	 * @brief	Returns the area of the face if the object was created with
+	 * 			the useTriangleArea flag, 1 otherwise
+	 */
+	virtual float faceWeight(HalfEdgeFace<VertexT, NormalT> &f);
+
 private:
 
 	float calcQuadricError(Matrix4<float> &quadric, HVertex* v, float area);
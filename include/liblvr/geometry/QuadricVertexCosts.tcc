@@ -77,6 +77,12 @@ float QuadricVertexCosts<VertexT, NormalT>::operator()(HalfEdgeVertex<VertexT, N
 	}
 }
 
+template<typename VertexT, typename NormalT>
+float QuadricVertexCosts<VertexT, NormalT>::faceWeight(HalfEdgeFace<VertexT, NormalT> &f)
+{
+	return m_useTri ? f.getArea() : 1.0f;
+}
+
 template<typename VertexT, typename NormalT>
 float QuadricVertexCosts<VertexT, NormalT>::calcQuadricError(Matrix4<float> &quadric, HVertex* v, float area)
 {
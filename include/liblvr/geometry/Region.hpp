@@ -120,6 +120,29 @@ public:
 	 */
 	virtual void regressionPlane();
 
+	/**
+	 * @brief Calculates a regression plane for the region with RANSAC
+	 * 		  without changing the region
+	 *
+	 * @param	point	a point in the plane
+	 * @param	normal	the normal of the plane
+	 * @param	seed	if 0, the samples are drawn with rand(). Otherwise a
+	 * 					separate generator with the given seed is used, so
+	 * 					that planes can be calculated in parallel and the
+	 * 					result does not depend on the calling order.
+	 *
+	 * @return	false if the region has too few faces
+	 */
+	virtual bool calcRegressionPlane(VertexT &point, NormalT &normal, unsigned long long seed = 0);
+
+	/**
+	 * @brief Drags all vertices of the region into the given plane
+	 *
+	 * @param	point	a point in the plane
+	 * @param	normal	the normal of the plane
+	 */
+	virtual void projectOntoPlane(const VertexT &point, const NormalT &normal);
+
 	/**
 	 * @brief tells if the given face is flickering
 	 *
@@ -168,6 +191,12 @@ private:
 	 */
 	virtual NormalT calcNormal();
 
+	/**
+	 * @brief returns a random number from rand() if seed is 0, otherwise
+	 * 		  from a linear congruential generator with the given state
+	 */
+	static int random(unsigned long long &seed);
+
 	// The region's label
 	std::string m_label;
 
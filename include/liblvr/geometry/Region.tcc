@@ -397,22 +397,32 @@ void Region<VertexT, NormalT>::regressionPlane()
 {
 //    srand(time(NULL));
 
+    VertexT bestpoint;
+    NormalT bestNorm;
+
     // Quick and dirty fox to avoid hanging when
     // degenrated faces are in buffer
-    if(m_faces.size() < 3)
+    if(!calcRegressionPlane(bestpoint, bestNorm))
     {
         m_normal = m_faces[0]->getFaceNormal();
         return;
     }
 
+    projectOntoPlane(bestpoint, bestNorm);
+}
+
+template<typename VertexT, typename NormalT>
+bool Region<VertexT, NormalT>::calcRegressionPlane(VertexT &bestpoint, NormalT &bestNorm, unsigned long long seed)
+{
+    if(m_faces.size() < 3)
+    {
+        return false;
+    }
+
     VertexT point1;
     VertexT point2;
     VertexT point3;
 
-    //representation of best regression plane by point and normal
-    VertexT bestpoint;
-    NormalT bestNorm;
-
     float bestdist = std::numeric_limits<float>::max();
     float dist     = 0;
 
@@ -424,9 +434,9 @@ void Region<VertexT, NormalT>::regressionPlane()
     	NormalT n0;
         //randomly choose 3 disjoint points
         do{
-            point1 = (*m_faces[rand() % m_faces.size()])(0)->m_position;
-            point2 = (*m_faces[rand() % m_faces.size()])(1)->m_position;
-            point3 = (*m_faces[rand() % m_faces.size()])(2)->m_position;
+            point1 = (*m_faces[random(seed) % m_faces.size()])(0)->m_position;
+            point2 = (*m_faces[random(seed) % m_faces.size()])(1)->m_position;
+            point3 = (*m_faces[random(seed) % m_faces.size()])(2)->m_position;
 
             //compute normal of the plane given by the 3 points
             n0 = (point1 - point2).cross(point1 - point3);
@@ -438,7 +448,7 @@ void Region<VertexT, NormalT>::regressionPlane()
         dist = 0;
         for(int i = 0; i < min(50, (int)m_faces.size()); i++)
         {
-            VertexT refpoint = (*m_faces[rand() % m_faces.size()])(0)->m_position;
+            VertexT refpoint = (*m_faces[random(seed) % m_faces.size()])(0)->m_position;
             dist += fabs(refpoint * n0 - point1 * n0) / min(50, (int)m_faces.size());
         }
 
@@ -460,6 +470,12 @@ void Region<VertexT, NormalT>::regressionPlane()
         iterations++;
     }
 
+    return true;
+}
+
+template<typename VertexT, typename NormalT>
+void Region<VertexT, NormalT>::projectOntoPlane(const VertexT &bestpoint, const NormalT &bestNorm)
+{
     //drag points into the regression plane
     for(size_t i = 0; i < m_faces.size(); i++)
     {
@@ -474,7 +490,20 @@ void Region<VertexT, NormalT>::regressionPlane()
     }
     this->m_inPlane = true;
     this->m_normal = calcNormal();
-    this->m_stuetzvektor = point1;
+    this->m_stuetzvektor = bestpoint;
+}
+
+template<typename VertexT, typename NormalT>
+int Region<VertexT, NormalT>::random(unsigned long long &seed)
+{
+    if(seed == 0)
+    {
+        return rand();
+    }
+
+    // 64 bit linear congruential generator, the upper bits are used
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (int)(seed >> 33);
 }
 
 template<typename VertexT, typename NormalT>
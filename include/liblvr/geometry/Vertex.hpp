@@ -42,7 +42,10 @@ template<typename T> class Matrix4;
 /**
  * @brief         Basic vertex class. Supports all arithmetic operators
  *                 as well as indexed access and matrix multiplication
- *                 with the Matrix4 class
+ *                 with the Matrix4 class. The class has no virtual
+ *                 methods and is trivially copyable, so it only holds
+ *                 the three coordinates and all operators can be
+ *                 inlined.
  */
 template<typename CoordType>
 class Vertex{
@@ -68,21 +71,6 @@ class Vertex{
             z = _z;
         }
 
-        /**
-         * @brief    Copy Ctor.
-         */
-        Vertex(const Vertex &o)
-        {
-            x = o.x;
-            y = o.y;
-            z = o.z;
-        }
-
-        /**
-         * @brief    Destructor
-         */
-        virtual ~Vertex(){};
-
         /**
          * @brief     Return the current length of the vector
          */
@@ -158,7 +146,7 @@ class Vertex{
          *             Vertex and assigns the result to the current
          *             instance.
          */
-        virtual void crossTo(const Vertex &other);
+        void crossTo(const Vertex &other);
 
 
         /**
@@ -166,7 +154,7 @@ class Vertex{
          *
          * @param other  Another Vertex.
          */
-        virtual CoordType distance( const Vertex &other ) const;
+        CoordType distance( const Vertex &other ) const;
 
 
 
@@ -175,65 +163,65 @@ class Vertex{
          *
          * @param other  Another Vertex.
          */
-		virtual CoordType sqrDistance( const Vertex &other ) const;
+		CoordType sqrDistance( const Vertex &other ) const;
 
         /**
          * @brief    Multiplication operator (dot product)
          */
-        virtual CoordType operator*(const Vertex &other) const;
+        CoordType operator*(const Vertex &other) const;
 
 
         /**
          * @brief     Multiplication operator (scaling)
          */
-        virtual Vertex<CoordType> operator*(const CoordType &scale) const;
+        Vertex<CoordType> operator*(const CoordType &scale) const;
 
 
-        virtual Vertex<CoordType> operator+(const Vertex &other) const;
+        Vertex<CoordType> operator+(const Vertex &other) const;
 
 
         /**
          * @brief    Coordinate subtraction
          */
-        virtual Vertex<CoordType> operator-(const Vertex &other) const;
+        Vertex<CoordType> operator-(const Vertex &other) const;
 
         /**
          * @brief    Coordinate substraction
          */
-        virtual void operator-=(const Vertex &other);
+        void operator-=(const Vertex &other);
 
         /**
          * @brief    Coordinate addition
          */
-        virtual void operator+=(const Vertex<CoordType> &other);
+        void operator+=(const Vertex<CoordType> &other);
 
 
         /**
          * @brief    Scaling
          */
-        virtual void operator*=(const CoordType &scale);
+        void operator*=(const CoordType &scale);
 
 
         /**
          * @brief    Scaling
          */
-        virtual void operator/=(const CoordType &scale);
+        void operator/=(const CoordType &scale);
 
         /**
          * @brief    Compares two vertices
          */
-        virtual bool operator==(const Vertex &other) const;
+        bool operator==(const Vertex &other) const;
 
         /**
          * @brief    Compares two vertices
          */
-        virtual bool operator!=(const Vertex &other) const
+        bool operator!=(const Vertex &other) const
         {
             return !(*this == other);
         }
 
 
-        virtual bool operator<(const Vertex &other) const
+        bool operator<(const Vertex &other) const
         {
             return ( this->x < other.x ) 
                 || ( ( this->x - other.x <= 0.00001 )
@@ -245,12 +233,12 @@ class Vertex{
         /**
          * @brief    Indexed coordinate access (reading)
          */
-        virtual CoordType operator[](const int &index) const;
+        CoordType operator[](const int &index) const;
 
         /**
          * @brief   Indexed coordinate access (writing)
          */
-        virtual CoordType& operator[](const int &index);
+        CoordType& operator[](const int &index);
 
 
         /// The x-coordinate of the vertex
@@ -49,6 +49,13 @@ public:
 	 * 			should be removed from the mesh.
 	 */
 	virtual float operator()(HalfEdgeVertex<VertexT, NormalT> &v) { return std::numeric_limits<float>::max(); }
+
+	/**
+	 * @brief	Weight of the plane of the given face in the error quadrics
+	 * 			of its vertices. The default implementation weights all
+	 * 			faces equally.
+	 */
+	virtual float faceWeight(HalfEdgeFace<VertexT, NormalT> &f) { return 1.0f; }
 };
 
 
@@ -56,13 +56,27 @@ class AsciiIO : public BaseIO
 
         /**
          * @brief Reads the given file and stores point and normal
-         *        information in the given parameters
+         *        information in the given parameters. The column layout
+         *        is taken from the column names in the first line or
+         *        guessed from the number of values in the second line
+         *        (see \ref AsciiParser::guessLayout).
          *
          * @param filename      The file to read
          */
         virtual ModelPtr read( string filename );
 
 
+        /**
+         * @brief Passes the points and normals of the given file chunk
+         *        by chunk to the handler. The column layout is
+         *        determined like in \ref read.
+         *
+         * @param filename      The file to read
+         * @param handler       Receives the chunks
+         */
+        virtual bool readChunks( string filename, PointChunkHandler &handler );
+
+
         /**
          * @todo : Implement save method for ASCII Files...
          * @param filename
@@ -70,7 +84,10 @@ class AsciiIO : public BaseIO
         virtual void save( string filename );
 
 
-        /// TODO: Coordinate mapping for ascii files
+        /**
+         * @brief Helper method. Returns the number of lines in the
+         *        given file.
+         */
         static size_t countLines(string filename);
 
 
@@ -0,0 +1,158 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * AsciiParser.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef ASCIIPARSER_HPP_
+#define ASCIIPARSER_HPP_
+
+#include "io/PointBuffer.hpp"
+#include "io/BaseIO.hpp"
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace lvr
+{
+
+/**
+ * @brief Column layout of point data in text files. Each member is the
+ *        index of the column that contains the value or -1 if the value
+ *        is not present.
+ */
+struct AsciiLayout
+{
+    /// Creates a layout with the coordinates in the first three columns
+    AsciiLayout();
+
+    /// Returns the number of columns a line needs to contain a point
+    int numColumns() const;
+
+    int x, y, z;
+    int intensity;
+    int confidence;
+    int r, g, b;
+    int nx, ny, nz;
+};
+
+/**
+ * @brief Parses point data from text files. The file is mapped into
+ *        memory, split into chunks at line boundaries and the chunks are
+ *        parsed in parallel. Values may be separated by blanks, tabs,
+ *        commas or semicolons. Numbers are parsed independently of the
+ *        current locale. Lines that contain too few values for the
+ *        given layout are ignored.
+ */
+class AsciiParser
+{
+public:
+
+    /**
+     * @brief Maps the given file into memory.
+     */
+    AsciiParser(string filename);
+
+    /**
+     * @brief Destructor. Releases the mapping.
+     */
+    virtual ~AsciiParser();
+
+    /// Returns true if the file could be opened
+    bool isOpen() const { return m_open; }
+
+    /// Returns the n-th line of the file without the line break
+    string getLine(size_t n) const;
+
+    /// Counts the lines of the file
+    size_t countLines() const;
+
+    /**
+     * @brief Guesses the column layout. If the first line names the
+     *        columns (e.g. "x y z r g b" or "//X Y Z Intensity"), the
+     *        names are used. Otherwise the number of values in the
+     *        second line selects the layout: four values are read as
+     *        coordinates and intensity, six as coordinates and color,
+     *        seven as coordinates, intensity and color and eight as
+     *        coordinates, confidence, an unused value and color.
+     */
+    AsciiLayout guessLayout() const;
+
+    /**
+     * @brief Parses all lines behind the first skipLines lines.
+     *
+     * @param layout        Column layout of the point data
+     * @param skipLines     Number of header lines to skip
+     *
+     * @return A point buffer with the points and all attributes that are
+     *         present in the layout
+     */
+    PointBufferPtr read(const AsciiLayout &layout, size_t skipLines = 1) const;
+
+    /**
+     * @brief Parses all lines behind the first skipLines lines and passes
+     *        the coordinates and normals to the handler in file order.
+     *        Only a few chunks are held in memory at once.
+     *
+     * @param layout        Column layout of the point data
+     * @param skipLines     Number of header lines to skip
+     * @param handler       Receives the parsed chunks
+     */
+    void readChunks(const AsciiLayout &layout, size_t skipLines,
+            PointChunkHandler &handler) const;
+
+    /// Splits the given line into its values
+    static vector<string> split(const string &line);
+
+private:
+
+    /// Returns the position behind the first n lines
+    const char* skip(size_t n) const;
+
+    /// Splits the range into chunks that start at the beginning of lines
+    void getChunks(const char* begin, vector<const char*> &chunks) const;
+
+    /// Start of the file data
+    char*           m_data;
+
+    /// Size of the file
+    size_t          m_size;
+
+    /// True if the file could be opened
+    bool            m_open;
+
+    /// True if the data is mapped, false if it was copied to memory
+    bool            m_mapped;
+
+    /// Maximal size of a chunk that is parsed by one thread at once
+    static const size_t m_chunkSize = 1 << 22;
+
+    /// Minimal size of a chunk that is parsed by one thread at once
+    static const size_t m_minChunkSize = 1 << 16;
+};
+
+} /* namespace lvr */
+
+#endif /* ASCIIPARSER_HPP_ */
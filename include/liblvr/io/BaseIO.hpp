@@ -43,6 +43,26 @@ using std::string;
 namespace lvr
 {
 
+/**
+ * @brief Receives the points of a file chunk by chunk, see
+ *        \ref BaseIO::readChunks.
+ */
+class PointChunkHandler
+{
+    public:
+        virtual ~PointChunkHandler() {}
+
+        /**
+         * \brief Called for each chunk of points in file order.
+         *
+         * @param points    Array of n points
+         * @param normals   Array of n normals or NULL if the file
+         *                  contains no normals
+         * @param n         Number of points in the chunk
+         */
+        virtual void addChunk(const float* points, const float* normals, size_t n) = 0;
+};
+
 /**
  * @brief Interface specification for low-level io. All read
  *        elements are stored in linear arrays.
@@ -60,6 +80,20 @@ class BaseIO
         virtual ModelPtr read(string filename ) = 0;
 
 
+        /**
+         * \brief Passes the points and normals of the given file chunk
+         *        by chunk to the handler, so that large files can be
+         *        processed without loading them completely. The default
+         *        implementation reads the whole file and passes it as a
+         *        single chunk.
+         *
+         * @param filename  The file to read.
+         * @param handler   Receives the chunks.
+         * @return          False if the file could not be read.
+         */
+        virtual bool readChunks( string filename, PointChunkHandler &handler );
+
+
         /**
          * \brief Save the loaded elements to the given file.
          *
@@ -122,6 +122,9 @@ typedef boost::shared_array<unsigned int> uintArr;
 typedef boost::shared_array<float> floatArr;
 
 
+typedef boost::shared_array<double> doubleArr;
+
+
 typedef boost::shared_array<unsigned char> ucharArr;
 
 
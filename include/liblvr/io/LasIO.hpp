@@ -32,12 +32,58 @@ namespace lvr
 {
 
 /**
- * @brief   Interface class to read laser scan data in .las-Format
+ * @brief   Filters that are applied while points are read from LAS files
+ */
+struct LasFilter
+{
+    /// True, if only points within the bounding box are read
+    bool            useBoundingBox;
+
+    /// Minimum corner of the bounding box
+    double          min[3];
+
+    /// Maximum corner of the bounding box
+    double          max[3];
+
+    /// Only every n-th point record of the file is read
+    unsigned int    everyNth;
+
+    LasFilter() : useBoundingBox(false), everyNth(1)
+    {
+        for(int i = 0; i < 3; i++)
+        {
+            min[i] = max[i] = 0;
+        }
+    }
+
+    /// Returns true if the given coordinates pass the bounding box filter
+    inline bool inside(double x, double y, double z) const
+    {
+        return !useBoundingBox
+            || (x >= min[0] && x <= max[0]
+             && y >= min[1] && y <= max[1]
+             && z >= min[2] && z <= max[2]);
+    }
+};
+
+/**
+ * @brief   Interface class to read and write laser scan data in .las and
+ *          .laz format. Uncompressed files of all point formats are read
+ *          in chunks that are decoded in parallel. Compressed files are
+ *          read with laslib. Colors, intensities, GPS times and normals
+ *          that are stored as extra bytes named NormalX, NormalY and
+ *          NormalZ are loaded.
  */
 class LasIO : public BaseIO
 {
 public:
-    LasIO() {};
+    /**
+     * @brief Constructor.
+     *
+     * @param filter    The filter that is applied to all files read by
+     *                  this instance
+     */
+    LasIO(const LasFilter &filter = LasFilter()) : m_filter(filter) {};
     virtual ~LasIO() {};
 
     /**
@@ -48,12 +94,47 @@ public:
     virtual ModelPtr read(string filename );
 
     /**
-     * @brief Save the loaded elements to the given file.
+     * @brief Save the point cloud of the model to the given file. The
+     *        points are streamed into a LAS 1.2 file with point format
+     *        0 to 3 depending on the available colors and times. Normals
+     *        are stored as float extra bytes. Files with the extension
+     *        .laz are compressed.
      *
      * @param filename Filename of the file to write.
      */
     virtual void save( string filename );
 
+    /**
+     * @brief Passes the points and normals of an uncompressed file chunk
+     *        by chunk to the handler. The filters are applied. Compressed
+     *        files are read completely.
+     *
+     * @param filename  The file to read.
+     * @param handler   Receives the chunks.
+     */
+    virtual bool readChunks(string filename, PointChunkHandler &handler);
+
+private:
+
+    /**
+     * @brief Reads an uncompressed file chunk by chunk and decodes the
+     *        point records of each chunk in parallel.
+     *
+     * @return The read model or an empty pointer if the file is
+     *         compressed or can not be parsed.
+     */
+    ModelPtr readChunked(string filename);
+
+    /**
+     * @brief Reads the file point by point with laslib.
+     */
+    ModelPtr readLaslib(string filename);
+
+    /// Number of point records that are decoded at once
+    static const size_t m_chunkSize = 1 << 20;
+
+    /// The filter that is applied to all read files
+    LasFilter           m_filter;
 };
 
 } /* namespace lvr */
@@ -0,0 +1,158 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * Metrics.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef METRICS_HPP_
+#define METRICS_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace lvr
+{
+
+/**
+ * @brief   A registry for performance metrics of the named phases of a
+ *          program run (e.g. normal estimation or mesh generation). For
+ *          each phase the wall clock time, the CPU time of all threads,
+ *          the peak resident set size of the process at the end of the
+ *          phase and the number of processed items are recorded. Phases
+ *          can be entered several times, the values are accumulated.
+ *          The registry can be written to a JSON file to compare runs.
+ */
+class Metrics
+{
+public:
+
+    /**
+     * @brief   Returns the global registry
+     */
+    static Metrics& instance();
+
+    /**
+     * @brief   Starts the time measurement of the given phase. The phase
+     *          is created if it does not exist.
+     */
+    void begin(string phase);
+
+    /**
+     * @brief   Stops the time measurement of the given phase.
+     *
+     * @param phase     Name of the phase
+     * @param items     Number of items that were processed in the phase
+     */
+    void end(string phase, size_t items = 0);
+
+    /**
+     * @brief   Adds the given number of processed items to a phase
+     */
+    void addItems(string phase, size_t items);
+
+    /**
+     * @brief   Writes all phases in the order of their creation to the
+     *          given JSON file.
+     *
+     * @return  False if the file could not be written
+     */
+    bool writeJSON(string filename);
+
+    /**
+     * @brief   Removes all phases
+     */
+    void clear();
+
+    /**
+     * @brief   Returns the CPU time of all threads of the process in seconds
+     */
+    static double getCPUTime();
+
+    /**
+     * @brief   Returns the peak resident set size of the process in kB
+     */
+    static long getPeakRSS();
+
+private:
+
+    /// Metrics of a single phase
+    struct Phase
+    {
+        Phase() : wallTime(0), cpuTime(0), peakRSS(0), items(0), calls(0),
+                  wallStart(0), cpuStart(0), running(false) {}
+
+        /// Accumulated wall clock time in seconds
+        double  wallTime;
+
+        /// Accumulated CPU time in seconds
+        double  cpuTime;
+
+        /// Peak resident set size in kB
+        long    peakRSS;
+
+        /// Number of processed items
+        size_t  items;
+
+        /// Number of finished measurements
+        size_t  calls;
+
+        /// Wall clock time at the start of the current measurement
+        double  wallStart;
+
+        /// CPU time at the start of the current measurement
+        double  cpuStart;
+
+        /// True while the phase is measured
+        bool    running;
+    };
+
+    Metrics();
+
+    /// Returns the wall clock time in seconds
+    static double getWallTime();
+
+    /// Returns the phase with the given name. It is created if needed.
+    Phase& getPhase(const string &phase);
+
+    /// The phases
+    map<string, Phase>  m_phases;
+
+    /// The phase names in the order of their creation
+    vector<string>      m_order;
+
+    /// Wall clock time at creation of the registry
+    double              m_startTime;
+
+    /// A mutex to register metrics from several threads
+    boost::mutex        m_mutex;
+};
+
+} /* namespace lvr */
+
+#endif /* METRICS_HPP_ */
@@ -28,6 +28,8 @@
 #define IOFACTORY_H_
 
 #include "Model.hpp"
+#include "BaseIO.hpp"
+#include "LasIO.hpp"
 
 #include <string>
 #include <vector>
@@ -78,7 +80,23 @@ class ModelFactory
 {
     public:
 
-        static ModelPtr readModel( std::string filename );
+        /**
+         * @brief Reads the given file. The LAS filter is only applied
+         *        to .las and .laz files.
+         */
+        static ModelPtr readModel( std::string filename, const LasFilter &lasFilter = LasFilter() );
+
+        /**
+         * @brief Passes the points and normals of the given file chunk by
+         *        chunk to the handler (see \ref BaseIO::readChunks). The
+         *        coordinate transformation is applied to each chunk. The
+         *        LAS filter is only applied to .las and .laz files.
+         *
+         * @return False if the file format is not supported or the file
+         *         could not be read
+         */
+        static bool readPointChunks( std::string filename, PointChunkHandler &handler,
+                const LasFilter &lasFilter = LasFilter() );
 
         static void saveModel( ModelPtr m, std::string file);
 
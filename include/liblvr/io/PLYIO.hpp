@@ -149,9 +149,42 @@ class PLYIO : public BaseIO
         ModelPtr read( string filename );
 
 
+        /**
+         * \brief Passes the points and normals of a binary little endian
+         *        file chunk by chunk from a memory mapping to the handler.
+         *        The point element is used if present, otherwise the
+         *        vertices of a file without faces. Other files are read
+         *        completely.
+         *
+         * \param filename        Filename of file to read.
+         * \param handler         Receives the chunks.
+         **/
+        virtual bool readChunks( string filename, PointChunkHandler &handler );
+
+
     private:
 
 
+        /**
+         * \brief Read a binary little endian PLY file from a memory mapping.
+         *
+         * Vertex and point records with scalar properties are converted
+         * in parallel directly from the mapped file. If the records only
+         * contain the float coordinates, the mapping itself is used as
+         * point array. Faces have to be triangles. Files with other
+         * layouts are not handled here.
+         *
+         * \return The read model or an empty pointer if the file layout
+         *         is not supported.
+         **/
+        ModelPtr readMapped( string filename, bool readColor, bool readConfidence,
+                bool readIntensity, bool readNormals, bool readFaces );
+
+
+        /// Number of points that are passed to a chunk handler at once
+        static const size_t m_chunkSize = 1 << 20;
+
+
         /**
          * \brief Callback for read vertices.
          * \param argument  Argument to pass the read data.
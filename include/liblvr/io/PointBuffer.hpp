@@ -139,6 +139,19 @@ public:
     void setPointConfidenceArray( floatArr array, size_t n );
 
 
+    /**
+     * \brief Set the point time array.
+     *
+     * By using setPointTimeArray the internal buffer for the acquisition
+     * times of the points (e.g. GPS times) can be set. The array has to be
+     * a one dimensional double array.
+     *
+     * \param array  Pointer to point time data.
+     * \param n      Amount of data in the array.
+     **/
+    void setPointTimeArray( doubleArr array, size_t n );
+
+
     /************************* Indexed Set *************************/
 
 
@@ -255,6 +268,20 @@ public:
     floatArr getPointConfidenceArray( size_t &n );
 
 
+    /**
+     * \brief Get the point time array.
+     *
+     * getPointTimeArray returns the acquisition times of the points. The
+     * returned array is a one dimensional double array. Additionally the
+     * passed reference of a size_t variable is set to the amount of time
+     * values stored in the array.
+     *
+     * \param n  Amount of time values in array.
+     * \return   %Point time array.
+     **/
+    doubleArr getPointTimeArray( size_t &n );
+
+
     /************************* Indexed Get *************************/
 
 
@@ -384,6 +411,8 @@ protected:
     floatArr        m_pointIntensities;
     /// %Point confidence buffer.
     floatArr        m_pointConfidences;
+    /// %Point time buffer.
+    doubleArr       m_pointTimes;
 
 
     /// Number of points in internal buffer.
@@ -396,6 +425,8 @@ protected:
     size_t          m_numPointIntensities;
     /// Number of point confidence values in internal buffer.
     size_t          m_numPointConfidence;
+    /// Number of point time values in internal buffer.
+    size_t          m_numPointTimes;
 
     /// Vector to save the indices of the first and last points of single scans
     std::vector<indexPair> m_subClouds;
@@ -0,0 +1,230 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * PointTiles.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef POINTTILES_HPP_
+#define POINTTILES_HPP_
+
+#include "io/PointBuffer.hpp"
+#include "io/BaseIO.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace lvr
+{
+
+/**
+ * @brief Distributes a point cloud into overlapping spatial tiles that
+ *        are stored on disk. The tiles are aligned to the lattice of a
+ *        reconstruction grid with the given origin and voxelsize: a point
+ *        belongs to the tile that contains the grid cell of the point.
+ *        Additionally, each point is copied to all tiles whose cell
+ *        range lies within the given number of overlap cells. The tiles
+ *        can then be loaded and processed one after another. Points can
+ *        be streamed into the tiles with \ref ModelFactory::readPointChunks.
+ */
+class PointTiles : public PointChunkHandler
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param directory     Directory for the tile files. It is created if
+     *                      it does not exist and removed with the tiles.
+     * @param origin        Origin of the grid lattice
+     * @param voxelsize     Voxelsize of the grid lattice
+     * @param tileCells     Number of grid cells per tile and dimension
+     * @param overlapCells  Number of grid cells that neighboring tiles
+     *                      share on each side
+     * @param bufferBudget  Number of floats that are buffered for all
+     *                      tiles together before the largest buffers
+     *                      are written to their files
+     */
+    PointTiles(string directory, const float origin[3], float voxelsize,
+            int tileCells, int overlapCells, size_t bufferBudget = 1 << 24);
+
+    /**
+     * @brief Destructor. Removes the tile files and the directory if it
+     *        was created by the constructor.
+     */
+    virtual ~PointTiles();
+
+    /**
+     * @brief Adds the given points to the tiles.
+     *
+     * @param points        Array of n points
+     * @param normals       Array of n point normals or NULL. Normals
+     *                      have to be given for all or none of the added
+     *                      points.
+     * @param n             Number of points
+     */
+    void addPoints(const float* points, const float* normals, size_t n);
+
+    /**
+     * @brief Adds a chunk of streamed points, see \ref addPoints
+     */
+    virtual void addChunk(const float* points, const float* normals, size_t n)
+    {
+        addPoints(points, normals, n);
+    }
+
+    /**
+     * @brief Writes all buffered points to the tile files. Has to be
+     *        called after the last points were added.
+     */
+    void flush();
+
+    /**
+     * @brief Returns the number of tiles that contain points
+     */
+    size_t numTiles() const { return m_tiles.size(); }
+
+    /**
+     * @brief Returns the position of the n-th tile in tile units. Tiles
+     *        are ordered lexicographically by their position.
+     */
+    void getTile(size_t n, int &i, int &j, int &k);
+
+    /**
+     * @brief Returns the number of points of the n-th tile including
+     *        the overlap points
+     */
+    size_t numPoints(size_t n);
+
+    /**
+     * @brief Loads the points of the n-th tile
+     */
+    PointBufferPtr loadTile(size_t n);
+
+private:
+
+    /// The data of a tile
+    struct Tile
+    {
+        /// Tile position
+        int             i, j, k;
+
+        /// Number of points in the tile
+        size_t          numPoints;
+
+        /// Name of the tile file
+        string          file;
+
+        /// Points that were not written to the file yet
+        vector<float>   buffer;
+    };
+
+    /**
+     * @brief Appends the buffered points of the given tile to its file
+     *        and releases the buffer
+     */
+    void flushTile(Tile &tile);
+
+    /**
+     * @brief Writes the largest tile buffers to their files until at
+     *        most half of the buffer budget is used
+     */
+    void flushLargest();
+
+    /**
+     * @brief Returns the tile at the given position. The tile is created
+     *        if needed.
+     */
+    Tile& getTile(int i, int j, int k);
+
+    /**
+     * @brief Returns the n-th tile in the order of the tile keys
+     */
+    Tile& tileAt(size_t n);
+
+    /**
+     * @brief Packs a tile position into a single 64 bit key (21 bits per
+     *        dimension). The order of the keys is the lexicographic
+     *        order of the positions.
+     */
+    inline static uint64_t tileKey(int i, int j, int k)
+    {
+        const uint64_t bias = 1 << 20;
+        const uint64_t mask = (1 << 21) - 1;
+        return   (((uint64_t)(i + bias) & mask) << 42)
+               | (((uint64_t)(j + bias) & mask) << 21)
+               |  ((uint64_t)(k + bias) & mask);
+    }
+
+    /**
+     * @brief Returns the tile coordinate of a lattice coordinate
+     */
+    inline int tileIndex(int c)
+    {
+        return c < 0 ? -((-c - 1) / m_tileCells) - 1 : c / m_tileCells;
+    }
+
+    /// Number of floats that are read from a tile file at once
+    static const size_t m_bufferSize = 1 << 16;
+
+    /// Number of floats that are buffered for all tiles together
+    size_t              m_bufferBudget;
+
+    /// Number of floats that are currently buffered
+    size_t              m_buffered;
+
+    /// The tiles
+    map<uint64_t, Tile> m_tiles;
+
+    /// The tiles in the order of their keys. Built on first access after
+    /// tiles were added.
+    vector<Tile*>       m_order;
+
+    /// Directory of the tile files
+    string              m_directory;
+
+    /// True if the directory was created by the constructor
+    bool                m_createdDirectory;
+
+    /// Origin of the grid lattice
+    float               m_origin[3];
+
+    /// Voxelsize of the grid lattice
+    float               m_voxelsize;
+
+    /// Number of grid cells per tile and dimension
+    int                 m_tileCells;
+
+    /// Number of shared grid cells on each side of a tile
+    int                 m_overlapCells;
+
+    /// Number of floats per point (3 or 6 with normals)
+    int                 m_stride;
+};
+
+} /* namespace lvr */
+
+#endif /* POINTTILES_HPP_ */
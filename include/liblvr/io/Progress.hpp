@@ -30,6 +30,7 @@
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <atomic>
 
 using std::stringstream;
 using std::cout;
@@ -74,6 +75,12 @@ public:
 	 */
 	void operator++();
 
+	/**
+	 * @brief Increases the counter of performed iterations by n. Can be
+	 * 		  used to report the progress of a whole batch of iterations.
+	 */
+	void operator+=(size_t n);
+
 	/**
 	 * @brief 	Registers a callback that is called with the new value
 	 * 			when the percentage of the progress changed.
@@ -100,10 +107,13 @@ protected:
 	/// The number of iterations
 	size_t			m_maxVal;
 
-        /// The current counter
-    size_t	 		m_currentVal;
+	/// The current counter. It is increased without locking.
+	std::atomic<size_t>	m_currentVal;
+
+	/// The counter value at which the next percent is reached
+	std::atomic<size_t>	m_nextVal;
 
-	/// A mutex object for counter increment (for parallel executions)
+	/// A mutex object for output generation (for parallel executions)
 	boost::mutex 	m_mutex;
 
 	/// The current progress in percent
@@ -146,8 +156,8 @@ public:
 
 protected:
 
-	/// Prints the current state
-	void print_progress();
+	/// Prints the given counter value
+	void print_progress(size_t val);
 
 	/// The prefix string
 	string 			m_prefix;
@@ -155,10 +165,10 @@ protected:
 	/// The step value for output generation
 	size_t			m_stepVal;
 
-	/// The current counter value
-	size_t			m_currentVal;
+	/// The current counter value. It is increased without locking.
+	std::atomic<size_t>	m_currentVal;
 
-	/// A mutex object for counter increment (for parallel executions)
+	/// A mutex object for output generation (for parallel executions)
 	boost::mutex 	m_mutex;
 
 	/// A string stream for output generation
@@ -0,0 +1,132 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * ScanCache.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef SCANCACHE_HPP_
+#define SCANCACHE_HPP_
+
+#include "io/PointBuffer.hpp"
+#include "geometry/Matrix4.hpp"
+
+#include <string>
+#include <stdint.h>
+
+using std::string;
+
+namespace lvr
+{
+
+/**
+ * @brief Binary cache for transformed scans. The cache of a scan file
+ *        is stored next to it with the extension .lvrcache. It consists
+ *        of a header that holds the pose, the bounding box and the
+ *        present attributes of the scan, followed by the transformed
+ *        points, the intensities and the colors as contiguous blocks.
+ *        A cache is only used if size and modification time of the scan
+ *        file and of the file that contained the pose did not change.
+ *        Valid caches are mapped into memory.
+ */
+class ScanCache
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param scanFile      The cached scan file
+     * @param poseFile      The file the pose of the scan was read from
+     *                      or an empty string if the scan has no pose
+     */
+    ScanCache(string scanFile, string poseFile);
+
+    /// Returns the name of the cache file
+    string filename() const { return m_cacheFile; }
+
+    /**
+     * @brief Loads the cached scan.
+     *
+     * @param pose          Receives the pose of the scan
+     *
+     * @return The transformed scan or an empty pointer if no valid
+     *         cache exists. The point arrays refer to the mapped file.
+     */
+    PointBufferPtr load(Matrix4<float> &pose) const;
+
+    /**
+     * @brief Writes the cache.
+     *
+     * @param scan          The transformed scan. Intensities and colors
+     *                      are cached if present.
+     * @param pose          The pose of the scan
+     *
+     * @return False if the cache file could not be written
+     */
+    bool save(PointBufferPtr scan, Matrix4<float> pose) const;
+
+private:
+
+    /// Attributes that are stored in a cache
+    enum Attributes
+    {
+        INTENSITIES = 1,
+        COLORS      = 2
+    };
+
+    /// Header of a cache file
+    struct Header
+    {
+        char        magic[8];
+        uint32_t    version;
+        uint32_t    attributes;
+        uint64_t    scanSize;
+        int64_t     scanTime;
+        uint64_t    poseSize;
+        int64_t     poseTime;
+        float       pose[16];
+        float       boundingBox[6];
+        uint64_t    numPoints;
+    };
+
+    /// Fills in the magic number and the state of the source files
+    bool getSourceState(Header &header) const;
+
+    /// Returns the expected size of a cache file
+    static size_t fileSize(const Header &header);
+
+    /// The scan file
+    string      m_scanFile;
+
+    /// The pose file
+    string      m_poseFile;
+
+    /// The cache file
+    string      m_cacheFile;
+
+    /// Version of the cache format
+    static const uint32_t m_version = 1;
+};
+
+} /* namespace lvr */
+
+#endif /* SCANCACHE_HPP_ */
@@ -75,7 +75,8 @@ public:
         m_reductionTarget(0),
         m_numScans(0),
         m_saveRemission(false),
-        m_saveRemissionColor(false){}
+        m_saveRemissionColor(false),
+        m_useCache(true){}
 
     /**
      * @brief Reads all scans or an specified range of scans
@@ -131,6 +132,15 @@ public:
      */
     void saveRemission(bool yes) { m_saveRemission= yes;}
 
+
+    /**
+     * @brief Enables or disables the binary scan cache. If enabled
+     *        (default), transformed scans in new UOS format are stored
+     *        in .lvrcache files next to the scans and loaded from there
+     *        as long as the scan and pose files are unchanged.
+     */
+    void useCache(bool yes) { m_useCache = yes;}
+
 private:
 
     /**
@@ -143,6 +153,18 @@ private:
     void readNewFormat(ModelPtr &m, string dir, int first, int last, size_t &n);
 
 
+    /**
+     * @brief Reads the scan with the given number in new UOS format and
+     *        transforms it according to its pose. The scan is loaded
+     *        from its cache if possible.
+     * @param dir       The directory path
+     * @param number    The number of the scan
+     * @return          The transformed scan or an empty pointer if the
+     *                  scan could not be read
+     */
+    PointBufferPtr readScan(string dir, int number);
+
+
     /**
      * @brief Reads scans from \ref{first} to \ref{last} in old UOS format.
      * @param dir       The directory path
@@ -230,6 +252,9 @@ private:
     /// If true, the original remission information will be saved
     bool    m_saveRemission;
 
+    /// If true, scans are cached in binary files
+    bool    m_useCache;
+
 };
 
 } // namespace lvr
@@ -17,12 +17,15 @@
 #include "io/PLYIO.hpp"
 #include "io/AsciiIO.hpp"
 #include "io/UosIO.hpp"
+#include "reconstruction/SearchTreeStann.hpp"
 
 // vorerst
 #include <cstring>
 #include <iostream>
 #include <list>
 #include <cctype>
+#include <vector>
+#include <algorithm>
 #include "MPINode.hpp"
 #include "boost/shared_array.hpp"
 
@@ -83,6 +86,35 @@ public:
 	 */
 	BoundingBox<VertexT> GetBoundingBox();
 
+	/**
+	 * @brief Estimates the radius of the k-neighborhoods of the points
+	 *        from a regular sample of the point cloud.
+	 *
+	 * @param k        Size of the neighborhoods
+	 * @param samples  Number of sampled points
+	 * @return The 95% quantile of the sampled radii
+	 */
+	float estimateNeighborhoodRadius(int k, size_t samples = 1000);
+
+	/**
+	 * @brief Prepares the computation of halos. Each point is assigned to
+	 *        its leaf and all points are sorted into a coarse grid.
+	 *
+	 * @param overlap  Width of the halos
+	 */
+	void initHalos(float overlap);
+
+	/**
+	 * @brief Returns the global indices of the halo points of the n-th leaf
+	 *        in the list returned by \ref GetList. The halo contains the
+	 *        points of all other leaves that lie within the overlap
+	 *        distance of the bounding box of the leaf.
+	 *
+	 * @param n        Position of the leaf in the list
+	 * @param halo     Receives the global indices of the halo points
+	 */
+	void getHalo(size_t n, vector<size_t> &halo);
+
 
 	// The pointcloud
 	PointBufferPtr         m_loader;
@@ -114,6 +146,27 @@ public:
 
 	// A shared-Pointer for the model, with the pointcloud in it  */
 	ModelPtr m_model;
+
+	// The leaves in the order of the list
+	vector<MPINode<VertexT>*> m_leaves;
+
+	// The leaf of each point or -1 if the point is in no leaf
+	vector<int> m_owner;
+
+	// Width of the halos
+	float m_overlap;
+
+	// Number of halo grid cells per axis
+	int m_gridSize[3];
+
+	// Size of the halo grid cells
+	float m_cellSize[3];
+
+	// Position of the first point of each cell in m_cellPoints
+	vector<size_t> m_cellStart;
+
+	// Global point indices sorted by grid cell
+	vector<size_t> m_cellPoints;
 };
 }
 
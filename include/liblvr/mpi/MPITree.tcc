@@ -25,6 +25,7 @@ MPITree<VertexT>::MPITree(PointBufferPtr loader, long int max_p , long int min_p
 	max_points = max_p;
 	min_points = min_p;
 	m_median   = median;
+	m_overlap  = 0.0f;
 
 	if (loader != NULL)
 	{
@@ -265,15 +266,7 @@ void MPITree<VertexT>::splitPointcloud(MPINode<VertexT> * child , int again)
 				    left[countleft] = child->node_points[j];
 				
 				    //save the global Indizes
-				    if (child_indizes[static_cast<unsigned int>(j)] == 0)
-				    {					  
-					    left_indizes[countleft] = j;
-				    }
-				    else
-				    {
-					
-					    left_indizes[countleft] =  child->indizes[static_cast<unsigned int>(j)];
-				    }
+				    left_indizes[countleft] = child_indizes[j];
 				    countleft++;
 				
 			    }
@@ -282,14 +275,7 @@ void MPITree<VertexT>::splitPointcloud(MPINode<VertexT> * child , int again)
 				    right[countright] = child->node_points[j];
     
 				    //save the global Indizes
-				    if (child_indizes[static_cast<unsigned int>(j)] == 0)
-				    {
-					    right_indizes[countright] = j;
-				    }
-				    else
-				    {
-					    right_indizes[countright] =  child->indizes[static_cast<unsigned int>(j)];
-				    }
+				    right_indizes[countright] = child_indizes[j];
 				    countright++;
 			    }
 			    else
@@ -359,4 +345,142 @@ std::list<MPINode<VertexT>*> MPITree<VertexT>::GetList(){
 	return nodelist;
 }
 
+template<typename VertexT>
+float MPITree<VertexT>::estimateNeighborhoodRadius(int k, size_t samples)
+{
+	if (m_numpoint == 0) return 0.0f;
+
+	size_t n = m_numpoint;
+	SearchTreeStann<VertexT> stann(m_loader, n, k, k, k);
+	SearchTree<VertexT>& tree = stann;
+
+	size_t step = std::max((size_t)1, m_numpoint / samples);
+	vector<float> radii;
+	vector<ulong> indices;
+	for (size_t i = 0; i < m_numpoint; i += step)
+	{
+		tree.kSearch(m_points[i], k, indices);
+
+		// the radius is the distance to the farthest neighbor
+		float radius = 0.0f;
+		for (size_t j = 0; j < indices.size(); j++)
+		{
+			float dx = m_points[indices[j]][0] - m_points[i][0];
+			float dy = m_points[indices[j]][1] - m_points[i][1];
+			float dz = m_points[indices[j]][2] - m_points[i][2];
+			radius = std::max(radius, dx * dx + dy * dy + dz * dz);
+		}
+		radii.push_back(sqrt(radius));
+	}
+
+	size_t quantile = (radii.size() * 95) / 100;
+	std::nth_element(radii.begin(), radii.begin() + quantile, radii.end());
+	return radii[quantile];
+}
+
+template<typename VertexT>
+void MPITree<VertexT>::initHalos(float overlap)
+{
+	m_overlap = overlap;
+	m_leaves.assign(nodelist.begin(), nodelist.end());
+
+	// assign the points to their leaves
+	m_owner.assign(m_numpoint, -1);
+	for (size_t l = 0; l < m_leaves.size(); l++)
+	{
+		boost::shared_array<size_t> indizes = m_leaves[l]->getIndizes();
+		for (size_t j = 0; j < m_leaves[l]->getnumpoints(); j++)
+		{
+			m_owner[indizes[j]] = l;
+		}
+	}
+
+	// the grid cells are at least as wide as the halos, so only few
+	// cells have to be checked for a leaf
+	VertexT min = m_boundingBox.getMin();
+	VertexT max = m_boundingBox.getMax();
+	size_t numCells = 1;
+	for (int a = 0; a < 3; a++)
+	{
+		float extent = max[a] - min[a];
+		m_gridSize[a] = 1;
+		if (overlap > 0.0f)
+		{
+			m_gridSize[a] = std::max(1, std::min(64, (int)(extent / overlap)));
+		}
+		m_cellSize[a] = extent > 0.0f ? extent / m_gridSize[a] : 1.0f;
+		numCells *= m_gridSize[a];
+	}
+
+	// sort the points into the cells
+	vector<size_t> cells(m_numpoint);
+	m_cellStart.assign(numCells + 1, 0);
+	for (size_t i = 0; i < m_numpoint; i++)
+	{
+		size_t cell = 0;
+		for (int a = 0; a < 3; a++)
+		{
+			int c = (int)((m_points[i][a] - min[a]) / m_cellSize[a]);
+			c = std::max(0, std::min(m_gridSize[a] - 1, c));
+			cell = cell * m_gridSize[a] + c;
+		}
+		cells[i] = cell;
+		m_cellStart[cell + 1]++;
+	}
+
+	for (size_t c = 0; c < numCells; c++)
+	{
+		m_cellStart[c + 1] += m_cellStart[c];
+	}
+
+	vector<size_t> position(m_cellStart.begin(), m_cellStart.end() - 1);
+	m_cellPoints.resize(m_numpoint);
+	for (size_t i = 0; i < m_numpoint; i++)
+	{
+		m_cellPoints[position[cells[i]]++] = i;
+	}
+}
+
+template<typename VertexT>
+void MPITree<VertexT>::getHalo(size_t n, vector<size_t> &halo)
+{
+	halo.clear();
+	if (m_overlap <= 0.0f || n >= m_leaves.size()) return;
+
+	// the bounding box of the leaf expanded by the overlap
+	float lo[3], hi[3];
+	int first[3], last[3];
+	VertexT min = m_boundingBox.getMin();
+	for (int a = 0; a < 3; a++)
+	{
+		lo[a] = m_leaves[n]->m_minvertex[a] - m_overlap;
+		hi[a] = m_leaves[n]->m_maxvertex[a] + m_overlap;
+		first[a] = std::max(0, (int)((lo[a] - min[a]) / m_cellSize[a]));
+		last[a]  = std::min(m_gridSize[a] - 1, (int)((hi[a] - min[a]) / m_cellSize[a]));
+	}
+
+	for (int i = first[0]; i <= last[0]; i++)
+	{
+		for (int j = first[1]; j <= last[1]; j++)
+		{
+			for (int k = first[2]; k <= last[2]; k++)
+			{
+				size_t cell = ((size_t)i * m_gridSize[1] + j) * m_gridSize[2] + k;
+				for (size_t c = m_cellStart[cell]; c < m_cellStart[cell + 1]; c++)
+				{
+					size_t p = m_cellPoints[c];
+					if (m_owner[p] == (int)n) continue;
+
+					if (m_points[p][0] >= lo[0] && m_points[p][0] <= hi[0] &&
+					    m_points[p][1] >= lo[1] && m_points[p][1] <= hi[1] &&
+					    m_points[p][2] >= lo[2] && m_points[p][2] <= hi[2])
+					{
+						halo.push_back(p);
+					}
+				}
+			}
+		}
+	}
+}
+
 }
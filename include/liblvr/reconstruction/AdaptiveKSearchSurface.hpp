@@ -176,6 +176,20 @@ public:
      */
     virtual void distance(VertexT v, float &projectedDistance, float &euklideanDistance);
 
+    /**
+     * @brief Calculates the distances of a block of grid points. The
+     *        nearest neighbors of all points are searched at once and
+     *        the search results are stored in the given buffers.
+     *
+     * @param v                     Array of n grid points
+     * @param n                     Number of grid points
+     * @param projectedDistances    Array of n projected distances
+     * @param euklideanDistances    Array of n euklidean distances
+     * @param buffers               Temporary buffers of the calling thread
+     */
+    virtual void distances(const VertexT* v, size_t n, float* projectedDistances, float* euklideanDistances,
+            typename PointsetSurface<VertexT>::DistanceBuffers &buffers);
+
 
     virtual void colorizePointCloud( typename AdaptiveKSearchSurface<VertexT, NormalT>::Ptr pcm,
           const float &sqrtMaxDist = std::numeric_limits<float>::max(),
@@ -192,6 +206,13 @@ public:
      *        plane fitting
      */
     void useRansac(bool use_it) { m_useRANSAC = use_it;}
+
+    /**
+     * @brief If set to true, tangent planes are fitted by a principal
+     *        component analysis of the neighborhood instead of a least
+     *        squares fit of y = f(x, z)
+     */
+    void usePCA(bool use_it) { m_usePCA = use_it;}
     
     
     void setKD( int kd )
@@ -279,6 +300,19 @@ private:
 	 */
 	float distance(VertexT v, Plane<VertexT, NormalT> p);
 
+	/**
+	 * @brief Calculates the distance of vertex v to the mean tangent
+	 *        plane of the given neighbors
+	 *
+	 * @param v                     A grid point
+	 * @param id                    Indices of the nearest neighbors
+	 * @param k                     Number of neighbors
+	 * @param projectedDistance     Projected distance to the mean plane
+	 * @param euklideanDistance     Distance to the mean neighbor position
+	 */
+	void tangentPlaneDistance(const VertexT &v, const ulong* id, int k,
+			float &projectedDistance, float &euklideanDistance);
+
 
 	void radiusSearch(const VertexT &v, double r, vector<VertexT> &resV, vector<NormalT> &resN){};
 
@@ -299,6 +333,22 @@ private:
 	        const int &k,
 	        const vector<unsigned long> &id, bool &ok );
 
+	/**
+	 * @brief Calculates a tangent plane for the query point from the
+	 *        covariance matrix of the k-neighborhood. The normal is the
+	 *        eigenvector of the smallest eigenvalue, which is calculated
+	 *        in closed form. Unlike \ref calcPlane, the fit does not
+	 *        depend on the orientation of the plane. Falls back to
+	 *        \ref calcPlane for degenerated neighborhoods.
+	 *
+	 * @param queryPoint    The point for which the tangent plane is created
+	 * @param k             The size of the used k-neighborhood
+	 * @param id            The positions of the neighborhood points in \ref m_points
+	 */
+	Plane<VertexT, NormalT> calcPlanePCA(const VertexT &queryPoint,
+	        const int &k,
+	        const vector<unsigned long> &id);
+
 
 	/// The centroid of the point set
 	VertexT                    m_centroid;
@@ -306,6 +356,9 @@ private:
     /// Should a randomized algorithm be used to determine planes?
 	bool                        m_useRANSAC;
 
+    /// Should planes be fitted by principal component analysis?
+	bool                        m_usePCA;
+
     /// The currently stored points
     coord3fArr                  m_points;
 
@@ -329,6 +382,9 @@ private:
     /// Search tree for scan poses
     typename SearchTree<VertexT>::Ptr  m_poseTree;
 
+    /// Number of points that are searched at once during normal interpolation
+    static const size_t         m_normalBlockSize = 256;
+
     /// Type of used search tree
     string						m_searchTreeName;
 
@@ -34,11 +34,26 @@
 
 #include <fstream>
 #include <set>
+#include <algorithm>
 #include <random>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LVR_SURFACE_SSE
+#endif
+
 namespace lvr
 {
 
+#ifdef LVR_SURFACE_SSE
+/// Loads a coordinate triple as [x, y, z, 0] without reading past it
+inline __m128 loadCoordSSE(const coord<float> &c)
+{
+    __m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(&c.x)));
+    return _mm_movelh_ps(xy, _mm_load_ss(&c.z));
+}
+#endif
+
 typedef ColorVertex<float, unsigned char>               cVertex;
 typedef Normal<float>                                   cNormal;
 typedef SearchTree<cVertex> search_tree;
@@ -47,6 +62,7 @@ template<typename VertexT, typename NormalT>
 AdaptiveKSearchSurface<VertexT, NormalT>::AdaptiveKSearchSurface()
 {
 	m_useRANSAC = true;
+	m_usePCA = false;
     this->m_ki = 10;
     this->m_kn = 10;
     this->m_kd = 10;
@@ -85,6 +101,7 @@ AdaptiveKSearchSurface<VertexT, NormalT>::AdaptiveKSearchSurface(
     this->m_kd = kd;
 
     m_useRANSAC = useRansac;
+    m_usePCA = false;
 
     init();
 
@@ -238,33 +255,33 @@ void AdaptiveKSearchSurface<VertexT, NormalT>::calculateSurfaceNormals()
     string comment = timestamp.getElapsedTime() + "Estimating normals ";
     ProgressBar progress(this->m_numPoints, comment);
 
-    #pragma omp parallel for schedule(static)
-    for( int i = 0; i < (int)this->m_numPoints; i++){
+    // The neighborhood is doubled up to five times if the bounding box
+    // of the neighbors is degenerated. Instead of searching again for
+    // every size, a search for the largest neighborhood is done once
+    // and the smaller neighborhoods are evaluated as its prefixes.
+    const int numDoublings = 5;
+    const int k_max = k_0 << numDoublings;
 
-        Vertexf query_point;
-        Normalf normal;
-
-        // We have to fit these vector to have the
-        // correct return values when performing the
-        // search on the stann kd tree. So we don't use
-        // the template parameter T for di
-        vector<unsigned long> id;
-        vector<double> di;
+    #pragma omp parallel
+    {
+        // Search buffers are reused for all points of a thread
+        vector<unsigned long> id(k_max);
+        vector<float> di(k_max);
 
-        int n = 0;
-        size_t k = k_0;
+        // Finished points are reported to the progress bar in batches
+        size_t done = 0;
 
-        while(n < 5){
+        #pragma omp for schedule(static)
+        for( int i = 0; i < (int)this->m_numPoints; i++){
 
-            n++;
-            /**
-             *  @todo Maybe this should be done at the end of the loop
-             *        after the bounding box check
-             */
-            k = k * 2;
+            Vertexf query_point;
+            Normalf normal;
 
-            //T* point = this->m_points[i];
-            this->m_searchTree->kSearch(this->m_points[i], k, id, di);
+            // Most neighborhoods are fine with the first size, so only
+            // search for these neighbors first
+            int k = 2 * k_0;
+            int searched = k;
+            int found = this->m_searchTree->kSearch(&this->m_points[i].x, searched, &id[0], &di[0]);
 
             float min_x = 1e15f;
             float min_y = 1e15f;
@@ -273,91 +290,101 @@ void AdaptiveKSearchSurface<VertexT, NormalT>::calculateSurfaceNormals()
             float max_y = - min_y;
             float max_z = - min_z;
 
-            float dx, dy, dz;
-            dx = dy = dz = 0;
-
-            // Calculate the bounding box of found point set
-            /**
-             * @todo Use the bounding box object from the old model3d
-             *       library for bounding box calculation...
-             */
-            for(size_t j = 0; j < k; j++){
-                min_x = min(min_x, this->m_points[id[j]][0]);
-                min_y = min(min_y, this->m_points[id[j]][1]);
-                min_z = min(min_z, this->m_points[id[j]][2]);
-
-                max_x = max(max_x, this->m_points[id[j]][0]);
-                max_y = max(max_y, this->m_points[id[j]][1]);
-                max_z = max(max_z, this->m_points[id[j]][2]);
-
-//                cout << "Points: " << this->m_numPoints << "Point[" << id[j] << "].x: " <<  this->m_points[id[j]][0] << endl ;
-//                cout << "Points: " << this->m_numPoints << "Point[" << id[j] << "].y: " <<  this->m_points[id[j]][1] << endl ;
-//                cout << "Points: " << this->m_numPoints << "Point[" << id[j] << "].z: " <<  this->m_points[id[j]][2] << endl ;
+            // Extend the bounding box of the neighbors with the points
+            // of each larger neighborhood
+            int evaluated = 0;
+            for(int n = 1; n <= numDoublings; n++)
+            {
+                if((k_0 << n) > searched && found == searched)
+                {
+                    // Get a larger neighborhood. The first neighbors are
+                    // the same as before. The second size is tried before
+                    // the largest one, since it suffices for most of the
+                    // remaining points.
+                    searched = (n == 2) ? (k_0 << 2) : k_max;
+                    found = this->m_searchTree->kSearch(&this->m_points[i].x, searched, &id[0], &di[0]);
+                }
+
+                k = std::min(k_0 << n, found);
+                for(int j = evaluated; j < k; j++)
+                {
+                    min_x = min(min_x, this->m_points[id[j]][0]);
+                    min_y = min(min_y, this->m_points[id[j]][1]);
+                    min_z = min(min_z, this->m_points[id[j]][2]);
+
+                    max_x = max(max_x, this->m_points[id[j]][0]);
+                    max_y = max(max_y, this->m_points[id[j]][1]);
+                    max_z = max(max_z, this->m_points[id[j]][2]);
+                }
+                evaluated = k;
+
+                if(boundingBoxOK(max_x - min_x, max_y - min_y, max_z - min_z)) break;
+            }
 
+            // Create a query point for the current point
+            query_point = VertexT(this->m_points[i][0],
+                    			  this->m_points[i][1],
+                    			  this->m_points[i][2]);
 
-                dx = max_x - min_x;
-                dy = max_y - min_y;
-                dz = max_z - min_z;
+            // Interpolate a plane based on the k-neighborhood
+            Plane<VertexT, NormalT> p;
+            bool ransac_ok;
+            if(m_useRANSAC)
+            {
+                p = calcPlaneRANSAC(query_point, k, id, ransac_ok);
+                // Fallback if RANSAC failed
+                if(!ransac_ok)
+                {
+                    p = m_usePCA ? calcPlanePCA(query_point, k, id) : calcPlane(query_point, k, id);
+                }
             }
+            else if(m_usePCA)
+            {
+                p = calcPlanePCA(query_point, k, id);
+            }
+            else
+            {
+                p = calcPlane(query_point, k, id);
+            }
+            // Get the mean distance to the tangent plane
+            //mean_distance = meanDistance(p, id, k);
 
-            if(boundingBoxOK(dx, dy, dz)) break;
-            //break;
-
-        }
+            // Flip normals towards the center of the scene or nearest scan pose
+            if(m_poseTree)
+            {
+            	vector<VertexT> nearestPoses;
+            	m_poseTree->kSearch(query_point, 1, nearestPoses);
+            	if(nearestPoses.size() == 1)
+            	{
+            		VertexT nearest = nearestPoses[0];
+            		normal = p.n;
+            		if(normal * (query_point - nearest) < 0) normal = normal * -1;
+            	}
+            	else
+            	{
+            		cout << timestamp << "Could not get nearest scan pose. Defaulting to centroid." << endl;
+            		normal =  p.n;
+            		if(normal * (query_point - m_centroid) < 0) normal = normal * -1;
+            	}
+            }
+            else
+            {
+                normal =  p.n;
+                if(normal * (query_point - m_centroid) < 0) normal = normal * -1;
+            }
 
-        // Create a query point for the current point
-        query_point = VertexT(this->m_points[i][0],
-                			  this->m_points[i][1],
-                			  this->m_points[i][2]);
+            // Save result in normal array
+            this->m_normals[i][0] = normal[0];
+            this->m_normals[i][1] = normal[1];
+            this->m_normals[i][2] = normal[2];
 
-        // Interpolate a plane based on the k-neighborhood
-        Plane<VertexT, NormalT> p;
-        bool ransac_ok;
-        if(m_useRANSAC)
-        {
-            p = calcPlaneRANSAC(query_point, k, id, ransac_ok);
-            // Fallback if RANSAC failed
-            if(!ransac_ok)
+            if(++done == m_normalBlockSize)
             {
-                p = calcPlane(query_point, k, id);
+                progress += done;
+                done = 0;
             }
         }
-        else
-        {
-            p = calcPlane(query_point, k, id);
-        }
-        // Get the mean distance to the tangent plane
-        //mean_distance = meanDistance(p, id, k);
-
-        // Flip normals towards the center of the scene or nearest scan pose
-        if(m_poseTree)
-        {
-        	vector<VertexT> nearestPoses;
-        	m_poseTree->kSearch(query_point, 1, nearestPoses);
-        	if(nearestPoses.size() == 1)
-        	{
-        		VertexT nearest = nearestPoses[0];
-        		normal = p.n;
-        		if(normal * (query_point - nearest) < 0) normal = normal * -1;
-        	}
-        	else
-        	{
-        		cout << timestamp << "Could not get nearest scan pose. Defaulting to centroid." << endl;
-        		normal =  p.n;
-        		if(normal * (query_point - m_centroid) < 0) normal = normal * -1;
-        	}
-        }
-        else
-        {
-            normal =  p.n;
-            if(normal * (query_point - m_centroid) < 0) normal = normal * -1;
-        }
-
-        // Save result in normal array
-        this->m_normals[i][0] = normal[0];
-        this->m_normals[i][1] = normal[1];
-        this->m_normals[i][2] = normal[2];
-        ++progress;
+        progress += done;
     }
     cout << endl;
 
@@ -368,64 +395,62 @@ void AdaptiveKSearchSurface<VertexT, NormalT>::calculateSurfaceNormals()
 template<typename VertexT, typename NormalT>
 void AdaptiveKSearchSurface<VertexT, NormalT>::interpolateSurfaceNormals()
 {
-    // Create a temporal normal array for the
-    vector<NormalT> tmp(this->m_numPoints, NormalT());
+    // The interpolated normals are written to a new array, so that
+    // every thread only reads the initial normals and only writes
+    // the normals of its own points. This makes the result independent
+    // of the number of threads and the scheduling.
+    coord3fArr interpolated(new coord<float>[this->m_numPoints]);
 
     // Create progress output
     string comment = timestamp.getElapsedTime() + "Interpolating normals ";
     ProgressBar progress(this->m_numPoints, comment);
 
-    // Interpolate normals
-    #pragma omp parallel for schedule(static)
-    for( int i = 0; i < (int)this->m_numPoints; i++){
-
-        vector<unsigned long> id;
-        vector<double> di;
-
-        this->m_searchTree->kSearch(this->m_points[i], this->m_ki, id, di);
-
-        VertexT mean;
-        NormalT mean_normal;
-
-        for(int j = 0; j < this->m_ki; j++)
-        {
-            mean += VertexT(this->m_normals[id[j]][0],
-                            this->m_normals[id[j]][1],
-                            this->m_normals[id[j]][2]);
-        }
-        mean_normal = NormalT(mean);
+    // Interpolate normals in blocks of points
+    int k = this->m_ki;
+    int numBlocks = (this->m_numPoints + m_normalBlockSize - 1) / m_normalBlockSize;
 
-        tmp[i] = mean;
+    #pragma omp parallel
+    {
+        // Search buffers are reused for all blocks of a thread
+        vector<ulong> ids(m_normalBlockSize * k);
+        vector<float> di(m_normalBlockSize * k);
+        vector<int> found(m_normalBlockSize);
 
-        ///todo Try to remove this code. Should improve the results at all.
-        for(int j = 0; j < this->m_ki; j++)
+        #pragma omp for schedule(dynamic)
+        for(int b = 0; b < numBlocks; b++)
         {
-            NormalT n(this->m_normals[id[j]][0],
-                      this->m_normals[id[j]][1],
-                      this->m_normals[id[j]][2]);
+            size_t first = b * m_normalBlockSize;
+            size_t n = std::min((size_t)m_normalBlockSize, (size_t)this->m_numPoints - first);
 
+            this->m_searchTree->kSearchBatch(&this->m_points[first].x, n, k, &ids[0], &di[0], &found[0]);
 
-            // Only override existing normals if the interpolated
-            // normals is significantly different from the initial
-            // estimation. This helps to avoid a too smooth normal
-            // field
-            if(fabs(n * mean_normal) > 0.2 )
+            for(size_t q = 0; q < n; q++)
             {
-                this->m_normals[id[j]][0] = mean_normal[0];
-                this->m_normals[id[j]][1] = mean_normal[1];
-                this->m_normals[id[j]][2] = mean_normal[2];
+                const ulong* id = &ids[q * k];
+
+                float x = 0.0f;
+                float y = 0.0f;
+                float z = 0.0f;
+                for(int j = 0; j < found[q]; j++)
+                {
+                    x += this->m_normals[id[j]][0];
+                    y += this->m_normals[id[j]][1];
+                    z += this->m_normals[id[j]][2];
+                }
+                NormalT mean_normal(x, y, z);
+
+                interpolated[first + q][0] = mean_normal[0];
+                interpolated[first + q][1] = mean_normal[1];
+                interpolated[first + q][2] = mean_normal[2];
             }
+            progress += n;
         }
-        ++progress;
     }
     cout << endl;
-    cout << timestamp << "Copying normals..." << endl;
 
-    for(size_t i = 0; i < this->m_numPoints; i++){
-        this->m_normals[i][0] = tmp[i][0];
-        this->m_normals[i][1] = tmp[i][1];
-        this->m_normals[i][2] = tmp[i][2];
-    }
+    // Replace the initial normals
+    this->m_normals = interpolated;
+    this->m_pointBuffer->setIndexedPointNormalArray(this->m_normals, this->m_numPoints);
 }
 
 template<typename VertexT, typename NormalT>
@@ -526,9 +551,99 @@ void AdaptiveKSearchSurface<VertexT, NormalT>::distance(VertexT v, float &projec
         this->m_searchTree->kSearch( p, k, id, di );
     }
 
+    tangentPlaneDistance(v, &id[0], k, projectedDistance, euklideanDistance);
+}
+
+template<typename VertexT, typename NormalT>
+void AdaptiveKSearchSurface<VertexT, NormalT>::distances(
+        const VertexT* v, size_t n,
+        float* projectedDistances,
+        float* euklideanDistances,
+        typename PointsetSurface<VertexT>::DistanceBuffers &buffers)
+{
+    int k = this->m_kd;
+    if(n == 0)
+    {
+        return;
+    }
+
+    // Search all points of the block at once. The buffers only grow,
+    // so they are allocated once per thread.
+    if(buffers.queries.size() < 3 * n)
+    {
+        buffers.queries.resize(3 * n);
+        buffers.found.resize(n);
+    }
+    if(buffers.indices.size() < n * k)
+    {
+        buffers.indices.resize(n * k);
+        buffers.distances.resize(n * k);
+    }
+
+    for(size_t q = 0; q < n; q++)
+    {
+        buffers.queries[3 * q]     = v[q][0];
+        buffers.queries[3 * q + 1] = v[q][1];
+        buffers.queries[3 * q + 2] = v[q][2];
+    }
+
+    this->m_searchTree->kSearchBatch(&buffers.queries[0], n, k,
+            &buffers.indices[0], &buffers.distances[0], &buffers.found[0]);
+
+    for(size_t q = 0; q < n; q++)
+    {
+        int m = buffers.found[q];
+        if(m == 0)
+        {
+            projectedDistances[q] = 0.0f;
+            euklideanDistances[q] = std::numeric_limits<float>::max();
+            continue;
+        }
+
+        tangentPlaneDistance(v[q], &buffers.indices[q * k], m, projectedDistances[q], euklideanDistances[q]);
+    }
+}
+
+template<typename VertexT, typename NormalT>
+void AdaptiveKSearchSurface<VertexT, NormalT>::tangentPlaneDistance(const VertexT &v, const ulong* id, int k,
+        float &projectedDistance, float &euklideanDistance)
+{
     VertexT nearest;
     NormalT normal;
 
+#ifdef LVR_SURFACE_SSE
+    // Sum the neighbors and their normals as [x, y, z, 0] vectors. The
+    // normal sum is renormalized after each step like Normal::operator+=
+    // does, in the same order of operations, so the results are the same
+    // as in the scalar version below.
+    __m128 points = _mm_setzero_ps();
+    __m128 normals = _mm_setzero_ps();
+
+    for ( int i = 0; i < k; i++ )
+    {
+        points  = _mm_add_ps(points,  loadCoordSSE(this->m_points[id[i]]));
+        normals = _mm_add_ps(normals, loadCoordSSE(this->m_normals[id[i]]));
+
+        __m128 sq = _mm_mul_ps(normals, normals);
+        float lengthSquare = _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(sq,
+                _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1, 1, 1, 1))),
+                _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 2, 2, 2))));
+        if ( fabs(1 - lengthSquare) > 0.001 )
+        {
+            float length = sqrt(lengthSquare);
+            if ( length != 0 )
+            {
+                normals = _mm_div_ps(normals, _mm_set1_ps(length));
+            }
+        }
+    }
+
+    float sum[4];
+    _mm_storeu_ps(sum, points);
+    nearest = VertexT(sum[0], sum[1], sum[2]);
+    _mm_storeu_ps(sum, normals);
+    normal = NormalT(sum[0], sum[1], sum[2]);
+#else
     for ( int i = 0; i < k; i++ )
     {
         //Get nearest tangent plane
@@ -541,6 +656,7 @@ void AdaptiveKSearchSurface<VertexT, NormalT>::distance(VertexT v, float &projec
         normal += n;
 
     }
+#endif
 
     normal /= k;
     nearest /= k;
@@ -549,7 +665,6 @@ void AdaptiveKSearchSurface<VertexT, NormalT>::distance(VertexT v, float &projec
     //Calculate distance
     projectedDistance = (v - nearest) * normal;
     euklideanDistance = (v - nearest).length();
-
 }
 
 template<typename VertexT, typename NormalT>
@@ -616,6 +731,116 @@ Plane<VertexT, NormalT> AdaptiveKSearchSurface<VertexT, NormalT>::calcPlane(cons
     return p;
 }
 
+template<typename VertexT, typename NormalT>
+Plane<VertexT, NormalT> AdaptiveKSearchSurface<VertexT, NormalT>::calcPlanePCA(const VertexT &queryPoint,
+        const int &k,
+        const vector<unsigned long> &id)
+{
+    if(k < 3)
+    {
+        return calcPlane(queryPoint, k, id);
+    }
+
+    // Accumulate the first and second moments of the neighborhood in
+    // one pass. Coordinates are taken relative to the query point to
+    // avoid cancellation for large coordinate values.
+    float qx = queryPoint[0];
+    float qy = queryPoint[1];
+    float qz = queryPoint[2];
+
+    float sx = 0, sy = 0, sz = 0;
+    float sxx = 0, sxy = 0, sxz = 0, syy = 0, syz = 0, szz = 0;
+
+    #pragma omp simd reduction(+:sx,sy,sz,sxx,sxy,sxz,syy,syz,szz)
+    for(int j = 0; j < k; j++)
+    {
+        float x = this->m_points[id[j]].x - qx;
+        float y = this->m_points[id[j]].y - qy;
+        float z = this->m_points[id[j]].z - qz;
+        sx += x;
+        sy += y;
+        sz += z;
+        sxx += x * x;
+        sxy += x * y;
+        sxz += x * z;
+        syy += y * y;
+        syz += y * z;
+        szz += z * z;
+    }
+
+    // Covariance matrix
+    double inv = 1.0 / k;
+    double mx = sx * inv;
+    double my = sy * inv;
+    double mz = sz * inv;
+
+    double a00 = sxx * inv - mx * mx;
+    double a01 = sxy * inv - mx * my;
+    double a02 = sxz * inv - mx * mz;
+    double a11 = syy * inv - my * my;
+    double a12 = syz * inv - my * mz;
+    double a22 = szz * inv - mz * mz;
+
+    // Smallest eigenvalue of the symmetric matrix with the trigonometric
+    // solution of the characteristic polynomial
+    double q = (a00 + a11 + a22) / 3.0;
+    double b00 = a00 - q;
+    double b11 = a11 - q;
+    double b22 = a22 - q;
+    double p2 = b00 * b00 + b11 * b11 + b22 * b22 + 2.0 * (a01 * a01 + a02 * a02 + a12 * a12);
+    double pp = sqrt(p2 / 6.0);
+
+    // All eigenvalues are equal, so there is no preferred direction
+    if(pp <= 1e-12 * fabs(q) || pp == 0.0)
+    {
+        return calcPlane(queryPoint, k, id);
+    }
+
+    double det =   b00 * (b11 * b22 - a12 * a12)
+                 - a01 * (a01 * b22 - a12 * a02)
+                 + a02 * (a01 * a12 - b11 * a02);
+    double r = det / (2.0 * pp * pp * pp);
+    r = std::max(-1.0, std::min(1.0, r));
+
+    double phi = acos(r) / 3.0;
+    double lambda = q + 2.0 * pp * cos(phi + 2.0 * M_PI / 3.0);
+
+    // The eigenvector is orthogonal to the rows of (A - lambda * I). Use
+    // the largest cross product of two rows for numerical stability.
+    double r0[3] = {a00 - lambda, a01, a02};
+    double r1[3] = {a01, a11 - lambda, a12};
+    double r2[3] = {a02, a12, a22 - lambda};
+
+    double c0[3] = {r0[1] * r1[2] - r0[2] * r1[1], r0[2] * r1[0] - r0[0] * r1[2], r0[0] * r1[1] - r0[1] * r1[0]};
+    double c1[3] = {r0[1] * r2[2] - r0[2] * r2[1], r0[2] * r2[0] - r0[0] * r2[2], r0[0] * r2[1] - r0[1] * r2[0]};
+    double c2[3] = {r1[1] * r2[2] - r1[2] * r2[1], r1[2] * r2[0] - r1[0] * r2[2], r1[0] * r2[1] - r1[1] * r2[0]};
+
+    double l0 = c0[0] * c0[0] + c0[1] * c0[1] + c0[2] * c0[2];
+    double l1 = c1[0] * c1[0] + c1[1] * c1[1] + c1[2] * c1[2];
+    double l2 = c2[0] * c2[0] + c2[1] * c2[1] + c2[2] * c2[2];
+
+    double* c = c0;
+    double l = l0;
+    if(l1 > l) { c = c1; l = l1; }
+    if(l2 > l) { c = c2; l = l2; }
+
+    // The smallest eigenvalue is not unique (linear neighborhood)
+    if(l <= 1e-24 * p2 * p2 || l == 0.0)
+    {
+        return calcPlane(queryPoint, k, id);
+    }
+
+    // Create a plane representation and return the result
+    Plane<VertexT, NormalT> p;
+    p.a = 0;
+    p.b = 0;
+    p.c = 0;
+    p.n = NormalT(c[0], c[1], c[2]);
+    p.p = queryPoint;
+
+    return p;
+}
+
 template<typename VertexT, typename NormalT>
 const VertexT AdaptiveKSearchSurface<VertexT, NormalT>::operator[]( const size_t& index ) const
 {
@@ -709,7 +934,7 @@ size_t AdaptiveKSearchSurface<VertexT, NormalT>::getNumPoints()
 
 		   std::set<unsigned long> ids;
 		   std::default_random_engine generator;
-		   std::uniform_int_distribution<unsigned long> distribution(0, id.size() - 1);
+		   std::uniform_int_distribution<unsigned long> distribution(0, k - 1);
 		   auto number = std::bind(distribution, generator);
 		   do
 		   {
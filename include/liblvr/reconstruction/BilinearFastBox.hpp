@@ -57,12 +57,28 @@ public:
             vector<QueryPoint<VertexT> > &query_points,
             uint &globalIndex);
 
+    /**
+     * @brief Calculates the local approximation of the box without
+     *        modifying the mesh. See FastBox::getLocalSurface.
+     */
+    virtual void getLocalSurface(
+            SurfaceBuffer<VertexT> &buffer,
+            vector<QueryPoint<VertexT> > &query_points);
+
     void optimizePlanarFaces(size_t kc);
 
     // the point set surface
     static typename PointsetSurface<VertexT>::Ptr m_surface;
 
 
+protected:
+
+    /**
+     * @brief Adds the triangle to the half edge mesh and saves the
+     *        created face for planar optimization.
+     */
+    virtual void insertTriangle(BaseMesh<VertexT, NormalT> &mesh, uint a, uint b, uint c);
+
 private:
     vector<HalfEdgeFace<VertexT, NormalT>* > m_faces;
     int                                      m_mcIndex;
@@ -127,6 +127,28 @@ void BilinearFastBox<VertexT, NormalT>::getSurface(
     }
 }
 
+template<typename VertexT, typename NormalT>
+void BilinearFastBox<VertexT, NormalT>::getLocalSurface(
+        SurfaceBuffer<VertexT> &buffer,
+        vector<QueryPoint<VertexT> > &qp)
+{
+    m_mcIndex = this->getIndex(qp);
+    FastBox<VertexT, NormalT>::getLocalSurface(buffer, qp);
+}
+
+template<typename VertexT, typename NormalT>
+void BilinearFastBox<VertexT, NormalT>::insertTriangle(
+        BaseMesh<VertexT, NormalT> &m,
+        uint a, uint b, uint c)
+{
+    HalfEdgeMesh<VertexT, NormalT> *mesh;
+    mesh = static_cast<HalfEdgeMesh<VertexT, NormalT>* >(&m);
+
+    HalfEdgeFace<VertexT, NormalT>* f;
+    mesh->addTriangle(a, b, c, f);
+    m_faces.push_back(f);
+}
+
 template<typename VertexT, typename NormalT>
 void BilinearFastBox<VertexT, NormalT>::optimizePlanarFaces(size_t kc)
 {
@@ -0,0 +1,187 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * BrickIndex.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef BRICKINDEX_HPP_
+#define BRICKINDEX_HPP_
+
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+using std::unordered_map;
+using std::vector;
+
+namespace lvr
+{
+
+/**
+ * @brief A sparse three dimensional array of unsigned indices. The
+ *        index space is split into dense bricks of 8 x 8 x 8 entries.
+ *        Only bricks that contain at least one entry are allocated.
+ *        The bricks are addressed by a hash of their packed brick
+ *        coordinates. Since neighboring grid positions usually lie in
+ *        the same brick, lookups can remember the last accessed brick
+ *        in a \ref Cursor. Lookups don't modify the index, so several
+ *        threads can read it at the same time if each thread uses its
+ *        own cursor.
+ */
+class BrickIndex
+{
+public:
+
+    /// Value of entries that were not set
+    static const unsigned int INVALID = 0xFFFFFFFF;
+
+    /// Number of bits per dimension within a brick
+    static const int BRICK_BITS = 3;
+
+    /// Number of entries per dimension within a brick
+    static const int BRICK_SIZE = 1 << BRICK_BITS;
+
+    /// Number of entries per brick
+    static const int BRICK_VOLUME = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+
+    /// Marks a missing brick
+    static const size_t NO_BRICK = (size_t)-1;
+
+    /**
+     * @brief Remembers the last brick that was accessed by a caller
+     */
+    struct Cursor
+    {
+        Cursor() : key(0), offset(NO_BRICK) {}
+
+        /// Key of the last accessed brick
+        uint64_t    key;
+
+        /// Offset of the last accessed brick
+        size_t      offset;
+    };
+
+    /**
+     * @brief Constructor.
+     */
+    BrickIndex();
+
+    /**
+     * @brief Returns the entry at the given grid position or INVALID
+     *        if no entry was set.
+     */
+    inline unsigned int get(int i, int j, int k) const
+    {
+        Cursor cursor;
+        return get(i, j, k, cursor);
+    }
+
+    /**
+     * @brief Returns the entry at the given grid position or INVALID
+     *        if no entry was set. The cursor is used to skip the brick
+     *        lookup if the position lies in the last accessed brick.
+     */
+    inline unsigned int get(int i, int j, int k, Cursor &cursor) const
+    {
+        size_t b = findBrick(i, j, k, cursor);
+        if(b == NO_BRICK)
+        {
+            return INVALID;
+        }
+        return m_values[b + localIndex(i, j, k)];
+    }
+
+    /**
+     * @brief Sets the entry at the given grid position. The surrounding
+     *        brick is created if needed. Must not be called while
+     *        other threads read the index.
+     */
+    inline void set(int i, int j, int k, unsigned int value)
+    {
+        m_values[createBrick(i, j, k) + localIndex(i, j, k)] = value;
+    }
+
+    /**
+     * @brief Returns the number of allocated bricks
+     */
+    size_t numBricks() const { return m_brickOffsets.size(); }
+
+    /**
+     * @brief Returns the number of bytes used by the allocated bricks
+     */
+    size_t memoryUsage() const { return m_values.capacity() * sizeof(unsigned int); }
+
+    /**
+     * @brief Removes all entries
+     */
+    void clear();
+
+private:
+
+    /**
+     * @brief Returns the offset of the brick containing the given grid
+     *        position within the value array or NO_BRICK.
+     */
+    size_t findBrick(int i, int j, int k, Cursor &cursor) const;
+
+    /**
+     * @brief Returns the offset of the brick containing the given grid
+     *        position within the value array. Missing bricks are
+     *        created.
+     */
+    size_t createBrick(int i, int j, int k);
+
+    /**
+     * @brief Packs the brick coordinates of a grid position into a
+     *        single 64 bit key (21 bits per dimension).
+     */
+    inline static uint64_t brickKey(int i, int j, int k)
+    {
+        const uint64_t bias = 1 << 20;
+        const uint64_t mask = (1 << 21) - 1;
+        return   (((uint64_t)((i >> BRICK_BITS) + bias) & mask) << 42)
+               | (((uint64_t)((j >> BRICK_BITS) + bias) & mask) << 21)
+               |  ((uint64_t)((k >> BRICK_BITS) + bias) & mask);
+    }
+
+    /**
+     * @brief Returns the position of a grid position within its brick
+     */
+    inline static size_t localIndex(int i, int j, int k)
+    {
+        const int mask = BRICK_SIZE - 1;
+        return ((i & mask) << (2 * BRICK_BITS)) | ((j & mask) << BRICK_BITS) | (k & mask);
+    }
+
+    /// Offsets of the allocated bricks in the value array
+    unordered_map<uint64_t, size_t> m_brickOffsets;
+
+    /// The brick entries
+    vector<unsigned int>            m_values;
+
+    /// The last brick that was accessed by \ref set
+    Cursor                          m_insertCursor;
+};
+
+} /* namespace lvr */
+
+#endif /* BRICKINDEX_HPP_ */
@@ -32,6 +32,7 @@
 #include "reconstruction/QueryPoint.hpp"
 #include "reconstruction/MCTable.hpp"
 #include "reconstruction/FastBoxTables.hpp"
+#include "reconstruction/SurfaceBuffer.hpp"
 #include <vector>
 #include <limits>
 
@@ -116,6 +117,45 @@ public:
             vector<QueryPoint<VertexT> > &query_points,
             uint &globalIndex);
 
+    /**
+     * @brief Calculates the local approximation of the box without
+     *        modifying the mesh or the neighbor boxes. The generated
+     *        vertices and triangles are appended to the given buffer.
+     *        The caller has to start a new record in the buffer via
+     *        SurfaceBuffer::beginBox() before. Several boxes can be
+     *        processed in parallel if each thread uses its own buffer.
+     *
+     * @param buffer        The buffer to store the local surface
+     * @param query_points  A vector containing the query points of the
+     *                      reconstruction grid
+     */
+    virtual void getLocalSurface(
+            SurfaceBuffer<VertexT> &buffer,
+            vector<QueryPoint<VertexT> > &query_points);
+
+    /**
+     * @brief Inserts a local surface that was created by \ref getLocalSurface
+     *        into the mesh. Intersections that were already generated by
+     *        neighbor boxes are reused, new ones are propagated to the
+     *        neighbors. Calling this for all boxes in the same order as
+     *        getSurface() yields exactly the same mesh.
+     *
+     * @param mesh          The reconstructed mesh
+     * @param buffer        The buffer that holds the local surface
+     * @param box           Index of the box record within the buffer
+     * @param globalIndex   The index of the next vertex in the mesh
+     */
+    void insertSurface(
+            BaseMesh<VertexT, NormalT> &mesh,
+            SurfaceBuffer<VertexT> &buffer,
+            size_t box,
+            uint &globalIndex);
+
+    /**
+     * @brief Returns the center of the box
+     */
+    const VertexT& getCenter() const { return m_center; }
+
     /// The voxelsize of the reconstruction grid
     static float             m_voxelsize;
 
@@ -181,6 +221,12 @@ protected:
      */
     float calcIntersection(float x1, float x2, float d1, float d2);
 
+    /**
+     * @brief Adds a triangle created by this box to the mesh. Derived
+     *        boxes can overload this to keep track of the created faces.
+     */
+    virtual void insertTriangle(BaseMesh<VertexT, NormalT> &mesh, uint a, uint b, uint c);
+
     /// The box center
     VertexT               		m_center;
 
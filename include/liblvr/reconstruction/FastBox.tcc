@@ -279,4 +279,122 @@ void FastBox<VertexT, NormalT>::getSurface(BaseMesh<VertexT, NormalT> &mesh,
 	}
 }	
 
+template<typename VertexT, typename NormalT>
+void FastBox<VertexT, NormalT>::getLocalSurface(SurfaceBuffer<VertexT> &buffer,
+                                                vector<QueryPoint<VertexT> > &qp)
+{
+	if(!m_fusionBox && !m_doubleBox)
+	{
+		VertexT corners[8];
+		VertexT vertex_positions[12];
+
+		float distances[8];
+
+		getCorners(corners, qp);
+		getDistances(distances, qp);
+		getIntersections(corners, distances, vertex_positions);
+
+		int index = getIndex(qp);
+
+		// Do not create traingles for invalid boxes
+		for (int i = 0; i < 8; i++)
+		{
+			if (qp[m_vertices[i]].m_invalid)
+			{
+				return;
+			}
+		}
+
+		// Box local index of each used edge intersection. Vertices
+		// are stored in the order of their first use to match the
+		// vertex order of getSurface()
+		int local_indices[12];
+		for(int i = 0; i < 12; i++)
+		{
+			local_indices[i] = -1;
+		}
+
+		int edge_index;
+		for(int a = 0; MCTable[index][a] != -1; a+= 3)
+		{
+			for(int b = 0; b < 3; b++)
+			{
+				edge_index = MCTable[index][a + b];
+				if(local_indices[edge_index] == -1)
+				{
+					local_indices[edge_index] = buffer.addVertex(vertex_positions[edge_index], edge_index);
+				}
+			}
+			buffer.addTriangle(
+					local_indices[MCTable[index][a]],
+					local_indices[MCTable[index][a + 1]],
+					local_indices[MCTable[index][a + 2]]);
+		}
+	}
+	else
+	{
+		m_fusionBox = false;
+	}
+}
+
+template<typename VertexT, typename NormalT>
+void FastBox<VertexT, NormalT>::insertSurface(BaseMesh<VertexT, NormalT> &mesh,
+                                              SurfaceBuffer<VertexT> &buffer,
+                                              size_t box,
+                                              uint &globalIndex)
+{
+	// Global indices of the box local vertices. A box creates at most
+	// one vertex per edge and one additional inner vertex.
+	uint global_indices[13];
+
+	size_t first = buffer.vertexBegin(box);
+	size_t last  = buffer.vertexEnd(box);
+	for(size_t i = first; i < last; i++)
+	{
+		int edge_index = buffer.m_edges[i];
+		if(edge_index == -1)
+		{
+			// Inner vertices are never shared
+			mesh.addVertex(buffer.m_vertices[i]);
+			mesh.addNormal(NormalT());
+			global_indices[i - first] = globalIndex++;
+		}
+		else
+		{
+			// Same as in getSurface(): Create a new vertex if no neighbor
+			// created one before and update all neighbor boxes
+			if(m_intersections[edge_index] == INVALID_INDEX)
+			{
+				m_intersections[edge_index] = globalIndex;
+				mesh.addVertex(buffer.m_vertices[i]);
+				mesh.addNormal(NormalT());
+				for(int j = 0; j < 3; j++)
+				{
+					FastBox<VertexT, NormalT>* current_neighbor = m_neighbors[neighbor_table[edge_index][j]];
+					if(current_neighbor != 0)
+					{
+						current_neighbor->m_intersections[neighbor_vertex_table[edge_index][j]] = globalIndex;
+					}
+				}
+				globalIndex++;
+			}
+			global_indices[i - first] = m_intersections[edge_index];
+		}
+	}
+
+	for(size_t i = buffer.faceBegin(box); i < buffer.faceEnd(box); i += 3)
+	{
+		insertTriangle(mesh,
+				global_indices[buffer.m_faces[i]],
+				global_indices[buffer.m_faces[i + 1]],
+				global_indices[buffer.m_faces[i + 2]]);
+	}
+}
+
+template<typename VertexT, typename NormalT>
+void FastBox<VertexT, NormalT>::insertTriangle(BaseMesh<VertexT, NormalT> &mesh, uint a, uint b, uint c)
+{
+	mesh.addTriangle(a, b, c);
+}
+
 } // namespace lvr
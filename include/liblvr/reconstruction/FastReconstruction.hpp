@@ -36,6 +36,7 @@
 #include "reconstruction/BilinearFastBox.hpp"
 #include "reconstruction/QueryPoint.hpp"
 #include "reconstruction/PointsetSurface.hpp"
+#include "io/Progress.hpp"
 
 #include "HashGrid.hpp"
 
@@ -79,8 +80,12 @@ public:
      * @brief Constructor.
      *
      * @param grid	A HashGrid instance on which the reconstruction is performed.
+     * @param parallel	If true, the local approximations of the cells are
+     * 					calculated in parallel. The resulting mesh is the same
+     * 					as in the serial extraction. Supported for FastBox,
+     * 					BilinearFastBox and SharpBox.
      */
-    FastReconstruction(HashGrid<VertexT, BoxT>* grid);
+    FastReconstruction(HashGrid<VertexT, BoxT>* grid, bool parallel = false);
 
 
     /**
@@ -97,7 +102,31 @@ public:
 
 private:
 
+    /**
+     * @brief Creates the triangles of all cells in parallel. The cells
+     *        are split into chunks that are processed independently into
+     *        thread local buffers. The buffers are inserted into the mesh
+     *        in the order of the given cells, so vertex and face indices
+     *        are the same as in the serial extraction.
+     *
+     * @param mesh			The reconstructed mesh
+     * @param cells			The cells of the grid in extraction order
+     * @param globalIndex	The index of the next vertex in the mesh
+     * @param progress		Progress bar for status output
+     */
+    void getMeshParallel(
+    		BaseMesh<VertexT, NormalT> &mesh,
+    		vector<BoxT*> &cells,
+    		uint &globalIndex,
+    		ProgressBar &progress);
+
     HashGrid<VertexT, BoxT>*		m_grid;
+
+    /// True if the cells are processed in parallel
+    bool							m_parallel;
+
+    /// Number of cells in a chunk of the parallel extraction
+    static const size_t				m_chunkSize = 4096;
 };
 
 
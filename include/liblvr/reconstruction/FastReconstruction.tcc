@@ -27,14 +27,18 @@
 #include "FastReconstructionTables.hpp"
 #include "SharpBox.hpp"
 #include "io/Progress.hpp"
+#include "config/lvropenmp.hpp"
+
+#include <algorithm>
 
 namespace lvr
 {
 
 template<typename VertexT, typename NormalT, typename BoxT>
-FastReconstruction<VertexT, NormalT, BoxT>::FastReconstruction(HashGrid<VertexT, BoxT>* grid)
+FastReconstruction<VertexT, NormalT, BoxT>::FastReconstruction(HashGrid<VertexT, BoxT>* grid, bool parallel)
 {
 	m_grid = grid;
+	m_parallel = parallel;
 }
 
 template<typename VertexT, typename NormalT, typename BoxT>
@@ -44,19 +48,25 @@ void FastReconstruction<VertexT, NormalT, BoxT>::getMesh(BaseMesh<VertexT, Norma
 	string comment = timestamp.getElapsedTime() + "Creating Mesh ";
 	ProgressBar progress(m_grid->getNumberOfCells(), comment);
 
-	// Some pointers
-	BoxT* b;
 	unsigned int global_index = mesh.meshSize();
 
+	// Get the cells of the grid
+	vector<BoxT*> cells;
+	m_grid->getCells(cells);
+
 	// Iterate through cells and calculate local approximations
-	typename HashGrid<VertexT, BoxT>::box_map_it it;
-	for(it = m_grid->firstCell(); it != m_grid->lastCell(); it++)
+	if(m_parallel)
 	{
-		b = it->second;
-		//#pragma omp task shared(mesh) // speedup 1/3
-		b->getSurface(mesh, m_grid->getQueryPoints(), global_index);
-		if(!timestamp.isQuiet())
-			++progress;
+		getMeshParallel(mesh, cells, global_index, progress);
+	}
+	else
+	{
+		for(size_t i = 0; i < cells.size(); i++)
+		{
+			cells[i]->getSurface(mesh, m_grid->getQueryPoints(), global_index);
+			if(!timestamp.isQuiet())
+				++progress;
+		}
 	}
 
 	if(!timestamp.isQuiet())
@@ -68,11 +78,11 @@ void FastReconstruction<VertexT, NormalT, BoxT>::getMesh(BaseMesh<VertexT, Norma
 	{
 		string SFComment = timestamp.getElapsedTime() + "Flipping edges  ";
 		ProgressBar SFProgress(this->m_grid->getNumberOfCells(), SFComment);
-		for(it = this->m_grid->firstCell(); it != this->m_grid->lastCell(); it++)
+		for(size_t i = 0; i < cells.size(); i++)
 		{
 
 			SharpBox<VertexT, NormalT>* sb;
-			sb = reinterpret_cast<SharpBox<VertexT, NormalT>* >(it->second);
+			sb = reinterpret_cast<SharpBox<VertexT, NormalT>* >(cells[i]);
 			if(sb->m_containsSharpFeature)
 			{
 				if(sb->m_containsSharpCorner)
@@ -96,10 +106,10 @@ void FastReconstruction<VertexT, NormalT, BoxT>::getMesh(BaseMesh<VertexT, Norma
 	{
 	    string comment = timestamp.getElapsedTime() + "Optimizing plane contours  ";
 	    ProgressBar progress(this->m_grid->getNumberOfCells(), comment);
-	    for(it = this->m_grid->firstCell(); it != this->m_grid->lastCell(); it++)
+	    for(size_t i = 0; i < cells.size(); i++)
 	    {
 	    	// FUCK type safety. According to traits object this is OK!
-	        BilinearFastBox<VertexT, NormalT>* box = reinterpret_cast<BilinearFastBox<VertexT, NormalT>*>(it->second);
+	        BilinearFastBox<VertexT, NormalT>* box = reinterpret_cast<BilinearFastBox<VertexT, NormalT>*>(cells[i]);
 	        box->optimizePlanarFaces(5);
 	        ++progress;
 	    }
@@ -108,6 +118,58 @@ void FastReconstruction<VertexT, NormalT, BoxT>::getMesh(BaseMesh<VertexT, Norma
 
 }
 
+template<typename VertexT, typename NormalT, typename BoxT>
+void FastReconstruction<VertexT, NormalT, BoxT>::getMeshParallel(
+		BaseMesh<VertexT, NormalT> &mesh,
+		vector<BoxT*> &cells,
+		uint &globalIndex,
+		ProgressBar &progress)
+{
+	vector<QueryPoint<VertexT> >& qp = m_grid->getQueryPoints();
+
+	// Process a limited number of chunks at once to bound the memory
+	// that is needed for the buffered triangles
+	size_t numChunks = (cells.size() + m_chunkSize - 1) / m_chunkSize;
+	size_t chunksPerBlock = 4 * OpenMPConfig::getNumThreads();
+	vector<SurfaceBuffer<VertexT> > buffers(chunksPerBlock);
+
+	for(size_t block = 0; block < numChunks; block += chunksPerBlock)
+	{
+		size_t blockEnd = std::min(numChunks, block + chunksPerBlock);
+
+		// Calculate the local approximations. Every chunk has its own
+		// buffer and the boxes only read the shared query points.
+		#pragma omp parallel for schedule(dynamic)
+		for(int c = (int)block; c < (int)blockEnd; c++)
+		{
+			SurfaceBuffer<VertexT>& buffer = buffers[c - block];
+			buffer.clear();
+
+			size_t first = c * m_chunkSize;
+			size_t last = std::min(cells.size(), first + m_chunkSize);
+			for(size_t i = first; i < last; i++)
+			{
+				buffer.beginBox();
+				cells[i]->getLocalSurface(buffer, qp);
+			}
+		}
+
+		// Insert the buffered triangles in cell order. Intersections
+		// shared with cells of other chunks are resolved here.
+		for(size_t c = block; c < blockEnd; c++)
+		{
+			SurfaceBuffer<VertexT>& buffer = buffers[c - block];
+			size_t first = c * m_chunkSize;
+			for(size_t i = 0; i < buffer.numBoxes(); i++)
+			{
+				cells[first + i]->insertSurface(mesh, buffer, i, globalIndex);
+				if(!timestamp.isQuiet())
+					++progress;
+			}
+		}
+	}
+}
+
 /*template<typename VertexT, typename NormalT, typename BoxT>
 void FastReconstruction<VertexT, typename BoxT, NormalT>::calcQueryPointValues(){
 
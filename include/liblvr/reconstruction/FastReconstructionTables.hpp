@@ -120,5 +120,26 @@ const static int HGCreateTable[8][3] = {
   { 0, -1, -1}
 };
 
+/**
+ * @brief For each box edge the box corner with the smaller coordinates
+ *        and the axis the edge is parallel to (0 = x, 1 = y, 2 = z).
+ *        Together with the lattice position of the box this identifies
+ *        an edge uniquely within the grid.
+ */
+const static int edge_origin_table[12][2] = {
+  { 0,  0},
+  { 1,  1},
+  { 3,  0},
+  { 0,  1},
+  { 4,  0},
+  { 5,  1},
+  { 7,  0},
+  { 4,  1},
+  { 0,  2},
+  { 1,  2},
+  { 3,  2},
+  { 2,  2}
+};
+
 
 #endif /* MCRECONSTRUCTIONTABLES_HPP_ */
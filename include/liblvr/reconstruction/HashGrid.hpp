@@ -11,8 +11,10 @@
 #include <unordered_map>
 #include <vector>
 #include <string>
+#include <stdint.h>
 
 #include "reconstruction/QueryPoint.hpp"
+#include "reconstruction/BrickIndex.hpp"
 #include "geometry/BoundingBox.hpp"
 
 using std::string;
@@ -22,6 +24,52 @@ using std::unordered_map;
 namespace lvr
 {
 
+/**
+ * @brief	Header of a binary grid checkpoint (see
+ * 			\ref HashGrid::saveCheckpoint). In the plain layout it is
+ * 			followed by the sorted cell keys (numCells * uint64_t), the
+ * 			sorted corner keys (numCorners * uint64_t), the signed
+ * 			distances of the corners (numCorners * float) and their
+ * 			invalid flags (numCorners * uint8_t).
+ *
+ * 			In the compressed layout the keys are split into blocks of
+ * 			HashGrid::m_checkpointBlockKeys keys. Each block stores its
+ * 			first key and the differences of the following keys as
+ * 			variable length integers (7 bits per byte). The header is
+ * 			followed by the end offsets of all cell and corner key blocks
+ * 			(uint64_t, relative to the first block), the encoded blocks,
+ * 			padding to a multiple of four bytes, the signed distances
+ * 			(numCorners * float) and the invalid flags packed into bits
+ * 			((numCorners + 7) / 8 * uint8_t).
+ */
+struct GridCheckpointHeader
+{
+	/// "LVRSDF" followed by the format version
+	char		magic[8];
+
+	/// Voxel size of the grid
+	float		voxelsize;
+
+	/// Minimum of the bounding box, i.e., the lattice origin
+	float		min[3];
+
+	/// Maximum of the bounding box
+	float		max[3];
+
+	/// Layout flags, see \ref GridCheckpointCompressed. Also keeps the
+	/// following sections 8 byte aligned.
+	uint32_t	flags;
+
+	/// Number of cells
+	uint64_t	numCells;
+
+	/// Number of cell corners (query points)
+	uint64_t	numCorners;
+};
+
+/// Checkpoint flag for the compressed layout
+const uint32_t GridCheckpointCompressed = 1;
+
 class GridBase
 {
 public:
@@ -86,10 +134,29 @@ public:
 	 * longest size of the given bounding box to estimate a suitable
 	 * resolution.
 	 *
+	 * If blocked is set to true, the boxes are not allocated one by one
+	 * and stored in the cell map. Instead they are stored by value in
+	 * large blocks and are addressed by a sparse index of dense 8x8x8
+	 * bricks (see \ref BrickIndex). The cell map iterators are not
+	 * available in this mode, use \ref getCells instead.
+	 *
 	 * @param 	cellSize		Voxel size of the grid cells
 	 * @param	isVoxelSize		Whether to interpret \ref cellSize as voxelsize or intersections
+	 * @param	blocked			Whether to use blocked box storage
 	 */
-	HashGrid(float cellSize, BoundingBox<VertexT> boundingBox, bool isVoxelSize = true);
+	HashGrid(float cellSize, BoundingBox<VertexT> boundingBox, bool isVoxelSize = true, bool blocked = false);
+
+	/***
+	 * @brief	Restores a grid from a binary checkpoint that was written
+	 * 			by \ref saveCheckpoint. The cells, query points and signed
+	 * 			distances are restored, so the grid can be polygonized
+	 * 			without calculating the distance values again. If the
+	 * 			checkpoint can't be read, the grid is empty.
+	 *
+	 * @param	checkpoint		Name of the checkpoint file
+	 * @param	blocked			Whether to use blocked box storage
+	 */
+	HashGrid(string checkpoint, bool blocked = false);
 
 	/**
 	 *
@@ -108,10 +175,41 @@ public:
 	 */
 	virtual void saveGrid(string file);
 
+	/**
+	 * @brief	Writes a binary checkpoint of the grid. The checkpoint
+	 * 			contains the voxel size, the bounding box, the sorted
+	 * 			lattice keys of all cells and corners and the signed
+	 * 			distances and invalid flags of the corners. All sections
+	 * 			are stored as plain arrays at aligned offsets, so the file
+	 * 			can be memory mapped. The sections are written in
+	 * 			parallel blocks. Optionally the keys are delta encoded
+	 * 			and the invalid flags are packed into bits. Compressed
+	 * 			checkpoints are decoded in parallel when they are loaded.
+	 *
+	 * @param	file		Output file name.
+	 * @param	compress	Whether to use the compressed layout
+	 * @return	True if the checkpoint was written
+	 */
+	bool saveCheckpoint(string file, bool compress = false);
+
 	/***
 	 * @brief 	Returns the number of generated cells.
 	 */
-	size_t getNumberOfCells() {return m_cells.size();}
+	size_t getNumberOfCells() {return m_blocked ? m_numBoxes : m_cells.size();}
+
+	/**
+	 * @brief	Returns pointers to all cells of the grid. With the default
+	 * 			storage the cells are ordered like the cell map iteration,
+	 * 			with blocked storage they are ordered by creation.
+	 *
+	 * @param	cells	The cells of the grid
+	 */
+	void getCells(vector<BoxT*> &cells);
+
+	/**
+	 * @brief	Returns true if the boxes are kept in blocked storage
+	 */
+	bool isBlocked() const {return m_blocked;}
 
 	/**
 	 * @return	Returns an iterator to the first box in the cell map.
@@ -168,6 +266,99 @@ protected:
 	 */
 	void calcIndices();
 
+	/**
+	 * @brief	Calculates the sorted lattice keys of all corners of the
+	 * 			given cells. Corners are shifted by one in every positive
+	 * 			direction of the box creation table.
+	 *
+	 * @param	cellKeys	Sorted lattice keys of the cells
+	 * @param	cornerKeys	Receives the sorted corner keys
+	 */
+	void collectCorners(const vector<uint64_t> &cellKeys, vector<uint64_t> &cornerKeys);
+
+	/**
+	 * @brief	Creates boxes, query points and neighbor links in bulk for
+	 * 			the given cells. The query points are numbered in the order
+	 * 			of the corner keys.
+	 *
+	 * @param	cellKeys	Sorted lattice keys of the cells
+	 * @param	cornerKeys	Sorted lattice keys of all cell corners
+	 */
+	void createCells(const vector<uint64_t> &cellKeys, const vector<uint64_t> &cornerKeys);
+
+	/**
+	 * @brief	Reads a checkpoint that was written by \ref saveCheckpoint
+	 *
+	 * @return	True if the grid was restored
+	 */
+	bool loadCheckpoint(string file);
+
+	/**
+	 * @brief	Delta encodes sorted keys into blocks of
+	 * 			\ref m_checkpointBlockKeys keys
+	 */
+	static void encodeKeys(const vector<uint64_t> &keys, vector<vector<uint8_t> > &blocks);
+
+	/**
+	 * @brief	Decodes keys that were encoded by \ref encodeKeys
+	 *
+	 * @param	data		Start of the first block of the checkpoint
+	 * @param	ends		End offsets of all blocks relative to data
+	 * @param	firstBlock	Index of the first block of the keys
+	 * @param	numKeys		Number of encoded keys
+	 * @param	keys		Receives the keys
+	 * @return	False if a block is corrupted
+	 */
+	static bool decodeKeys(const uint8_t* data, const uint64_t* ends, size_t firstBlock, size_t numKeys, vector<uint64_t> &keys);
+
+	/**
+	 * @brief	Releases the memory mapping of a checkpoint file
+	 *
+	 * @param	data	Start of the mapping or NULL
+	 * @param	size	Size of the mapping
+	 */
+	void unmapCheckpoint(const char* data, size_t size);
+
+	/**
+	 * @brief	Packs a lattice position into a single 64 bit key (21 bits
+	 * 			per dimension). The order of the keys is the lexicographic
+	 * 			order of the positions.
+	 */
+	inline static uint64_t latticeKey(int i, int j, int k)
+	{
+		const uint64_t mask = (1 << 21) - 1;
+		return   (((uint64_t)(i + m_keyBias) & mask) << 42)
+			   | (((uint64_t)(j + m_keyBias) & mask) << 21)
+			   |  ((uint64_t)(k + m_keyBias) & mask);
+	}
+
+	/**
+	 * @brief	Restores the lattice position from a key
+	 */
+	inline static void latticePosition(uint64_t key, int &i, int &j, int &k)
+	{
+		const uint64_t mask = (1 << 21) - 1;
+		i = (int)((key >> 42) & mask) - m_keyBias;
+		j = (int)((key >> 21) & mask) - m_keyBias;
+		k = (int)(key & mask) - m_keyBias;
+	}
+
+	/**
+	 * @brief	Creates a new box in the blocked storage.
+	 *
+	 * @param	center	The center of the new box
+	 * @return	The index of the created box
+	 */
+	unsigned int createBlockedBox(VertexT &center);
+
+	/**
+	 * @brief	Returns the box with the given index from the blocked storage
+	 */
+	inline BoxT* getBlockedBox(unsigned int index)
+	{
+		return m_boxBlocks[index / m_boxBlockSize] + index % m_boxBlockSize;
+	}
+
     /**
      * @brief Calculates the hash value for the given index triple
      */
@@ -216,6 +407,30 @@ protected:
 
     /// Save scaling factors (i.e., -1 or +1) to mapp different coordinate systems
     VertexT						m_coordinateScales;
+
+    /// True if the boxes are kept in blocked storage
+    bool						m_blocked;
+
+    /// Indices of the boxes in the blocked storage addressed by cell position
+    BrickIndex					m_cellIndices;
+
+    /// Query point indices addressed by the lattice position of the cell corners
+    BrickIndex					m_cornerIndices;
+
+    /// Blocks of boxes in the blocked storage
+    vector<BoxT*>				m_boxBlocks;
+
+    /// Number of boxes in the blocked storage
+    size_t						m_numBoxes;
+
+    /// Number of boxes per block
+    static const size_t			m_boxBlockSize = 4096;
+
+    /// Offset to store negative lattice positions in keys
+    static const int			m_keyBias = 1 << 20;
+
+    /// Number of keys per block in compressed checkpoints
+    static const size_t			m_checkpointBlockKeys = 1 << 16;
 };
 
 } /* namespace lvr */
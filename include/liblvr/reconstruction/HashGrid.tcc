@@ -37,15 +37,31 @@
 #include "FastReconstructionTables.hpp"
 #include "SharpBox.hpp"
 #include "io/Progress.hpp"
+#include "ParallelSort.hpp"
+
+#include <new>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace lvr
 {
 
 template<typename VertexT, typename BoxT>
-HashGrid<VertexT, BoxT>::HashGrid(float cellSize, BoundingBox<VertexT> boundingBox, bool isVoxelsize) :
+HashGrid<VertexT, BoxT>::HashGrid(float cellSize, BoundingBox<VertexT> boundingBox, bool isVoxelsize, bool blocked) :
 	m_extrude(false),
 	m_boundingBox(boundingBox),
-	m_globalIndex(0)
+	m_globalIndex(0),
+	m_blocked(blocked),
+	m_numBoxes(0)
 {
 	m_coordinateScales[0] = 1.0;
 	m_coordinateScales[1] = 1.0;
@@ -77,6 +93,24 @@ HashGrid<VertexT, BoxT>::HashGrid(float cellSize, BoundingBox<VertexT> boundingB
 	calcIndices();
 }
 
+template<typename VertexT, typename BoxT>
+HashGrid<VertexT, BoxT>::HashGrid(string checkpoint, bool blocked) :
+	m_voxelsize(0),
+	m_extrude(false),
+	m_globalIndex(0),
+	m_blocked(blocked),
+	m_numBoxes(0)
+{
+	m_coordinateScales[0] = 1.0;
+	m_coordinateScales[1] = 1.0;
+	m_coordinateScales[2] = 1.0;
+
+	if(!loadCheckpoint(checkpoint))
+	{
+		cout << timestamp << "Unable to restore grid from " << checkpoint << endl;
+	}
+}
+
 template<typename VertexT, typename BoxT>
 void HashGrid<VertexT, BoxT>::setCoordinateScaling(float x, float y, float z)
 {
@@ -99,6 +133,52 @@ HashGrid<VertexT, BoxT>::~HashGrid()
 	}
 
 	m_cells.clear();
+
+	// Destroy the boxes in the blocked storage
+	for(size_t i = 0; i < m_numBoxes; i++)
+	{
+		getBlockedBox(i)->~BoxT();
+	}
+	for(size_t i = 0; i < m_boxBlocks.size(); i++)
+	{
+		::operator delete(m_boxBlocks[i]);
+	}
+	m_boxBlocks.clear();
+	m_numBoxes = 0;
+}
+
+template<typename VertexT, typename BoxT>
+unsigned int HashGrid<VertexT, BoxT>::createBlockedBox(VertexT &center)
+{
+	if(m_numBoxes == m_boxBlocks.size() * m_boxBlockSize)
+	{
+		m_boxBlocks.push_back(static_cast<BoxT*>(::operator new(m_boxBlockSize * sizeof(BoxT))));
+	}
+
+	new (getBlockedBox(m_numBoxes)) BoxT(center);
+	return m_numBoxes++;
+}
+
+template<typename VertexT, typename BoxT>
+void HashGrid<VertexT, BoxT>::getCells(vector<BoxT*> &cells)
+{
+	cells.clear();
+	cells.reserve(getNumberOfCells());
+	if(m_blocked)
+	{
+		for(size_t i = 0; i < m_numBoxes; i++)
+		{
+			cells.push_back(getBlockedBox(i));
+		}
+	}
+	else
+	{
+		box_map_it it;
+		for(it = m_cells.begin(); it != m_cells.end(); it++)
+		{
+			cells.push_back(it->second);
+		}
+	}
 }
 
 
@@ -117,6 +197,610 @@ void HashGrid<VertexT, BoxT>::calcIndices()
 	m_maxIndexZ = (int)ceil(m_boundingBox.getZSize() / m_voxelsize) + 3;
 }
 
+template<typename VertexT, typename BoxT>
+void HashGrid<VertexT, BoxT>::collectCorners(const vector<uint64_t> &cellKeys, vector<uint64_t> &cornerKeys)
+{
+	size_t numCells = cellKeys.size();
+	cornerKeys.resize(numCells * 8);
+	#pragma omp parallel for
+	for(long i = 0; i < (long)numCells; i++)
+	{
+		int x, y, z;
+		latticePosition(cellKeys[i], x, y, z);
+		for(int k = 0; k < 8; k++)
+		{
+			cornerKeys[i * 8 + k] = latticeKey(
+					x + (box_creation_table[k][0] > 0 ? 1 : 0),
+					y + (box_creation_table[k][1] > 0 ? 1 : 0),
+					z + (box_creation_table[k][2] > 0 ? 1 : 0));
+		}
+	}
+	parallelSort(cornerKeys);
+	cornerKeys.erase(std::unique(cornerKeys.begin(), cornerKeys.end()), cornerKeys.end());
+}
+
+template<typename VertexT, typename BoxT>
+void HashGrid<VertexT, BoxT>::createCells(const vector<uint64_t> &cellKeys, const vector<uint64_t> &cornerKeys)
+{
+	VertexT v_min = this->m_boundingBox.getMin();
+	float vsh = 0.5 * this->m_voxelsize;
+	size_t numCells = cellKeys.size();
+
+	// Create the query points
+	size_t firstQueryPoint = this->m_queryPoints.size();
+	this->m_queryPoints.resize(firstQueryPoint + cornerKeys.size());
+	#pragma omp parallel for
+	for(long i = 0; i < (long)cornerKeys.size(); i++)
+	{
+		int x, y, z;
+		latticePosition(cornerKeys[i], x, y, z);
+		VertexT position(
+				x * this->m_voxelsize + v_min[0] - vsh,
+				y * this->m_voxelsize + v_min[1] - vsh,
+				z * this->m_voxelsize + v_min[2] - vsh);
+		this->m_queryPoints[firstQueryPoint + i] = QueryPoint<VertexT>(position, 0.0);
+	}
+	this->m_globalIndex += cornerKeys.size();
+
+	// Create the boxes
+	vector<BoxT*> boxes(numCells);
+	if(this->m_blocked)
+	{
+		for(size_t i = 0; i < numCells; i++)
+		{
+			int x, y, z;
+			latticePosition(cellKeys[i], x, y, z);
+			VertexT box_center(
+					x * this->m_voxelsize + v_min[0],
+					y * this->m_voxelsize + v_min[1],
+					z * this->m_voxelsize + v_min[2]);
+
+			unsigned int box_index = this->createBlockedBox(box_center);
+			this->m_cellIndices.set(x, y, z, box_index);
+			boxes[i] = this->getBlockedBox(box_index);
+		}
+	}
+	else
+	{
+		#pragma omp parallel for
+		for(long i = 0; i < (long)numCells; i++)
+		{
+			int x, y, z;
+			latticePosition(cellKeys[i], x, y, z);
+			VertexT box_center(
+					x * this->m_voxelsize + v_min[0],
+					y * this->m_voxelsize + v_min[1],
+					z * this->m_voxelsize + v_min[2]);
+			boxes[i] = new BoxT(box_center);
+		}
+	}
+
+	// Set the corners and neighbors of the boxes. Every box only writes
+	// its own entries, so no synchronization is needed.
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for(long i = 0; i < (long)numCells; i++)
+	{
+		int x, y, z;
+		latticePosition(cellKeys[i], x, y, z);
+		BoxT* box = boxes[i];
+
+		for(int k = 0; k < 8; k++)
+		{
+			uint64_t key = latticeKey(
+					x + (box_creation_table[k][0] > 0 ? 1 : 0),
+					y + (box_creation_table[k][1] > 0 ? 1 : 0),
+					z + (box_creation_table[k][2] > 0 ? 1 : 0));
+			size_t index = std::lower_bound(cornerKeys.begin(), cornerKeys.end(), key) - cornerKeys.begin();
+			box->setVertex(k, firstQueryPoint + index);
+		}
+
+		int neighbor_index = 0;
+		for(int a = -1; a < 2; a++)
+		{
+			for(int b = -1; b < 2; b++)
+			{
+				for(int c = -1; c < 2; c++)
+				{
+					if(a != 0 || b != 0 || c != 0)
+					{
+						uint64_t key = latticeKey(x + a, y + b, z + c);
+						vector<uint64_t>::const_iterator it = std::lower_bound(cellKeys.begin(), cellKeys.end(), key);
+						if(it != cellKeys.end() && *it == key)
+						{
+							box->setNeighbor(neighbor_index, boxes[it - cellKeys.begin()]);
+						}
+					}
+					neighbor_index++;
+				}
+			}
+		}
+	}
+
+	// Register the boxes in the cell lookup structures
+	if(this->m_blocked)
+	{
+		for(size_t i = 0; i < cornerKeys.size(); i++)
+		{
+			int x, y, z;
+			latticePosition(cornerKeys[i], x, y, z);
+			this->m_cornerIndices.set(x, y, z, firstQueryPoint + i);
+		}
+	}
+	else
+	{
+		this->m_cells.reserve(numCells);
+		for(size_t i = 0; i < numCells; i++)
+		{
+			int x, y, z;
+			latticePosition(cellKeys[i], x, y, z);
+			this->m_cells[this->hashValue(x, y, z)] = boxes[i];
+		}
+	}
+}
+
+template<typename VertexT, typename BoxT>
+bool HashGrid<VertexT, BoxT>::saveCheckpoint(string filename, bool compress)
+{
+	cout << timestamp << "Writing grid checkpoint " << filename << endl;
+
+	VertexT v_min = m_boundingBox.getMin();
+	VertexT v_max = m_boundingBox.getMax();
+	float vsh = 0.5 * m_voxelsize;
+
+	vector<BoxT*> cells;
+	getCells(cells);
+
+	// The lattice positions of the cells and corners are restored from
+	// the cell centers and the query point positions
+	vector<uint64_t> cellKeys(cells.size());
+	#pragma omp parallel for
+	for(long i = 0; i < (long)cells.size(); i++)
+	{
+		const VertexT& center = cells[i]->getCenter();
+		int p[3];
+		for(int a = 0; a < 3; a++)
+		{
+			float f = (center[a] - v_min[a]) / m_voxelsize;
+			p[a] = f < 0 ? f - .5 : f + .5;
+		}
+		cellKeys[i] = latticeKey(p[0], p[1], p[2]);
+	}
+	parallelSort(cellKeys);
+
+	vector<std::pair<uint64_t, unsigned int> > corners(m_queryPoints.size());
+	#pragma omp parallel for
+	for(long i = 0; i < (long)m_queryPoints.size(); i++)
+	{
+		const VertexT& position = m_queryPoints[i].m_position;
+		int p[3];
+		for(int a = 0; a < 3; a++)
+		{
+			float f = (position[a] - v_min[a] + vsh) / m_voxelsize;
+			p[a] = f < 0 ? f - .5 : f + .5;
+		}
+		corners[i] = std::make_pair(latticeKey(p[0], p[1], p[2]), (unsigned int)i);
+	}
+	parallelSort(corners);
+
+	// Collect the corner data in key order
+	size_t numCorners = corners.size();
+	vector<uint64_t> cornerKeys(numCorners);
+	vector<float> distances(numCorners);
+	vector<uint8_t> invalid(numCorners);
+	#pragma omp parallel for
+	for(long i = 0; i < (long)numCorners; i++)
+	{
+		const QueryPoint<VertexT>& qp = m_queryPoints[corners[i].second];
+		cornerKeys[i] = corners[i].first;
+		distances[i] = qp.m_distance;
+		invalid[i] = qp.m_invalid ? 1 : 0;
+	}
+	corners.clear();
+
+	GridCheckpointHeader header;
+	memcpy(header.magic, "LVRSDF01", 8);
+	header.voxelsize = m_voxelsize;
+	for(int a = 0; a < 3; a++)
+	{
+		header.min[a] = v_min[a];
+		header.max[a] = v_max[a];
+	}
+	header.flags = compress ? GridCheckpointCompressed : 0;
+	header.numCells = cellKeys.size();
+	header.numCorners = numCorners;
+
+	// The sections of the file in the order of their offsets
+	vector<const char*> sectionData;
+	vector<size_t> sectionSize;
+	sectionData.push_back(reinterpret_cast<const char*>(&header));
+	sectionSize.push_back(sizeof(header));
+
+	vector<vector<uint8_t> > keyBlocks;
+	vector<uint64_t> blockEnds;
+	vector<uint8_t> packedInvalid;
+	const char padding[4] = {0, 0, 0, 0};
+	if(compress)
+	{
+		vector<vector<uint8_t> > cornerBlocks;
+		encodeKeys(cellKeys, keyBlocks);
+		encodeKeys(cornerKeys, cornerBlocks);
+		keyBlocks.insert(keyBlocks.end(), cornerBlocks.begin(), cornerBlocks.end());
+
+		uint64_t end = 0;
+		for(size_t i = 0; i < keyBlocks.size(); i++)
+		{
+			end += keyBlocks[i].size();
+			blockEnds.push_back(end);
+		}
+
+		packedInvalid.resize((numCorners + 7) / 8);
+		#pragma omp parallel for
+		for(long i = 0; i < (long)packedInvalid.size(); i++)
+		{
+			uint8_t bits = 0;
+			for(size_t b = 0; b < 8 && i * 8 + b < numCorners; b++)
+			{
+				bits |= invalid[i * 8 + b] << b;
+			}
+			packedInvalid[i] = bits;
+		}
+
+		sectionData.push_back(reinterpret_cast<const char*>(blockEnds.data()));
+		sectionSize.push_back(blockEnds.size() * sizeof(uint64_t));
+		for(size_t i = 0; i < keyBlocks.size(); i++)
+		{
+			sectionData.push_back(reinterpret_cast<const char*>(keyBlocks[i].data()));
+			sectionSize.push_back(keyBlocks[i].size());
+		}
+		sectionData.push_back(padding);
+		sectionSize.push_back((4 - (sizeof(header) + sectionSize[1] + end) % 4) % 4);
+		sectionData.push_back(reinterpret_cast<const char*>(distances.data()));
+		sectionSize.push_back(numCorners * sizeof(float));
+		sectionData.push_back(reinterpret_cast<const char*>(packedInvalid.data()));
+		sectionSize.push_back(packedInvalid.size());
+	}
+	else
+	{
+		sectionData.push_back(reinterpret_cast<const char*>(cellKeys.data()));
+		sectionSize.push_back(cellKeys.size() * sizeof(uint64_t));
+		sectionData.push_back(reinterpret_cast<const char*>(cornerKeys.data()));
+		sectionSize.push_back(numCorners * sizeof(uint64_t));
+		sectionData.push_back(reinterpret_cast<const char*>(distances.data()));
+		sectionSize.push_back(numCorners * sizeof(float));
+		sectionData.push_back(reinterpret_cast<const char*>(invalid.data()));
+		sectionSize.push_back(numCorners * sizeof(uint8_t));
+	}
+
+#ifndef _WIN32
+	// Split the sections into blocks at precomputed file offsets, so that
+	// the blocks can be written in parallel
+	const size_t blockSize = 1 << 24;
+	vector<const char*> blockData;
+	vector<size_t> blockLength;
+	vector<off_t> blockOffset;
+	off_t fileSize = 0;
+	for(size_t i = 0; i < sectionData.size(); i++)
+	{
+		for(size_t b = 0; b < sectionSize[i]; b += blockSize)
+		{
+			blockData.push_back(sectionData[i] + b);
+			blockLength.push_back(std::min(blockSize, sectionSize[i] - b));
+			blockOffset.push_back(fileSize + b);
+		}
+		fileSize += sectionSize[i];
+	}
+
+	int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	long errors = (fd < 0 || ftruncate(fd, fileSize) != 0) ? 1 : 0;
+	if(!errors)
+	{
+		#pragma omp parallel for schedule(dynamic) reduction(+:errors)
+		for(long i = 0; i < (long)blockData.size(); i++)
+		{
+			size_t written = 0;
+			while(written < blockLength[i])
+			{
+				ssize_t n = pwrite(fd, blockData[i] + written, blockLength[i] - written, blockOffset[i] + written);
+				if(n <= 0)
+				{
+					errors++;
+					break;
+				}
+				written += n;
+			}
+		}
+	}
+	if(fd >= 0 && close(fd) != 0)
+	{
+		errors++;
+	}
+
+	if(errors)
+	{
+		cout << timestamp << "Unable to write grid checkpoint " << filename << endl;
+		return false;
+	}
+#else
+	ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+	for(size_t i = 0; i < sectionData.size(); i++)
+	{
+		out.write(sectionData[i], sectionSize[i]);
+	}
+
+	if(!out.good())
+	{
+		cout << timestamp << "Unable to write grid checkpoint " << filename << endl;
+		return false;
+	}
+#endif
+
+	cout << timestamp << "Wrote " << cellKeys.size() << " cells and " << numCorners << " corners." << endl;
+	return true;
+}
+
+template<typename VertexT, typename BoxT>
+bool HashGrid<VertexT, BoxT>::loadCheckpoint(string filename)
+{
+	cout << timestamp << "Reading grid checkpoint " << filename << endl;
+
+	// Get the whole file as one block of memory. It is mapped if possible.
+	const char* data = NULL;
+	uint64_t fileSize = 0;
+#ifndef _WIN32
+	int fd = open(filename.c_str(), O_RDONLY);
+	struct stat st;
+	if(fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0)
+	{
+		void* mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(mapping != MAP_FAILED)
+		{
+			data = (const char*) mapping;
+			fileSize = st.st_size;
+		}
+	}
+	if(fd >= 0)
+	{
+		close(fd);
+	}
+#else
+	vector<char> buffer;
+	ifstream in(filename.c_str(), std::ios::binary);
+	in.seekg(0, std::ios::end);
+	if(in.good() && in.tellg() > 0)
+	{
+		buffer.resize(in.tellg());
+		in.seekg(0, std::ios::beg);
+		if(in.read(buffer.data(), buffer.size()))
+		{
+			data = buffer.data();
+			fileSize = buffer.size();
+		}
+	}
+#endif
+
+	GridCheckpointHeader header;
+	if(!data || fileSize < sizeof(header) || memcmp(data, "LVRSDF01", 8) != 0)
+	{
+		cout << timestamp << filename << " is not a grid checkpoint." << endl;
+		unmapCheckpoint(data, fileSize);
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	// Check the counts against the file size before the arrays are
+	// allocated. The counts are compared before they are multiplied, so
+	// corrupted counts can not overflow.
+	uint64_t payload = fileSize - sizeof(header);
+	vector<uint64_t> cellKeys;
+	vector<uint64_t> cornerKeys;
+	const float* distances = NULL;
+	const uint8_t* invalid = NULL;
+	vector<uint8_t> unpackedInvalid;
+	bool valid = false;
+	if(header.flags == 0)
+	{
+		const uint64_t cornerSize = sizeof(uint64_t) + sizeof(float) + sizeof(uint8_t);
+		valid = header.numCells <= payload / sizeof(uint64_t)
+				&& header.numCorners <= (payload - header.numCells * sizeof(uint64_t)) / cornerSize
+				&& payload == header.numCells * sizeof(uint64_t) + header.numCorners * cornerSize;
+		if(valid)
+		{
+			const uint64_t* cellData = reinterpret_cast<const uint64_t*>(data + sizeof(header));
+			const uint64_t* cornerData = cellData + header.numCells;
+			distances = reinterpret_cast<const float*>(cornerData + header.numCorners);
+			invalid = reinterpret_cast<const uint8_t*>(distances + header.numCorners);
+			cellKeys.assign(cellData, cellData + header.numCells);
+			cornerKeys.assign(cornerData, cornerData + header.numCorners);
+		}
+	}
+	else if(header.flags == GridCheckpointCompressed)
+	{
+		// Every key takes at least one byte and every corner at least four
+		// more bytes for its distance
+		const uint64_t B = m_checkpointBlockKeys;
+		valid = header.numCells <= payload && header.numCorners <= payload / 5;
+		uint64_t numCellBlocks = (header.numCells + B - 1) / B;
+		uint64_t numBlocks = numCellBlocks + (header.numCorners + B - 1) / B;
+		valid = valid && numBlocks <= payload / sizeof(uint64_t);
+
+		const uint64_t* ends = reinterpret_cast<const uint64_t*>(data + sizeof(header));
+		uint64_t keyOffset = sizeof(header) + numBlocks * sizeof(uint64_t);
+		uint64_t keyBytes = valid && numBlocks ? ends[numBlocks - 1] : 0;
+		valid = valid && keyBytes <= fileSize - keyOffset;
+		uint64_t distanceOffset = (keyOffset + keyBytes + 3) / 4 * 4;
+		valid = valid && fileSize == distanceOffset + header.numCorners * sizeof(float) + (header.numCorners + 7) / 8;
+
+		const uint8_t* keyData = reinterpret_cast<const uint8_t*>(data + keyOffset);
+		valid = valid
+				&& decodeKeys(keyData, ends, 0, header.numCells, cellKeys)
+				&& decodeKeys(keyData, ends, numCellBlocks, header.numCorners, cornerKeys);
+
+		if(valid)
+		{
+			distances = reinterpret_cast<const float*>(data + distanceOffset);
+			const uint8_t* packed = reinterpret_cast<const uint8_t*>(distances + header.numCorners);
+			unpackedInvalid.resize(header.numCorners);
+			#pragma omp parallel for
+			for(long i = 0; i < (long)header.numCorners; i++)
+			{
+				unpackedInvalid[i] = (packed[i / 8] >> (i % 8)) & 1;
+			}
+			invalid = unpackedInvalid.data();
+		}
+	}
+	if(!valid)
+	{
+		cout << timestamp << "Grid checkpoint " << filename << " is truncated or corrupted." << endl;
+		unmapCheckpoint(data, fileSize);
+		return false;
+	}
+
+	// All keys have to be sorted and every cell corner has to be present
+	long errors = 0;
+	#pragma omp parallel for reduction(+:errors)
+	for(long i = 0; i < (long)cellKeys.size(); i++)
+	{
+		if(i > 0 && cellKeys[i - 1] >= cellKeys[i])
+		{
+			errors++;
+		}
+
+		int x, y, z;
+		latticePosition(cellKeys[i], x, y, z);
+		for(int k = 0; k < 8; k++)
+		{
+			uint64_t key = latticeKey(
+					x + (box_creation_table[k][0] > 0 ? 1 : 0),
+					y + (box_creation_table[k][1] > 0 ? 1 : 0),
+					z + (box_creation_table[k][2] > 0 ? 1 : 0));
+			if(!std::binary_search(cornerKeys.begin(), cornerKeys.end(), key))
+			{
+				errors++;
+			}
+		}
+	}
+	#pragma omp parallel for reduction(+:errors)
+	for(long i = 1; i < (long)cornerKeys.size(); i++)
+	{
+		if(cornerKeys[i - 1] >= cornerKeys[i])
+		{
+			errors++;
+		}
+	}
+	if(errors)
+	{
+		cout << timestamp << "Grid checkpoint " << filename << " is inconsistent." << endl;
+		unmapCheckpoint(data, fileSize);
+		return false;
+	}
+
+	m_voxelsize = header.voxelsize;
+	BoxT::m_voxelsize = m_voxelsize;
+	m_boundingBox.expand(header.min[0], header.min[1], header.min[2]);
+	m_boundingBox.expand(header.max[0], header.max[1], header.max[2]);
+	calcIndices();
+
+	createCells(cellKeys, cornerKeys);
+
+	#pragma omp parallel for
+	for(long i = 0; i < (long)m_queryPoints.size(); i++)
+	{
+		m_queryPoints[i].m_distance = distances[i];
+		m_queryPoints[i].m_invalid = invalid[i] != 0;
+	}
+	unmapCheckpoint(data, fileSize);
+
+	cout << timestamp << "Restored " << getNumberOfCells() << " cells and "
+		 << m_queryPoints.size() << " query points with voxelsize " << m_voxelsize << endl;
+	return true;
+}
+
+template<typename VertexT, typename BoxT>
+void HashGrid<VertexT, BoxT>::encodeKeys(const vector<uint64_t> &keys, vector<vector<uint8_t> > &blocks)
+{
+	const size_t B = m_checkpointBlockKeys;
+	blocks.resize((keys.size() + B - 1) / B);
+	#pragma omp parallel for schedule(dynamic)
+	for(long b = 0; b < (long)blocks.size(); b++)
+	{
+		size_t end = std::min(keys.size(), (b + 1) * B);
+		vector<uint8_t> &block = blocks[b];
+		block.reserve(2 * (end - b * B) + 8);
+		uint64_t last = 0;
+		for(size_t i = b * B; i < end; i++)
+		{
+			uint64_t delta = keys[i] - last;
+			last = keys[i];
+			while(delta >= 0x80)
+			{
+				block.push_back((uint8_t)(delta | 0x80));
+				delta >>= 7;
+			}
+			block.push_back((uint8_t)delta);
+		}
+	}
+}
+
+template<typename VertexT, typename BoxT>
+bool HashGrid<VertexT, BoxT>::decodeKeys(const uint8_t* data, const uint64_t* ends, size_t firstBlock, size_t numKeys, vector<uint64_t> &keys)
+{
+	const size_t B = m_checkpointBlockKeys;
+	size_t numBlocks = (numKeys + B - 1) / B;
+	keys.resize(numKeys);
+
+	long errors = 0;
+	#pragma omp parallel for schedule(dynamic) reduction(+:errors)
+	for(long b = 0; b < (long)numBlocks; b++)
+	{
+		size_t block = firstBlock + b;
+		uint64_t begin = block ? ends[block - 1] : 0;
+		if(ends[block] < begin)
+		{
+			errors++;
+			continue;
+		}
+		const uint8_t* p = data + begin;
+		const uint8_t* blockEnd = data + ends[block];
+
+		size_t end = std::min(numKeys, (b + 1) * B);
+		uint64_t last = 0;
+		for(size_t i = b * B; i < end; i++)
+		{
+			uint64_t delta = 0;
+			int shift = 0;
+			while(p < blockEnd && shift < 64 && (*p & 0x80))
+			{
+				delta |= (uint64_t)(*p++ & 0x7f) << shift;
+				shift += 7;
+			}
+			if(p == blockEnd || shift >= 64)
+			{
+				errors++;
+				break;
+			}
+			delta |= (uint64_t)*p++ << shift;
+			last += delta;
+			keys[i] = last;
+		}
+		if(p != blockEnd)
+		{
+			errors++;
+		}
+	}
+	return errors == 0;
+}
+
+template<typename VertexT, typename BoxT>
+void HashGrid<VertexT, BoxT>::unmapCheckpoint(const char* data, size_t size)
+{
+#ifndef _WIN32
+	if(data)
+	{
+		munmap((void*) data, size);
+	}
+#endif
+}
+
 template<typename VertexT, typename BoxT>
 unsigned int HashGrid<VertexT, BoxT>::findQueryPoint(
 		const int &position, const int &x, const int &y, const int &z)
@@ -158,7 +842,7 @@ void HashGrid<VertexT, BoxT>::saveGrid(string filename)
 	if(out.good())
 	{
 		// Write header
-		out << m_queryPoints.size() << " " << m_voxelsize << " " << m_cells.size() << endl;
+		out << m_queryPoints.size() << " " << m_voxelsize << " " << getNumberOfCells() << endl;
 
 		// Write query points and distances
 		for(size_t i = 0; i < m_queryPoints.size(); i++)
@@ -179,14 +863,13 @@ void HashGrid<VertexT, BoxT>::saveGrid(string filename)
 		}
 
 		// Write box definitions
-		typename unordered_map<size_t, BoxT* >::iterator it;
-		BoxT* box;
-		for(it = m_cells.begin(); it != m_cells.end(); it++)
+		vector<BoxT*> cells;
+		getCells(cells);
+		for(size_t c = 0; c < cells.size(); c++)
 		{
-			box = it->second;
 			for(int i = 0; i < 8; i++)
 			{
-				out << box->getVertex(i) << " ";
+				out << cells[c]->getVertex(i) << " ";
 			}
 			out << endl;
 		}
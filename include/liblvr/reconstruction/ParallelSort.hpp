@@ -0,0 +1,86 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * ParallelSort.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef PARALLELSORT_HPP_
+#define PARALLELSORT_HPP_
+
+#include "config/lvropenmp.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace lvr
+{
+
+/**
+ * @brief	Sorts the given values using all available threads. Equally
+ * 			sized parts of the array are sorted independently and merged
+ * 			pairwise afterwards.
+ *
+ * @param	values	The values to sort
+ */
+template<typename T>
+void parallelSort(std::vector<T> &values)
+{
+	int parts = OpenMPConfig::getNumThreads();
+	if(parts < 2 || values.size() < 100000)
+	{
+		std::sort(values.begin(), values.end());
+		return;
+	}
+
+	// Sort equally sized parts of the array independently
+	std::vector<size_t> bounds(parts + 1);
+	for(int p = 0; p <= parts; p++)
+	{
+		bounds[p] = values.size() * p / parts;
+	}
+
+	#pragma omp parallel for
+	for(int p = 0; p < parts; p++)
+	{
+		std::sort(values.begin() + bounds[p], values.begin() + bounds[p + 1]);
+	}
+
+	// Merge neighboring sorted parts until the whole array is sorted
+	for(int width = 1; width < parts; width *= 2)
+	{
+		#pragma omp parallel for
+		for(int p = 0; p < parts; p += 2 * width)
+		{
+			if(p + width < parts)
+			{
+				std::inplace_merge(
+						values.begin() + bounds[p],
+						values.begin() + bounds[p + width],
+						values.begin() + bounds[std::min(p + 2 * width, parts)]);
+			}
+		}
+	}
+}
+
+} /* namespace lvr */
+
+#endif /* PARALLELSORT_HPP_ */
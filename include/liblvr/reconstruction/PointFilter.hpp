@@ -0,0 +1,128 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * PointFilter.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef POINTFILTER_HPP_
+#define POINTFILTER_HPP_
+
+#include "io/PointBuffer.hpp"
+#include "geometry/Vertex.hpp"
+#include "reconstruction/SearchTree.hpp"
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace lvr
+{
+
+/**
+ * @brief Point cloud filters that work directly on the arrays of a
+ *        \ref PointBuffer. Neighbors are searched with the liblvr search
+ *        trees, so no conversion into other point cloud formats is
+ *        needed. Colors, normals, intensities, confidences and time
+ *        stamps of the remaining points are preserved. All filters are
+ *        parallelized with OpenMP.
+ */
+class PointFilter
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param buffer            The points to filter
+     * @param searchTreeName    Search tree used for the neighbor queries
+     *                          (STANN, FLANN, NANOFLANN or NABO)
+     */
+    PointFilter(PointBufferPtr buffer, string searchTreeName = "STANN");
+
+    virtual ~PointFilter();
+
+    /**
+     * @brief Statistical outlier removal. For every point the mean
+     *        distance to its k nearest neighbors is calculated. Points
+     *        whose mean distance is larger than the mean of all mean
+     *        distances plus thresh times their standard deviation are
+     *        removed.
+     *
+     * @param meank     Number of neighbors
+     * @param thresh    Standard deviation multiplier
+     */
+    void applyOutlierRemoval(int meank, float thresh);
+
+    /**
+     * @brief Removes all points that have less than minNeighbors
+     *        neighbors within the given radius.
+     *
+     * @param radius        Search radius
+     * @param minNeighbors  Minimal number of neighbors within the radius
+     */
+    void applyRadiusOutlierRemoval(float radius, int minNeighbors);
+
+    /**
+     * @brief Replaces the points within each cell of a regular grid by
+     *        their centroid. The attributes of the points are averaged,
+     *        averaged normals are normalized again.
+     *
+     * @param voxelsize     Edge length of the grid cells
+     */
+    void applyVoxelGrid(float voxelsize);
+
+    /**
+     * @brief Returns the filtered points
+     */
+    PointBufferPtr getPointBuffer();
+
+private:
+
+    /**
+     * @brief Creates the search tree for the current points
+     */
+    void createSearchTree();
+
+    /**
+     * @brief Replaces the current buffer by a buffer that contains the
+     *        attributes of the points with the given indices
+     */
+    void select(const vector<size_t> &indices);
+
+    /// Number of points that are searched by one thread at once
+    static const size_t         m_blockSize = 1024;
+
+    /// The current points
+    PointBufferPtr              m_buffer;
+
+    /// Name of the used search tree
+    string                      m_searchTreeName;
+
+    /// Search tree for the current points
+    SearchTree<Vertex<float> >::Ptr m_searchTree;
+};
+
+} /* namespace lvr */
+
+#endif /* POINTFILTER_HPP_ */
@@ -19,7 +19,41 @@ template<typename VertexT, typename BoxT>
 class PointsetGrid: public HashGrid<VertexT, BoxT>
 {
 public:
-	PointsetGrid(float cellSize, typename PointsetSurface<VertexT>::Ptr& surface, BoundingBox<VertexT> bb, bool isVoxelsize = true);
+	/**
+	 * @brief Creates a grid around all points of the given surface.
+	 *
+	 * @param cellSize		Voxel size or number of intersections
+	 * @param surface		The point set surface
+	 * @param bb			Bounding box of the grid
+	 * @param isVoxelsize	Whether to interpret cellSize as voxel size
+	 * @param blocked		Whether to store the boxes in blocked storage
+	 * 						instead of the cell map (see \ref HashGrid)
+	 * @param parallel		Whether to build the grid in parallel. The
+	 * 						resulting grid has the same cells, corners and
+	 * 						neighbors, but the query points are numbered in
+	 * 						lattice order.
+	 */
+	PointsetGrid(
+			float cellSize,
+			typename PointsetSurface<VertexT>::Ptr& surface,
+			BoundingBox<VertexT> bb,
+			bool isVoxelsize = true,
+			bool blocked = false,
+			bool parallel = false);
+
+	/**
+	 * @brief Restores a grid with calculated distance values from a
+	 *        checkpoint that was written by \ref saveCheckpoint.
+	 *
+	 * @param checkpoint	Name of the checkpoint file
+	 * @param surface		The point set surface
+	 * @param blocked		Whether to store the boxes in blocked storage
+	 */
+	PointsetGrid(
+			string checkpoint,
+			typename PointsetSurface<VertexT>::Ptr& surface,
+			bool blocked = false);
+
 	virtual ~PointsetGrid();
 
 	/**
@@ -36,6 +70,28 @@ public:
 
 private:
 
+	/**
+	 * @brief Adds a lattice point to the blocked storage. Cells and
+	 *        query points are looked up by their lattice position in
+	 *        the brick indices instead of the cell map.
+	 */
+	void addLatticePointBlocked(int i, int j, int k, float distance);
+
+	/**
+	 * @brief Builds the grid for all given points in parallel. First the
+	 *        cell keys of all points are calculated and sorted. Then the
+	 *        corner keys of all cells are collected the same way. Boxes,
+	 *        query points and neighbor links are created in bulk from
+	 *        the two sorted key arrays.
+	 *
+	 * @param points		The input points
+	 * @param numPoints		The number of input points
+	 */
+	void createGridParallel(coord3fArr points, size_t numPoints);
+
+	/// Number of query points that are passed to the surface at once
+	static const size_t m_distanceBlockSize = 256;
+
     /**
      * @brief Rounds the given value to the neares integer value
      */
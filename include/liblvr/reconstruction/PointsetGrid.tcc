@@ -6,13 +6,22 @@
  */
 
 #include "PointsetGrid.hpp"
+#include "config/lvropenmp.hpp"
+
+#include <algorithm>
 
 namespace lvr
 {
 
 template<typename VertexT, typename BoxT>
-PointsetGrid<VertexT, BoxT>::PointsetGrid(float cellSize, typename PointsetSurface<VertexT>::Ptr& surface, BoundingBox<VertexT> bb, bool isVoxelsize)
-	: HashGrid<VertexT, BoxT>(cellSize, bb, isVoxelsize), m_surface(surface)
+PointsetGrid<VertexT, BoxT>::PointsetGrid(
+		float cellSize,
+		typename PointsetSurface<VertexT>::Ptr& surface,
+		BoundingBox<VertexT> bb,
+		bool isVoxelsize,
+		bool blocked,
+		bool parallel)
+	: HashGrid<VertexT, BoxT>(cellSize, bb, isVoxelsize, blocked), m_surface(surface)
 {
 	PointBufferPtr buffer = surface->pointBuffer();
 
@@ -27,20 +36,49 @@ PointsetGrid<VertexT, BoxT>::PointsetGrid(float cellSize, typename PointsetSurfa
 
 	cout << timestamp << "Creating Grid..." << endl;
 
-	// Iterator over all points, calc lattice indices and add lattice points to the grid
-	for(size_t i = 0; i < num_points; i++)
+	if(parallel)
+	{
+		createGridParallel(points, num_points);
+	}
+	else
 	{
-		index_x = calcIndex((points[i][0] - v_min[0]) / this->m_voxelsize);
-		index_y = calcIndex((points[i][1] - v_min[1]) / this->m_voxelsize);
-		index_z = calcIndex((points[i][2] - v_min[2]) / this->m_voxelsize);
-		this->addLatticePoint(index_x, index_y, index_z);
+		// Iterator over all points, calc lattice indices and add lattice points to the grid
+		for(size_t i = 0; i < num_points; i++)
+		{
+			index_x = calcIndex((points[i][0] - v_min[0]) / this->m_voxelsize);
+			index_y = calcIndex((points[i][1] - v_min[1]) / this->m_voxelsize);
+			index_z = calcIndex((points[i][2] - v_min[2]) / this->m_voxelsize);
+			this->addLatticePoint(index_x, index_y, index_z);
+		}
 	}
 
+	if(this->m_blocked)
+	{
+		cout << timestamp << "Blocked grid: " << this->m_numBoxes << " cells in "
+			 << this->m_cellIndices.numBricks() << " bricks ("
+			 << (this->m_cellIndices.memoryUsage() + this->m_cornerIndices.memoryUsage()) / (1024 * 1024)
+			 << " MB index memory)" << endl;
+	}
+}
+
+template<typename VertexT, typename BoxT>
+PointsetGrid<VertexT, BoxT>::PointsetGrid(
+		string checkpoint,
+		typename PointsetSurface<VertexT>::Ptr& surface,
+		bool blocked)
+	: HashGrid<VertexT, BoxT>(checkpoint, blocked), m_surface(surface)
+{
 }
 
 template<typename VertexT, typename BoxT>
 void PointsetGrid<VertexT, BoxT>::addLatticePoint(int index_x, int index_y, int index_z, float distance)
 {
+	if(this->m_blocked)
+	{
+		addLatticePointBlocked(index_x, index_y, index_z, distance);
+		return;
+	}
+
 	size_t hash_value;
 
 	unsigned int INVALID = BoxT::INVALID_INDEX;
@@ -145,6 +183,142 @@ void PointsetGrid<VertexT, BoxT>::addLatticePoint(int index_x, int index_y, int
 
 }
 
+template<typename VertexT, typename BoxT>
+void PointsetGrid<VertexT, BoxT>::addLatticePointBlocked(int index_x, int index_y, int index_z, float distance)
+{
+	unsigned int INVALID = BrickIndex::INVALID;
+	BrickIndex::Cursor cellCursor, cornerCursor;
+
+	float vsh = 0.5 * this->m_voxelsize;
+
+	// Get min vertex of the point clouds bounding box
+	VertexT v_min = this->m_boundingBox.getMin();
+
+	int e;
+	this->m_extrude ? e = 8 : e = 1;
+	for(int j = 0; j < e; j++)
+	{
+		// Get the grid position of the cell for the given box corner
+		int x = index_x + HGCreateTable[j][0];
+		int y = index_y + HGCreateTable[j][1];
+		int z = index_z + HGCreateTable[j][2];
+
+		if(this->m_cellIndices.get(x, y, z, cellCursor) != INVALID)
+		{
+			continue;
+		}
+
+		//Calculate box center
+		VertexT box_center(
+				x * this->m_voxelsize + v_min[0],
+				y * this->m_voxelsize + v_min[1],
+				z * this->m_voxelsize + v_min[2]);
+
+		//Create new box
+		unsigned int box_index = this->createBlockedBox(box_center);
+		BoxT* box = this->getBlockedBox(box_index);
+		this->m_cellIndices.set(x, y, z, box_index);
+
+		//Setup the box itself. The corners are shared via their
+		//lattice position, i.e. the cell position shifted by one
+		//in every positive direction of the corner.
+		for(int k = 0; k < 8; k++)
+		{
+			int cx = x + (box_creation_table[k][0] > 0 ? 1 : 0);
+			int cy = y + (box_creation_table[k][1] > 0 ? 1 : 0);
+			int cz = z + (box_creation_table[k][2] > 0 ? 1 : 0);
+
+			unsigned int current_index = this->m_cornerIndices.get(cx, cy, cz, cornerCursor);
+			if(current_index != INVALID)
+			{
+				box->setVertex(k, current_index);
+			}
+			else
+			{
+				VertexT position(box_center[0] + box_creation_table[k][0] * vsh,
+						box_center[1] + box_creation_table[k][1] * vsh,
+						box_center[2] + box_creation_table[k][2] * vsh);
+
+				this->m_queryPoints.push_back(QueryPoint<VertexT>(position, distance));
+				box->setVertex(k, this->m_globalIndex);
+				this->m_cornerIndices.set(cx, cy, cz, this->m_globalIndex);
+				this->m_globalIndex++;
+			}
+		}
+
+		//Set pointers to the neighbors of the current box
+		int neighbor_index = 0;
+		for(int a = -1; a < 2; a++)
+		{
+			for(int b = -1; b < 2; b++)
+			{
+				for(int c = -1; c < 2; c++)
+				{
+					unsigned int n = this->m_cellIndices.get(x + a, y + b, z + c, cellCursor);
+					if(n != INVALID && n != box_index)
+					{
+						BoxT* neighbor = this->getBlockedBox(n);
+						box->setNeighbor(neighbor_index, neighbor);
+						neighbor->setNeighbor(26 - neighbor_index, box);
+					}
+					neighbor_index++;
+				}
+			}
+		}
+	}
+}
+
+template<typename VertexT, typename BoxT>
+void PointsetGrid<VertexT, BoxT>::createGridParallel(coord3fArr points, size_t numPoints)
+{
+	VertexT v_min = this->m_boundingBox.getMin();
+
+	int e;
+	this->m_extrude ? e = 8 : e = 1;
+
+	// Calculate the keys of the cells that contain the points
+	vector<uint64_t> cellKeys(numPoints);
+	#pragma omp parallel for
+	for(long i = 0; i < (long)numPoints; i++)
+	{
+		int x = calcIndex((points[i][0] - v_min[0]) / this->m_voxelsize);
+		int y = calcIndex((points[i][1] - v_min[1]) / this->m_voxelsize);
+		int z = calcIndex((points[i][2] - v_min[2]) / this->m_voxelsize);
+		cellKeys[i] = this->latticeKey(x, y, z);
+	}
+	parallelSort(cellKeys);
+	cellKeys.erase(std::unique(cellKeys.begin(), cellKeys.end()), cellKeys.end());
+
+	// Extrude the unique cells
+	if(e > 1)
+	{
+		// Release the memory of the point keys before expanding
+		vector<uint64_t>(cellKeys).swap(cellKeys);
+
+		size_t numBaseCells = cellKeys.size();
+		vector<uint64_t> extruded(numBaseCells * e);
+		#pragma omp parallel for
+		for(long i = 0; i < (long)numBaseCells; i++)
+		{
+			int x, y, z;
+			this->latticePosition(cellKeys[i], x, y, z);
+			for(int j = 0; j < e; j++)
+			{
+				extruded[i * e + j] = this->latticeKey(x + HGCreateTable[j][0], y + HGCreateTable[j][1], z + HGCreateTable[j][2]);
+			}
+		}
+		vector<uint64_t>().swap(cellKeys);
+		parallelSort(extruded);
+		extruded.erase(std::unique(extruded.begin(), extruded.end()), extruded.end());
+		cellKeys.swap(extruded);
+	}
+
+	// Create the boxes and query points for the sorted cell keys
+	vector<uint64_t> cornerKeys;
+	this->collectCorners(cellKeys, cornerKeys);
+	this->createCells(cellKeys, cornerKeys);
+}
+
 template<typename VertexT, typename BoxT>
 void PointsetGrid<VertexT, BoxT>::calcDistanceValues()
 {
@@ -154,21 +328,44 @@ void PointsetGrid<VertexT, BoxT>::calcDistanceValues()
 
 	Timestamp ts;
 
-	// Calculate a distance value for each query point
-	#pragma omp parallel for
-	for( int i = 0; i < (int)this->m_queryPoints.size(); i++){
-		float projectedDistance;
-		float euklideanDistance;
-
-		//cout << euklideanDistance << " " << projectedDistance << endl;
+	// Calculate the distance values in blocks of neighboring query
+	// points. Query points are created cell by cell, so the points of
+	// a block are close to each other and share most of their search
+	// tree nodes.
+	int numBlocks = (this->m_queryPoints.size() + m_distanceBlockSize - 1) / m_distanceBlockSize;
 
-		this->m_surface->distance(this->m_queryPoints[i].m_position, projectedDistance, euklideanDistance);
-		if (euklideanDistance > 1.7320 * this->m_voxelsize)
+	#pragma omp parallel
+	{
+		// Per thread buffers for the block data
+		vector<VertexT> positions(m_distanceBlockSize);
+		vector<float> projectedDistances(m_distanceBlockSize);
+		vector<float> euklideanDistances(m_distanceBlockSize);
+		typename PointsetSurface<VertexT>::DistanceBuffers buffers;
+
+		#pragma omp for schedule(dynamic)
+		for(int b = 0; b < numBlocks; b++)
 		{
-			this->m_queryPoints[i].m_invalid = true;
+			size_t first = b * m_distanceBlockSize;
+			size_t n = std::min((size_t)m_distanceBlockSize, this->m_queryPoints.size() - first);
+
+			for(size_t i = 0; i < n; i++)
+			{
+				positions[i] = this->m_queryPoints[first + i].m_position;
+			}
+
+			this->m_surface->distances(&positions[0], n, &projectedDistances[0], &euklideanDistances[0], buffers);
+
+			for(size_t i = 0; i < n; i++)
+			{
+				QueryPoint<VertexT>& qp = this->m_queryPoints[first + i];
+				if (euklideanDistances[i] > 1.7320 * this->m_voxelsize)
+				{
+					qp.m_invalid = true;
+				}
+				qp.m_distance = projectedDistances[i];
+			}
+			progress += n;
 		}
-		this->m_queryPoints[i].m_distance = projectedDistance;
-		++progress;
 	}
 	cout << endl;
 	cout << timestamp << "Elapsed time: " << ts << endl;
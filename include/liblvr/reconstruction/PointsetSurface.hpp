@@ -60,6 +60,43 @@ public:
             float &projectedDistance,
             float &euklideanDistance) = 0;
 
+    /**
+     * @brief   Temporary buffers for \ref distances. Every thread that
+     *          calculates distances should own one instance and pass it
+     *          to all of its calls, so the buffers are only allocated once.
+     */
+    struct DistanceBuffers
+    {
+        /// Coordinates of the grid points of a block
+        vector<float>   queries;
+
+        /// Indices of the nearest neighbors
+        vector<ulong>   indices;
+
+        /// Squared distances of the nearest neighbors
+        vector<float>   distances;
+
+        /// Number of found neighbors per grid point
+        vector<int>     found;
+    };
+
+    /**
+     * @brief   Calculates the distances of a block of grid points. The
+     *          default implementation calls \ref distance for every point.
+     *          Subclasses can override it to use the given buffers for
+     *          their search results.
+     *
+     * @param   v                     Array of n grid points
+     * @param   n                     Number of grid points
+     * @param   projectedDistances    Array of n projected distances
+     * @param   euklideanDistances    Array of n euklidean distances
+     * @param   buffers               Temporary buffers of the calling thread
+     */
+    virtual void distances(const VertexT* v, size_t n,
+            float* projectedDistances,
+            float* euklideanDistances,
+            DistanceBuffers &buffers);
+
     /**
      * @brief   Calculates surface normals for each data point in the given
      *          PointBuffeer. If the buffer alreay contains normal information
@@ -48,6 +48,18 @@ void PointsetSurface<VertexT>::expandBoundingBox(
     this->m_boundingBox.expand(xmax, ymax, zmax);
 }
 
+template<typename VertexT>
+void PointsetSurface<VertexT>::distances(const VertexT* v, size_t n,
+        float* projectedDistances,
+        float* euklideanDistances,
+        DistanceBuffers &buffers)
+{
+    for(size_t i = 0; i < n; i++)
+    {
+        distance(v[i], projectedDistances[i], euklideanDistances[i]);
+    }
+}
+
 template<typename VertexT>
 VertexT PointsetSurface<VertexT>::getInterpolatedNormal(VertexT position)
 {
@@ -37,6 +37,7 @@
 // Standard C++ includes
 #include <vector>
 #include <iostream>
+#include <algorithm>
 
 using std::cout;
 using std::endl;
@@ -92,6 +93,34 @@ public:
     virtual void kSearch( coord < float >&       qp, int k, vector< ulong > &indices, vector< double > &distances ) = 0;
     virtual void kSearch( VertexT      qp, int k, vector< VertexT > &neighbors ) = 0;
 
+    /**
+     * @brief This function performs a k-next-neighbour search that writes
+     *        its results into buffers owned by the caller. Backends that
+     *        support it natively do not allocate any memory.
+     *
+     * @param qp          The query point.
+     * @param k           The number of neighbours that should be searched.
+     * @param indices     A buffer for at least k neighbour indices.
+     * @param distances   A buffer for at least k squared neighbour distances.
+     * @return            The number of neighbours that were found.
+     */
+    virtual int kSearch( const float qp[3], int k, ulong* indices, float* distances );
+
+    /**
+     * @brief Performs a k-next-neighbour search for n query points. The
+     *        results of query point i are stored at position i * k of
+     *        the buffers.
+     *
+     * @param qp          The n query points as x, y, z triples.
+     * @param n           The number of query points.
+     * @param k           The number of neighbours that should be searched.
+     * @param indices     A buffer for n * k neighbour indices.
+     * @param distances   A buffer for n * k squared neighbour distances.
+     * @param found       A buffer for the number of neighbours found for
+     *                    each query point.
+     */
+    virtual void kSearchBatch( const float* qp, size_t n, int k, ulong* indices, float* distances, int* found );
+
 
 
     virtual void radiusSearch( float              qp[3], double r, vector< ulong > &indices ) = 0;
@@ -65,6 +65,42 @@ void SearchTree< VertexT >::kSearch( const coord< float > &qp, int neighbours, v
 }
 
 
+/*
+   Begin of kSearch implementations with caller owned buffers
+ */
+template<typename VertexT>
+int SearchTree< VertexT >::kSearch( const float qp[3], int neighbours, ulong* indices, float* distances )
+{
+    // Generic fallback for backends that can only fill vectors
+    coord< float > Point;
+    Point[0] = qp[0];
+    Point[1] = qp[1];
+    Point[2] = qp[2];
+
+    vector< ulong > id;
+    vector< double > di;
+    this->kSearch( Point, neighbours, id, di );
+
+    int found = std::min( neighbours, (int)id.size() );
+    for( int i = 0; i < found; i++ )
+    {
+        indices[i] = id[i];
+        distances[i] = i < (int)di.size() ? di[i] : 0.0f;
+    }
+    return found;
+}
+
+
+template<typename VertexT>
+void SearchTree< VertexT >::kSearchBatch( const float* qp, size_t n, int neighbours, ulong* indices, float* distances, int* found )
+{
+    for( size_t i = 0; i < n; i++ )
+    {
+        found[i] = this->kSearch( qp + 3 * i, neighbours, indices + i * neighbours, distances + i * neighbours );
+    }
+}
+
+
 /*
    Begin of kSearch implementations with distances
  */
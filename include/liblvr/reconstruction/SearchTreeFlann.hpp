@@ -29,6 +29,9 @@
 // C++ Stl includes
 #include <vector>
 
+// Boost includes
+#include <boost/shared_ptr.hpp>
+
 // PCL includes
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
@@ -36,6 +39,9 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/normal_3d_omp.h>
 
+// FLANN includes
+#include <flann/flann.hpp>
+
 // Superclass
 #include "SearchTree.hpp"
 
@@ -93,6 +99,33 @@ public:
 
     virtual void kSearch( VertexT qp, int k, vector< VertexT > &neighbors );
 
+    /**
+     * @brief Performs a k-next-neighbor search that writes directly into
+     *        the given buffers without allocating memory.
+     *
+     * @param qp          The query point.
+     * @param k           The number of neighbours that should be searched.
+     * @param indices     A buffer for at least k neighbour indices.
+     * @param distances   A buffer for at least k squared neighbour distances.
+     * @return            The number of neighbours that were found.
+     */
+    virtual int kSearch( const float qp[3], int k, ulong* indices, float* distances );
+
+    /**
+     * @brief Performs a k-next-neighbour search for n query points with a
+     *        single FLANN query without allocating memory. The results of
+     *        query point i are stored at position i * k of the buffers.
+     *
+     * @param qp          The n query points as x, y, z triples.
+     * @param n           The number of query points.
+     * @param k           The number of neighbours that should be searched.
+     * @param indices     A buffer for n * k neighbour indices.
+     * @param distances   A buffer for n * k squared neighbour distances.
+     * @param found       A buffer for the number of neighbours found for
+     *                    each query point.
+     */
+    virtual void kSearchBatch( const float* qp, size_t n, int k, ulong* indices, float* distances, int* found );
+
     virtual void radiusSearch( float              qp[3], double r, vector< ulong > &indices );
     virtual void radiusSearch( VertexT&              qp, double r, vector< ulong > &indices );
     virtual void radiusSearch( const VertexT&        qp, double r, vector< ulong > &indices );
@@ -101,9 +134,19 @@ public:
 
 protected:
 
-    /// Store the pcl kd-tree
+    /// The points and colors in pcl format
     pcl::PointCloud< pcl::PointXYZRGB >::Ptr       m_pointCloud;
-    pcl::KdTreeFLANN< pcl::PointXYZRGB >::Ptr      m_kdTree;
+
+    /// The packed point coordinates the FLANN index is built on
+    vector< float >                                m_points;
+
+    /// The FLANN kd-tree. It is used directly instead of through
+    /// pcl::KdTreeFLANN, because only FLANN itself can search into
+    /// caller owned buffers and answer many query points at once.
+    boost::shared_ptr< flann::Index< flann::L2_Simple< float > > > m_index;
+
+    /// Search parameters of the FLANN index
+    flann::SearchParams                            m_searchParams;
 
 }; // SearchTreePCL
 
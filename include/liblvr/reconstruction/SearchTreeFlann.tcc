@@ -26,12 +26,14 @@
 
 // stl includes
 #include <limits>
+#include <algorithm>
 
 // External libraries in lvr source tree
 #include <Eigen/Dense>
 
 // boost libraries
 #include <boost/filesystem.hpp>
+#include <boost/static_assert.hpp>
 
 // lvr includes
 
@@ -41,7 +43,6 @@ using std::numeric_limits;
 
 using pcl::PointCloud;
 using pcl::PointXYZ;
-using pcl::KdTreeFLANN;
 
 namespace lvr {
 
@@ -93,10 +94,24 @@ SearchTreeFlann< VertexT >::SearchTreeFlann( PointBufferPtr buffer, size_t &n_po
     m_pointCloud->width  = n_points;
     m_pointCloud->height = 1;
 
-    // initialize kd-Tree
-    cout << timestamp << "Initialising PCL<Flann> Kd-Tree" << endl;
-    m_kdTree = KdTreeFLANN< pcl::PointXYZRGB >::Ptr( new KdTreeFLANN< pcl::PointXYZRGB > );
-    m_kdTree->setInputCloud(m_pointCloud);
+    // initialize kd-Tree with the parameters pcl::KdTreeFLANN uses, i.e.,
+    // a single exact kd-tree with sorted results
+    cout << timestamp << "Initialising Flann Kd-Tree" << endl;
+    m_points.resize( 3 * n_points );
+    for( size_t i = 0; i < n_points; ++i )
+    {
+        m_points[3 * i]     = points[i].x;
+        m_points[3 * i + 1] = points[i].y;
+        m_points[3 * i + 2] = points[i].z;
+    }
+    if( n_points )
+    {
+        flann::Matrix< float > dataset( &m_points[0], n_points, 3 );
+        m_index = boost::shared_ptr< flann::Index< flann::L2_Simple< float > > >(
+                new flann::Index< flann::L2_Simple< float > >( dataset, flann::KDTreeSingleIndexParams( 15 ) ) );
+        m_index->buildIndex();
+    }
+    m_searchParams = flann::SearchParams( -1, 0.0f, true );
 }
 
 
@@ -108,25 +123,49 @@ SearchTreeFlann< VertexT >::~SearchTreeFlann() {
 template<typename VertexT>
 void SearchTreeFlann< VertexT >::kSearch( coord< float > &qp, int neighbours, vector< ulong > &indices, vector< double > &distances )
 {
-    // get pcl compatible point.
-    pcl::PointXYZRGB pcl_qp;
-    pcl_qp.x = qp[0];
-    pcl_qp.y = qp[1];
-    pcl_qp.z = qp[2];
-
-    // get pcl-compatible indice and distance vectors
-    vector< int > ind;
-    vector< float > dist;
+    float q[3] = { qp[0], qp[1], qp[2] };
+    vector< float > dist( std::max( neighbours, 0 ) );
+    indices.resize( dist.size() );
 
-    // perform the search
-    m_kdTree->nearestKSearch( pcl_qp, neighbours, ind, dist );
+    int found = dist.empty() ? 0 : this->kSearch( q, neighbours, &indices[0], &dist[0] );
 
     // copy information to interface conform vector types
-    indices.clear();
-    distances.clear();
-    indices.insert( indices.begin(), ind.begin(), ind.end() );
-    distances.insert( distances.begin(), dist.begin(), dist.end() );
+    indices.resize( found );
+    distances.assign( dist.begin(), dist.begin() + found );
+}
+
+
+template<typename VertexT>
+int SearchTreeFlann< VertexT >::kSearch( const float qp[3], int neighbours, ulong* indices, float* distances )
+{
+    int found = 0;
+    this->kSearchBatch( qp, 1, neighbours, indices, distances, &found );
+    return found;
+}
+
+
+template<typename VertexT>
+void SearchTreeFlann< VertexT >::kSearchBatch( const float* qp, size_t n, int neighbours, ulong* indices, float* distances, int* found )
+{
+    // The index is exact, so it finds k neighbours unless there are
+    // fewer points
+    int k = std::min( neighbours, (int) m_points.size() / 3 );
+    for( size_t i = 0; i < n; i++ )
+    {
+        found[i] = std::max( k, 0 );
+    }
+    if( k <= 0 || n == 0 )
+    {
+        return;
+    }
 
+    // Wrap the caller's buffers. Rows are neighbours apart, so that the
+    // results are stored at position i * neighbours.
+    BOOST_STATIC_ASSERT( sizeof( ulong ) == sizeof( size_t ) );
+    flann::Matrix< float > query( const_cast< float* >( qp ), n, 3 );
+    flann::Matrix< size_t > ind( reinterpret_cast< size_t* >( indices ), n, k, neighbours * sizeof( size_t ) );
+    flann::Matrix< float > dist( distances, n, k, neighbours * sizeof( float ) );
+    m_index->knnSearch( query, ind, dist, k, m_searchParams );
 }
 
 template<typename VertexT>
@@ -85,6 +85,21 @@ public:
      */
     virtual void kSearch( coord < float >& qp, int neighbours, vector< ulong > &indices, vector< double > &distances );
 
+    /**
+     * @brief Performs a k-next-neighbour search for n query points with a
+     *        single call of the Nabo search. The results of query point
+     *        i are stored at position i * k of the buffers.
+     *
+     * @param qp          The n query points as x, y, z triples.
+     * @param n           The number of query points.
+     * @param k           The number of neighbours that should be searched.
+     * @param indices     A buffer for n * k neighbour indices.
+     * @param distances   A buffer for n * k squared neighbour distances.
+     * @param found       A buffer for the number of neighbours found for
+     *                    each query point.
+     */
+    virtual void kSearchBatch( const float* qp, size_t n, int k, ulong* indices, float* distances, int* found );
+
     virtual void radiusSearch( float              qp[3], double r, vector< ulong > &indices );
     virtual void radiusSearch( VertexT&              qp, double r, vector< ulong > &indices );
     virtual void radiusSearch( const VertexT&        qp, double r, vector< ulong > &indices );
@@ -108,6 +108,37 @@ void SearchTreeNabo< VertexT >::kSearch( coord< float > &qp, int neighbours, vec
 }
 
 
+template<typename VertexT>
+void SearchTreeNabo< VertexT >::kSearchBatch( const float* qp, size_t n, int k, ulong* indices, float* distances, int* found )
+{
+    // Nabo expects one query point per column
+    Eigen::Map<const Eigen::MatrixXf> query( qp, 3, n );
+
+    Eigen::MatrixXi ind( k, n );
+    Eigen::MatrixXf dist( k, n );
+
+    enum Nabo::NearestNeighbourSearch<float>::SearchOptionFlags opType = Nabo::NearestNeighbourSearch<float>::SORT_RESULTS;
+    m_pointTree->knn( query, ind, dist, k, 0, opType );
+
+    // Copy the valid results of each query point
+    for( size_t i = 0; i < n; i++ )
+    {
+        int valid = 0;
+        for( int j = 0; j < k; j++ )
+        {
+            float d = dist( j, i );
+            if( !isinf( d ) && !isnan( d ) )
+            {
+                indices[i * k + valid] = ind( j, i );
+                distances[i * k + valid] = d;
+                valid++;
+            }
+        }
+        found[i] = valid;
+    }
+}
+
+
 /*
    Begin of radiusSearch implementations
  */
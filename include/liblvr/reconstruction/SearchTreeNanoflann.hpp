@@ -77,6 +77,18 @@ public:
 
     virtual void kSearch(VertexT qp, int k, vector< VertexT > &neighbors);
 
+    /**
+     * @brief Performs a k-next-neighbor search that writes directly into
+     *        the given buffers without allocating memory.
+     *
+     * @param qp          The query point.
+     * @param k           The number of neighbours that should be searched.
+     * @param indices     A buffer for at least k neighbour indices.
+     * @param distances   A buffer for at least k squared neighbour distances.
+     * @return            The number of neighbours that were found.
+     */
+    virtual int kSearch( const float qp[3], int k, ulong* indices, float* distances );
+
 
     virtual void radiusSearch( float              qp[3], double r, vector< ulong > &indices );
     virtual void radiusSearch( VertexT&              qp, double r, vector< ulong > &indices );
@@ -63,6 +63,15 @@ void SearchTreeNanoflann<VertexT>::kSearch(
         distances.push_back(dist[i]);
     }
 }
+template<typename VertexT>
+int SearchTreeNanoflann<VertexT>::kSearch( const float qp[3], int k, ulong* indices, float* distances )
+{
+    nanoflann::KNNResultSet<float, ulong> resultSet(k);
+    resultSet.init(indices, distances);
+    m_tree->findNeighbors(resultSet, qp, nanoflann::SearchParams());
+    return resultSet.size();
+}
+
 template<typename VertexT>
 void SearchTreeNanoflann<VertexT>::kSearch(VertexT qp, int k, vector< VertexT > &nb)
 {
@@ -82,6 +82,39 @@ void SearchTreeStann< VertexT >::kSearch( coord< float > &qp, int neighbours, ve
     m_pointTree.ksearch( qp, neighbours, indices, distances, 0);
 }
 
+template<typename VertexT>
+int SearchTreeStann< VertexT >::kSearch( const float qp[3], int neighbours, ulong* indices, float* distances )
+{
+    if( neighbours <= 0 )
+    {
+        return 0;
+    }
+
+    coord< float > Point;
+    Point[0] = qp[0];
+    Point[1] = qp[1];
+    Point[2] = qp[2];
+    return m_pointTree.ksearch( Point, neighbours, indices, distances, 0 );
+}
+
+
+template<typename VertexT>
+void SearchTreeStann< VertexT >::kSearchBatch( const float* qp, size_t n, int neighbours, ulong* indices, float* distances, int* found )
+{
+    coord< float > Point;
+    for( size_t i = 0; i < n; i++ )
+    {
+        found[i] = 0;
+        if( neighbours > 0 )
+        {
+            Point[0] = qp[3 * i];
+            Point[1] = qp[3 * i + 1];
+            Point[2] = qp[3 * i + 2];
+            found[i] = m_pointTree.ksearch( Point, neighbours, indices + i * neighbours, distances + i * neighbours, 0 );
+        }
+    }
+}
+
 	template<typename VertexT>
 void SearchTreeStann< VertexT >::kSearch(VertexT qp, int k, vector< VertexT > &neighbors)
 {
@@ -60,6 +60,15 @@ public:
             vector<QueryPoint<VertexT> > &query_points,
             uint &globalIndex);
 
+    /**
+     * @brief Calculates the local approximation of the box w.r.t. to
+     *        sharp features without modifying the mesh. See
+     *        FastBox::getLocalSurface.
+     */
+    virtual void getLocalSurface(
+            SurfaceBuffer<VertexT> &buffer,
+            vector<QueryPoint<VertexT> > &query_points);
+
     // Threshold angle for sharp feature detection
     static float m_theta_sharp;
 
@@ -93,6 +102,16 @@ private:
 
     void detectSharpFeatures(VertexT vertex_positions[], NormalT vertex_normals[], uint index);
 
+    /**
+     * @brief Calculates the position of the additional vertex that is
+     *        inserted for extended marching cubes
+     *
+     * @param vertex_positions  The edge intersections of the box
+     * @param vertex_normals    The normals of the edge intersections
+     * @param index             The marching cubes index of the box
+     */
+    VertexT getSharpVertex(VertexT vertex_positions[], NormalT vertex_normals[], uint index);
+
 
     typedef SharpBox<VertexT, NormalT> BoxType;
 };
@@ -140,6 +140,77 @@ void SharpBox<VertexT, NormalT>::detectSharpFeatures(VertexT vertex_positions[],
 }
 
 
+template<typename VertexT, typename NormalT>
+VertexT SharpBox<VertexT, NormalT>::getSharpVertex(VertexT vertex_positions[], NormalT vertex_normals[], uint index)
+{
+	//calculate intersection for the new vertex position
+	VertexT v = this->m_center;
+	if (m_containsSharpCorner)
+	{
+		//First plane
+		VertexT v1 = vertex_positions[ExtendedMCTable[index][0]];
+		NormalT n1 = vertex_normals[ExtendedMCTable[index][0]];
+
+		//Second plane
+		VertexT v2 = vertex_positions[ExtendedMCTable[index][1]];
+		NormalT n2 = vertex_normals[ExtendedMCTable[index][1]];
+
+		//Third plane
+		VertexT v3 = vertex_positions[ExtendedMCTable[index][3]];
+		NormalT n3 = vertex_normals[ExtendedMCTable[index][3]];
+
+		//calculate intersection between plane 1 and 2
+		if (fabs(n1 * n2) < 0.9)
+		{
+			float d1 = n1 * v1;
+			float d2 = n2 * v2;
+
+			VertexT direction = n1.cross(n2);
+
+			float denom = direction * direction;
+			VertexT x = ((n2 * d1 - n1 * d2).cross(direction)) * (1 / denom);
+
+			//calculate intersection between plane 3 and the intersection line between plane 1 and 2
+			float denom2 = n3 * direction;
+			if(fabs(denom2) > 0.0001)
+			{
+				float d = n3 * v3;
+				float t = (d - n3 * x) / (denom2);
+
+				VertexT intersection = x + direction * t;
+
+				v = intersection;
+			}
+		}
+	}
+	else
+	{
+		//First plane
+		VertexT v1 = (vertex_positions[ExtendedMCTable[index][2]] + vertex_positions[ExtendedMCTable[index][3]]) * 0.5;
+		NormalT n1 = (vertex_normals[ExtendedMCTable[index][2]] + vertex_normals[ExtendedMCTable[index][3]]) * 0.5;
+		//Second plane
+		VertexT v2 = (vertex_positions[ExtendedMCTable[index][6]] + vertex_positions[ExtendedMCTable[index][7]]) * 0.5;
+		NormalT n2 = (vertex_normals[ExtendedMCTable[index][6]] + vertex_normals[ExtendedMCTable[index][7]]) * 0.5;
+
+		//calculate intersection between plane 1 and 2
+		if (fabs(n1 * n2) < 0.9)
+		{
+			float d1 = n1 * v1;
+			float d2 = n2 * v2;
+
+			VertexT direction = n1.cross(n2);
+
+			float denom = direction * direction;
+			VertexT x = ((n2 * d1 - n1 * d2).cross(direction)) * (1 / denom);
+
+			// project center of the box onto intersection line of the two planes
+			v = x + direction * (((v - x) * direction) / (direction.length() * direction.length()));
+		}
+
+	}
+	return v;
+}
+
 template<typename VertexT, typename NormalT>
 void SharpBox<VertexT, NormalT>::getSurface(
         BaseMesh<VertexT, NormalT> &mesh,
@@ -221,82 +292,92 @@ void SharpBox<VertexT, NormalT>::getSurface(
 		// save for edge flipping
 		m_extendedMCIndex = index;
 		//calculate intersection for the new vertex position
-		VertexT v = this->m_center;
-		if (m_containsSharpCorner)
-		{
-			//First plane
-			VertexT v1 = vertex_positions[ExtendedMCTable[index][0]];
-			NormalT n1 = vertex_normals[ExtendedMCTable[index][0]];
+		VertexT v = getSharpVertex(vertex_positions, vertex_normals, index);
 
-			//Second plane
-			VertexT v2 = vertex_positions[ExtendedMCTable[index][1]];
-			NormalT n2 = vertex_normals[ExtendedMCTable[index][1]];
+		mesh.addVertex(v);
+		mesh.addNormal(NormalT());
+		uint index_center = globalIndex++;
+		// Add triangle actually does the normal interpolation for us.
+		for(int a = 0; ExtendedMCTable[index][a] != -1; a+= 2)
+		{
+			mesh.addTriangle(this->m_intersections[ExtendedMCTable[index][a]], index_center, this->m_intersections[ExtendedMCTable[index][a+1]]);
+		}
 
-			//Third plane
-			VertexT v3 = vertex_positions[ExtendedMCTable[index][3]];
-			NormalT n3 = vertex_normals[ExtendedMCTable[index][3]];
+	}
+}
 
-			//calculate intersection between plane 1 and 2
-			if (fabs(n1 * n2) < 0.9)
-			{
-				float d1 = n1 * v1;
-				float d2 = n2 * v2;
 
-				VertexT direction = n1.cross(n2);
+template<typename VertexT, typename NormalT>
+void SharpBox<VertexT, NormalT>::getLocalSurface(
+        SurfaceBuffer<VertexT> &buffer,
+        vector<QueryPoint<VertexT> > &query_points)
+{
+	VertexT corners[8];
+	VertexT vertex_positions[12];
+	NormalT vertex_normals[12];
 
-				float denom = direction * direction;
-				VertexT x = ((n2 * d1 - n1 * d2).cross(direction)) * (1 / denom);
+	float distances[8];
 
-				//calculate intersection between plane 3 and the intersection line between plane 1 and 2
-				float denom2 = n3 * direction;
-				if(fabs(denom2) > 0.0001)
-				{
-					float d = n3 * v3;
-					float t = (d - n3 * x) / (denom2);
+	this->getCorners(corners, query_points);
+	this->getDistances(distances, query_points);
+	this->getIntersections(corners, distances, vertex_positions);
 
-					VertexT intersection = x + direction * t;
+	int index = this->getIndex(query_points);
 
-					v = intersection;
-				}
-			}
-		}
-		else
+	// Do not create traingles for invalid boxes
+	for (int i = 0; i < 8; i++)
+	{
+		if (query_points[this->m_vertices[i]].m_invalid)
 		{
-			//First plane
-			VertexT v1 = (vertex_positions[ExtendedMCTable[index][2]] + vertex_positions[ExtendedMCTable[index][3]]) * 0.5;
-			NormalT n1 = (vertex_normals[ExtendedMCTable[index][2]] + vertex_normals[ExtendedMCTable[index][3]]) * 0.5;
-			//Second plane
-			VertexT v2 = (vertex_positions[ExtendedMCTable[index][6]] + vertex_positions[ExtendedMCTable[index][7]]) * 0.5;
-			NormalT n2 = (vertex_normals[ExtendedMCTable[index][6]] + vertex_normals[ExtendedMCTable[index][7]]) * 0.5;
-
-			//calculate intersection between plane 1 and 2
-			if (fabs(n1 * n2) < 0.9)
-			{
-				float d1 = n1 * v1;
-				float d2 = n2 * v2;
+			return;
+		}
+	}
 
-				VertexT direction = n1.cross(n2);
+	// Check for presence of sharp features in the box
+	this->detectSharpFeatures(vertex_positions, vertex_normals, index);
 
-				float denom = direction * direction;
-				VertexT x = ((n2 * d1 - n1 * d2).cross(direction)) * (1 / denom);
+	int local_indices[12];
+	for(int i = 0; i < 12; i++)
+	{
+		local_indices[i] = -1;
+	}
 
-				// project center of the box onto intersection line of the two planes
-				v = x + direction * (((v - x) * direction) / (direction.length() * direction.length()));
+	// Create the edge intersections in the same order as getSurface()
+	int edge_index;
+	for(int a = 0; MCTable[index][a] != -1; a+= 3)
+	{
+		for(int b = 0; b < 3; b++)
+		{
+			edge_index = MCTable[index][a + b];
+			if(local_indices[edge_index] == -1)
+			{
+				local_indices[edge_index] = buffer.addVertex(vertex_positions[edge_index], edge_index);
 			}
-
 		}
+		if (!m_containsSharpFeature) // No sharp features present -> use standard marching cubes
+		{
+			buffer.addTriangle(
+					local_indices[MCTable[index][a]],
+					local_indices[MCTable[index][a + 1]],
+					local_indices[MCTable[index][a + 2]]);
+		}
+	}
+
+	// Sharp feature detected -> use extended marching cubes
+	if (m_containsSharpFeature)
+	{
+		// save for edge flipping
+		m_extendedMCIndex = index;
+		uint index_center = buffer.addVertex(getSharpVertex(vertex_positions, vertex_normals, index), -1);
 
-		mesh.addVertex(v);
-		mesh.addNormal(NormalT());
-		uint index_center = globalIndex++;
-		// Add triangle actually does the normal interpolation for us.
 		for(int a = 0; ExtendedMCTable[index][a] != -1; a+= 2)
 		{
-			mesh.addTriangle(this->m_intersections[ExtendedMCTable[index][a]], index_center, this->m_intersections[ExtendedMCTable[index][a+1]]);
+			buffer.addTriangle(
+					local_indices[ExtendedMCTable[index][a]],
+					index_center,
+					local_indices[ExtendedMCTable[index][a + 1]]);
 		}
-
 	}
 }
 
-
 } /* namespace lvr */
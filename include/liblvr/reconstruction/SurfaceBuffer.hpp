@@ -0,0 +1,140 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * SurfaceBuffer.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef SURFACEBUFFER_HPP_
+#define SURFACEBUFFER_HPP_
+
+#include <vector>
+#include <cstddef>
+
+using std::vector;
+
+namespace lvr
+{
+
+/**
+ * @brief A buffer for the local surface approximations of a sequence of
+ *        grid cells. It is used to compute marching cubes triangles in
+ *        parallel without touching the shared mesh. Vertices and faces
+ *        are stored per cell with cell local indices. Vertices that lie
+ *        on one of the twelve cell edges remember the edge number, so
+ *        that intersections shared with neighbor cells can be resolved
+ *        when the buffer is inserted into the mesh.
+ */
+template<typename VertexT>
+class SurfaceBuffer
+{
+public:
+
+    /**
+     * @brief Removes all stored cells. Allocated memory is kept to be
+     *        reused for the next chunk of cells.
+     */
+    void clear()
+    {
+        m_vertices.clear();
+        m_edges.clear();
+        m_faces.clear();
+        m_vertexOffsets.clear();
+        m_faceOffsets.clear();
+    }
+
+    /**
+     * @brief Starts the record for the next cell. Has to be called once
+     *        for every processed cell, even if it creates no triangles.
+     */
+    void beginBox()
+    {
+        m_vertexOffsets.push_back(m_vertices.size());
+        m_faceOffsets.push_back(m_faces.size());
+    }
+
+    /**
+     * @brief Adds a vertex to the current cell.
+     *
+     * @param v         The vertex position
+     * @param edge      The cell edge the vertex lies on or -1 if the
+     *                  vertex is not shared with other cells
+     * @return          The cell local index of the new vertex
+     */
+    unsigned int addVertex(const VertexT &v, int edge)
+    {
+        m_vertices.push_back(v);
+        m_edges.push_back(edge);
+        return m_vertices.size() - 1 - m_vertexOffsets.back();
+    }
+
+    /**
+     * @brief Adds a triangle defined by three cell local vertex indices
+     *        to the current cell.
+     */
+    void addTriangle(unsigned int a, unsigned int b, unsigned int c)
+    {
+        m_faces.push_back(a);
+        m_faces.push_back(b);
+        m_faces.push_back(c);
+    }
+
+    /// Returns the number of stored cells
+    size_t numBoxes() const { return m_vertexOffsets.size(); }
+
+    /// Returns the index of the first vertex of the given cell
+    size_t vertexBegin(size_t box) const { return m_vertexOffsets[box]; }
+
+    /// Returns the index behind the last vertex of the given cell
+    size_t vertexEnd(size_t box) const
+    {
+        return box + 1 < m_vertexOffsets.size() ? m_vertexOffsets[box + 1] : m_vertices.size();
+    }
+
+    /// Returns the index of the first face index of the given cell
+    size_t faceBegin(size_t box) const { return m_faceOffsets[box]; }
+
+    /// Returns the index behind the last face index of the given cell
+    size_t faceEnd(size_t box) const
+    {
+        return box + 1 < m_faceOffsets.size() ? m_faceOffsets[box + 1] : m_faces.size();
+    }
+
+    /// The stored vertex positions
+    vector<VertexT>         m_vertices;
+
+    /// The cell edge of each vertex or -1 for vertices inside the cell
+    vector<int>             m_edges;
+
+    /// Cell local vertex indices, three per triangle
+    vector<unsigned int>    m_faces;
+
+private:
+
+    /// Position of the first vertex of each cell
+    vector<size_t>          m_vertexOffsets;
+
+    /// Position of the first face index of each cell
+    vector<size_t>          m_faceOffsets;
+};
+
+} /* namespace lvr */
+
+#endif /* SURFACEBUFFER_HPP_ */
@@ -0,0 +1,328 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * TiledMeshWriter.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef TILEDMESHWRITER_HPP_
+#define TILEDMESHWRITER_HPP_
+
+#include "reconstruction/HashGrid.hpp"
+#include "reconstruction/SurfaceBuffer.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+using std::string;
+using std::vector;
+using std::unordered_map;
+
+namespace lvr
+{
+
+/**
+ * @brief The triangles of a range of grid cells. Vertices on lattice
+ *        edges are merged and carry the key of their edge, so that they
+ *        can be merged with the vertices of adjacent ranges.
+ */
+struct MeshFragment
+{
+    /// Key of vertices that do not lie on a lattice edge
+    static const uint64_t noKey = ~(uint64_t)0;
+
+    /// Removes all vertices and faces
+    void clear()
+    {
+        vertices.clear();
+        keys.clear();
+        faces.clear();
+    }
+
+    /// Vertex positions (three values per vertex)
+    vector<float>       vertices;
+
+    /// Edge key of each vertex or noKey
+    vector<uint64_t>    keys;
+
+    /// Vertex indices of the triangles (three per triangle)
+    vector<uint32_t>    faces;
+
+    /// First lattice position of the cell range
+    int                 first[3];
+
+    /// Lattice position behind the cell range
+    int                 last[3];
+};
+
+/**
+ * @brief Extracts the triangles of a sequence of reconstruction grids
+ *        that cover adjacent parts of a common lattice and streams them
+ *        into a single PLY file. All grids have to use the same origin
+ *        and voxelsize. From each grid only the cells within the given
+ *        cell range are used, so every cell is polygonized exactly once
+ *        if the ranges do not overlap. Vertices are identified by the
+ *        lattice edge they lie on. Vertices on the border of a range
+ *        are kept and reused by the adjacent ranges, so the seams are
+ *        closed without duplicate vertices. They are dropped as soon as
+ *        all cells around their edge have been polygonized.
+ *        Grids of adjacent ranges are built from different points, so
+ *        they may disagree on the distances of the shared corners. The
+ *        first grid that contains a corner on the border of its range
+ *        therefore defines the distance of that corner for all later
+ *        grids. Vertices and faces are buffered in temporary files until
+ *        the final counts are known. Lattice positions have to lie in
+ *        [0, 2^20), so the origin should be placed below all points.
+ */
+template<typename VertexT, typename BoxT>
+class TiledMeshWriter
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param filename      Name of the output PLY file
+     * @param origin        Origin of the grid lattice
+     * @param voxelsize     Voxelsize of the grid lattice
+     */
+    TiledMeshWriter(string filename, VertexT origin, float voxelsize);
+
+    /**
+     * @brief Destructor. Removes the temporary files.
+     */
+    virtual ~TiledMeshWriter();
+
+    /**
+     * @brief Polygonizes the cells of the given grid with lattice
+     *        positions first <= position < last and appends the created
+     *        triangles to the mesh. The distances of the corners on the
+     *        border of the range are replaced by the distances of
+     *        previously added grids (see \ref shareBorderDistances).
+     *
+     * @param grid          A grid with calculated distance values
+     * @param first         First lattice position of the cell range
+     * @param last          Lattice position behind the cell range
+     */
+    void addTile(HashGrid<VertexT, BoxT>* grid, const int first[3], const int last[3]);
+
+    /**
+     * @brief Makes the distances of the corners on the border of the
+     *        given range consistent with the previously added grids.
+     *        Corners that were already seen get the stored distance,
+     *        the distances of new corners are stored.
+     *
+     * @param grid          A grid with calculated distance values
+     * @param first         First lattice position of the cell range
+     * @param last          Lattice position behind the cell range
+     */
+    void shareBorderDistances(HashGrid<VertexT, BoxT>* grid, const int first[3], const int last[3]);
+
+    /**
+     * @brief Collects the query points of the given grid that are
+     *        corners on the border of the given range. The corners can
+     *        be collected in a different process than the final mesh.
+     *
+     * @param grid          A grid with calculated distance values
+     * @param origin        Origin of the grid lattice
+     * @param voxelsize     Voxelsize of the grid lattice
+     * @param first         First lattice position of the cell range
+     * @param last          Lattice position behind the cell range
+     * @param indices       Receives the query point indices of the corners
+     * @param keys          Receives the lattice keys of the corners
+     */
+    static void getBorderCorners(HashGrid<VertexT, BoxT>* grid, VertexT origin, float voxelsize,
+            const int first[3], const int last[3], vector<size_t> &indices, vector<uint64_t> &keys);
+
+    /**
+     * @brief Replaces the distances and invalid flags of the given
+     *        border corners by the stored values of corners that were
+     *        already seen and stores the values of the new corners.
+     *
+     * @param keys          Lattice keys of the corners
+     * @param distances     Distances of the corners
+     * @param invalid       Invalid flags of the corners
+     * @param first         First lattice position of the cell range
+     *                      the corners belong to
+     * @param last          Lattice position behind the cell range
+     *
+     * @return The number of corners that were already known
+     */
+    size_t shareBorderCorners(const vector<uint64_t> &keys, vector<float> &distances,
+            vector<unsigned char> &invalid, const int first[3], const int last[3]);
+
+    /**
+     * @brief Polygonizes the cells of the given grid with lattice
+     *        positions first <= position < last. The fragment can be
+     *        created in a different process than the final mesh.
+     *
+     * @param grid          A grid with calculated distance values
+     * @param origin        Origin of the grid lattice
+     * @param voxelsize     Voxelsize of the grid lattice
+     * @param first         First lattice position of the cell range
+     * @param last          Lattice position behind the cell range
+     * @param fragment      Receives the triangles of the cell range
+     */
+    static void extractTile(HashGrid<VertexT, BoxT>* grid, VertexT origin, float voxelsize,
+            const int first[3], const int last[3], MeshFragment &fragment);
+
+    /**
+     * @brief Appends the triangles of a fragment to the mesh. Vertices
+     *        on the border of the cell range are merged with the
+     *        vertices of previously added adjacent ranges.
+     */
+    void addFragment(const MeshFragment &fragment);
+
+    /**
+     * @brief Writes the PLY file
+     */
+    void finalize();
+
+    /// Returns the number of written vertices
+    size_t numVertices() const { return m_numVertices; }
+
+    /// Returns the number of written faces
+    size_t numFaces() const { return m_numFaces; }
+
+private:
+
+    /**
+     * @brief Appends a vertex to the temporary vertex file
+     *
+     * @return The index of the vertex in the mesh
+     */
+    unsigned int writeVertex(const float* v);
+
+    /**
+     * @brief Packs the lattice position of the lower edge corner and the
+     *        edge direction into a single 64 bit key (20 bits per
+     *        dimension, 2 bits for the direction). The positions have to
+     *        lie in [0, m_maxPosition], see \ref checkRange.
+     */
+    inline static uint64_t edgeKey(int i, int j, int k, int axis)
+    {
+        const uint64_t mask = (1 << 20) - 1;
+        return   (((uint64_t)i & mask) << 42)
+               | (((uint64_t)j & mask) << 22)
+               | (((uint64_t)k & mask) << 2)
+               |  (uint64_t)axis;
+    }
+
+    /**
+     * @brief Unpacks a key that was created with \ref edgeKey
+     */
+    inline static void edgePosition(uint64_t key, int p[3], int &axis)
+    {
+        const uint64_t mask = (1 << 20) - 1;
+        p[0] = (int)((key >> 42) & mask);
+        p[1] = (int)((key >> 22) & mask);
+        p[2] = (int)((key >> 2) & mask);
+        axis = (int)(key & 3);
+    }
+
+    /**
+     * @brief Packs a corner position into a key that differs from all
+     *        edge keys (the direction bits are 3)
+     */
+    inline static uint64_t cornerKey(int i, int j, int k)
+    {
+        return edgeKey(i, j, k, 3);
+    }
+
+    /**
+     * @brief Returns the number of cells around the given edge (four
+     *        cells) or corner (eight cells) that lie within the given
+     *        range
+     */
+    static int cellsInRange(uint64_t key, const int first[3], const int last[3]);
+
+    /**
+     * @brief Returns false and prints a message if the corners of the
+     *        given range do not fit into edge keys
+     */
+    static bool checkRange(const int first[3], const int last[3]);
+
+    /// Largest lattice position that fits into an edge key
+    static const int m_maxPosition = (1 << 20) - 1;
+
+    /// Number of cells that are polygonized by one thread at once
+    static const size_t m_chunkSize = 1024;
+
+    /// Name of the output file
+    string                          m_filename;
+
+    /// Name of the temporary vertex file
+    string                          m_vertexFile;
+
+    /// Name of the temporary face file
+    string                          m_faceFile;
+
+    /// Temporary vertex file
+    std::ofstream                   m_vertices;
+
+    /// Temporary face file
+    std::ofstream                   m_faces;
+
+    /// Mesh index of a vertex on a range border
+    struct BorderVertex
+    {
+        unsigned int    index;
+
+        /// Number of polygonized cells around the edge of the vertex
+        int             cells;
+    };
+
+    /// The vertices on range borders
+    unordered_map<uint64_t, BorderVertex>  m_borderVertices;
+
+    /// Distance and invalid flag of a corner on a range border
+    struct BorderCorner
+    {
+        float   distance;
+        bool    invalid;
+
+        /// Number of cells around the corner whose ranges were shared
+        int     cells;
+    };
+
+    /// The corners on range borders
+    unordered_map<uint64_t, BorderCorner>  m_borderCorners;
+
+    /// Origin of the grid lattice
+    VertexT                         m_origin;
+
+    /// Voxelsize of the grid lattice
+    float                           m_voxelsize;
+
+    /// Number of written vertices
+    size_t                          m_numVertices;
+
+    /// Number of written faces
+    size_t                          m_numFaces;
+};
+
+} /* namespace lvr */
+
+#include "TiledMeshWriter.tcc"
+
+#endif /* TILEDMESHWRITER_HPP_ */
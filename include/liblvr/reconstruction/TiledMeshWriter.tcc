@@ -0,0 +1,487 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * TiledMeshWriter.tcc
+ *
+ *  @date 18.10.2026
+ */
+
+#include "FastReconstructionTables.hpp"
+#include "io/Progress.hpp"
+#include "io/Timestamp.hpp"
+#include "config/lvropenmp.hpp"
+
+#include <rply.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace lvr
+{
+
+template<typename VertexT, typename BoxT>
+TiledMeshWriter<VertexT, BoxT>::TiledMeshWriter(string filename, VertexT origin, float voxelsize)
+	: m_filename(filename),
+	  m_vertexFile(filename + ".vertices.tmp"),
+	  m_faceFile(filename + ".faces.tmp"),
+	  m_origin(origin),
+	  m_voxelsize(voxelsize),
+	  m_numVertices(0),
+	  m_numFaces(0)
+{
+	m_vertices.open(m_vertexFile.c_str(), std::ios::binary | std::ios::trunc);
+	m_faces.open(m_faceFile.c_str(), std::ios::binary | std::ios::trunc);
+
+	if(!m_vertices.good() || !m_faces.good())
+	{
+		cout << timestamp << "TiledMeshWriter: Unable to create temporary files for "
+			 << m_filename << "." << endl;
+	}
+}
+
+template<typename VertexT, typename BoxT>
+TiledMeshWriter<VertexT, BoxT>::~TiledMeshWriter()
+{
+	m_vertices.close();
+	m_faces.close();
+	std::remove(m_vertexFile.c_str());
+	std::remove(m_faceFile.c_str());
+}
+
+template<typename VertexT, typename BoxT>
+void TiledMeshWriter<VertexT, BoxT>::addTile(HashGrid<VertexT, BoxT>* grid, const int first[3], const int last[3])
+{
+	shareBorderDistances(grid, first, last);
+
+	MeshFragment fragment;
+	extractTile(grid, m_origin, m_voxelsize, first, last, fragment);
+	addFragment(fragment);
+}
+
+template<typename VertexT, typename BoxT>
+void TiledMeshWriter<VertexT, BoxT>::shareBorderDistances(HashGrid<VertexT, BoxT>* grid,
+		const int first[3], const int last[3])
+{
+	vector<QueryPoint<VertexT> >& qp = grid->getQueryPoints();
+
+	vector<size_t> indices;
+	vector<uint64_t> keys;
+	getBorderCorners(grid, m_origin, m_voxelsize, first, last, indices, keys);
+
+	vector<float> distances(indices.size());
+	vector<unsigned char> invalid(indices.size());
+	for(size_t i = 0; i < indices.size(); i++)
+	{
+		distances[i] = qp[indices[i]].m_distance;
+		invalid[i] = qp[indices[i]].m_invalid;
+	}
+
+	size_t shared = shareBorderCorners(keys, distances, invalid, first, last);
+
+	for(size_t i = 0; i < indices.size(); i++)
+	{
+		qp[indices[i]].m_distance = distances[i];
+		qp[indices[i]].m_invalid = invalid[i];
+	}
+
+	cout << timestamp << "Took " << shared << " border distances from adjacent tiles." << endl;
+}
+
+template<typename VertexT, typename BoxT>
+void TiledMeshWriter<VertexT, BoxT>::getBorderCorners(HashGrid<VertexT, BoxT>* grid, VertexT origin, float voxelsize,
+		const int first[3], const int last[3], vector<size_t> &indices, vector<uint64_t> &keys)
+{
+	vector<QueryPoint<VertexT> >& qp = grid->getQueryPoints();
+	float vsh = 0.5 * voxelsize;
+
+	indices.clear();
+	keys.clear();
+	if(!checkRange(first, last))
+	{
+		return;
+	}
+	for(size_t i = 0; i < qp.size(); i++)
+	{
+		// The lattice position of a corner is restored from its position.
+		// The cells of the range use the corners first <= c <= last.
+		int c[3];
+		bool inside = true;
+		bool border = false;
+		for(int a = 0; a < 3; a++)
+		{
+			float f = (qp[i].m_position[a] - origin[a] + vsh) / voxelsize;
+			c[a] = f < 0 ? f - .5 : f + .5;
+			inside = inside && c[a] >= first[a] && c[a] <= last[a];
+			border = border || c[a] == first[a] || c[a] == last[a];
+		}
+		if(inside && border)
+		{
+			indices.push_back(i);
+			keys.push_back(cornerKey(c[0], c[1], c[2]));
+		}
+	}
+}
+
+template<typename VertexT, typename BoxT>
+size_t TiledMeshWriter<VertexT, BoxT>::shareBorderCorners(const vector<uint64_t> &keys,
+		vector<float> &distances, vector<unsigned char> &invalid, const int first[3], const int last[3])
+{
+	size_t shared = 0;
+	for(size_t i = 0; i < keys.size(); i++)
+	{
+		// A corner is not needed anymore when the ranges of all eight
+		// cells around it were shared
+		int cells = cellsInRange(keys[i], first, last);
+		typename unordered_map<uint64_t, BorderCorner>::iterator it = m_borderCorners.find(keys[i]);
+		if(it != m_borderCorners.end())
+		{
+			distances[i] = it->second.distance;
+			invalid[i] = it->second.invalid;
+			shared++;
+
+			it->second.cells += cells;
+			if(it->second.cells >= 8)
+			{
+				m_borderCorners.erase(it);
+			}
+		}
+		else if(cells < 8)
+		{
+			BorderCorner corner;
+			corner.distance = distances[i];
+			corner.invalid = invalid[i];
+			corner.cells = cells;
+			m_borderCorners[keys[i]] = corner;
+		}
+	}
+	return shared;
+}
+
+template<typename VertexT, typename BoxT>
+void TiledMeshWriter<VertexT, BoxT>::extractTile(HashGrid<VertexT, BoxT>* grid, VertexT origin, float voxelsize,
+		const int first[3], const int last[3], MeshFragment &fragment)
+{
+	fragment.clear();
+	for(int a = 0; a < 3; a++)
+	{
+		fragment.first[a] = first[a];
+		fragment.last[a] = last[a];
+	}
+
+	if(!checkRange(first, last))
+	{
+		return;
+	}
+
+	vector<BoxT*> cells;
+	grid->getCells(cells);
+
+	// Select the cells within the range. The lattice position is
+	// restored from the cell center.
+	vector<BoxT*> tileCells;
+	vector<int> positions;
+	for(size_t i = 0; i < cells.size(); i++)
+	{
+		const VertexT& center = cells[i]->getCenter();
+		int p[3];
+		bool inside = true;
+		for(int a = 0; a < 3; a++)
+		{
+			float f = (center[a] - origin[a]) / voxelsize;
+			p[a] = f < 0 ? f - .5 : f + .5;
+			inside = inside && p[a] >= first[a] && p[a] < last[a];
+		}
+
+		if(inside)
+		{
+			tileCells.push_back(cells[i]);
+			positions.insert(positions.end(), p, p + 3);
+		}
+	}
+
+	string comment = timestamp.getElapsedTime() + "Creating mesh ";
+	ProgressBar progress(tileCells.size(), comment);
+
+	vector<QueryPoint<VertexT> >& qp = grid->getQueryPoints();
+
+	size_t numChunks = (tileCells.size() + m_chunkSize - 1) / m_chunkSize;
+	size_t chunksPerBlock = 4 * OpenMPConfig::getNumThreads();
+	vector<SurfaceBuffer<VertexT> > buffers(chunksPerBlock);
+
+	// Fragment indices of the vertices on lattice edges and of the
+	// vertices of the current cell
+	unordered_map<uint64_t, unsigned int> edgeVertices;
+	vector<unsigned int> indices;
+
+	for(size_t block = 0; block < numChunks; block += chunksPerBlock)
+	{
+		size_t blockEnd = std::min(numChunks, block + chunksPerBlock);
+
+		#pragma omp parallel for schedule(dynamic)
+		for(int c = (int)block; c < (int)blockEnd; c++)
+		{
+			SurfaceBuffer<VertexT>& buffer = buffers[c - block];
+			buffer.clear();
+
+			size_t firstCell = c * m_chunkSize;
+			size_t lastCell = std::min(tileCells.size(), firstCell + m_chunkSize);
+			for(size_t i = firstCell; i < lastCell; i++)
+			{
+				buffer.beginBox();
+				tileCells[i]->getLocalSurface(buffer, qp);
+			}
+		}
+
+		// Collect the buffered surfaces. Vertices on cell edges are
+		// looked up by the lattice position of the edge.
+		for(size_t c = block; c < blockEnd; c++)
+		{
+			SurfaceBuffer<VertexT>& buffer = buffers[c - block];
+			size_t firstCell = c * m_chunkSize;
+			for(size_t i = 0; i < buffer.numBoxes(); i++)
+			{
+				const int* p = &positions[3 * (firstCell + i)];
+
+				indices.clear();
+				for(size_t v = buffer.vertexBegin(i); v < buffer.vertexEnd(i); v++)
+				{
+					const VertexT& vertex = buffer.m_vertices[v];
+					int edge = buffer.m_edges[v];
+					uint64_t key = MeshFragment::noKey;
+					if(edge != -1)
+					{
+						int corner = edge_origin_table[edge][0];
+						key = edgeKey(
+								p[0] + (box_creation_table[corner][0] > 0 ? 1 : 0),
+								p[1] + (box_creation_table[corner][1] > 0 ? 1 : 0),
+								p[2] + (box_creation_table[corner][2] > 0 ? 1 : 0),
+								edge_origin_table[edge][1]);
+
+						unordered_map<uint64_t, unsigned int>::iterator it = edgeVertices.find(key);
+						if(it != edgeVertices.end())
+						{
+							indices.push_back(it->second);
+							continue;
+						}
+						edgeVertices[key] = fragment.keys.size();
+					}
+
+					indices.push_back(fragment.keys.size());
+					fragment.keys.push_back(key);
+					fragment.vertices.push_back(vertex[0]);
+					fragment.vertices.push_back(vertex[1]);
+					fragment.vertices.push_back(vertex[2]);
+				}
+
+				for(size_t f = buffer.faceBegin(i); f < buffer.faceEnd(i); f++)
+				{
+					fragment.faces.push_back(indices[buffer.m_faces[f]]);
+				}
+
+				if(!timestamp.isQuiet())
+					++progress;
+			}
+		}
+	}
+
+	if(!timestamp.isQuiet())
+		cout << endl;
+}
+
+template<typename VertexT, typename BoxT>
+void TiledMeshWriter<VertexT, BoxT>::addFragment(const MeshFragment &fragment)
+{
+	// Mesh indices of the vertices of the fragment
+	vector<unsigned int> indices(fragment.keys.size());
+
+	// Vertices on the border of the range are kept for the adjacent
+	// ranges
+	for(size_t v = 0; v < fragment.keys.size(); v++)
+	{
+		uint64_t key = fragment.keys[v];
+		if(key == MeshFragment::noKey)
+		{
+			indices[v] = writeVertex(&fragment.vertices[3 * v]);
+			continue;
+		}
+
+		// A vertex is not needed anymore when all four cells around its
+		// edge were polygonized
+		int cells = cellsInRange(key, fragment.first, fragment.last);
+		typename unordered_map<uint64_t, BorderVertex>::iterator it = m_borderVertices.find(key);
+		if(it != m_borderVertices.end())
+		{
+			indices[v] = it->second.index;
+			it->second.cells += cells;
+			if(it->second.cells >= 4)
+			{
+				m_borderVertices.erase(it);
+			}
+		}
+		else
+		{
+			indices[v] = writeVertex(&fragment.vertices[3 * v]);
+			if(cells < 4)
+			{
+				BorderVertex vertex;
+				vertex.index = indices[v];
+				vertex.cells = cells;
+				m_borderVertices[key] = vertex;
+			}
+		}
+	}
+
+	for(size_t f = 0; f < fragment.faces.size(); f += 3)
+	{
+		uint32_t face[3];
+		face[0] = indices[fragment.faces[f]];
+		face[1] = indices[fragment.faces[f + 1]];
+		face[2] = indices[fragment.faces[f + 2]];
+		m_faces.write(reinterpret_cast<const char*>(face), sizeof(face));
+		m_numFaces++;
+	}
+
+	cout << timestamp << "Tile done. " << m_borderVertices.size() << " border vertices and "
+		 << m_borderCorners.size() << " border corners are kept." << endl;
+}
+
+template<typename VertexT, typename BoxT>
+void TiledMeshWriter<VertexT, BoxT>::finalize()
+{
+	m_vertices.close();
+	m_faces.close();
+	m_borderVertices.clear();
+	m_borderCorners.clear();
+
+	cout << timestamp << "Writing " << m_numVertices << " vertices and "
+		 << m_numFaces << " faces to " << m_filename << "." << endl;
+
+	p_ply oply = ply_create(m_filename.c_str(), PLY_LITTLE_ENDIAN, NULL, 0, NULL);
+	if(!oply)
+	{
+		cout << timestamp << "Could not create »" << m_filename << "«" << endl;
+		return;
+	}
+
+	ply_add_element(oply, "vertex", m_numVertices);
+	ply_add_scalar_property(oply, "x", PLY_FLOAT);
+	ply_add_scalar_property(oply, "y", PLY_FLOAT);
+	ply_add_scalar_property(oply, "z", PLY_FLOAT);
+	ply_add_element(oply, "face", m_numFaces);
+	ply_add_list_property(oply, "vertex_indices", PLY_UCHAR, PLY_INT);
+
+	if(!ply_write_header(oply))
+	{
+		cout << timestamp << "Could not write header." << endl;
+		ply_close(oply);
+		return;
+	}
+
+	// Copy the temporary files block by block
+	const size_t blockSize = 3 * 65536;
+
+	std::ifstream vertices(m_vertexFile.c_str(), std::ios::binary);
+	vector<float> v(blockSize);
+	for(size_t i = 0; i < m_numVertices; )
+	{
+		size_t n = std::min(blockSize / 3, m_numVertices - i);
+		vertices.read(reinterpret_cast<char*>(&v[0]), 3 * n * sizeof(float));
+		for(size_t j = 0; j < 3 * n; j++)
+		{
+			ply_write(oply, (double) v[j]);
+		}
+		i += n;
+	}
+
+	std::ifstream faces(m_faceFile.c_str(), std::ios::binary);
+	vector<uint32_t> f(blockSize);
+	for(size_t i = 0; i < m_numFaces; )
+	{
+		size_t n = std::min(blockSize / 3, m_numFaces - i);
+		faces.read(reinterpret_cast<char*>(&f[0]), 3 * n * sizeof(uint32_t));
+		for(size_t j = 0; j < n; j++)
+		{
+			ply_write(oply, 3.0);
+			ply_write(oply, (double) f[3 * j]);
+			ply_write(oply, (double) f[3 * j + 1]);
+			ply_write(oply, (double) f[3 * j + 2]);
+		}
+		i += n;
+	}
+
+	if(!vertices.good() || !faces.good())
+	{
+		cout << timestamp << "TiledMeshWriter: Unable to read temporary files." << endl;
+	}
+
+	if(!ply_close(oply))
+	{
+		cout << timestamp << "Could not close file." << endl;
+	}
+
+	std::remove(m_vertexFile.c_str());
+	std::remove(m_faceFile.c_str());
+}
+
+template<typename VertexT, typename BoxT>
+unsigned int TiledMeshWriter<VertexT, BoxT>::writeVertex(const float* v)
+{
+	m_vertices.write(reinterpret_cast<const char*>(v), 3 * sizeof(float));
+	return m_numVertices++;
+}
+
+template<typename VertexT, typename BoxT>
+int TiledMeshWriter<VertexT, BoxT>::cellsInRange(uint64_t key, const int first[3], const int last[3])
+{
+	int p[3];
+	int axis;
+	edgePosition(key, p, axis);
+
+	// The cells around an edge lie at p - 1 and p in the two directions
+	// orthogonal to the edge and at p along the edge. The cells around a
+	// corner lie at p - 1 and p in all directions.
+	int cells = 1;
+	for(int a = 0; a < 3; a++)
+	{
+		int inside = 0;
+		for(int c = (a == axis ? p[a] : p[a] - 1); c <= p[a]; c++)
+		{
+			inside += c >= first[a] && c < last[a];
+		}
+		cells *= inside;
+	}
+	return cells;
+}
+
+template<typename VertexT, typename BoxT>
+bool TiledMeshWriter<VertexT, BoxT>::checkRange(const int first[3], const int last[3])
+{
+	for(int a = 0; a < 3; a++)
+	{
+		if(first[a] < 0 || last[a] > m_maxPosition)
+		{
+			cout << timestamp << "TiledMeshWriter: The cell range [" << first[a] << ", " << last[a]
+				 << ") exceeds the lattice positions 0 to " << m_maxPosition << "." << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+} /* namespace lvr */
@@ -0,0 +1,174 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/*
+ * TextureIndex.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef TEXTUREINDEX_HPP_
+#define TEXTUREINDEX_HPP_
+
+#include "io/TextureIO.hpp"
+#include "texture/Texture.hpp"
+
+#include <map>
+#include <vector>
+#include <utility>
+
+namespace lvr {
+
+/**
+ * @brief	An index over the textures of a texture package for fast
+ *		texture matching. The normalized histograms, CCVs and
+ *		statistics of all textures are kept in flat arrays. For every
+ *		texture class the textures are sorted by a scalar color key
+ *		and by their most discriminative statistical value. Both keys
+ *		are lower bounds of the corresponding distances, so a query
+ *		only evaluates the textures within the key range given by the
+ *		thresholds. The remaining candidates are evaluated in
+ *		parallel. The results are the same as comparing the reference
+ *		texture to every texture of the package.
+ */
+class TextureIndex {
+public:
+
+	/**
+	 * \brief	Constructor. Builds the index over all textures of the
+	 *		given texture package.
+	 *
+	 * \param	tio	The texture package
+	 */
+	TextureIndex(TextureIO* tio);
+
+	/**
+	 * \brief	Adds the texture with the given index in the texture
+	 *		package to the index. Textures have to be added in the
+	 *		order of their indices.
+	 *
+	 * \param	index	The index of the texture in the texture package
+	 */
+	void add(size_t index);
+
+	/**
+	 * \brief	Searches the best matching texture for the given reference
+	 *		texture. The filters are applied in the order texture class,
+	 *		histogram and CCV, statistics, image features. A texture is
+	 *		discarded if one of its distances is greater than the
+	 *		threshold of the filter. A threshold of FLT_MAX disables the
+	 *		filter. The distances of the applied filters and the cross
+	 *		correlation are summed up.
+	 *
+	 * \param	refTexture		The texture to compare the textures of the package with
+	 * \param	textureClass		The class of the texture to search for
+	 * \param	colorThreshold		Threshold for the histogram and CCV distances
+	 * \param	statsThreshold		Threshold for the statistical distance
+	 * \param	featureThreshold	Threshold for the image feature distance
+	 * \param	useCrossCorr		Whether to add the cross correlation distance
+	 * \param	distance		Receives the summed distance of the best match
+	 *
+	 * \return	The index of the best match in the texture package or -1 if
+	 *		no texture passed the filters
+	 */
+	int findBestMatch(Texture* refTexture, unsigned short int textureClass,
+			float colorThreshold, float statsThreshold, float featureThreshold,
+			bool useCrossCorr, float &distance);
+
+private:
+
+	/// Textures of one class with the same number of CCV colors
+	struct Bucket
+	{
+		/// Color keys and indices of the textures, sorted by the key
+		std::vector<std::pair<float, size_t> > colorKeys;
+
+		/// Statistics keys and indices of the textures, sorted by the key
+		std::vector<std::pair<float, size_t> > statsKeys;
+
+		/// Textures without a valid statistics key
+		std::vector<size_t> unsortedStats;
+	};
+
+	/**
+	 * \brief	Calculates the normalized histogram and CCV of the given
+	 *		texture and its color key.
+	 *
+	 * \param	t		The texture
+	 * \param	histogram	Receives three entries per color
+	 * \param	ccv		Receives two entries per color and channel
+	 *				plus two entries per channel
+	 *
+	 * \return	The color key, a lower bound of the histogram distance
+	 */
+	static float calcSignature(Texture* t, std::vector<float> &histogram, std::vector<float> &ccv);
+
+	/**
+	 * \brief	Calculates the distance of a texture of the package to the
+	 *		reference texture and discards it if a filter fails.
+	 *
+	 * \return	false if the texture does not pass the filters
+	 */
+	bool evaluate(size_t index, Texture* refTexture, const float* refHistogram, const float* refCCV,
+			float colorThreshold, float statsThreshold, float featureThreshold,
+			bool useCrossCorr, float &distance);
+
+	/**
+	 * \brief	Collects the indices of the textures with keys within
+	 *		[key - range, key + range]
+	 */
+	static void collectRange(const std::vector<std::pair<float, size_t> > &keys, float key, float range,
+			std::vector<size_t> &candidates);
+
+	/**
+	 * \brief	Counts the textures with keys within [key - range, key + range]
+	 */
+	static size_t countRange(const std::vector<std::pair<float, size_t> > &keys, float key, float range);
+
+	/// The texture package
+	TextureIO*				m_tio;
+
+	/// The buckets, sorted by texture class and number of CCV colors
+	std::map<std::pair<unsigned short int, unsigned char>, Bucket> m_buckets;
+
+	/// Normalized histograms of all textures
+	std::vector<float>			m_histograms;
+
+	/// Normalized CCVs of all textures
+	std::vector<float>			m_ccvs;
+
+	/// Offsets of the histograms of the textures in m_histograms
+	std::vector<size_t>			m_histogramOffsets;
+
+	/// Offsets of the CCVs of the textures in m_ccvs
+	std::vector<size_t>			m_ccvOffsets;
+
+	/// Statistics of all textures (14 values per texture)
+	std::vector<float>			m_stats;
+
+	/// Whether the statistics of a texture are available
+	std::vector<bool>			m_hasStats;
+
+	/// Statistical value that is used as key
+	int					m_statsKey;
+};
+
+}
+
+#endif /* TEXTUREINDEX_HPP_ */
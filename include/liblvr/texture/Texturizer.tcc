@@ -79,6 +79,7 @@ template<typename VertexT, typename NormalT>
 Texturizer<VertexT, NormalT>::~Texturizer()
 {
     //delete m_tio;
+    delete m_index;
 }
 
 template<typename VertexT, typename NormalT>
@@ -86,6 +87,7 @@ Texturizer<VertexT, NormalT>::Texturizer(typename PointsetSurface<VertexT>::Ptr
 {
 	//Load texture packamge
 	this->m_tio = new TextureIO(Texturizer::m_filename);
+	this->m_index = new TextureIndex(this->m_tio);
 	
 	this->m_pm = pm;
 
@@ -306,27 +308,41 @@ TextureToken<VertexT, NormalT>* Texturizer<VertexT, NormalT>::createInitialTextu
     string msg = timestamp.getElapsedTime() + "Calculating Texture Pixels... ";
     ProgressBar progress(sizeX * sizeY, msg);
 
+    // Colors of the point cloud. Texels without color information get
+    // the default color of a vertex.
+    size_t numColors;
+    color3bArr colors = m_pm->pointBuffer()->getIndexedPointColorArray(numColors);
+    VertexT defaultColor(0, 0, 0);
+
     #pragma omp parallel for
 	for(int y = 0; y < sizeY; y++)
 	{
 		for(int x = 0; x < sizeX; x++)
 		{
-			vector<VertexT> cv;
-
 			VertexT current_position = p + best_v1
 				* (x * Texture::m_texelSize + best_a_min - Texture::m_texelSize / 2.0)
 				+ best_v2
 				* (y * Texture::m_texelSize + best_b_min - Texture::m_texelSize / 2.0);
 
-			int one = 1;
-			m_pm->searchTree()->kSearch(current_position, one, cv);
+			float query[3] = {current_position[0], current_position[1], current_position[2]};
+			ulong index;
+			float distance;
+			unsigned char r = defaultColor.r;
+			unsigned char g = defaultColor.g;
+			unsigned char b = defaultColor.b;
+			if(m_pm->searchTree()->kSearch(query, 1, &index, &distance) && index < numColors)
+			{
+				r = colors[index].r;
+				g = colors[index].g;
+				b = colors[index].b;
+			}
 
-			texture->m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 0] = cv[0].r;
-			texture->m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 1] = cv[0].g;
-			texture->m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 2] = cv[0].b;
+			texture->m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 0] = r;
+			texture->m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 1] = g;
+			texture->m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 2] = b;
 
 		}
-        ++progress;
+        progress += sizeX;
 	}
 
 	//calculate SURF features of  texture
@@ -341,120 +357,6 @@ TextureToken<VertexT, NormalT>* Texturizer<VertexT, NormalT>::createInitialTextu
 	return result;
 }
 
-template<typename VertexT, typename NormalT>
-void Texturizer<VertexT, NormalT>::filterByColor(vector<Texture*> &textures, Texture* refTexture, float threshold)
-{
-	vector<Texture*> toDelete;
-
-	//Filter by histogram
-	for (int i = 0; i < textures.size(); i++)
-	{
-		float dist = ImageProcessor::compareTexturesHist(textures[i], refTexture);
-		if(dist > threshold)
-		{
-			toDelete.push_back(textures[i]);
-		}
-		textures[i]->m_distance += dist;
-	}	
-	//filter by CCV
-	for (int i = 0; i < textures.size(); i++)
-	{
-		float dist = ImageProcessor::compareTexturesCCV(textures[i], refTexture);
-		if(dist > threshold)
-		{
-			toDelete.push_back(textures[i]);
-		}
-		textures[i]->m_distance += dist;
-	}	
-	
-	//delete bad matches
-	for (int d = 0; d < toDelete.size(); d++)
-	{
-		if(find(textures.begin(), textures.end(), toDelete[d]) != textures.end())
-		{
-			textures.erase(find(textures.begin(), textures.end(), toDelete[d]));
-		}
-	}	
-	
-}
-template<typename VertexT, typename NormalT>
-void Texturizer<VertexT, NormalT>::filterByCrossCorr(vector<Texture*> &textures, Texture* refTexture)
-{
-	//filter by CC
-	for (int i = 0; i < textures.size(); i++)
-	{
-		float dist = ImageProcessor::compareTexturesCrossCorr(textures[i], refTexture);
-		textures[i]->m_distance += dist;
-	}	
-}
-template<typename VertexT, typename NormalT>
-void Texturizer<VertexT, NormalT>::filterByStats(vector<Texture*> &textures, Texture* refTexture, float threshold)
-{
-	vector<Texture*> toDelete;
-
-	//filter by stats
-	for (int i = 0; i < textures.size(); i++)
-	{
-		float dist = ImageProcessor::compareTexturesStats(textures[i], refTexture);
-		if(dist > threshold)
-		{
-			toDelete.push_back(textures[i]);
-		}
-		textures[i]->m_distance += dist;
-	}	
-	
-	//delete bad matches
-	for (int d = 0; d < toDelete.size(); d++)
-	{
-		textures.erase(find(textures.begin(), textures.end(), toDelete[d]));
-	}	
-}
-template<typename VertexT, typename NormalT>
-void Texturizer<VertexT, NormalT>::filterByFeatures(vector<Texture*> &textures, Texture* refTexture, float threshold)
-{
-	vector<Texture*> toDelete;
-
-	//filter by features
-	for (int i = 0; i < textures.size(); i++)
-	{
-		float dist = ImageProcessor::compareTexturesSURF(textures[i], refTexture);
-		if(dist > threshold)
-		{
-			toDelete.push_back(textures[i]);
-		}
-		textures[i]->m_distance += dist;
-	}	
-	
-	//delete bad matches
-	for (int d = 0; d < toDelete.size(); d++)
-	{
-		textures.erase(find(textures.begin(), textures.end(), toDelete[d]));
-	}	
-}
-template<typename VertexT, typename NormalT>
-void Texturizer<VertexT, NormalT>::filterByNormal(vector<Texture*> &textures, vector<VertexT> contour)
-{
-	vector<Texture*> toDelete;
-
-	//calculate normal of plane
-	NormalT n = (contour[1] - contour[0]).cross(contour[2]-contour[0]);
-	
-	//filter by normal
-	for (int i = 0; i < textures.size(); i++)
-	{
-		if(Texturizer<VertexT, NormalT>::classifyNormal(n) != textures[i]->m_textureClass)
-		{
-			toDelete.push_back(textures[i]);
-		}
-	}	
-	
-	//delete bad matches
-	for (int d = 0; d < toDelete.size(); d++)
-	{
-		textures.erase(find(textures.begin(), textures.end(), toDelete[d]));
-	}	
-}
-
 template<typename VertexT, typename NormalT>
 TextureToken<VertexT, NormalT>* Texturizer<VertexT, NormalT>::texturizePlane(vector<VertexT> contour
                                                                              )
@@ -474,54 +376,25 @@ TextureToken<VertexT, NormalT>* Texturizer<VertexT, NormalT>::texturizePlane(vec
 		//create an initial texture from the point cloud
         initialTexture = createInitialTexture(contour);
 
-		//reset distance values
-		for (int i = 0; i < m_tio->m_textures.size(); i++)
-		{
-			m_tio->m_textures[i]->m_distance = 0;
-		}
-		//reduce number of matching textures from the texture pack step by step
-		//std::vector<Texture*> textures = this->m_tio->m_textures;
-		std::vector<Texture*> textures;
-
-		//std::copy(this->m_tio->m_textures.begin(), this->m_tio->m_textures.end(), textures.begin());
-		for(size_t i = 0; i < m_tio->m_textures.size(); i++)
+		if (m_tio->m_textures.size() > 0 && m_doAnalysis)
 		{
-		    textures.push_back(m_tio->m_textures[i]);
-		}
-
-		if (textures.size() > 0 && m_doAnalysis)
-		{
-		    filterByNormal		(textures, contour);
-		    if (colorThreshold != FLT_MAX)
-		    {
-		        filterByColor		(textures, initialTexture->m_texture, colorThreshold);
-		    }
-		    if (statsThreshold != FLT_MAX)
-		    {
-		        filterByStats		(textures, initialTexture->m_texture, statsThreshold);
-		    }
-		    if (featureThreshold != FLT_MAX)
-		    {
-		        filterByFeatures	(textures, initialTexture->m_texture, featureThreshold);
-		    }
-		    if (useCrossCorr != FLT_MAX)
-		    {
-		        filterByCrossCorr	(textures, initialTexture->m_texture);
-		    }
-
-		    sort(textures.begin(), textures.end(), Texture::cmpTextures);
+		    //search the best match of the same class in the texture package
+		    NormalT n = (contour[1] - contour[0]).cross(contour[2] - contour[0]);
+		    float distance = 0;
+		    int best = m_index->findBestMatch(initialTexture->m_texture, classifyNormal(n),
+		            colorThreshold, statsThreshold, featureThreshold, useCrossCorr, distance);
 
-		    if(textures.size())
+		    if(best >= 0)
 		    {
 		        //Found matching textures in texture package -> use best match
+		        Texture* match = m_tio->m_textures[best];
+		        match->m_distance = distance;
 		        TextureToken<VertexT, NormalT>* result = new TextureToken<VertexT, NormalT>(
 		                initialTexture->v1, initialTexture->v2, initialTexture->p,
-		                initialTexture->a_min, initialTexture->b_min, textures[0],
-		                find(this->m_tio->m_textures.begin(), this->m_tio->m_textures.end(), textures[0])
-		                - this->m_tio->m_textures.begin());
+		                initialTexture->a_min, initialTexture->b_min, match, best);
 
-		        cout << "DISTANCE: " << textures[0]->m_distance << endl;
-		        if(textures[0]->m_isPattern)
+		        cout << "DISTANCE: " << match->m_distance << endl;
+		        if(match->m_isPattern)
 		        {
 		            m_stats_matchedPatTextures++;
 		            //	cout<<"Using Pattern Texture from texture package!!!"<<endl;
@@ -532,7 +405,7 @@ TextureToken<VertexT, NormalT>* Texturizer<VertexT, NormalT>::texturizePlane(vec
 		            //	cout<<"Using Texture from texture package!!!"<<endl;
 		            //	cerr<<"Distance: "<<textures[0]->m_distance <<endl;
 		            //Calculate transformation for texture coordinate calculation
-		            Transform* trans = new Transform(initialTexture->m_texture, textures[0]);
+		            Transform* trans = new Transform(initialTexture->m_texture, match);
 		            double* mat = trans->getTransArr();
 		            for (int i = 0; i < 6; i++)
 		            {
@@ -564,6 +437,7 @@ TextureToken<VertexT, NormalT>* Texturizer<VertexT, NormalT>::texturizePlane(vec
 
 		        //Add pattern to texture package
 		        size_t index = this->m_tio->add(pattern);
+		        this->m_index->add(index);
 		        this->m_tio->write();
 
 		        //return a texture token
@@ -579,6 +453,7 @@ TextureToken<VertexT, NormalT>* Texturizer<VertexT, NormalT>::texturizePlane(vec
 		        delete pattern;
 		        //Add initial texture to texture pack
 		        initialTexture->m_textureIndex = this->m_tio->add(initialTexture->m_texture);
+		        this->m_index->add(initialTexture->m_textureIndex);
 		        this->m_tio->write();
 		        //	cout<<initialTexture->m_textureIndex<<endl;
 		    }
@@ -0,0 +1,544 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * PointTransform.cpp
+ *
+ *  @date 18.10.2026
+ */
+
+#include "geometry/PointTransform.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LVR_TRANSFORM_SSE
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define LVR_TRANSFORM_AVX
+#endif
+
+namespace lvr
+{
+
+namespace
+{
+
+/// Number of points that are transformed by a thread at once
+const size_t chunkSize = 1 << 16;
+
+/// Lowers min and raises max to the given point
+inline void expand(float* min, float* max, float x, float y, float z)
+{
+    min[0] = std::min(min[0], x);
+    min[1] = std::min(min[1], y);
+    min[2] = std::min(min[2], z);
+    max[0] = std::max(max[0], x);
+    max[1] = std::max(max[1], y);
+    max[2] = std::max(max[2], z);
+}
+
+/// Transforms points one by one. The order of the operations is the same
+/// as in Matrix4::operator*, so all versions give the same results.
+template<bool bounds>
+void transformScalar(const float* m, float* p, size_t n, float* min, float* max)
+{
+    for(size_t i = 0; i < n; i++, p += 3)
+    {
+        float x = m[0] * p[0] + m[4] * p[1] + m[ 8] * p[2] + m[12];
+        float y = m[1] * p[0] + m[5] * p[1] + m[ 9] * p[2] + m[13];
+        float z = m[2] * p[0] + m[6] * p[1] + m[10] * p[2] + m[14];
+        p[0] = x;
+        p[1] = y;
+        p[2] = z;
+
+        if(bounds)
+        {
+            expand(min, max, x, y, z);
+        }
+    }
+}
+
+/**
+ * @brief Stores the inverse transpose of the upper 3x3 part of the given
+ *        matrix in the upper 3x3 part of n. Normals have to be
+ *        transformed with this matrix to stay perpendicular to the
+ *        surface under scaling and shearing. For rotations it equals the
+ *        rotation itself. The columns of the cofactor matrix are the
+ *        cross products of the columns of the matrix. If the matrix is
+ *        singular, the cofactor matrix is used as is.
+ */
+void normalMatrix(const float* m, float* n)
+{
+    const float* c0 = m;
+    const float* c1 = m + 4;
+    const float* c2 = m + 8;
+
+    float cof[9] = {
+        c1[1] * c2[2] - c1[2] * c2[1], c1[2] * c2[0] - c1[0] * c2[2], c1[0] * c2[1] - c1[1] * c2[0],
+        c2[1] * c0[2] - c2[2] * c0[1], c2[2] * c0[0] - c2[0] * c0[2], c2[0] * c0[1] - c2[1] * c0[0],
+        c0[1] * c1[2] - c0[2] * c1[1], c0[2] * c1[0] - c0[0] * c1[2], c0[0] * c1[1] - c0[1] * c1[0]};
+
+    float det = c0[0] * cof[0] + c0[1] * cof[1] + c0[2] * cof[2];
+    float f = det != 0 ? 1.0f / det : 1.0f;
+
+    for(int i = 0; i < 16; i++)
+    {
+        n[i] = 0;
+    }
+    for(int c = 0; c < 3; c++)
+    {
+        for(int r = 0; r < 3; r++)
+        {
+            n[4 * c + r] = cof[3 * c + r] * f;
+        }
+    }
+    n[15] = 1;
+}
+
+/// Transforms and normalizes normals one by one like Matrix4::operator*
+void normalsScalar(const float* m, float* p, size_t n)
+{
+    for(size_t i = 0; i < n; i++, p += 3)
+    {
+        float x = m[0] * p[0] + m[4] * p[1] + m[ 8] * p[2];
+        float y = m[1] * p[0] + m[5] * p[1] + m[ 9] * p[2];
+        float z = m[2] * p[0] + m[6] * p[1] + m[10] * p[2];
+
+        float l2 = x * x + y * y + z * z;
+        if(std::fabs(1 - l2) > 0.001f && l2 != 0)
+        {
+            float length = std::sqrt(l2);
+            x /= length;
+            y /= length;
+            z /= length;
+        }
+
+        p[0] = x;
+        p[1] = y;
+        p[2] = z;
+    }
+}
+
+#ifdef LVR_TRANSFORM_SSE
+
+// Four interleaved points a = (x0 y0 z0 x1), b = (y1 z1 x2 y2) and
+// c = (z2 x3 y3 z3) are converted to x = (x0 x1 x2 x3), y and z and back.
+// The AVX versions below do the same in both 128 bit lanes.
+
+inline void deinterleave(__m128 a, __m128 b, __m128 c, __m128 &x, __m128 &y, __m128 &z)
+{
+    x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                       _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+}
+
+inline void interleave(__m128 x, __m128 y, __m128 z, __m128 &a, __m128 &b, __m128 &c)
+{
+    a = _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)),
+                       _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+    b = _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+                       _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+    c = _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+                       _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+/// Lowers min and raises max to the values of the given vectors
+inline void expand(float* min, float* max, __m128 vmin[3], __m128 vmax[3])
+{
+    float lo[4], hi[4];
+    for(int a = 0; a < 3; a++)
+    {
+        _mm_storeu_ps(lo, vmin[a]);
+        _mm_storeu_ps(hi, vmax[a]);
+        for(int i = 0; i < 4; i++)
+        {
+            min[a] = std::min(min[a], lo[i]);
+            max[a] = std::max(max[a], hi[i]);
+        }
+    }
+}
+
+template<bool bounds>
+void transformSSE(const float* m, float* p, size_t n, float* min, float* max)
+{
+    __m128 r[12];
+    for(int i = 0; i < 12; i++)
+    {
+        r[i] = _mm_set1_ps(m[i < 3 ? i : (i < 6 ? i + 1 : (i < 9 ? i + 2 : i + 3))]);
+    }
+
+    __m128 vmin[3], vmax[3];
+    for(int a = 0; a < 3; a++)
+    {
+        vmin[a] = _mm_set1_ps(FLT_MAX);
+        vmax[a] = _mm_set1_ps(-FLT_MAX);
+    }
+
+    size_t groups = n / 4;
+    for(size_t i = 0; i < groups; i++, p += 12)
+    {
+        __m128 x, y, z;
+        deinterleave(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _mm_loadu_ps(p + 8), x, y, z);
+
+        // r holds the columns of the matrix (rows of the transposed matrix)
+        __m128 tx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], x), _mm_mul_ps(r[3], y)), _mm_mul_ps(r[6], z)), r[ 9]);
+        __m128 ty = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[1], x), _mm_mul_ps(r[4], y)), _mm_mul_ps(r[7], z)), r[10]);
+        __m128 tz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[2], x), _mm_mul_ps(r[5], y)), _mm_mul_ps(r[8], z)), r[11]);
+
+        __m128 a, b, c;
+        interleave(tx, ty, tz, a, b, c);
+        _mm_storeu_ps(p, a);
+        _mm_storeu_ps(p + 4, b);
+        _mm_storeu_ps(p + 8, c);
+
+        if(bounds)
+        {
+            vmin[0] = _mm_min_ps(vmin[0], tx);
+            vmin[1] = _mm_min_ps(vmin[1], ty);
+            vmin[2] = _mm_min_ps(vmin[2], tz);
+            vmax[0] = _mm_max_ps(vmax[0], tx);
+            vmax[1] = _mm_max_ps(vmax[1], ty);
+            vmax[2] = _mm_max_ps(vmax[2], tz);
+        }
+    }
+
+    if(bounds)
+    {
+        expand(min, max, vmin, vmax);
+    }
+    transformScalar<bounds>(m, p, n - 4 * groups, min, max);
+}
+
+void normalsSSE(const float* m, float* p, size_t n)
+{
+    __m128 r[9];
+    for(int i = 0; i < 9; i++)
+    {
+        r[i] = _mm_set1_ps(m[i < 3 ? i : (i < 6 ? i + 1 : i + 2)]);
+    }
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 eps = _mm_set1_ps(0.001f);
+    const __m128 abs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    size_t groups = n / 4;
+    for(size_t i = 0; i < groups; i++, p += 12)
+    {
+        __m128 x, y, z;
+        deinterleave(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _mm_loadu_ps(p + 8), x, y, z);
+
+        __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], x), _mm_mul_ps(r[3], y)), _mm_mul_ps(r[6], z));
+        __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[1], x), _mm_mul_ps(r[4], y)), _mm_mul_ps(r[7], z));
+        __m128 tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[2], x), _mm_mul_ps(r[5], y)), _mm_mul_ps(r[8], z));
+
+        // Normalize the normals whose length differs from one
+        __m128 l2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)), _mm_mul_ps(tz, tz));
+        __m128 mask = _mm_and_ps(_mm_cmpgt_ps(_mm_and_ps(_mm_sub_ps(one, l2), abs), eps),
+                                 _mm_cmpneq_ps(l2, zero));
+        __m128 length = _mm_or_ps(_mm_and_ps(mask, _mm_sqrt_ps(l2)), _mm_andnot_ps(mask, one));
+        tx = _mm_div_ps(tx, length);
+        ty = _mm_div_ps(ty, length);
+        tz = _mm_div_ps(tz, length);
+
+        __m128 a, b, c;
+        interleave(tx, ty, tz, a, b, c);
+        _mm_storeu_ps(p, a);
+        _mm_storeu_ps(p + 4, b);
+        _mm_storeu_ps(p + 8, c);
+    }
+
+    normalsScalar(m, p, n - 4 * groups);
+}
+
+#endif /* LVR_TRANSFORM_SSE */
+
+#ifdef LVR_TRANSFORM_AVX
+
+__attribute__((target("avx")))
+inline __m256 load2(const float* p)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps(p + 12), 1);
+}
+
+__attribute__((target("avx")))
+inline void store2(float* p, __m256 v)
+{
+    _mm_storeu_ps(p, _mm256_castps256_ps128(v));
+    _mm_storeu_ps(p + 12, _mm256_extractf128_ps(v, 1));
+}
+
+__attribute__((target("avx")))
+inline void deinterleave(__m256 a, __m256 b, __m256 c, __m256 &x, __m256 &y, __m256 &z)
+{
+    x = _mm256_shuffle_ps(a, _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                          _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+}
+
+__attribute__((target("avx")))
+inline void interleave(__m256 x, __m256 y, __m256 z, __m256 &a, __m256 &b, __m256 &c)
+{
+    a = _mm256_shuffle_ps(_mm256_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)),
+                          _mm256_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+    b = _mm256_shuffle_ps(_mm256_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+                          _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+    c = _mm256_shuffle_ps(_mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+                          _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+/// Eight points are processed at once. The lower lanes hold the points
+/// 0 to 3, the upper lanes the points 4 to 7.
+template<bool bounds>
+__attribute__((target("avx")))
+void transformAVX(const float* m, float* p, size_t n, float* min, float* max)
+{
+    __m256 r[12];
+    for(int i = 0; i < 12; i++)
+    {
+        r[i] = _mm256_set1_ps(m[i < 3 ? i : (i < 6 ? i + 1 : (i < 9 ? i + 2 : i + 3))]);
+    }
+
+    __m256 vmin[3], vmax[3];
+    for(int a = 0; a < 3; a++)
+    {
+        vmin[a] = _mm256_set1_ps(FLT_MAX);
+        vmax[a] = _mm256_set1_ps(-FLT_MAX);
+    }
+
+    size_t groups = n / 8;
+    for(size_t i = 0; i < groups; i++, p += 24)
+    {
+        __m256 x, y, z;
+        deinterleave(load2(p), load2(p + 4), load2(p + 8), x, y, z);
+
+        __m256 tx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], x), _mm256_mul_ps(r[3], y)), _mm256_mul_ps(r[6], z)), r[ 9]);
+        __m256 ty = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[1], x), _mm256_mul_ps(r[4], y)), _mm256_mul_ps(r[7], z)), r[10]);
+        __m256 tz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[2], x), _mm256_mul_ps(r[5], y)), _mm256_mul_ps(r[8], z)), r[11]);
+
+        __m256 a, b, c;
+        interleave(tx, ty, tz, a, b, c);
+        store2(p, a);
+        store2(p + 4, b);
+        store2(p + 8, c);
+
+        if(bounds)
+        {
+            vmin[0] = _mm256_min_ps(vmin[0], tx);
+            vmin[1] = _mm256_min_ps(vmin[1], ty);
+            vmin[2] = _mm256_min_ps(vmin[2], tz);
+            vmax[0] = _mm256_max_ps(vmax[0], tx);
+            vmax[1] = _mm256_max_ps(vmax[1], ty);
+            vmax[2] = _mm256_max_ps(vmax[2], tz);
+        }
+    }
+
+    if(bounds)
+    {
+        float lo[8], hi[8];
+        for(int a = 0; a < 3; a++)
+        {
+            _mm256_storeu_ps(lo, vmin[a]);
+            _mm256_storeu_ps(hi, vmax[a]);
+            for(int i = 0; i < 8; i++)
+            {
+                min[a] = std::min(min[a], lo[i]);
+                max[a] = std::max(max[a], hi[i]);
+            }
+        }
+    }
+    transformScalar<bounds>(m, p, n - 8 * groups, min, max);
+}
+
+/// Eight normals are processed at once like in transformAVX
+__attribute__((target("avx")))
+void normalsAVX(const float* m, float* p, size_t n)
+{
+    __m256 r[9];
+    for(int i = 0; i < 9; i++)
+    {
+        r[i] = _mm256_set1_ps(m[i < 3 ? i : (i < 6 ? i + 1 : i + 2)]);
+    }
+
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 eps = _mm256_set1_ps(0.001f);
+    const __m256 abs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+    size_t groups = n / 8;
+    for(size_t i = 0; i < groups; i++, p += 24)
+    {
+        __m256 x, y, z;
+        deinterleave(load2(p), load2(p + 4), load2(p + 8), x, y, z);
+
+        __m256 tx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], x), _mm256_mul_ps(r[3], y)), _mm256_mul_ps(r[6], z));
+        __m256 ty = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[1], x), _mm256_mul_ps(r[4], y)), _mm256_mul_ps(r[7], z));
+        __m256 tz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[2], x), _mm256_mul_ps(r[5], y)), _mm256_mul_ps(r[8], z));
+
+        // Normalize the normals whose length differs from one
+        __m256 l2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(tx, tx), _mm256_mul_ps(ty, ty)), _mm256_mul_ps(tz, tz));
+        __m256 mask = _mm256_and_ps(_mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(one, l2), abs), eps, _CMP_GT_OQ),
+                                    _mm256_cmp_ps(l2, zero, _CMP_NEQ_UQ));
+        __m256 length = _mm256_or_ps(_mm256_and_ps(mask, _mm256_sqrt_ps(l2)), _mm256_andnot_ps(mask, one));
+        tx = _mm256_div_ps(tx, length);
+        ty = _mm256_div_ps(ty, length);
+        tz = _mm256_div_ps(tz, length);
+
+        __m256 a, b, c;
+        interleave(tx, ty, tz, a, b, c);
+        store2(p, a);
+        store2(p + 4, b);
+        store2(p + 8, c);
+    }
+
+    normalsScalar(m, p, n - 8 * groups);
+}
+
+/// Returns true if the CPU supports AVX
+bool hasAVX()
+{
+    static bool avx = __builtin_cpu_supports("avx");
+    return avx;
+}
+
+#endif /* LVR_TRANSFORM_AVX */
+
+/// Transforms a chunk of points with the best available instructions
+template<bool bounds>
+void transformChunk(const float* m, float* p, size_t n, float* min, float* max)
+{
+#ifdef LVR_TRANSFORM_AVX
+    if(hasAVX())
+    {
+        transformAVX<bounds>(m, p, n, min, max);
+        return;
+    }
+#endif
+#ifdef LVR_TRANSFORM_SSE
+    transformSSE<bounds>(m, p, n, min, max);
+#else
+    transformScalar<bounds>(m, p, n, min, max);
+#endif
+}
+
+/// Transforms a chunk of normals with the best available instructions
+void normalsChunk(const float* m, float* p, size_t n)
+{
+#ifdef LVR_TRANSFORM_AVX
+    if(hasAVX())
+    {
+        normalsAVX(m, p, n);
+        return;
+    }
+#endif
+#ifdef LVR_TRANSFORM_SSE
+    normalsSSE(m, p, n);
+#else
+    normalsScalar(m, p, n);
+#endif
+}
+
+} /* anonymous namespace */
+
+void transformPointArray(const float matrix[16], float* points, size_t n, float* bbMin, float* bbMax)
+{
+    bool bounds = bbMin || bbMax;
+    long numChunks = (n + chunkSize - 1) / chunkSize;
+
+    #pragma omp parallel
+    {
+        float min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+        float max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+        #pragma omp for schedule(static)
+        for(long c = 0; c < numChunks; c++)
+        {
+            size_t first = c * chunkSize;
+            size_t count = std::min(chunkSize, n - first);
+            if(bounds)
+            {
+                transformChunk<true>(matrix, points + 3 * first, count, min, max);
+            }
+            else
+            {
+                transformChunk<false>(matrix, points + 3 * first, count, min, max);
+            }
+        }
+
+        if(bounds)
+        {
+            #pragma omp critical
+            {
+                for(int a = 0; a < 3; a++)
+                {
+                    if(bbMin)
+                    {
+                        bbMin[a] = std::min(bbMin[a], min[a]);
+                    }
+                    if(bbMax)
+                    {
+                        bbMax[a] = std::max(bbMax[a], max[a]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void transformNormalArray(const float matrix[16], float* normals, size_t n)
+{
+    float normal[16];
+    normalMatrix(matrix, normal);
+
+    long numChunks = (n + chunkSize - 1) / chunkSize;
+
+    #pragma omp parallel for schedule(static)
+    for(long c = 0; c < numChunks; c++)
+    {
+        size_t first = c * chunkSize;
+        normalsChunk(normal, normals + 3 * first, std::min(chunkSize, n - first));
+    }
+}
+
+void transformPointBuffer(const float matrix[16], PointBufferPtr buffer, float* bbMin, float* bbMax)
+{
+    size_t numPoints, numNormals;
+    floatArr points = buffer->getPointArray(numPoints);
+    floatArr normals = buffer->getPointNormalArray(numNormals);
+
+    if(points)
+    {
+        transformPointArray(matrix, points.get(), numPoints, bbMin, bbMax);
+    }
+
+    if(normals)
+    {
+        transformNormalArray(matrix, normals.get(), numNormals);
+    }
+}
+
+} /* namespace lvr */
@@ -25,14 +25,11 @@
  */
 
 #include <fstream>
-#include <string.h>
-#include <algorithm>
-
-using std::ifstream;
 
 #include <boost/filesystem.hpp>
 
 #include "io/AsciiIO.hpp"
+#include "io/AsciiParser.hpp"
 #include "io/Progress.hpp"
 #include "io/Timestamp.hpp"
 
@@ -50,162 +47,62 @@ ModelPtr AsciiIO::read(string filename)
         cout << "»" << extension << "« is not a valid file extension." << endl;
         return ModelPtr();
     }
-    // Count lines in file to estimate the number of present points
-    int lines_in_file = countLines(filename);
-
-    if ( lines_in_file < 2 )
+    // Map the file. Skip the first line (as it may contain meta
+    // data in some formats). Then try to guess the additional data
+    // from the column names in the first line or using some
+    // heuristics that apply for most data formats: If 4 values per
+    // point are given, the 4th value usually is a reflectence
+    // information. Six entries suggest RGB information, seven entries
+    // intensity and RGB.
+    AsciiParser parser(filename);
+    if ( !parser.isOpen() )
     {
-        cout << timestamp << "AsciiIO: Too few lines in file (has to be > 2)." << endl;
+        cout << timestamp << "AsciiIO: Unable to open »" << filename << "«." << endl;
         return ModelPtr();
     }
-    // Open the given file. Skip the first line (as it may
-    // contain meta data in some formats). Then try to guess
-    // the additional data using some heuristics that apply for
-    // most data formats: If 4 values per point are, given
-    // the 4th value usually is a reflectence information.
-    // Six entries suggest RGB information, seven entries
-    // intensity and RGB.
 
-    // Open file
-    ifstream in;
-    in.open(filename.c_str());
+    AsciiLayout layout = parser.guessLayout();
 
-    // Read first to lines, ignore the first one
-    char buffer[2048];
-    in.getline(buffer, 2048);
-    in.getline(buffer, 2048);
-
-    // Get number of entries in test line and analize
-    int num_attributes  = AsciiIO::getEntriesInLine(filename) - 3;
-    bool has_color      = (num_attributes == 3) || (num_attributes == 4) || (num_attributes == 5);
-    bool has_intensity  = (num_attributes == 1) || (num_attributes == 4);
-    bool has_accuracy   = num_attributes == 5;
-    bool has_validcolor = num_attributes == 5;
-
-    if ( has_color ) {
+    if ( layout.r >= 0 ) {
         cout << timestamp << "Reading color information." << endl;
     }
 
-    if ( has_intensity ) {
+    if ( layout.intensity >= 0 ) {
         cout << timestamp << "Reading intensity information." << endl;
     }
 
-    // Reopen file and read data
-    in.close();
-    in.open(filename.c_str());
-
-    // Again skip first line
-    in.getline(buffer, 2048);
-
-    // Buffer related variables
-    size_t numPoints = 0;
-
-    floatArr points;
-    ucharArr pointColors;
-    floatArr pointIntensities;
-    floatArr pointConfidences;
-
-    // Alloc memory for points
-    numPoints = lines_in_file - 1;
-    points = floatArr( new float[ numPoints * 3 ] );
-
-    // Alloc buffer memory for additional attributes
-    if ( has_color )
-    {
-        pointColors = ucharArr( new uint8_t[ numPoints * 3 ] );
+    if ( layout.nx >= 0 ) {
+        cout << timestamp << "Reading normal information." << endl;
     }
 
-    if ( has_intensity )
-    {
-        pointIntensities = floatArr( new float[ numPoints ] );
-    }
+    // Parse all lines behind the first one in parallel
+    PointBufferPtr buffer = parser.read( layout, 1 );
 
-    if ( has_accuracy )
+    if ( buffer->getNumPoints() == 0 )
     {
-        pointConfidences = floatArr( new float[ numPoints ] );
-    }
-
-    // Read data form file
-    size_t c = 0;
-    while (in.good() && c < numPoints)
-    {
-
-        //cout << has_intensity << " " << has_color << endl;
-        //cout << c << " " << m_colors << " " << m_numPoints << endl;
-        float x, y, z, i, dummy, confidence;
-        unsigned int r, g, b;
-
-        // Read according to determined format
-        if(has_intensity && has_color)
-        {
-            in >> x >> y >> z >> i >> r >> g >> b;
-            pointIntensities[c] = i;
-            pointColors[ c * 3     ] = (unsigned char) r;
-            pointColors[ c * 3 + 1 ] = (unsigned char) g;
-            pointColors[ c * 3 + 2 ] = (unsigned char) b;
-
-        }
-        else if ( has_color && has_accuracy && has_validcolor )
-        {
-            in >> x >> y >> z >> confidence >> dummy >> r >> g >> b;
-            pointConfidences[c]      = confidence;
-            pointColors[ c * 3     ] = (unsigned char) r;
-            pointColors[ c * 3 + 1 ] = (unsigned char) g;
-            pointColors[ c * 3 + 2 ] = (unsigned char) b;
-
-        }
-        else if (has_intensity)
-        {
-            in >> x >> y >> z >> i;
-            pointIntensities[c] = i;
-
-        }
-        else if(has_color)
-        {
-            in >> x >> y >> z >> r >> g >> b;
-            pointColors[ c * 3     ] = (unsigned char) r;
-            pointColors[ c * 3 + 1 ] = (unsigned char) g;
-            pointColors[ c * 3 + 2 ] = (unsigned char) b;
-        }
-        else
-        {
-            in >> x >> y >> z;
-            for(int n_dummys = 0; n_dummys < num_attributes; n_dummys++) in >> dummy;
-        }
-        points[ c * 3     ] = x;
-        points[ c * 3 + 1 ] = y;
-        points[ c * 3 + 2 ] = z;
-        c++;
+        cout << timestamp << "AsciiIO: No points found in file." << endl;
+        return ModelPtr();
     }
 
-    // Assign buffers
-    size_t numColors = 0;
-    size_t numIntensities = 0;
-    size_t numConfidences = 0;
+    ModelPtr model( new Model( buffer ) );
+    m_model = model;
 
-    if(has_color)
-    {
-        numColors = numPoints;
-    }
+    return model;
+}
 
-    if(has_intensity)
-    {
-        numIntensities = numPoints;
-    }
 
-    if(has_accuracy)
+bool AsciiIO::readChunks( string filename, PointChunkHandler &handler )
+{
+    AsciiParser parser(filename);
+    if ( !parser.isOpen() )
     {
-        numConfidences = numPoints;
+        cout << timestamp << "AsciiIO: Unable to open »" << filename << "«." << endl;
+        return false;
     }
 
-    ModelPtr model( new Model( PointBufferPtr( new PointBuffer)));
-    model->m_pointCloud->setPointArray(           points,           numPoints );
-    model->m_pointCloud->setPointColorArray(      pointColors,      numColors );
-    model->m_pointCloud->setPointIntensityArray(  pointIntensities, numIntensities );
-    model->m_pointCloud->setPointConfidenceArray( pointConfidences, numConfidences );
-    m_model = model;
-
-    return model;
+    cout << timestamp << "Streaming points from »" << filename << "«." << endl;
+    parser.readChunks( parser.guessLayout(), 1, handler );
+    return true;
 }
 
 
@@ -281,45 +178,17 @@ void AsciiIO::save( std::string filename )
 
 size_t AsciiIO::countLines(string filename)
 {
-    // Open file for reading
-    ifstream in(filename.c_str());
-
-    // Count lines in file
-    size_t c = 0;
-    char line[2048];
-    while(in.good())
-    {
-        in.getline(line, 1024);
-        c++;
-    }
-    in.close();
-    return c;
+    AsciiParser parser(filename);
+    return parser.countLines();
 }
 
 
 int AsciiIO::getEntriesInLine(string filename)
 {
-
-    ifstream in(filename.c_str());
-
-    // Get first line from file and skip it (possibly metadata)
-    char line[1024];
-    in.getline(line, 1024);
-
-    // Get second line -> hopefully point data
-    in.getline(line, 1024);
-
-    in.close();
-
-    // Get number of blanks
-    int c = 0;
-    char* pch = strtok(line, " ");
-    while(pch){
-        c++;
-        pch = strtok(NULL, " ");
-    }
-
-    return c;
+    // Skip the first line (possibly metadata) and count the
+    // values in the second line
+    AsciiParser parser(filename);
+    return AsciiParser::split( parser.getLine(1) ).size();
 }
 
 
@@ -0,0 +1,653 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * AsciiParser.cpp
+ *
+ *  @date 18.10.2026
+ */
+
+#include "io/AsciiParser.hpp"
+#include "config/lvropenmp.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace lvr
+{
+
+namespace
+{
+
+/// Number of values in an AsciiLayout
+const int numLayoutValues = 11;
+
+/// Exactly representable powers of ten
+const double powersOfTen[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool isSeparator(char c)
+{
+    return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/// Parses unusual numbers (nan, inf, hex, long exponents) with strtod
+bool parseNumberSlow(const char* begin, const char* end, float &value)
+{
+    char buffer[64];
+    size_t length = end - begin;
+    if(length >= sizeof(buffer))
+    {
+        return false;
+    }
+    memcpy(buffer, begin, length);
+    buffer[length] = 0;
+
+    char* last;
+    value = (float) strtod(buffer, &last);
+    return last == buffer + length;
+}
+
+/**
+ * @brief Parses the number in [begin, end). Decimal numbers with up to
+ *        17 significant digits and small exponents are converted
+ *        without rounding errors in double precision.
+ *
+ * @return False if the range contains no number
+ */
+bool parseNumber(const char* begin, const char* end, float &value)
+{
+    const char* p = begin;
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for(; p < end && isDigit(*p); p++, digits++)
+    {
+        if(mantissa < 100000000000000000ULL)
+        {
+            mantissa = 10 * mantissa + (*p - '0');
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+
+    if(p < end && *p == '.')
+    {
+        for(p++; p < end && isDigit(*p); p++, digits++)
+        {
+            if(mantissa < 100000000000000000ULL)
+            {
+                mantissa = 10 * mantissa + (*p - '0');
+                exponent--;
+            }
+        }
+    }
+
+    if(digits == 0)
+    {
+        return parseNumberSlow(begin, end, value);
+    }
+
+    if(p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool negativeExponent = false;
+        if(p < end && (*p == '-' || *p == '+'))
+        {
+            negativeExponent = *p == '-';
+            p++;
+        }
+
+        const char* first = p;
+        int e = 0;
+        for(; p < end && isDigit(*p); p++)
+        {
+            if(e < 10000)
+            {
+                e = 10 * e + (*p - '0');
+            }
+        }
+        if(p == first)
+        {
+            return false;
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+
+    if(p != end)
+    {
+        return false;
+    }
+
+    if(exponent < -22 || exponent > 22 || mantissa > (1ULL << 53))
+    {
+        return parseNumberSlow(begin, end, value);
+    }
+
+    double v = (double) mantissa;
+    v = exponent < 0 ? v / powersOfTen[-exponent] : v * powersOfTen[exponent];
+    value = (float) (negative ? -v : v);
+    return true;
+}
+
+/**
+ * @brief Parses the first n values of the line that starts at p and
+ *        moves p to the beginning of the next line.
+ *
+ * @return The number of parsed values or -1 if one of the first n
+ *         values is no number
+ */
+int parseLine(const char* &p, const char* end, float* values, int n)
+{
+    int count = 0;
+    while(p < end && *p != '\n' && count < n)
+    {
+        while(p < end && isSeparator(*p))
+        {
+            p++;
+        }
+        if(p == end || *p == '\n')
+        {
+            break;
+        }
+
+        const char* token = p;
+        while(p < end && *p != '\n' && !isSeparator(*p))
+        {
+            p++;
+        }
+        if(!parseNumber(token, p, values[count]))
+        {
+            count = -1;
+            break;
+        }
+        count++;
+    }
+
+    const char* next = (const char*) memchr(p, '\n', end - p);
+    p = next ? next + 1 : end;
+    return count;
+}
+
+/// Parsed data of a chunk
+struct ChunkData
+{
+    ChunkData() : numPoints(0) {}
+
+    size_t                  numPoints;
+    vector<float>           points;
+    vector<float>           intensities;
+    vector<float>           confidences;
+    vector<float>           normals;
+    vector<unsigned char>   colors;
+};
+
+inline unsigned char toColor(float v)
+{
+    return (unsigned char) std::min(255.0f, std::max(0.0f, v));
+}
+
+/// Copies the data of the chunk into arr behind the given number of values
+template<typename T>
+void copyTo(const vector<T> &data, boost::shared_array<T> &arr, size_t offset)
+{
+    if(arr && !data.empty())
+    {
+        std::copy(data.begin(), data.end(), arr.get() + offset);
+    }
+}
+
+/// Parses the lines between begin and end. Lines with less than
+/// numColumns values are ignored. Only the values of the layout are kept.
+void parseChunk(const char* begin, const char* end, const AsciiLayout &layout,
+        int numColumns, ChunkData &chunk)
+{
+    bool hasIntensity  = layout.intensity >= 0;
+    bool hasConfidence = layout.confidence >= 0;
+    bool hasColor      = layout.r >= 0 && layout.g >= 0 && layout.b >= 0;
+    bool hasNormals    = layout.nx >= 0 && layout.ny >= 0 && layout.nz >= 0;
+
+    vector<float> values(numColumns);
+    const char* p = begin;
+    while(p < end)
+    {
+        if(parseLine(p, end, &values[0], numColumns) < numColumns)
+        {
+            continue;
+        }
+
+        chunk.points.push_back(values[layout.x]);
+        chunk.points.push_back(values[layout.y]);
+        chunk.points.push_back(values[layout.z]);
+        if(hasIntensity)
+        {
+            chunk.intensities.push_back(values[layout.intensity]);
+        }
+        if(hasConfidence)
+        {
+            chunk.confidences.push_back(values[layout.confidence]);
+        }
+        if(hasColor)
+        {
+            chunk.colors.push_back(toColor(values[layout.r]));
+            chunk.colors.push_back(toColor(values[layout.g]));
+            chunk.colors.push_back(toColor(values[layout.b]));
+        }
+        if(hasNormals)
+        {
+            chunk.normals.push_back(values[layout.nx]);
+            chunk.normals.push_back(values[layout.ny]);
+            chunk.normals.push_back(values[layout.nz]);
+        }
+        chunk.numPoints++;
+    }
+}
+
+} // namespace
+
+AsciiLayout::AsciiLayout()
+    : x(0), y(1), z(2), intensity(-1), confidence(-1),
+      r(-1), g(-1), b(-1), nx(-1), ny(-1), nz(-1)
+{
+}
+
+int AsciiLayout::numColumns() const
+{
+    const int columns[numLayoutValues] = {x, y, z, intensity, confidence, r, g, b, nx, ny, nz};
+    return *std::max_element(columns, columns + numLayoutValues) + 1;
+}
+
+AsciiParser::AsciiParser(string filename)
+    : m_data(0), m_size(0), m_open(false), m_mapped(false)
+{
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd >= 0)
+    {
+        struct stat st;
+        if(fstat(fd, &st) == 0)
+        {
+            m_open = true;
+            m_size = st.st_size;
+            if(m_size > 0)
+            {
+                void* data = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(data != MAP_FAILED)
+                {
+                    m_data = (char*) data;
+                    m_mapped = true;
+                }
+            }
+        }
+        close(fd);
+    }
+#endif
+
+    // Read the whole file if it can not be mapped
+    if(!m_mapped)
+    {
+        std::ifstream in(filename.c_str(), std::ios::binary);
+        if(in.good())
+        {
+            in.seekg(0, std::ios::end);
+            m_size = in.tellg();
+            in.seekg(0, std::ios::beg);
+            m_data = m_size ? new char[m_size] : 0;
+            in.read(m_data, m_size);
+            m_open = in.good();
+        }
+    }
+}
+
+AsciiParser::~AsciiParser()
+{
+#ifndef _WIN32
+    if(m_mapped)
+    {
+        munmap(m_data, m_size);
+        return;
+    }
+#endif
+    delete[] m_data;
+}
+
+string AsciiParser::getLine(size_t n) const
+{
+    const char* begin = skip(n);
+    const char* end = m_data + m_size;
+    const char* next = (const char*) memchr(begin, '\n', end - begin);
+    if(next)
+    {
+        end = next;
+    }
+    if(end > begin && end[-1] == '\r')
+    {
+        end--;
+    }
+    return string(begin, end);
+}
+
+size_t AsciiParser::countLines() const
+{
+    if(m_size == 0)
+    {
+        return 0;
+    }
+
+    vector<const char*> chunks;
+    getChunks(m_data, chunks);
+
+    size_t lines = 0;
+    #pragma omp parallel for schedule(dynamic) reduction(+:lines)
+    for(int c = 0; c < (int)chunks.size() - 1; c++)
+    {
+        lines += std::count(chunks[c], chunks[c + 1], '\n');
+    }
+
+    // The last line may not be terminated
+    if(m_data[m_size - 1] != '\n')
+    {
+        lines++;
+    }
+    return lines;
+}
+
+AsciiLayout AsciiParser::guessLayout() const
+{
+    // Look for column names in the first line
+    vector<string> names = split(getLine(0));
+    AsciiLayout named;
+    named.x = named.y = named.z = -1;
+    for(size_t i = 0; i < names.size(); i++)
+    {
+        string name = names[i];
+        name.erase(0, name.find_first_not_of("/#"));
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        int c = (int) i;
+        if(name == "x")                                             named.x = c;
+        else if(name == "y")                                        named.y = c;
+        else if(name == "z")                                        named.z = c;
+        else if(name == "r" || name == "red")                       named.r = c;
+        else if(name == "g" || name == "green")                     named.g = c;
+        else if(name == "b" || name == "blue")                      named.b = c;
+        else if(name == "nx" || name == "normalx" || name == "normal_x") named.nx = c;
+        else if(name == "ny" || name == "normaly" || name == "normal_y") named.ny = c;
+        else if(name == "nz" || name == "normalz" || name == "normal_z") named.nz = c;
+        else if(name == "i" || name == "intensity" || name == "reflectance"
+                || name == "remission" || name == "scalar_intensity") named.intensity = c;
+        else if(name == "confidence" || name == "accuracy")        named.confidence = c;
+    }
+
+    if(named.x >= 0 && named.y >= 0 && named.z >= 0)
+    {
+        // Only complete colors and normals can be used
+        if(named.r < 0 || named.g < 0 || named.b < 0)
+        {
+            named.r = named.g = named.b = -1;
+        }
+        if(named.nx < 0 || named.ny < 0 || named.nz < 0)
+        {
+            named.nx = named.ny = named.nz = -1;
+        }
+        return named;
+    }
+
+    // Guess the attributes from the number of values in the second line
+    AsciiLayout layout;
+    int numAttributes = (int) split(getLine(1)).size() - 3;
+    switch(numAttributes)
+    {
+    case 1:
+        layout.intensity = 3;
+        break;
+    case 3:
+        layout.r = 3;
+        layout.g = 4;
+        layout.b = 5;
+        break;
+    case 4:
+        layout.intensity = 3;
+        layout.r = 4;
+        layout.g = 5;
+        layout.b = 6;
+        break;
+    case 5:
+        layout.confidence = 3;
+        layout.r = 5;
+        layout.g = 6;
+        layout.b = 7;
+        break;
+    }
+    return layout;
+}
+
+PointBufferPtr AsciiParser::read(const AsciiLayout &layout, size_t skipLines) const
+{
+    vector<const char*> chunks;
+    getChunks(skip(skipLines), chunks);
+    int numChunks = (int) chunks.size() - 1;
+
+    bool hasIntensity  = layout.intensity >= 0;
+    bool hasConfidence = layout.confidence >= 0;
+    bool hasColor      = layout.r >= 0 && layout.g >= 0 && layout.b >= 0;
+    bool hasNormals    = layout.nx >= 0 && layout.ny >= 0 && layout.nz >= 0;
+    int numColumns     = layout.numColumns();
+
+    // Parse the chunks
+    vector<ChunkData> data(std::max(numChunks, 0));
+    #pragma omp parallel for schedule(dynamic)
+    for(int c = 0; c < numChunks; c++)
+    {
+        parseChunk(chunks[c], chunks[c + 1], layout, numColumns, data[c]);
+    }
+
+    // Copy the chunks into the buffer arrays
+    vector<size_t> offsets(data.size() + 1, 0);
+    for(size_t c = 0; c < data.size(); c++)
+    {
+        offsets[c + 1] = offsets[c] + data[c].numPoints;
+    }
+    size_t numPoints = offsets.back();
+
+    floatArr points(new float[3 * numPoints]);
+    floatArr intensities;
+    floatArr confidences;
+    floatArr normals;
+    ucharArr colors;
+    if(hasIntensity)
+    {
+        intensities = floatArr(new float[numPoints]);
+    }
+    if(hasConfidence)
+    {
+        confidences = floatArr(new float[numPoints]);
+    }
+    if(hasColor)
+    {
+        colors = ucharArr(new unsigned char[3 * numPoints]);
+    }
+    if(hasNormals)
+    {
+        normals = floatArr(new float[3 * numPoints]);
+    }
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int c = 0; c < numChunks; c++)
+    {
+        size_t offset = offsets[c];
+        copyTo(data[c].points, points, 3 * offset);
+        copyTo(data[c].intensities, intensities, offset);
+        copyTo(data[c].confidences, confidences, offset);
+        copyTo(data[c].colors, colors, 3 * offset);
+        copyTo(data[c].normals, normals, 3 * offset);
+
+        // Release the chunk early
+        data[c] = ChunkData();
+    }
+
+    PointBufferPtr buffer(new PointBuffer);
+    buffer->setPointArray(points, numPoints);
+    if(hasIntensity)
+    {
+        buffer->setPointIntensityArray(intensities, numPoints);
+    }
+    if(hasConfidence)
+    {
+        buffer->setPointConfidenceArray(confidences, numPoints);
+    }
+    if(hasColor)
+    {
+        buffer->setPointColorArray(colors, numPoints);
+    }
+    if(hasNormals)
+    {
+        buffer->setPointNormalArray(normals, numPoints);
+    }
+    return buffer;
+}
+
+void AsciiParser::readChunks(const AsciiLayout &layout, size_t skipLines,
+        PointChunkHandler &handler) const
+{
+    vector<const char*> chunks;
+    getChunks(skip(skipLines), chunks);
+    int numChunks = (int) chunks.size() - 1;
+
+    // Only coordinates and normals are passed on, but lines are still
+    // required to contain all columns of the layout
+    int numColumns = layout.numColumns();
+    AsciiLayout geometry;
+    geometry.x  = layout.x;
+    geometry.y  = layout.y;
+    geometry.z  = layout.z;
+    geometry.nx = layout.nx;
+    geometry.ny = layout.ny;
+    geometry.nz = layout.nz;
+    bool hasNormals = layout.nx >= 0 && layout.ny >= 0 && layout.nz >= 0;
+
+    // Parse a group of chunks in parallel and pass them on in file order,
+    // so that only one group is held in memory
+    int groupSize = 4 * OpenMPConfig::getNumThreads();
+    vector<ChunkData> data(groupSize);
+    for(int group = 0; group < numChunks; group += groupSize)
+    {
+        int groupEnd = std::min(numChunks, group + groupSize);
+
+        #pragma omp parallel for schedule(dynamic)
+        for(int c = group; c < groupEnd; c++)
+        {
+            data[c - group] = ChunkData();
+            parseChunk(chunks[c], chunks[c + 1], geometry, numColumns, data[c - group]);
+        }
+
+        for(int c = group; c < groupEnd; c++)
+        {
+            ChunkData& chunk = data[c - group];
+            if(chunk.numPoints)
+            {
+                handler.addChunk(&chunk.points[0], hasNormals ? &chunk.normals[0] : NULL, chunk.numPoints);
+            }
+        }
+    }
+}
+
+vector<string> AsciiParser::split(const string &line)
+{
+    vector<string> values;
+    size_t i = 0;
+    while(i < line.size())
+    {
+        while(i < line.size() && isSeparator(line[i]))
+        {
+            i++;
+        }
+        size_t first = i;
+        while(i < line.size() && !isSeparator(line[i]))
+        {
+            i++;
+        }
+        if(i > first)
+        {
+            values.push_back(line.substr(first, i - first));
+        }
+    }
+    return values;
+}
+
+const char* AsciiParser::skip(size_t n) const
+{
+    const char* p = m_data;
+    const char* end = m_data + m_size;
+    for(size_t i = 0; i < n && p < end; i++)
+    {
+        const char* next = (const char*) memchr(p, '\n', end - p);
+        p = next ? next + 1 : end;
+    }
+    return p;
+}
+
+void AsciiParser::getChunks(const char* begin, vector<const char*> &chunks) const
+{
+    const char* end = m_data + m_size;
+    size_t size = end - begin;
+
+    // Use enough chunks to balance the load without making them too small
+    size_t numChunks = std::max((size_t) 4 * OpenMPConfig::getNumThreads(), size / m_chunkSize);
+    numChunks = std::max((size_t) 1, std::min(numChunks, size / m_minChunkSize));
+
+    chunks.clear();
+    chunks.push_back(begin);
+    for(size_t c = 1; c < numChunks; c++)
+    {
+        const char* p = std::max(begin + c * (size / numChunks), chunks.back());
+        const char* next = (const char*) memchr(p, '\n', end - p);
+        chunks.push_back(next ? next + 1 : end);
+    }
+    chunks.push_back(end);
+}
+
+} /* namespace lvr */
@@ -42,6 +42,22 @@ void BaseIO::save( ModelPtr m, string filename)
 }
 
 
+bool BaseIO::readChunks( string filename, PointChunkHandler &handler )
+{
+    ModelPtr model = read( filename );
+    if ( !model || !model->m_pointCloud )
+    {
+        return false;
+    }
+
+    size_t numPoints, numNormals;
+    floatArr points = model->m_pointCloud->getPointArray( numPoints );
+    floatArr normals = model->m_pointCloud->getPointNormalArray( numNormals );
+    handler.addChunk( points.get(), numNormals == numPoints ? normals.get() : NULL, numPoints );
+    return true;
+}
+
+
 void BaseIO::setModel( ModelPtr m )
 {
     m_model = m;
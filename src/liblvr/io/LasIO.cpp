@@ -33,71 +33,651 @@ using std::endl;
 #include "lasreader.hpp"
 #include "laswriter.hpp"
 
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+
+using std::vector;
+
 namespace lvr
 {
 
+/* Helpers for decoding LAS point records. */
+namespace
+{
+
+/// Sizes of the standard point records of the point formats 0 to 10
+const size_t lasRecordSizes[] = { 20, 28, 26, 34, 57, 63, 30, 36, 38, 59, 67 };
+
+/// Offsets of the GPS time in the point records or 0 if there is none
+const size_t lasTimeOffsets[] = { 0, 20, 0, 20, 20, 20, 22, 22, 22, 22, 22 };
+
+/// Offsets of the RGB values in the point records or 0 if there are none
+const size_t lasColorOffsets[] = { 0, 0, 20, 28, 0, 28, 0, 30, 30, 0, 30 };
+
+/// Sizes of the extra bytes data types 1 to 10
+const size_t lasExtraSizes[] = { 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+
+/// Extra bytes data type of a single float
+const int lasExtraFloat = 9;
+
+/// Names of the extra bytes that contain the normals
+const char* lasNormalNames[] = { "NormalX", "NormalY", "NormalZ" };
+
+/// Reads a little endian value from an unaligned position
+template<typename T>
+inline T readLE(const char* data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+/// Returns the normal component that is stored in the extra bytes with
+/// the given name or -1
+int normalComponent(const char* name)
+{
+    for(int i = 0; i < 3; i++)
+    {
+        if(strncmp(name, lasNormalNames[i], 32) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// Converts 16 bit colors to 8 bit. The standard demands colors scaled to
+/// 16 bit, but many writers store 8 bit values.
+ucharArr convertColors(const vector<uint16_t> &rgb, size_t n)
+{
+    uint16_t maxValue = 0;
+    for(size_t i = 0; i < 3 * n; i++)
+    {
+        maxValue = std::max(maxValue, rgb[i]);
+    }
+    int shift = maxValue > 255 ? 8 : 0;
+
+    ucharArr colors(new unsigned char[3 * n]);
+
+    #pragma omp parallel for
+    for(long i = 0; i < (long)(3 * n); i++)
+    {
+        colors[i] = rgb[i] >> shift;
+    }
+    return colors;
+}
+
+/// Copies a vector into a new array
+template<typename T>
+boost::shared_array<T> toArray(const vector<T> &v)
+{
+    boost::shared_array<T> array(new T[v.size()]);
+    std::copy(v.begin(), v.end(), array.get());
+    return array;
+}
+
+/// The layout of the point records of an uncompressed LAS file
+struct LasLayout
+{
+    uint32_t    dataOffset;
+    uint8_t     format;
+    uint16_t    recordSize;
+    uint64_t    numRecords;
+    double      scale[3];
+    double      offset[3];
+
+    /// Offsets of the normal components in the records or -1
+    int         normalOffsets[3];
+    bool        hasNormals;
+
+    /// Offsets of the GPS time and the colors in the records or 0
+    size_t      timeOffset;
+    size_t      colorOffset;
+};
+
+/// Reads the header and the extra bytes description of an uncompressed
+/// file. Returns false if the file is compressed or can not be decoded
+/// by copying the values, which requires a little endian host.
+bool readLasLayout(std::ifstream &in, LasLayout &layout)
+{
+    const uint16_t one = 1;
+    if(*reinterpret_cast<const uint8_t*>(&one) != 1)
+    {
+        return false;
+    }
+
+    char header[375];
+    memset(header, 0, sizeof(header));
+    in.read(header, sizeof(header));
+    if(in.gcount() < 227 || strncmp(header, "LASF", 4) != 0)
+    {
+        return false;
+    }
+
+    int versionMinor        = (uint8_t)header[25];
+    uint16_t headerSize     = readLE<uint16_t>(header + 94);
+    uint32_t numVLRs        = readLE<uint32_t>(header + 100);
+    layout.dataOffset       = readLE<uint32_t>(header + 96);
+    layout.format           = header[104];
+    layout.recordSize       = readLE<uint16_t>(header + 105);
+    layout.numRecords       = readLE<uint32_t>(header + 107);
+    if(versionMinor >= 4 && headerSize >= 375 && in.gcount() == 375)
+    {
+        // The legacy point count is 0 for the new point formats
+        uint64_t extendedNumRecords = readLE<uint64_t>(header + 247);
+        if(extendedNumRecords)
+        {
+            layout.numRecords = extendedNumRecords;
+        }
+    }
+
+    // Compressed files have the upper bits of the format set
+    if(layout.format > 10 || layout.recordSize < lasRecordSizes[layout.format])
+    {
+        return false;
+    }
+
+    for(int a = 0; a < 3; a++)
+    {
+        layout.scale[a] = readLE<double>(header + 131 + 8 * a);
+        layout.offset[a] = readLE<double>(header + 155 + 8 * a);
+        layout.normalOffsets[a] = -1;
+    }
+
+    // Search the extra bytes description for normals
+    in.clear();
+    in.seekg(headerSize);
+    for(uint32_t v = 0; v < numVLRs; v++)
+    {
+        char vlr[54];
+        in.read(vlr, sizeof(vlr));
+        if(!in.good())
+        {
+            break;
+        }
+
+        uint16_t length = readLE<uint16_t>(vlr + 20);
+        if(strncmp(vlr + 2, "LASF_Spec", 16) != 0 || readLE<uint16_t>(vlr + 18) != 4)
+        {
+            in.seekg(length, std::ios::cur);
+            continue;
+        }
+
+        vector<char> descriptors(length + 1);
+        in.read(&descriptors[0], length);
+        size_t extraOffset = lasRecordSizes[layout.format];
+        for(size_t d = 0; d + 192 <= length; d += 192)
+        {
+            uint8_t type = descriptors[d + 2];
+            uint8_t options = descriptors[d + 3];
+            int c = normalComponent(&descriptors[d + 4]);
+            if(c >= 0 && type == lasExtraFloat && extraOffset + 4 <= layout.recordSize)
+            {
+                layout.normalOffsets[c] = extraOffset;
+            }
+            extraOffset += type == 0 ? options : lasExtraSizes[(type - 1) % 10] * ((type - 1) / 10 + 1);
+        }
+    }
+
+    layout.hasNormals = layout.normalOffsets[0] >= 0
+            && layout.normalOffsets[1] >= 0
+            && layout.normalOffsets[2] >= 0;
+    layout.timeOffset = lasTimeOffsets[layout.format];
+    layout.colorOffset = lasColorOffsets[layout.format];
+
+    in.clear();
+    in.seekg(layout.dataOffset);
+    return true;
+}
+
+/// Position of records that are removed by the filters
+const size_t skipRecord = (size_t)-1;
+
+/// Applies the filters to a chunk of records that starts at the given
+/// record. The positions of the remaining records are numbered
+/// consecutively starting at numPoints, removed records get skipRecord.
+void selectRecords(const char* buffer, size_t count, uint64_t first, const LasLayout &layout,
+        const LasFilter &filter, vector<size_t> &positions, size_t &numPoints)
+{
+    size_t nth = std::max(1u, filter.everyNth);
+
+    #pragma omp parallel for
+    for(int r = 0; r < (int)count; r++)
+    {
+        const char* record = buffer + (size_t)r * layout.recordSize;
+        bool keep = (first + r) % nth == 0;
+        if(keep && filter.useBoundingBox)
+        {
+            keep = filter.inside(
+                    readLE<int32_t>(record) * layout.scale[0] + layout.offset[0],
+                    readLE<int32_t>(record + 4) * layout.scale[1] + layout.offset[1],
+                    readLE<int32_t>(record + 8) * layout.scale[2] + layout.offset[2]);
+        }
+        positions[r] = keep ? 0 : skipRecord;
+    }
+
+    // Determine the positions of the remaining points in the arrays
+    for(size_t r = 0; r < count; r++)
+    {
+        if(positions[r] != skipRecord)
+        {
+            positions[r] = numPoints++;
+        }
+    }
+}
+
+} // namespace
+
 ModelPtr LasIO::read(string filename )
 {
+    ModelPtr model = readChunked(filename);
+    if(!model)
+    {
+        model = readLaslib(filename);
+    }
 
-    // Create Lasreader object
-    LASreadOpener lasreadopener;
-    lasreadopener.set_file_name(filename.c_str());
+    m_model = model;
+    return model;
+}
 
-    if(lasreadopener.active())
+ModelPtr LasIO::readChunked(string filename)
+{
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    LasLayout layout;
+    if(!readLasLayout(in, layout))
     {
-        LASreader* lasreader = lasreadopener.open();
+        return ModelPtr();
+    }
+
+    uint64_t numRecords = layout.numRecords;
+    size_t recordSize = layout.recordSize;
+    bool hasNormals = layout.hasNormals;
+    size_t timeOffset = layout.timeOffset;
+    size_t colorOffset = layout.colorOffset;
+
+    cout << timestamp << "Reading " << numRecords << " point records of format "
+         << (int)layout.format << " from " << filename << "." << endl;
+
+    // Allocate the arrays for all points that pass the every n-th filter
+    size_t nth = std::max(1u, m_filter.everyNth);
+    size_t maxPoints = (numRecords + nth - 1) / nth;
+
+    floatArr points(new float[3 * maxPoints]);
+    floatArr intensities(new float[maxPoints]);
+    floatArr normals;
+    doubleArr times;
+    vector<uint16_t> rgb;
+    if(hasNormals)
+    {
+        normals = floatArr(new float[3 * maxPoints]);
+    }
+    if(timeOffset)
+    {
+        times = doubleArr(new double[maxPoints]);
+    }
+    if(colorOffset)
+    {
+        rgb.resize(3 * maxPoints);
+    }
+
+    size_t chunkSize = std::min((uint64_t)m_chunkSize, numRecords);
+    vector<char> buffer(chunkSize * recordSize);
+    vector<size_t> positions(chunkSize);
+    size_t numPoints = 0;
 
-        // Get number of points in file
-        size_t num_points = lasreader->npoints;
+    for(uint64_t first = 0; first < numRecords; first += chunkSize)
+    {
+        size_t count = std::min((uint64_t)chunkSize, numRecords - first);
+        in.read(&buffer[0], count * recordSize);
+        if((size_t)in.gcount() != count * recordSize)
+        {
+            cout << timestamp << "LasIO::read(): " << filename << " is truncated." << endl;
+            return ModelPtr();
+        }
 
-        // Alloc coordinate array
-        floatArr points ( new float[3 * num_points]);
-        floatArr intensities ( new float[num_points]);
-        ucharArr colors (new unsigned char[3 * num_points]);
+        selectRecords(&buffer[0], count, first, layout, m_filter, positions, numPoints);
 
-        // Read point data
-        for(size_t i = 0; i < num_points; i++)
+        // Decode the records
+        #pragma omp parallel for
+        for(int r = 0; r < (int)count; r++)
         {
-            size_t buf_pos = 3 * i;
-            lasreader->read_point();
-            points[buf_pos]     = lasreader->point.x;
-            points[buf_pos + 1] = lasreader->point.y;
-            points[buf_pos + 2] = lasreader->point.z;
+            size_t p = positions[r];
+            if(p == skipRecord)
+            {
+                continue;
+            }
+
+            const char* record = &buffer[(size_t)r * recordSize];
+            for(int a = 0; a < 3; a++)
+            {
+                points[3 * p + a] = readLE<int32_t>(record + 4 * a) * layout.scale[a] + layout.offset[a];
+            }
+            intensities[p] = readLE<uint16_t>(record + 12);
+
+            if(timeOffset)
+            {
+                times[p] = readLE<double>(record + timeOffset);
+            }
+            if(colorOffset)
+            {
+                for(int a = 0; a < 3; a++)
+                {
+                    rgb[3 * p + a] = readLE<uint16_t>(record + colorOffset + 2 * a);
+                }
+            }
+            if(hasNormals)
+            {
+                for(int a = 0; a < 3; a++)
+                {
+                    normals[3 * p + a] = readLE<float>(record + layout.normalOffsets[a]);
+                }
+            }
+        }
+    }
+
+    cout << timestamp << "Read " << numPoints << " points." << endl;
+
+    // Create point buffer and model
+    PointBufferPtr p_buffer( new PointBuffer);
+    p_buffer->setPointArray(points, numPoints);
+    p_buffer->setPointIntensityArray(intensities, numPoints);
+    if(colorOffset)
+    {
+        p_buffer->setPointColorArray(convertColors(rgb, numPoints), numPoints);
+    }
+    if(timeOffset)
+    {
+        p_buffer->setPointTimeArray(times, numPoints);
+    }
+    if(hasNormals)
+    {
+        p_buffer->setPointNormalArray(normals, numPoints);
+    }
+
+    return ModelPtr( new Model(p_buffer));
+}
 
-            // Create fake colors from intensities
-            /// TODO: Check for color attributes if possible...
-            colors[buf_pos] = lasreader->point.intensity;
-            colors[buf_pos + 1] = lasreader->point.intensity;
-            colors[buf_pos + 2] = lasreader->point.intensity;
+bool LasIO::readChunks(string filename, PointChunkHandler &handler)
+{
+    // Compressed files are read completely by laslib
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    LasLayout layout;
+    if(!readLasLayout(in, layout))
+    {
+        return BaseIO::readChunks(filename, handler);
+    }
 
-            intensities[i] = lasreader->point.intensity;
+    cout << timestamp << "Streaming " << layout.numRecords << " point records of format "
+         << (int)layout.format << " from " << filename << "." << endl;
 
+    size_t recordSize = layout.recordSize;
+    size_t chunkSize = std::min((uint64_t)m_chunkSize, layout.numRecords);
+    vector<char> buffer(chunkSize * recordSize);
+    vector<size_t> positions(chunkSize);
+    vector<float> points(3 * chunkSize);
+    vector<float> normals(layout.hasNormals ? 3 * chunkSize : 0);
+
+    for(uint64_t first = 0; first < layout.numRecords; first += chunkSize)
+    {
+        size_t count = std::min((uint64_t)chunkSize, layout.numRecords - first);
+        in.read(&buffer[0], count * recordSize);
+        if((size_t)in.gcount() != count * recordSize)
+        {
+            cout << timestamp << "LasIO::readChunks(): " << filename << " is truncated." << endl;
+            return false;
         }
 
-        // Create point buffer and model
-        PointBufferPtr p_buffer( new PointBuffer);
-        p_buffer->setPointArray(points, num_points);
-        p_buffer->setPointIntensityArray(intensities, num_points);
-        p_buffer->setPointColorArray(colors, num_points);
+        // The positions are numbered within the chunk
+        size_t numPoints = 0;
+        selectRecords(&buffer[0], count, first, layout, m_filter, positions, numPoints);
 
-        ModelPtr m_ptr( new Model(p_buffer));
-        m_model = m_ptr;
+        #pragma omp parallel for
+        for(int r = 0; r < (int)count; r++)
+        {
+            size_t p = positions[r];
+            if(p == skipRecord)
+            {
+                continue;
+            }
 
-        delete lasreader;
+            const char* record = &buffer[(size_t)r * recordSize];
+            for(int a = 0; a < 3; a++)
+            {
+                points[3 * p + a] = readLE<int32_t>(record + 4 * a) * layout.scale[a] + layout.offset[a];
+                if(layout.hasNormals)
+                {
+                    normals[3 * p + a] = readLE<float>(record + layout.normalOffsets[a]);
+                }
+            }
+        }
 
-        return m_ptr;
+        if(numPoints)
+        {
+            handler.addChunk(&points[0], layout.hasNormals ? &normals[0] : NULL, numPoints);
+        }
     }
-    else
+    return true;
+}
+
+ModelPtr LasIO::readLaslib(string filename)
+{
+    // Create Lasreader object
+    LASreadOpener lasreadopener;
+    lasreadopener.set_file_name(filename.c_str());
+
+    LASreader* lasreader = lasreadopener.active() ? lasreadopener.open() : 0;
+    if(!lasreader)
     {
         cout << timestamp << "LasIO::read(): Unable to open file " << filename << endl;
+        return ModelPtr();
+    }
+
+    // Search the extra bytes for normals
+    LASheader& header = lasreader->header;
+    int normalOffsets[3] = { -1, -1, -1 };
+    for(int i = 0; i < header.number_extra_attributes; i++)
+    {
+        int c = normalComponent(header.extra_attributes[i].name);
+        if(c >= 0 && header.extra_attributes[i].data_type == lasExtraFloat)
+        {
+            normalOffsets[c] = header.extra_attribute_array_offsets[i];
+        }
+    }
+    bool hasNormals = normalOffsets[0] >= 0 && normalOffsets[1] >= 0 && normalOffsets[2] >= 0;
+
+    vector<float> points;
+    vector<float> intensities;
+    vector<float> normals;
+    vector<double> times;
+    vector<uint16_t> rgb;
+
+    size_t nth = std::max(1u, m_filter.everyNth);
+    points.reserve(3 * (lasreader->npoints / nth + 1));
+
+    // Read point data
+    for(I64 i = 0; lasreader->read_point(); i++)
+    {
+        LASpoint& point = lasreader->point;
+        double x = point.get_x();
+        double y = point.get_y();
+        double z = point.get_z();
+        if(i % nth != 0 || !m_filter.inside(x, y, z))
+        {
+            continue;
+        }
+
+        points.push_back(x);
+        points.push_back(y);
+        points.push_back(z);
+        intensities.push_back(point.intensity);
+
+        if(point.have_gps_time)
+        {
+            times.push_back(point.gps_time);
+        }
+        if(point.have_rgb)
+        {
+            rgb.insert(rgb.end(), point.rgb, point.rgb + 3);
+        }
+        if(hasNormals)
+        {
+            for(int a = 0; a < 3; a++)
+            {
+                F32 value;
+                point.get_extra_attribute(normalOffsets[a], value);
+                normals.push_back(value);
+            }
+        }
+    }
+
+    lasreader->close();
+    delete lasreader;
+
+    // Create point buffer and model
+    size_t numPoints = intensities.size();
+    PointBufferPtr p_buffer( new PointBuffer);
+    p_buffer->setPointArray(toArray(points), numPoints);
+    p_buffer->setPointIntensityArray(toArray(intensities), numPoints);
+    if(rgb.size() == 3 * numPoints && numPoints)
+    {
+        p_buffer->setPointColorArray(convertColors(rgb, numPoints), numPoints);
     }
+    if(times.size() == numPoints && numPoints)
+    {
+        p_buffer->setPointTimeArray(toArray(times), numPoints);
+    }
+    if(hasNormals)
+    {
+        p_buffer->setPointNormalArray(toArray(normals), numPoints);
+    }
+
+    return ModelPtr( new Model(p_buffer));
 }
 
 
 void LasIO::save( string filename )
 {
-    /// TODO: Implement LAS output
-    std::cerr << "LASIO: Saving not yet implemented." << endl;
+    if(!m_model || !m_model->m_pointCloud)
+    {
+        cout << timestamp << "LasIO::save(): No point cloud to save." << endl;
+        return;
+    }
+
+    PointBufferPtr pc = m_model->m_pointCloud;
+    size_t n, numColors, numNormals, numIntensities, numTimes;
+    floatArr points      = pc->getPointArray(n);
+    ucharArr colors      = pc->getPointColorArray(numColors);
+    floatArr normals     = pc->getPointNormalArray(numNormals);
+    floatArr intensities = pc->getPointIntensityArray(numIntensities);
+    doubleArr times      = pc->getPointTimeArray(numTimes);
+
+    bool hasColors      = n > 0 && numColors == n;
+    bool hasNormals     = n > 0 && numNormals == n;
+    bool hasIntensities = n > 0 && numIntensities == n;
+    bool hasTimes       = n > 0 && numTimes == n;
+
+    LASheader header;
+    header.version_major = 1;
+    header.version_minor = 2;
+    header.point_data_format = (hasTimes ? 1 : 0) + (hasColors ? 2 : 0);
+    header.point_data_record_length = lasRecordSizes[header.point_data_format];
+    strncpy((char*)header.generating_software, "LVR", 32);
+
+    // Choose offsets and scales that cover the bounding box
+    double min[3] = { 0, 0, 0 };
+    double max[3] = { 0, 0, 0 };
+    for(size_t i = 0; i < n; i++)
+    {
+        for(int a = 0; a < 3; a++)
+        {
+            min[a] = i ? std::min(min[a], (double)points[3 * i + a]) : points[3 * i + a];
+            max[a] = i ? std::max(max[a], (double)points[3 * i + a]) : points[3 * i + a];
+        }
+    }
+
+    double scale[3];
+    for(int a = 0; a < 3; a++)
+    {
+        min[a] = floor(min[a]);
+        scale[a] = 0.001;
+        while((max[a] - min[a]) / scale[a] > 2e9)
+        {
+            scale[a] *= 10;
+        }
+    }
+    header.x_offset = min[0];
+    header.y_offset = min[1];
+    header.z_offset = min[2];
+    header.x_scale_factor = scale[0];
+    header.y_scale_factor = scale[1];
+    header.z_scale_factor = scale[2];
+
+    if(hasNormals)
+    {
+        for(int a = 0; a < 3; a++)
+        {
+            header.add_extra_attribute(LASattribute(LAS_ATTRIBUTE_F32, lasNormalNames[a], "Point normal"));
+        }
+        header.update_extra_bytes_vlr();
+        header.point_data_record_length += 3 * sizeof(F32);
+    }
+
+    LASwriteOpener laswriteopener;
+    laswriteopener.set_file_name(filename.c_str());
+    LASwriter* laswriter = laswriteopener.open(&header);
+    if(!laswriter)
+    {
+        cout << timestamp << "LasIO::save(): Unable to open file " << filename << endl;
+        return;
+    }
+
+    LASpoint point;
+    point.init(&header, header.point_data_format, header.point_data_record_length, &header);
+
+    // Stream the points into the file
+    for(size_t i = 0; i < n; i++)
+    {
+        point.set_x(points[3 * i]);
+        point.set_y(points[3 * i + 1]);
+        point.set_z(points[3 * i + 2]);
+
+        if(hasIntensities)
+        {
+            point.intensity = (U16)std::max(0.0f, std::min(65535.0f, intensities[i]));
+        }
+        if(hasColors)
+        {
+            // Scale to 16 bit
+            for(int a = 0; a < 3; a++)
+            {
+                point.rgb[a] = colors[3 * i + a] * 257;
+            }
+        }
+        if(hasTimes)
+        {
+            point.gps_time = times[i];
+        }
+        if(hasNormals)
+        {
+            for(int a = 0; a < 3; a++)
+            {
+                point.set_extra_attribute(header.extra_attribute_array_offsets[a], (F32)normals[3 * i + a]);
+            }
+        }
+
+        laswriter->write_point(&point);
+        laswriter->update_inventory(&point);
+    }
+
+    laswriter->update_header(&header, TRUE);
+    laswriter->close();
+    delete laswriter;
+
+    cout << timestamp << "Wrote " << n << " points to " << filename << "." << endl;
 }
 
 } /* namespace lvr */
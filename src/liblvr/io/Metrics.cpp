@@ -0,0 +1,186 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * Metrics.cpp
+ *
+ *  @date 18.10.2026
+ */
+
+#include "io/Metrics.hpp"
+#include "io/Timestamp.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <ctime>
+#include <algorithm>
+
+#if !defined(_MSC_VER)
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+using std::cout;
+using std::endl;
+
+namespace lvr
+{
+
+Metrics::Metrics()
+{
+    m_startTime = getWallTime();
+}
+
+Metrics& Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::begin(string phase)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    Phase& p = getPhase(phase);
+    p.wallStart = getWallTime();
+    p.cpuStart = getCPUTime();
+    p.running = true;
+}
+
+void Metrics::end(string phase, size_t items)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    map<string, Phase>::iterator it = m_phases.find(phase);
+    if(it == m_phases.end() || !it->second.running)
+    {
+        cout << timestamp << "Metrics: Phase " << phase << " was not started." << endl;
+        return;
+    }
+
+    Phase& p = it->second;
+
+    p.wallTime += getWallTime() - p.wallStart;
+    p.cpuTime += getCPUTime() - p.cpuStart;
+    p.peakRSS = std::max(p.peakRSS, getPeakRSS());
+    p.items += items;
+    p.calls++;
+    p.running = false;
+}
+
+void Metrics::addItems(string phase, size_t items)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    getPhase(phase).items += items;
+}
+
+bool Metrics::writeJSON(string filename)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    std::ofstream out(filename.c_str());
+    if(!out.good())
+    {
+        cout << timestamp << "Metrics: Unable to open " << filename << "." << endl;
+        return false;
+    }
+
+    // Phase names are plain identifiers, so they are not escaped
+    out << std::fixed << std::setprecision(6);
+    out << "{" << endl;
+    out << "  \"total_wall_time\": " << getWallTime() - m_startTime << "," << endl;
+    out << "  \"total_cpu_time\": " << getCPUTime() << "," << endl;
+    out << "  \"peak_rss_kb\": " << getPeakRSS() << "," << endl;
+    out << "  \"phases\": [" << endl;
+    for(size_t i = 0; i < m_order.size(); i++)
+    {
+        const Phase& p = m_phases[m_order[i]];
+        out << "    {" << endl;
+        out << "      \"name\": \"" << m_order[i] << "\"," << endl;
+        out << "      \"calls\": " << p.calls << "," << endl;
+        out << "      \"wall_time\": " << p.wallTime << "," << endl;
+        out << "      \"cpu_time\": " << p.cpuTime << "," << endl;
+        out << "      \"peak_rss_kb\": " << p.peakRSS << "," << endl;
+        out << "      \"items\": " << p.items << endl;
+        out << "    }" << (i + 1 < m_order.size() ? "," : "") << endl;
+    }
+    out << "  ]" << endl;
+    out << "}" << endl;
+
+    if(!out.good())
+    {
+        cout << timestamp << "Metrics: Unable to write " << filename << "." << endl;
+        return false;
+    }
+
+    cout << timestamp << "Wrote metrics to " << filename << "." << endl;
+    return true;
+}
+
+void Metrics::clear()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_phases.clear();
+    m_order.clear();
+    m_startTime = getWallTime();
+}
+
+Metrics::Phase& Metrics::getPhase(const string &phase)
+{
+    map<string, Phase>::iterator it = m_phases.find(phase);
+    if(it == m_phases.end())
+    {
+        m_order.push_back(phase);
+        it = m_phases.insert(std::make_pair(phase, Phase())).first;
+    }
+    return it->second;
+}
+
+double Metrics::getWallTime()
+{
+    return timestamp.getCurrentTimeinS();
+}
+
+double Metrics::getCPUTime()
+{
+#if defined(_MSC_VER)
+    return (double) clock() / CLOCKS_PER_SEC;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+         + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#endif
+}
+
+long Metrics::getPeakRSS()
+{
+#if defined(_MSC_VER)
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    // Reported in bytes on Mac OS
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+} /* namespace lvr */
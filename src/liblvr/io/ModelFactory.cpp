@@ -48,10 +48,16 @@ namespace lvr
 
 CoordinateTransform ModelFactory::m_transform;
 
-ModelPtr ModelFactory::readModel( std::string filename )
+namespace
 {
-    ModelPtr m;
 
+/**
+ * @brief Creates the io object for the given file or directory. Returns
+ *        NULL if the format is not supported. LAS readers get the given
+ *        filter.
+ */
+BaseIO* createIO( std::string filename, const LasFilter &lasFilter )
+{
     // Check extension
     boost::filesystem::path selectedFile( filename );
     std::string extension = selectedFile.extension().string();
@@ -70,9 +76,9 @@ ModelPtr ModelFactory::readModel( std::string filename )
     {
         io = new ObjIO;
     }
-    else if (extension == ".las")
+    else if (extension == ".las" || extension == ".laz")
     {
-        io = new LasIO;
+        io = new LasIO( lasFilter );
     }
     else if (extension ==".dat")
     {
@@ -141,6 +147,57 @@ ModelPtr ModelFactory::readModel( std::string filename )
         }
     }
 
+    return io;
+}
+
+/**
+ * @brief Applies the coordinate transformation of the model factory to
+ *        the chunks before they are passed on.
+ */
+class TransformHandler : public PointChunkHandler
+{
+public:
+    TransformHandler( PointChunkHandler &handler, const CoordinateTransform &transform )
+        : m_handler( handler ), m_transform( transform ) {}
+
+    void addChunk( const float* points, const float* normals, size_t n )
+    {
+        m_points.resize( 3 * n );
+        m_normals.resize( normals ? 3 * n : 0 );
+        for ( size_t i = 0; i < n; i++ )
+        {
+            convert( points + 3 * i, &m_points[ 3 * i ] );
+            if ( normals )
+            {
+                convert( normals + 3 * i, &m_normals[ 3 * i ] );
+            }
+        }
+        m_handler.addChunk( n ? &m_points[0] : points, normals && n ? &m_normals[0] : normals, n );
+    }
+
+private:
+
+    // Re-order and scale the coordinates
+    void convert( const float* in, float* out )
+    {
+        out[0] = in[ m_transform.x ] * m_transform.sx;
+        out[1] = in[ m_transform.y ] * m_transform.sy;
+        out[2] = in[ m_transform.z ] * m_transform.sz;
+    }
+
+    PointChunkHandler&          m_handler;
+    const CoordinateTransform&  m_transform;
+    std::vector<float>          m_points;
+    std::vector<float>          m_normals;
+};
+
+} // namespace
+
+ModelPtr ModelFactory::readModel( std::string filename, const LasFilter &lasFilter )
+{
+    ModelPtr m;
+    BaseIO* io = createIO( filename, lasFilter );
+
     // Return data model
     if( io )
     {
@@ -196,6 +253,30 @@ ModelPtr ModelFactory::readModel( std::string filename )
 
 }
 
+bool ModelFactory::readPointChunks( std::string filename, PointChunkHandler &handler,
+        const LasFilter &lasFilter )
+{
+    BaseIO* io = createIO( filename, lasFilter );
+    if ( !io )
+    {
+        return false;
+    }
+
+    bool success;
+    if ( m_transform.convert )
+    {
+        TransformHandler transformed( handler, m_transform );
+        success = io->readChunks( filename, transformed );
+    }
+    else
+    {
+        success = io->readChunks( filename, handler );
+    }
+
+    delete io;
+    return success;
+}
+
 void ModelFactory::saveModel( ModelPtr m, std::string filename)
 {
     // Get file exptension
@@ -217,6 +298,10 @@ void ModelFactory::saveModel( ModelPtr m, std::string filename)
     {
         io = new ObjIO;
     }
+    else if ( extension == ".las" || extension == ".laz" )
+    {
+        io = new LasIO;
+    }
 #ifdef _USE_PCL_
     else if (extension == ".pcd")
     {
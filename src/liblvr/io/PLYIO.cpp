@@ -34,16 +34,586 @@
 #include "io/PLYIO.hpp"
 #include "io/Timestamp.hpp"
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <sstream>
 #include <fstream>
+#include <vector>
+#include <stdint.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
+using std::vector;
 
 namespace lvr
 {
 
+const size_t PLYIO::m_chunkSize;
+
+/* Helpers for reading memory mapped binary PLY files. */
+namespace
+{
+
+/// Names of the PLY scalar types. Index modulo 8 is the type id.
+const char* plyTypeNames[] = {
+    "char", "uchar", "short", "ushort", "int", "uint", "float", "double",
+    "int8", "uint8", "int16", "uint16", "int32", "uint32", "float32", "float64"
+};
+
+/// Sizes of the PLY scalar types in bytes
+const size_t plyTypeSizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+/// A property of an element in the PLY header
+struct MappedProperty
+{
+    string name;
+    int    type;
+    int    countType;
+    bool   list;
+    size_t offset;
+};
+
+/// An element in the PLY header
+struct MappedElement
+{
+    string                 name;
+    size_t                 count;
+    vector<MappedProperty> properties;
+
+    /// Size of a record or 0 if the element contains list properties
+    size_t                 recordSize;
+
+    /// Position of the first record in the file
+    size_t                 dataOffset;
+};
+
+/// A read only memory mapping of a file
+struct MappedFile
+{
+    MappedFile() : data( NULL ), size( 0 ) {}
+    ~MappedFile()
+    {
+#ifndef _WIN32
+        if ( data )
+        {
+            munmap( data, size );
+        }
+#endif
+    }
+
+    char*  data;
+    size_t size;
+};
+
+typedef boost::shared_ptr<MappedFile> MappedFilePtr;
+
+/// Deleter for arrays that point into a mapping. Keeps the mapping alive.
+struct MappingDeleter
+{
+    MappingDeleter( MappedFilePtr f ) : file( f ) {}
+    void operator()( void* ) {}
+    MappedFilePtr file;
+};
+
+int plyType( const string &name )
+{
+    for ( int i = 0; i < 16; i++ )
+    {
+        if ( name == plyTypeNames[i] )
+        {
+            return i % 8;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Calls op.template apply<S>() with S being the C type of a PLY scalar
+ * type, so that a property is converted with a single type dispatch
+ * instead of one per value.
+ */
+template<typename Op>
+void dispatchPlyType( int type, Op &op )
+{
+    switch ( type )
+    {
+        case 0:  op.template apply<int8_t>();   break;
+        case 1:  op.template apply<uint8_t>();  break;
+        case 2:  op.template apply<int16_t>();  break;
+        case 3:  op.template apply<uint16_t>(); break;
+        case 4:  op.template apply<int32_t>();  break;
+        case 5:  op.template apply<uint32_t>(); break;
+        case 6:  op.template apply<float>();    break;
+        default: op.template apply<double>();   break;
+    }
+}
+
+/// Reads an unaligned value of a mapped record
+template<typename S>
+inline S plyRead( const char* p )
+{
+    S v;
+    memcpy( &v, p, sizeof( S ) );
+    return v;
+}
+
+/**
+ * Copies one property of count records with the given stride into every
+ * n-th element of out
+ */
+template<typename T>
+struct ColumnCopy
+{
+    const char* src;
+    size_t      stride;
+    size_t      count;
+    T*          out;
+    int         n;
+
+    template<typename S>
+    void apply()
+    {
+        #pragma omp parallel for schedule(static)
+        for ( long i = 0; i < (long) count; i++ )
+        {
+            out[ i * n ] = (T) plyRead<S>( src + i * stride );
+        }
+    }
+};
+
+/**
+ * Counts the list sizes that are not three
+ */
+struct TriangleCheck
+{
+    const char* src;
+    size_t      stride;
+    size_t      count;
+    long        invalid;
+
+    template<typename S>
+    void apply()
+    {
+        long bad = 0;
+        #pragma omp parallel for schedule(static) reduction(+:bad)
+        for ( long i = 0; i < (long) count; i++ )
+        {
+            if ( plyRead<S>( src + i * stride ) != (S) 3 )
+            {
+                bad++;
+            }
+        }
+        invalid = bad;
+    }
+};
+
+/**
+ * Copies three vertex indices per record and counts the indices that are
+ * negative or beyond the vertex count. Invalid indices are set to 0.
+ */
+struct IndexCopy
+{
+    const char*   src;
+    size_t        stride;
+    size_t        count;
+    size_t        numVertices;
+    unsigned int* out;
+    long          invalid;
+
+    template<typename S>
+    void apply()
+    {
+        long bad = 0;
+        #pragma omp parallel for schedule(static) reduction(+:bad)
+        for ( long i = 0; i < (long) count; i++ )
+        {
+            const char* record = src + i * stride;
+            for ( int j = 0; j < 3; j++ )
+            {
+                S index = plyRead<S>( record + j * sizeof( S ) );
+                if ( !( index >= (S) 0 && (double) index < (double) numVertices ) )
+                {
+                    bad++;
+                    index = 0;
+                }
+                out[ 3 * i + j ] = (unsigned int) index;
+            }
+        }
+        invalid = bad;
+    }
+};
+
+/**
+ * Parses the record count of an element. Rejects anything but a plain
+ * decimal number and counts that exceed the file size, since every record
+ * takes at least one byte.
+ */
+bool parseElementCount( const string &token, size_t fileSize, size_t &count )
+{
+    if ( token.empty() || token.size() > 20
+            || token.find_first_not_of( "0123456789" ) != string::npos )
+    {
+        return false;
+    }
+    unsigned long long value = strtoull( token.c_str(), NULL, 10 );
+    if ( value > fileSize )
+    {
+        return false;
+    }
+    count = (size_t) value;
+    return true;
+}
+
+/**
+ * Parses the header of a binary little endian PLY file. Returns false if
+ * the file has another format or the header is malformed.
+ */
+bool parseMappedHeader( const char* data, size_t size,
+        vector<MappedElement> &elements, size_t &dataOffset )
+{
+    size_t pos = 0;
+    bool format = false;
+    while ( pos < size )
+    {
+        const char* end = (const char*) memchr( data + pos, '\n', size - pos );
+        if ( !end )
+        {
+            return false;
+        }
+        string line( data + pos, end );
+        pos = end - data + 1;
+        if ( !line.empty() && line[ line.size() - 1 ] == '\r' )
+        {
+            line.erase( line.size() - 1 );
+        }
+
+        std::istringstream ss( line );
+        string keyword;
+        ss >> keyword;
+
+        if ( keyword == "format" )
+        {
+            string type, version;
+            ss >> type >> version;
+            format = ( type == "binary_little_endian" );
+        }
+        else if ( keyword == "element" )
+        {
+            MappedElement e;
+            string count;
+            ss >> e.name >> count;
+            if ( ss.fail() || !parseElementCount( count, size, e.count ) )
+            {
+                return false;
+            }
+            e.recordSize = 0;
+            e.dataOffset = 0;
+            elements.push_back( e );
+        }
+        else if ( keyword == "property" )
+        {
+            if ( elements.empty() )
+            {
+                return false;
+            }
+            MappedProperty p;
+            string type;
+            ss >> type;
+            p.list = ( type == "list" );
+            p.countType = -1;
+            if ( p.list )
+            {
+                string countType;
+                ss >> countType >> type;
+                p.countType = plyType( countType );
+                if ( p.countType < 0 )
+                {
+                    return false;
+                }
+            }
+            p.type = plyType( type );
+            ss >> p.name;
+            if ( p.type < 0 || ss.fail() )
+            {
+                return false;
+            }
+            elements.back().properties.push_back( p );
+        }
+        else if ( keyword == "end_header" )
+        {
+            break;
+        }
+        else if ( keyword != "ply" && keyword != "comment" && keyword != "obj_info" )
+        {
+            return false;
+        }
+    }
+    dataOffset = pos;
+
+    // Calculate the property offsets of fixed size records
+    for ( size_t i = 0; i < elements.size(); i++ )
+    {
+        size_t offset = 0;
+        bool fixed = true;
+        for ( size_t j = 0; j < elements[i].properties.size(); j++ )
+        {
+            MappedProperty &p = elements[i].properties[j];
+            p.offset = offset;
+            fixed = fixed && !p.list;
+            offset += plyTypeSizes[ p.type ];
+        }
+        elements[i].recordSize = fixed ? offset : 0;
+    }
+
+    return format;
+}
+
+/**
+ * Returns the property with the given name or NULL
+ */
+const MappedProperty* findProperty( const MappedElement &e, const char* name )
+{
+    for ( size_t i = 0; i < e.properties.size(); i++ )
+    {
+        if ( e.properties[i].name == name )
+        {
+            return &e.properties[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Copies n properties of count records of an element starting at record
+ * first into a packed array of n values per record.
+ */
+template<typename T>
+void deinterleave( const MappedFilePtr &file, const MappedElement &e,
+        size_t first, size_t count, const MappedProperty** props, int n, T* out )
+{
+    const char* data = file->data + e.dataOffset + first * e.recordSize;
+    for ( int j = 0; j < n; j++ )
+    {
+        ColumnCopy<T> copy = { data + props[j]->offset, e.recordSize, count, out + j, n };
+        dispatchPlyType( props[j]->type, copy );
+    }
+}
+
+/**
+ * Reads the scalar properties of a vertex or point element. Returns false
+ * if a property is only partly present.
+ */
+bool readMappedPoints( const MappedFilePtr &file, const MappedElement &e,
+        bool readColor, bool readConfidence, bool readIntensity, bool readNormals,
+        floatArr &points, ucharArr &colors, floatArr &confidences,
+        floatArr &intensities, floatArr &normals )
+{
+    const MappedProperty* xyz[3]    = { findProperty( e, "x" ),  findProperty( e, "y" ),     findProperty( e, "z" ) };
+    const MappedProperty* rgb[3]    = { findProperty( e, "red" ), findProperty( e, "green" ), findProperty( e, "blue" ) };
+    const MappedProperty* n[3]      = { findProperty( e, "nx" ), findProperty( e, "ny" ),    findProperty( e, "nz" ) };
+    const MappedProperty* confidence = findProperty( e, "confidence" );
+    const MappedProperty* intensity  = findProperty( e, "intensity" );
+
+    if ( !e.recordSize || !xyz[0] || !xyz[1] || !xyz[2] )
+    {
+        return false;
+    }
+    if ( ( readColor && rgb[0] && !( rgb[1] && rgb[2] ) )
+            || ( readNormals && n[0] && !( n[1] && n[2] ) ) )
+    {
+        return false;
+    }
+
+    // Use the mapped records directly if they only contain the
+    // coordinates as floats
+    const char* data = file->data + e.dataOffset;
+    if ( e.recordSize == 3 * sizeof( float )
+            && xyz[0]->type == 6 && xyz[0]->offset == 0
+            && xyz[1]->type == 6 && xyz[1]->offset == 4
+            && xyz[2]->type == 6 && xyz[2]->offset == 8
+            && ( (uintptr_t) data ) % sizeof( float ) == 0 )
+    {
+        points = floatArr( (float*) data, MappingDeleter( file ) );
+    }
+    else
+    {
+        points = floatArr( new float[ 3 * e.count ] );
+        deinterleave( file, e, 0, e.count, xyz, 3, points.get() );
+    }
+
+    if ( readColor && rgb[0] )
+    {
+        colors = ucharArr( new unsigned char[ 3 * e.count ] );
+        deinterleave( file, e, 0, e.count, rgb, 3, colors.get() );
+    }
+    if ( readNormals && n[0] )
+    {
+        normals = floatArr( new float[ 3 * e.count ] );
+        deinterleave( file, e, 0, e.count, n, 3, normals.get() );
+    }
+    if ( readConfidence && confidence )
+    {
+        confidences = floatArr( new float[ e.count ] );
+        deinterleave( file, e, 0, e.count, &confidence, 1, confidences.get() );
+    }
+    if ( readIntensity && intensity )
+    {
+        intensities = floatArr( new float[ e.count ] );
+        deinterleave( file, e, 0, e.count, &intensity, 1, intensities.get() );
+    }
+    return true;
+}
+
+/**
+ * Checks whether an element consists of a single list of three indices
+ * per record, i.e. whether it is a triangle list
+ */
+bool isTriangleList( const MappedFilePtr &file, const MappedElement &e, size_t offset )
+{
+    if ( e.properties.size() != 1 || !e.properties[0].list )
+    {
+        return false;
+    }
+    const MappedProperty &p = e.properties[0];
+    size_t stride = plyTypeSizes[ p.countType ] + 3 * plyTypeSizes[ p.type ];
+    if ( offset + e.count * stride > file->size )
+    {
+        return false;
+    }
+
+    TriangleCheck check = { file->data + offset, stride, e.count, 0 };
+    dispatchPlyType( p.countType, check );
+    return check.invalid == 0;
+}
+
+/**
+ * Maps a file copy-on-write, so that arrays pointing into the mapping
+ * can be modified like allocated arrays. Returns an empty pointer if the
+ * file can not be mapped or the host is not little endian, since the
+ * mapped data can only be used as is on little endian hosts.
+ */
+MappedFilePtr mapFile( const string &filename )
+{
+#ifdef _WIN32
+    return MappedFilePtr();
+#else
+    const uint16_t one = 1;
+    if ( *reinterpret_cast<const uint8_t*>( &one ) != 1 )
+    {
+        return MappedFilePtr();
+    }
+
+    int fd = open( filename.c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+        return MappedFilePtr();
+    }
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 || st.st_size == 0 )
+    {
+        close( fd );
+        return MappedFilePtr();
+    }
+
+    void* data = mmap( NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if ( data == MAP_FAILED )
+    {
+        return MappedFilePtr();
+    }
+
+    MappedFilePtr file( new MappedFile );
+    file->data = (char*) data;
+    file->size = st.st_size;
+    return file;
+#endif
+}
+
+/**
+ * Sets the data offsets of the elements whose records start at the given
+ * offset and returns the vertex, point and face elements. Elements behind
+ * a variable sized element that is not a triangle list can not be
+ * located. Returns false if a needed element can not be located or the
+ * faces are not stored as a known index list.
+ */
+bool locateElements( const MappedFilePtr &file, vector<MappedElement> &elements,
+        size_t offset, bool readFaces, MappedElement* &vertexElement,
+        MappedElement* &pointElement, MappedElement* &faceElement )
+{
+    vertexElement = NULL;
+    pointElement  = NULL;
+    faceElement   = NULL;
+    bool located = true;
+    for ( size_t i = 0; i < elements.size(); i++ )
+    {
+        MappedElement &e = elements[i];
+        bool needed = e.name == "vertex" || e.name == "point" || ( e.name == "face" && readFaces );
+        if ( !located )
+        {
+            if ( needed )
+            {
+                return false;
+            }
+            continue;
+        }
+
+        e.dataOffset = offset;
+        if ( e.recordSize )
+        {
+            offset += e.count * e.recordSize;
+        }
+        else if ( isTriangleList( file, e, offset ) )
+        {
+            const MappedProperty &p = e.properties[0];
+            offset += e.count * ( plyTypeSizes[ p.countType ] + 3 * plyTypeSizes[ p.type ] );
+        }
+        else if ( needed )
+        {
+            return false;
+        }
+        else
+        {
+            located = false;
+            continue;
+        }
+
+        if ( offset > file->size )
+        {
+            return false;
+        }
+
+        if ( e.name == "vertex" )
+        {
+            vertexElement = &e;
+        }
+        else if ( e.name == "point" )
+        {
+            pointElement = &e;
+        }
+        else if ( e.name == "face" && readFaces && e.count )
+        {
+            /* Only the index lists that are also read by rply are used. */
+            const string &list = e.properties[0].name;
+            if ( list != "vertex_indices" && list != "vertex_index" )
+            {
+                return false;
+            }
+            faceElement = &e;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+
 
 void PLYIO::save( string filename )
 {
@@ -392,6 +962,15 @@ ModelPtr PLYIO::read( string filename, bool readColor, bool readConfidence,
         bool readIntensity, bool readNormals, bool readFaces )
 {
 
+    /* Try to read the file from a memory mapping first. */
+    ModelPtr mapped = readMapped( filename, readColor, readConfidence,
+            readIntensity, readNormals, readFaces );
+    if ( mapped )
+    {
+        m_model = mapped;
+        return mapped;
+    }
+
     /* Start reading new PLY */
     p_ply ply = ply_open( filename.c_str(), NULL, 0, NULL );
 
@@ -414,6 +993,12 @@ ModelPtr PLYIO::read( string filename, bool readColor, bool readConfidence,
     long int n;
     p_ply_element elem  = NULL;
 
+    /* Every element takes at least one byte, so larger counts are
+     * malformed. */
+    std::ifstream in( filename.c_str(), std::ios::binary | std::ios::ate );
+    long int fileSize = (long int) in.tellg();
+    in.close();
+
     // Buffer count variables
     size_t numVertices              = 0;
     size_t numVertexColors          = 0;
@@ -431,6 +1016,13 @@ ModelPtr PLYIO::read( string filename, bool readColor, bool readConfidence,
     while ( ( elem = ply_get_next_element( ply, elem ) ) )
     {
         ply_get_element_info( elem, &name, &n );
+        if ( n < 0 || n > fileSize )
+        {
+            std::cerr << timestamp << "Invalid number of " << name
+                << " elements in ply." << std::endl;
+            ply_close( ply );
+            return ModelPtr();
+        }
         if ( !strcmp( name, "vertex" ) )
         {
             numVertices = n;
@@ -608,8 +1200,14 @@ ModelPtr PLYIO::read( string filename, bool readColor, bool readConfidence,
 
     if ( face )
     {
-        ply_set_read_cb( ply, "face", "vertex_indices", readFaceCb, &face, 0 );
-        ply_set_read_cb( ply, "face", "vertex_index", readFaceCb, &face, 0 );
+        /* Faces without a known index list are not read at all. */
+        if ( !ply_set_read_cb( ply, "face", "vertex_indices", readFaceCb, &face, 0 )
+                && !ply_set_read_cb( ply, "face", "vertex_index", readFaceCb, &face, 0 ) )
+        {
+            faceIndices.reset();
+            numFaces = 0;
+            face = NULL;
+        }
     }
 
     if ( point )
@@ -676,6 +1274,21 @@ ModelPtr PLYIO::read( string filename, bool readColor, bool readConfidence,
 
     ply_close( ply );
 
+    /* Reject faces referring to vertices that do not exist. */
+    if ( faceIndices && vertices )
+    {
+        for ( size_t i = 0; i < 3 * numFaces; i++ )
+        {
+            if ( faceIndices[ i ] >= numVertices )
+            {
+                std::cerr << timestamp << "»" << filename << "« contains a face "
+                    << "with vertex index " << faceIndices[ i ] << ", but only "
+                    << numVertices << " vertices." << std::endl;
+                return ModelPtr();
+            }
+        }
+    }
+
 
     // Save buffers in model
     PointBufferPtr pc;
@@ -708,6 +1321,183 @@ ModelPtr PLYIO::read( string filename, bool readColor, bool readConfidence,
 }
 
 
+ModelPtr PLYIO::readMapped( string filename, bool readColor, bool readConfidence,
+        bool readIntensity, bool readNormals, bool readFaces )
+{
+#ifdef _WIN32
+    return ModelPtr();
+#else
+    MappedFilePtr file = mapFile( filename );
+    if ( !file )
+    {
+        return ModelPtr();
+    }
+
+    vector<MappedElement> elements;
+    size_t offset;
+    MappedElement* vertexElement;
+    MappedElement* pointElement;
+    MappedElement* faceElement;
+    if ( !parseMappedHeader( file->data, file->size, elements, offset )
+            || !locateElements( file, elements, offset, readFaces,
+                vertexElement, pointElement, faceElement ) )
+    {
+        return ModelPtr();
+    }
+
+    if ( !( vertexElement || pointElement ) )
+    {
+        return ModelPtr();
+    }
+
+    /* If there are neither faces nor points, the vertices are meant to be
+     * points. */
+    if ( vertexElement && !pointElement && !faceElement )
+    {
+        std::cout << timestamp << "PLY contains neither faces nor points. "
+            << "Assuming that vertices are meant to be points." << std::endl;
+        pointElement  = vertexElement;
+        vertexElement = NULL;
+    }
+
+    PointBufferPtr pc;
+    MeshBufferPtr mesh;
+
+    if ( pointElement )
+    {
+        floatArr points, confidences, intensities, normals;
+        ucharArr colors;
+        if ( !readMappedPoints( file, *pointElement, readColor, readConfidence,
+                    readIntensity, readNormals, points, colors, confidences,
+                    intensities, normals ) )
+        {
+            return ModelPtr();
+        }
+
+        size_t n = pointElement->count;
+        pc = PointBufferPtr( new PointBuffer );
+        pc->setPointArray(           points,      n );
+        pc->setPointColorArray(      colors,      colors      ? n : 0 );
+        pc->setPointIntensityArray(  intensities, intensities ? n : 0 );
+        pc->setPointConfidenceArray( confidences, confidences ? n : 0 );
+        pc->setPointNormalArray(     normals,     normals     ? n : 0 );
+    }
+
+    if ( vertexElement )
+    {
+        floatArr vertices, confidences, intensities, normals;
+        ucharArr colors;
+        if ( !readMappedPoints( file, *vertexElement, readColor, readConfidence,
+                    readIntensity, readNormals, vertices, colors, confidences,
+                    intensities, normals ) )
+        {
+            return ModelPtr();
+        }
+
+        uintArr faces;
+        size_t numFaces = 0;
+        if ( faceElement )
+        {
+            const MappedProperty &p = faceElement->properties[0];
+            size_t stride = plyTypeSizes[ p.countType ] + 3 * plyTypeSizes[ p.type ];
+            const char* faceData = file->data + faceElement->dataOffset + plyTypeSizes[ p.countType ];
+
+            numFaces = faceElement->count;
+            faces = uintArr( new unsigned int[ 3 * numFaces ] );
+
+            IndexCopy copy = { faceData, stride, numFaces, vertexElement->count, faces.get(), 0 };
+            dispatchPlyType( p.type, copy );
+
+            /* Leave the error message to the rply reader, which rejects
+             * the same faces. */
+            if ( copy.invalid )
+            {
+                return ModelPtr();
+            }
+        }
+
+        size_t n = vertexElement->count;
+        mesh = MeshBufferPtr( new MeshBuffer );
+        mesh->setVertexArray(           vertices,    n );
+        mesh->setVertexColorArray(      colors,      colors      ? n : 0 );
+        mesh->setVertexIntensityArray(  intensities, intensities ? n : 0 );
+        mesh->setVertexNormalArray(     normals,     normals     ? n : 0 );
+        mesh->setVertexConfidenceArray( confidences, confidences ? n : 0 );
+        mesh->setFaceArray(             faces,       numFaces );
+    }
+
+    std::cout << timestamp << "Loaded »" << filename << "« from memory mapping." << std::endl;
+
+    return ModelPtr( new Model( mesh, pc ) );
+#endif
+}
+
+
+bool PLYIO::readChunks( string filename, PointChunkHandler &handler )
+{
+    MappedFilePtr file = mapFile( filename );
+    vector<MappedElement> elements;
+    size_t offset;
+    MappedElement* vertexElement = NULL;
+    MappedElement* pointElement  = NULL;
+    MappedElement* faceElement   = NULL;
+    if ( file && parseMappedHeader( file->data, file->size, elements, offset ) )
+    {
+        locateElements( file, elements, offset, false,
+                vertexElement, pointElement, faceElement );
+    }
+
+    /* Vertices are only points if there are neither points nor faces. */
+    MappedElement* e = pointElement;
+    if ( !e )
+    {
+        e = vertexElement;
+        for ( size_t i = 0; i < elements.size(); i++ )
+        {
+            if ( elements[i].name == "face" && elements[i].count )
+            {
+                e = NULL;
+            }
+        }
+    }
+
+    const MappedProperty* xyz[3] = { NULL, NULL, NULL };
+    const MappedProperty* n[3]   = { NULL, NULL, NULL };
+    if ( e && e->recordSize )
+    {
+        xyz[0] = findProperty( *e, "x" );
+        xyz[1] = findProperty( *e, "y" );
+        xyz[2] = findProperty( *e, "z" );
+        n[0] = findProperty( *e, "nx" );
+        n[1] = findProperty( *e, "ny" );
+        n[2] = findProperty( *e, "nz" );
+    }
+    if ( !xyz[0] || !xyz[1] || !xyz[2] )
+    {
+        return BaseIO::readChunks( filename, handler );
+    }
+    bool hasNormals = n[0] && n[1] && n[2];
+
+    std::cout << timestamp << "Streaming " << e->count << " points from »"
+        << filename << "«." << std::endl;
+
+    size_t chunkSize = std::min( m_chunkSize, e->count );
+    vector<float> points( 3 * chunkSize );
+    vector<float> normals( hasNormals ? 3 * chunkSize : 0 );
+    for ( size_t first = 0; first < e->count; first += chunkSize )
+    {
+        size_t count = std::min( chunkSize, e->count - first );
+        deinterleave( file, *e, first, count, xyz, 3, &points[0] );
+        if ( hasNormals )
+        {
+            deinterleave( file, *e, first, count, n, 3, &normals[0] );
+        }
+        handler.addChunk( &points[0], hasNormals ? &normals[0] : NULL, count );
+    }
+    return true;
+}
+
+
 int PLYIO::readVertexCb( p_ply_argument argument )
 {
     float ** ptr;
@@ -40,7 +40,8 @@ PointBuffer::PointBuffer() :
     m_numPointColors( 0 ),
     m_numPointNormals( 0 ),
     m_numPointIntensities( 0 ),
-    m_numPointConfidence( 0 )
+    m_numPointConfidence( 0 ),
+    m_numPointTimes( 0 )
     {
         /* coordf must be the exact size of three floats to cast the float
          * array to a coordf array. */
@@ -53,6 +54,7 @@ PointBuffer::PointBuffer() :
         m_pointIntensities.reset();
         m_pointNormals.reset();
 		m_pointColors.reset();
+        m_pointTimes.reset();
     }
 
 
@@ -101,6 +103,15 @@ floatArr PointBuffer::getPointConfidenceArray( size_t &n )
 }
 
 
+doubleArr PointBuffer::getPointTimeArray( size_t &n )
+{
+
+    n = m_numPointTimes;
+    return m_pointTimes;
+
+}
+
+
 size_t PointBuffer::getNumPoints()
 {
 
@@ -228,6 +239,15 @@ void PointBuffer::setPointConfidenceArray( floatArr array, size_t n )
 }
 
 
+void PointBuffer::setPointTimeArray( doubleArr array, size_t n )
+{
+
+    m_numPointTimes = n;
+    m_pointTimes = array;
+
+}
+
+
 void PointBuffer::freeBuffer()
 {
     m_pointConfidences.reset();
@@ -235,8 +255,9 @@ void PointBuffer::freeBuffer()
     m_pointNormals.reset();
     m_points.reset();
     m_pointColors.reset();
+    m_pointTimes.reset();
     m_numPoints = m_numPointColors = m_numPointIntensities
-        = m_numPointConfidence = m_numPointNormals = 0;
+        = m_numPointConfidence = m_numPointNormals = m_numPointTimes = 0;
 
 }
 
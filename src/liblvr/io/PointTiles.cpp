@@ -0,0 +1,278 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * PointTiles.cpp
+ *
+ *  @date 18.10.2026
+ */
+
+#include "io/PointTiles.hpp"
+#include "io/Timestamp.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+#include <algorithm>
+
+using std::cout;
+using std::endl;
+
+namespace lvr
+{
+
+PointTiles::PointTiles(string directory, const float origin[3], float voxelsize,
+        int tileCells, int overlapCells, size_t bufferBudget)
+    : m_bufferBudget(bufferBudget),
+      m_buffered(0),
+      m_directory(directory),
+      m_createdDirectory(false),
+      m_voxelsize(voxelsize),
+      m_tileCells(tileCells),
+      m_overlapCells(overlapCells),
+      m_stride(0)
+{
+    for(int i = 0; i < 3; i++)
+    {
+        m_origin[i] = origin[i];
+    }
+
+    m_createdDirectory = boost::filesystem::create_directories(m_directory);
+}
+
+PointTiles::~PointTiles()
+{
+    map<uint64_t, Tile>::iterator it;
+    for(it = m_tiles.begin(); it != m_tiles.end(); it++)
+    {
+        std::remove(it->second.file.c_str());
+    }
+
+    // Only remove an empty directory that was created for the tiles
+    if(m_createdDirectory)
+    {
+        boost::system::error_code error;
+        boost::filesystem::remove(m_directory, error);
+    }
+}
+
+void PointTiles::addPoints(const float* points, const float* normals, size_t n)
+{
+    int stride = normals ? 6 : 3;
+    if(m_stride == 0)
+    {
+        m_stride = stride;
+    }
+    else if(m_stride != stride)
+    {
+        cout << timestamp << "PointTiles: Normals have to be given for all or none of the points." << endl;
+        return;
+    }
+
+    for(size_t p = 0; p < n; p++)
+    {
+        // Calculate the grid cell of the point the same way as the
+        // reconstruction grid does and the range of tiles that
+        // contain the cell or share it as overlap
+        int first[3];
+        int last[3];
+        for(int a = 0; a < 3; a++)
+        {
+            float f = (points[3 * p + a] - m_origin[a]) / m_voxelsize;
+            int c = f < 0 ? f - .5 : f + .5;
+            first[a] = tileIndex(c - m_overlapCells);
+            last[a] = tileIndex(c + m_overlapCells);
+        }
+
+        for(int i = first[0]; i <= last[0]; i++)
+        {
+            for(int j = first[1]; j <= last[1]; j++)
+            {
+                for(int k = first[2]; k <= last[2]; k++)
+                {
+                    Tile& tile = getTile(i, j, k);
+                    tile.buffer.insert(tile.buffer.end(), &points[3 * p], &points[3 * p] + 3);
+                    if(normals)
+                    {
+                        tile.buffer.insert(tile.buffer.end(), &normals[3 * p], &normals[3 * p] + 3);
+                    }
+                    tile.numPoints++;
+                    m_buffered += stride;
+                }
+            }
+        }
+
+        // The budget is shared by all tiles, so tiles that receive many
+        // points get large buffers and are written in few large blocks
+        if(m_buffered > m_bufferBudget)
+        {
+            flushLargest();
+        }
+    }
+}
+
+void PointTiles::flush()
+{
+    map<uint64_t, Tile>::iterator it;
+    for(it = m_tiles.begin(); it != m_tiles.end(); it++)
+    {
+        flushTile(it->second);
+    }
+}
+
+void PointTiles::getTile(size_t n, int &i, int &j, int &k)
+{
+    Tile& tile = tileAt(n);
+    i = tile.i;
+    j = tile.j;
+    k = tile.k;
+}
+
+size_t PointTiles::numPoints(size_t n)
+{
+    return tileAt(n).numPoints;
+}
+
+PointBufferPtr PointTiles::loadTile(size_t n)
+{
+    Tile& tile = tileAt(n);
+    flushTile(tile);
+
+    PointBufferPtr buffer(new PointBuffer);
+    floatArr points(new float[3 * tile.numPoints]);
+    floatArr normals;
+    if(m_stride == 6)
+    {
+        normals = floatArr(new float[3 * tile.numPoints]);
+    }
+
+    std::ifstream in(tile.file.c_str(), std::ios::binary);
+    vector<float> data(m_bufferSize - m_bufferSize % m_stride);
+    size_t pointsPerRead = data.size() / m_stride;
+    size_t p = 0;
+    while(p < tile.numPoints && in.good())
+    {
+        size_t count = std::min(pointsPerRead, tile.numPoints - p);
+        in.read(reinterpret_cast<char*>(&data[0]), count * m_stride * sizeof(float));
+        for(size_t i = 0; i < count; i++, p++)
+        {
+            for(int a = 0; a < 3; a++)
+            {
+                points[3 * p + a] = data[i * m_stride + a];
+                if(normals)
+                {
+                    normals[3 * p + a] = data[i * m_stride + 3 + a];
+                }
+            }
+        }
+    }
+
+    if(p < tile.numPoints)
+    {
+        cout << timestamp << "PointTiles: Unable to read " << tile.file << "." << endl;
+        return PointBufferPtr();
+    }
+
+    buffer->setPointArray(points, tile.numPoints);
+    if(normals)
+    {
+        buffer->setPointNormalArray(normals, tile.numPoints);
+    }
+    return buffer;
+}
+
+void PointTiles::flushTile(Tile &tile)
+{
+    if(tile.buffer.empty())
+    {
+        return;
+    }
+
+    std::ofstream out(tile.file.c_str(), std::ios::binary | std::ios::app);
+    out.write(reinterpret_cast<const char*>(&tile.buffer[0]), tile.buffer.size() * sizeof(float));
+    if(!out.good())
+    {
+        cout << timestamp << "PointTiles: Unable to write " << tile.file << "." << endl;
+    }
+
+    // Release the memory, the budget only counts buffered floats
+    m_buffered -= tile.buffer.size();
+    vector<float>().swap(tile.buffer);
+}
+
+void PointTiles::flushLargest()
+{
+    vector<std::pair<size_t, Tile*> > buffers;
+    map<uint64_t, Tile>::iterator it;
+    for(it = m_tiles.begin(); it != m_tiles.end(); it++)
+    {
+        if(!it->second.buffer.empty())
+        {
+            buffers.push_back(std::make_pair(it->second.buffer.size(), &it->second));
+        }
+    }
+    std::sort(buffers.begin(), buffers.end());
+
+    for(size_t i = buffers.size(); i > 0 && m_buffered > m_bufferBudget / 2; i--)
+    {
+        flushTile(*buffers[i - 1].second);
+    }
+}
+
+PointTiles::Tile& PointTiles::getTile(int i, int j, int k)
+{
+    uint64_t key = tileKey(i, j, k);
+    map<uint64_t, Tile>::iterator it = m_tiles.find(key);
+    if(it != m_tiles.end())
+    {
+        return it->second;
+    }
+
+    std::stringstream name;
+    name << "tile_" << i << "_" << j << "_" << k << ".bin";
+
+    Tile& tile = m_tiles[key];
+    tile.i = i;
+    tile.j = j;
+    tile.k = k;
+    tile.numPoints = 0;
+    tile.file = (boost::filesystem::path(m_directory) / name.str()).string();
+
+    // Remove leftovers of previous runs
+    std::remove(tile.file.c_str());
+    return tile;
+}
+
+PointTiles::Tile& PointTiles::tileAt(size_t n)
+{
+    if(m_order.size() != m_tiles.size())
+    {
+        m_order.clear();
+        map<uint64_t, Tile>::iterator it;
+        for(it = m_tiles.begin(); it != m_tiles.end(); it++)
+        {
+            m_order.push_back(&it->second);
+        }
+    }
+    return *m_order[n];
+}
+
+} /* namespace lvr */
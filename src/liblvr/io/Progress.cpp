@@ -29,6 +29,7 @@
 
 #include <sstream>
 #include <iostream>
+#include <limits>
 
 using std::stringstream;
 using std::cout;
@@ -45,8 +46,9 @@ ProgressBar::ProgressBar(size_t max_val, string prefix)
 {
 	m_prefix = prefix;
 	m_maxVal = max_val;
-    m_currentVal = 0;
+	m_currentVal = 0;
 	m_percent = 0;
+	m_nextVal = max_val > 0 ? (max_val + 99) / 100 : std::numeric_limits<size_t>::max();
 
 	if(m_titleCallback)
 	{
@@ -74,27 +76,35 @@ void ProgressBar::setProgressTitleCallback(ProgressTitleCallbackPtr ptr)
 
 void ProgressBar::operator++()
 {
-    boost::mutex::scoped_lock lock(m_mutex);
-
-    m_currentVal++;
-    short difference = (short)((float)m_currentVal/m_maxVal * 100 - m_percent);
-    if (difference < 1)
-    {
-        return;
-    }
-
-    while (difference >= 1)
-    {
-        m_percent++;
-        difference--;
-        print_bar();
-
-        if(m_progressCallback)
-        {
-        	m_progressCallback(m_percent);
-        }
-    }
+	*this += 1;
+}
+
+void ProgressBar::operator+=(size_t n)
+{
+	size_t val = m_currentVal.fetch_add(n, std::memory_order_relaxed) + n;
+
+	// Only increments that complete a new percent have to print
+	if(val < m_nextVal.load(std::memory_order_relaxed))
+	{
+		return;
+	}
 
+	boost::mutex::scoped_lock lock(m_mutex);
+
+	int percent = (int)(m_currentVal.load(std::memory_order_relaxed) * 100 / m_maxVal);
+	while(m_percent < percent)
+	{
+		m_percent++;
+		print_bar();
+
+		if(m_progressCallback)
+		{
+			m_progressCallback(m_percent);
+		}
+	}
+
+	// Smallest counter value of the next percent
+	m_nextVal.store(((size_t)(m_percent + 1) * m_maxVal + 99) / 100, std::memory_order_relaxed);
 }
 
 void ProgressBar::print_bar()
@@ -111,17 +121,17 @@ ProgressCounter::ProgressCounter(int stepVal, string prefix)
 
 void ProgressCounter::operator++()
 {
-	boost::mutex::scoped_lock lock(m_mutex);
-	m_currentVal++;
-	if(m_currentVal % m_stepVal == 0)
+	size_t val = m_currentVal.fetch_add(1, std::memory_order_relaxed) + 1;
+	if(val % m_stepVal == 0)
 	{
-		print_progress();
+		boost::mutex::scoped_lock lock(m_mutex);
+		print_progress(val);
 	}
 }
 
-void ProgressCounter::print_progress()
+void ProgressCounter::print_progress(size_t val)
 {
-	cout << "\r" << m_prefix << " " << m_currentVal << flush;
+	cout << "\r" << m_prefix << " " << val << flush;
 }
 
 
@@ -0,0 +1,303 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * ScanCache.cpp
+ *
+ *  @date 18.10.2026
+ */
+
+#include "io/ScanCache.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace lvr
+{
+
+namespace
+{
+
+const char cacheMagic[8] = {'L', 'V', 'R', 'S', 'C', 'A', 'N', 0};
+
+/// A cache file in memory. Mapped if possible, otherwise copied.
+struct CacheData
+{
+    CacheData() : data(0), size(0), mapped(false) {}
+    ~CacheData()
+    {
+#ifndef _WIN32
+        if(mapped)
+        {
+            munmap(data, size);
+            return;
+        }
+#endif
+        delete[] data;
+    }
+
+    char*   data;
+    size_t  size;
+    bool    mapped;
+};
+
+typedef boost::shared_ptr<CacheData> CacheDataPtr;
+
+/// Deleter for arrays that point into a cache file. Keeps the data alive.
+struct CacheDeleter
+{
+    CacheDeleter(CacheDataPtr d) : data(d) {}
+    void operator()(void*) {}
+    CacheDataPtr data;
+};
+
+CacheDataPtr openCache(const string &filename)
+{
+    CacheDataPtr cache(new CacheData);
+
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        return CacheDataPtr();
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        // Map copy-on-write, so that the arrays can be modified
+        void* data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if(data != MAP_FAILED)
+        {
+            cache->data = (char*) data;
+            cache->size = st.st_size;
+            cache->mapped = true;
+        }
+    }
+    close(fd);
+    if(cache->mapped)
+    {
+        return cache;
+    }
+#endif
+
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    if(!in.good())
+    {
+        return CacheDataPtr();
+    }
+    in.seekg(0, std::ios::end);
+    cache->size = in.tellg();
+    in.seekg(0, std::ios::beg);
+    cache->data = new char[cache->size];
+    in.read(cache->data, cache->size);
+    return in.good() ? cache : CacheDataPtr();
+}
+
+/// Gets size and modification time of the given file
+bool getFileState(const string &filename, uint64_t &size, int64_t &time)
+{
+    boost::system::error_code error;
+    size = boost::filesystem::file_size(filename, error);
+    if(error)
+    {
+        return false;
+    }
+    time = boost::filesystem::last_write_time(filename, error);
+    return !error;
+}
+
+} // namespace
+
+ScanCache::ScanCache(string scanFile, string poseFile)
+    : m_scanFile(scanFile),
+      m_poseFile(poseFile)
+{
+    boost::filesystem::path path(scanFile);
+    m_cacheFile = path.replace_extension(".lvrcache").string();
+}
+
+PointBufferPtr ScanCache::load(Matrix4<float> &pose) const
+{
+    Header expected;
+    if(!getSourceState(expected))
+    {
+        return PointBufferPtr();
+    }
+
+    CacheDataPtr cache = openCache(m_cacheFile);
+    if(!cache || cache->size < sizeof(Header))
+    {
+        return PointBufferPtr();
+    }
+
+    // Check that the cache belongs to the current source files
+    Header header;
+    memcpy(&header, cache->data, sizeof(Header));
+    if(memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0
+            || header.version != m_version
+            || header.scanSize != expected.scanSize
+            || header.scanTime != expected.scanTime
+            || header.poseSize != expected.poseSize
+            || header.poseTime != expected.poseTime
+            || cache->size != fileSize(header))
+    {
+        return PointBufferPtr();
+    }
+
+    pose = Matrix4<float>(header.pose);
+
+    size_t n = header.numPoints;
+    char* data = cache->data + sizeof(Header);
+
+    PointBufferPtr scan(new PointBuffer);
+    scan->setPointArray(floatArr((float*) data, CacheDeleter(cache)), n);
+    data += 3 * n * sizeof(float);
+
+    if(header.attributes & INTENSITIES)
+    {
+        scan->setPointIntensityArray(floatArr((float*) data, CacheDeleter(cache)), n);
+        data += n * sizeof(float);
+    }
+
+    if(header.attributes & COLORS)
+    {
+        scan->setPointColorArray(ucharArr((unsigned char*) data, CacheDeleter(cache)), n);
+    }
+
+    return scan;
+}
+
+bool ScanCache::save(PointBufferPtr scan, Matrix4<float> pose) const
+{
+    Header header;
+    if(!getSourceState(header))
+    {
+        return false;
+    }
+
+    size_t n, numIntensities, numColors;
+    floatArr points = scan->getPointArray(n);
+    floatArr intensities = scan->getPointIntensityArray(numIntensities);
+    ucharArr colors = scan->getPointColorArray(numColors);
+
+    header.attributes = 0;
+    if(intensities && numIntensities == n)
+    {
+        header.attributes |= INTENSITIES;
+    }
+    if(colors && numColors == n)
+    {
+        header.attributes |= COLORS;
+    }
+    header.numPoints = n;
+    memcpy(header.pose, pose.getData(), sizeof(header.pose));
+
+    // Bounding box of the transformed points
+    for(int a = 0; a < 3; a++)
+    {
+        header.boundingBox[a] = std::numeric_limits<float>::max();
+        header.boundingBox[a + 3] = -std::numeric_limits<float>::max();
+    }
+    for(size_t i = 0; i < n; i++)
+    {
+        for(int a = 0; a < 3; a++)
+        {
+            header.boundingBox[a] = std::min(header.boundingBox[a], points[3 * i + a]);
+            header.boundingBox[a + 3] = std::max(header.boundingBox[a + 3], points[3 * i + a]);
+        }
+    }
+
+    // Write to a temporary file first, so that concurrent readers never
+    // see an incomplete cache
+    string tmpFile = m_cacheFile + ".tmp";
+    std::ofstream out(tmpFile.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    if(n)
+    {
+        out.write(reinterpret_cast<const char*>(points.get()), 3 * n * sizeof(float));
+        if(header.attributes & INTENSITIES)
+        {
+            out.write(reinterpret_cast<const char*>(intensities.get()), n * sizeof(float));
+        }
+        if(header.attributes & COLORS)
+        {
+            out.write(reinterpret_cast<const char*>(colors.get()), 3 * n);
+        }
+    }
+    out.close();
+
+    if(!out.good())
+    {
+        std::remove(tmpFile.c_str());
+        return false;
+    }
+
+    boost::system::error_code error;
+    boost::filesystem::rename(tmpFile, m_cacheFile, error);
+    if(error)
+    {
+        std::remove(tmpFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ScanCache::getSourceState(Header &header) const
+{
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = m_version;
+
+    if(!getFileState(m_scanFile, header.scanSize, header.scanTime))
+    {
+        return false;
+    }
+
+    return m_poseFile.empty() || getFileState(m_poseFile, header.poseSize, header.poseTime);
+}
+
+size_t ScanCache::fileSize(const Header &header)
+{
+    size_t n = header.numPoints;
+    size_t size = sizeof(Header) + 3 * n * sizeof(float);
+    if(header.attributes & INTENSITIES)
+    {
+        size += n * sizeof(float);
+    }
+    if(header.attributes & COLORS)
+    {
+        size += 3 * n;
+    }
+    return size;
+}
+
+} /* namespace lvr */
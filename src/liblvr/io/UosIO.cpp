@@ -35,6 +35,7 @@
 #include <cmath>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
 
 using std::list;
 using std::vector;
@@ -45,7 +46,8 @@ using std::stringstream;
 //using namespace boost::filesystem;
 
 
-#include "io/Progress.hpp"
+#include "io/AsciiParser.hpp"
+#include "io/ScanCache.hpp"
 #include "io/Timestamp.hpp"
 
 namespace lvr
@@ -196,33 +198,33 @@ void UosIO::reduce(string dir, string target, int reduction)
 
 void UosIO::readNewFormat(ModelPtr &model, string dir, int first, int last, size_t &n)
 {
-    list<Vertex<float> > allPoints;
-    list<Vertex<int> > allColors;
+    vector<float> allPoints;
+    vector<unsigned char> allColors;
 
     size_t point_counter = 0;
 
     vector<indexPair> sub_clouds;
 
-    // Count points in all given files
-    size_t numPointsTotal = 0;
-    for(int fileCounter = first; fileCounter <= last; fileCounter++)
-    {
-        // Create scan file name
-        boost::filesystem::path scan_path(
-                boost::filesystem::path(dir) /
-                boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".3d" ) );
-        string scanFileName = "/" + scan_path.relative_path().string();
-
-        // Count lines in scan
-        numPointsTotal += AsciiIO::countLines(scanFileName);
-    }
-
     // Calculate the number of points to skip when writing to disk
     size_t skipPoints = 1;
 
     if(m_reductionTarget > 1)
     {
-        skipPoints = (int)numPointsTotal / m_reductionTarget;
+        // Count points in all given files
+        size_t numPointsTotal = 0;
+        for(int fileCounter = first; fileCounter <= last; fileCounter++)
+        {
+            // Create scan file name
+            boost::filesystem::path scan_path(
+                    boost::filesystem::path(dir) /
+                    boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".3d" ) );
+            string scanFileName = "/" + scan_path.relative_path().string();
+
+            // Count lines in scan
+            numPointsTotal += AsciiIO::countLines(scanFileName);
+        }
+
+        skipPoints = std::max((size_t)1, numPointsTotal / m_reductionTarget);
     }
 
     if(m_saveToDisk)
@@ -232,257 +234,106 @@ void UosIO::readNewFormat(ModelPtr &model, string dir, int first, int last, size
 
     for(int fileCounter = first; fileCounter <= last; fileCounter++)
     {
-        // New (unit) transformation matrix
-        Matrix4<float> tf;
-
-        // Input file streams for scan data, poses and frames
-        ifstream scan_in, pose_in, frame_in;
-
-        // Create scan file name
-        boost::filesystem::path scan_path(
-                boost::filesystem::path(dir) /
-                boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".3d" ) );
-        string scanFileName = "/" + scan_path.relative_path().string();
-
-        // Count lines in scan
-        size_t points_in_file = AsciiIO::countLines(scanFileName);
-
-        int num_attributes = AsciiIO::getEntriesInLine(scanFileName) - 3;
-        bool has_color = (num_attributes == 3) || (num_attributes == 4);
-        bool has_intensity = (num_attributes == 1) || (num_attributes == 4);
-
-        if(has_color)
+        // Read the transformed scan
+        PointBufferPtr scan = readScan(dir, fileCounter);
+        if(!scan)
         {
-            cout << timestamp << "Reading color information." << endl;
-        }
-
-        if(has_intensity)
-        {
-            cout << timestamp << "Reading intensity information." << endl;
-        }
-
-        // Read scan data
-        scan_in.open(scanFileName.c_str());
-        if(!scan_in.good())
-        {
-            // Continue with next file if the expected file couldn't be read
-            cout << timestamp << "UOS Reader: Unable to read scan " << scanFileName << endl;
-            scan_in.close();
-            scan_in.clear();
             continue;
         }
-        else
-        {
-            // Tmp list of read points
-            list<Vertex<float> > tmp_points;
 
+        size_t numScanPoints, numValues;
+        floatArr points = scan->getPointArray(numScanPoints);
+        floatArr intensities = scan->getPointIntensityArray(numValues);
+        ucharArr colors = scan->getPointColorArray(numValues);
 
-            // Try to get fransformation from .frames file
-            boost::filesystem::path frame_path(
-                    boost::filesystem::path(dir) /
-                    boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".frames" ) );
-            string frameFileName = "/" + frame_path.relative_path().string();
+        // Save index of first point of new scan
+        size_t firstIndex = allPoints.size() / 3;
 
-            frame_in.open(frameFileName.c_str());
-            if(!frame_in.good())
-            {
-                // Try to parse .pose file
-                boost::filesystem::path pose_path(
-                        boost::filesystem::path(dir) /
-                        boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".pose" ) );
-                string poseFileName = "/" + pose_path.relative_path().string();
-
-                pose_in.open(poseFileName.c_str());
-                if(pose_in.good())
-                {
-                    float euler[6];
-                    for(int i = 0; i < 6; i++) pose_in >> euler[i];
-                    Vertex<float> position(euler[0], euler[1], euler[2]);
-                    Vertex<float> angle(euler[3], euler[4], euler[5]);
-                    tf = Matrix4<float>(position, angle);
-                }
-                else
-                {
-                    cout << timestamp << "UOS Reader: Warning: No position information found." << endl;
-                    tf = Matrix4<float>();
-                }
+        // Code branching for point converter!
+        if(!m_saveToDisk)
+        {
+            allPoints.insert(allPoints.end(), points.get(), points.get() + 3 * numScanPoints);
 
-            }
-            else
+            if(colors)
             {
-                // Use transformation from .frame files
-                tf = parseFrameFile(frame_in);
-
+                allColors.insert(allColors.end(), colors.get(), colors.get() + 3 * numScanPoints);
             }
-
-            // Print pose information
-            float euler[6];
-            tf.toPostionAngle(euler);
-
-            cout << timestamp << "Processing " << scanFileName << " @ "
-                << euler[0] << " " << euler[1] << " " << euler[2] << " "
-                << euler[3] << " " << euler[4] << " " << euler[5] << endl;
-
-            // Skip first line in scan file (maybe metadata)
-            char dummy[1024];
-            scan_in.getline(dummy, 1024);
-
-            // Setup info output
-            string comment = timestamp.getElapsedTime() + "Reading file " + scanFileName;
-            ProgressBar progress(points_in_file, comment);
-
-            // Read all points
-            while(scan_in.good())
+        }
+        else if(m_outputFile.good())
+        {
+            for(size_t i = 0; i < numScanPoints; i++)
             {
-                float x, y, z, rem, dummy;
-                int r, g, b;
-
-                point_counter ++;
-
-                if(has_intensity && !has_color)
-                {
-                    scan_in >> x >> y >> z >> rem;
-                }
-                else if(has_intensity && has_color)
+                point_counter++;
+                if(point_counter % skipPoints != 0)
                 {
-                    scan_in >> x >> y >> z >> rem >> r >> g >> b;
-                    allColors.push_back(Vertex<int> (r, g, b));
+                    continue;
                 }
-                else if(has_color && !has_intensity)
-                {
-                    scan_in >> x >> y >> z >> r >> g >> b;
-                    allColors.push_back(Vertex<int> (r, g, b));
-                }
-                else
+
+                m_outputFile << points[3 * i] << " " << points[3 * i + 1] << " " << points[3 * i + 2] << " ";
+
+                // Save remission values if present
+                float rem = intensities ? intensities[i] : 0;
+                if(intensities && m_saveRemission)
                 {
-                    scan_in >> x >> y >> z;
-                    for(int n_dummys = 0; n_dummys < num_attributes; n_dummys++) scan_in >> dummy;
+                    m_outputFile << rem << " ";
                 }
 
-                Vertex<float> point(x, y, z);
-                Vertex<unsigned char> color;
-
-                // Code branching for point converter!
-                if(!m_saveToDisk)
+                // Save color values if present
+                if(colors)
                 {
-                    tmp_points.push_back(point);
+                    m_outputFile << (int) colors[3 * i] << " "
+                                 << (int) colors[3 * i + 1] << " "
+                                 << (int) colors[3 * i + 2];
                 }
-                else
+                else if(m_saveRemissionColor)
                 {
-                    if(m_outputFile.good())
-                    {
-                        if(point_counter % skipPoints == 0)
-                        {
-                            point.transform(tf);
-                            m_outputFile << point[0] << " " << point[1] << " " << point[2] << " ";
-
-                            // Save remission values if present
-                            if(has_intensity && m_saveRemission)
-                            {
-                                m_outputFile << rem << " ";
-                            }
-
-                            // Save color values if present
-                            if(has_color)
-                            {
-                                m_outputFile << r << " " << g << " " << b;
-                            }
-                            else if(m_saveRemissionColor)
-                            {
-                                r = g = b = rem;
-                                m_outputFile << r << " " << g << " " << b;
-                            }
-                            m_outputFile << endl;
-                        }
-                    }
+                    int r, g, b;
+                    r = g = b = rem;
+                    m_outputFile << r << " " << g << " " << b;
                 }
-                ++progress;
-            }
-
-            // Save index of first point of new scan
-            size_t firstIndex;
-            if(allPoints.size() > 0)
-            {
-                firstIndex = allPoints.size();
-            }
-            else
-            {
-                firstIndex = 0;
-            }
-
-            // Transform scan point with current matrix
-            list<Vertex<float> >::iterator it, it1;
-            for(it = tmp_points.begin(); it != tmp_points.end(); it++)
-            {
-                Vertex<float> v = *it;
-                v.transform(tf);
-                allPoints.push_back(v);
-            }
-
-            // Save last index
-            size_t lastIndex;
-            if(allPoints.size() > 0)
-            {
-                lastIndex = allPoints.size() - 1;
-            }
-            else
-            {
-                lastIndex = 0;
+                m_outputFile << endl;
             }
+        }
 
-            // Save index pair for current scan
-            sub_clouds.push_back(make_pair(firstIndex, lastIndex));
-            m_numScans++;
+        // Save last index
+        size_t lastIndex;
+        if(allPoints.size() > 0)
+        {
+            lastIndex = allPoints.size() / 3 - 1;
         }
-        cout << endl;
+        else
+        {
+            lastIndex = 0;
+        }
+
+        // Save index pair for current scan
+        sub_clouds.push_back(make_pair(firstIndex, lastIndex));
+        m_numScans++;
     }
 
     // Convert into array
     if ( allPoints.size() )
     {
-        cout << timestamp << "UOS Reader: Read " << allPoints.size() << " points." << endl;
+        size_t numPoints = allPoints.size() / 3;
+        cout << timestamp << "UOS Reader: Read " << numPoints << " points." << endl;
 
         // Save position information
+        floatArr points( new float[allPoints.size()] );
+        std::copy(allPoints.begin(), allPoints.end(), points.get());
 
-        size_t numPoints(0);
-        floatArr points;
+        // Save color information if all scans have colors
         ucharArr pointColors;
-
-
-        numPoints = allPoints.size();
-        points = floatArr( new float[3 * allPoints.size()] );
-        list<Vertex<float> >::iterator p_it;
-        size_t i(0);
-        for( p_it = allPoints.begin(); p_it != allPoints.end(); p_it++ )
+        if ( allColors.size() == allPoints.size() )
         {
-            Vertex<float> v = *p_it;
-            points[i    ] = v[0];
-            points[i + 1] = v[1];
-            points[i + 2] = v[2];
-            i += 3;
-        }
-
-        // Save color information
-        if ( allColors.size() )
-        {
-            pointColors = ucharArr( new unsigned char[ 3 * numPoints ] );
-            i = 0;
-            list<Vertex<int> >::iterator c_it;
-            for(c_it = allColors.begin(); c_it != allColors.end(); c_it++)
-            {
-                Vertex<int> v = *c_it;
-                pointColors[i    ] = (unsigned char) v[0];
-                pointColors[i + 1] = (unsigned char) v[1];
-                pointColors[i + 2] = (unsigned char) v[2];
-                i += 3;
-            }
+            pointColors = ucharArr( new unsigned char[allColors.size()] );
+            std::copy(allColors.begin(), allColors.end(), pointColors.get());
         }
 
         // Create point cloud in model
         model = ModelPtr( new Model );
         model->m_pointCloud = PointBufferPtr( new PointBuffer );
         model->m_pointCloud->setPointArray( points, numPoints );
-        model->m_pointCloud->setPointColorArray(pointColors, numPoints);
+        model->m_pointCloud->setPointColorArray(pointColors, pointColors ? numPoints : 0);
 
         // Add sub cloud information
         for(size_t i = 0; i < sub_clouds.size(); i++)
@@ -493,6 +344,144 @@ void UosIO::readNewFormat(ModelPtr &model, string dir, int first, int last, size
 
 }
 
+PointBufferPtr UosIO::readScan(string dir, int number)
+{
+    // New (unit) transformation matrix
+    Matrix4<float> tf;
+
+    // Input file streams for poses and frames
+    ifstream pose_in, frame_in;
+
+    // Create scan, frame and pose file names
+    boost::filesystem::path scan_path(
+            boost::filesystem::path(dir) /
+            boost::filesystem::path( "scan" + to_string( number, 3 ) + ".3d" ) );
+    string scanFileName = "/" + scan_path.relative_path().string();
+
+    boost::filesystem::path frame_path(
+            boost::filesystem::path(dir) /
+            boost::filesystem::path( "scan" + to_string( number, 3 ) + ".frames" ) );
+    string frameFileName = "/" + frame_path.relative_path().string();
+
+    boost::filesystem::path pose_path(
+            boost::filesystem::path(dir) /
+            boost::filesystem::path( "scan" + to_string( number, 3 ) + ".pose" ) );
+    string poseFileName = "/" + pose_path.relative_path().string();
+
+    // The pose is taken from the .frames file if present. The cache
+    // depends on the file the pose is read from.
+    string poseSource;
+    if(boost::filesystem::exists(frameFileName))
+    {
+        poseSource = frameFileName;
+    }
+    else if(boost::filesystem::exists(poseFileName))
+    {
+        poseSource = poseFileName;
+    }
+
+    ScanCache cache(scanFileName, poseSource);
+    PointBufferPtr scan;
+    if(m_useCache)
+    {
+        scan = cache.load(tf);
+    }
+
+    if(scan)
+    {
+        float euler[6];
+        tf.toPostionAngle(euler);
+
+        cout << timestamp << "Loaded " << cache.filename() << " @ "
+            << euler[0] << " " << euler[1] << " " << euler[2] << " "
+            << euler[3] << " " << euler[4] << " " << euler[5] << endl;
+        return scan;
+    }
+
+    // Map scan data
+    AsciiParser parser(scanFileName);
+    if(!parser.isOpen())
+    {
+        // Continue with next file if the expected file couldn't be read
+        cout << timestamp << "UOS Reader: Unable to read scan " << scanFileName << endl;
+        return PointBufferPtr();
+    }
+
+    int num_attributes = (int)AsciiParser::split(parser.getLine(1)).size() - 3;
+    bool has_color = (num_attributes == 3) || (num_attributes == 4);
+    bool has_intensity = (num_attributes == 1) || (num_attributes == 4);
+
+    AsciiLayout layout;
+
+    if(has_color)
+    {
+        cout << timestamp << "Reading color information." << endl;
+        layout.r = has_intensity ? 4 : 3;
+        layout.g = layout.r + 1;
+        layout.b = layout.r + 2;
+    }
+
+    if(has_intensity)
+    {
+        cout << timestamp << "Reading intensity information." << endl;
+        layout.intensity = 3;
+    }
+
+    // Try to get fransformation from .frames file
+    frame_in.open(frameFileName.c_str());
+    if(!frame_in.good())
+    {
+        // Try to parse .pose file
+        pose_in.open(poseFileName.c_str());
+        if(pose_in.good())
+        {
+            float euler[6];
+            for(int i = 0; i < 6; i++) pose_in >> euler[i];
+            Vertex<float> position(euler[0], euler[1], euler[2]);
+            Vertex<float> angle(euler[3], euler[4], euler[5]);
+            tf = Matrix4<float>(position, angle);
+        }
+        else
+        {
+            cout << timestamp << "UOS Reader: Warning: No position information found." << endl;
+            tf = Matrix4<float>();
+        }
+
+    }
+    else
+    {
+        // Use transformation from .frame files
+        tf = parseFrameFile(frame_in);
+
+    }
+
+    // Print pose information
+    float euler[6];
+    tf.toPostionAngle(euler);
+
+    cout << timestamp << "Processing " << scanFileName << " @ "
+        << euler[0] << " " << euler[1] << " " << euler[2] << " "
+        << euler[3] << " " << euler[4] << " " << euler[5] << endl;
+
+    // Read all points. Skip first line in scan file (maybe metadata)
+    scan = parser.read(layout, 1);
+
+    // Transform scan points with current matrix
+    size_t numScanPoints;
+    floatArr points = scan->getPointArray(numScanPoints);
+    if(points)
+    {
+        tf.transformPoints(points.get(), numScanPoints);
+    }
+
+    if(m_useCache && !cache.save(scan, tf))
+    {
+        cout << timestamp << "UOS Reader: Unable to write " << cache.filename() << endl;
+    }
+
+    return scan;
+}
+
 void UosIO::readOldFormat(ModelPtr &model, string dir, int first, int last, size_t &n)
 {
     Matrix4<float> m_tf;
@@ -0,0 +1,83 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/**
+ * BrickIndex.cpp
+ *
+ *  @date 18.10.2026
+ */
+
+#include "reconstruction/BrickIndex.hpp"
+
+namespace lvr
+{
+
+const unsigned int BrickIndex::INVALID;
+const size_t BrickIndex::NO_BRICK;
+
+BrickIndex::BrickIndex()
+{
+
+}
+
+size_t BrickIndex::findBrick(int i, int j, int k, Cursor &cursor) const
+{
+    uint64_t key = brickKey(i, j, k);
+    if(key == cursor.key && cursor.offset != NO_BRICK)
+    {
+        return cursor.offset;
+    }
+
+    unordered_map<uint64_t, size_t>::const_iterator it = m_brickOffsets.find(key);
+    if(it == m_brickOffsets.end())
+    {
+        return NO_BRICK;
+    }
+
+    cursor.key = key;
+    cursor.offset = it->second;
+    return cursor.offset;
+}
+
+size_t BrickIndex::createBrick(int i, int j, int k)
+{
+    size_t offset = findBrick(i, j, k, m_insertCursor);
+    if(offset != NO_BRICK)
+    {
+        return offset;
+    }
+
+    // Allocate a new brick with invalid entries
+    uint64_t key = brickKey(i, j, k);
+    offset = m_values.size();
+    m_values.resize(offset + BRICK_VOLUME, INVALID);
+    m_brickOffsets[key] = offset;
+
+    m_insertCursor.key = key;
+    m_insertCursor.offset = offset;
+    return offset;
+}
+
+void BrickIndex::clear()
+{
+    m_brickOffsets.clear();
+    m_values.clear();
+    m_insertCursor = Cursor();
+}
+
+} /* namespace lvr */
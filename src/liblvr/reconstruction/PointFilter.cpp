@@ -0,0 +1,441 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/**
+ * PointFilter.cpp
+ *
+ *  @date 18.10.2026
+ */
+
+#include "reconstruction/PointFilter.hpp"
+#include "reconstruction/ParallelSort.hpp"
+#include "reconstruction/SearchTreeStann.hpp"
+#include "reconstruction/SearchTreeNanoflann.hpp"
+#ifdef _USE_PCL_
+#include "reconstruction/SearchTreeFlann.hpp"
+#endif
+#ifdef _USE_NABO
+#include "reconstruction/SearchTreeNabo.hpp"
+#endif
+#include "io/Timestamp.hpp"
+#include "io/Progress.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <stdint.h>
+
+namespace lvr
+{
+
+const size_t PointFilter::m_blockSize;
+
+namespace
+{
+
+/// Copies the entries with the given indices. Every entry consists of
+/// width values.
+template<typename T>
+boost::shared_array<T> gather(boost::shared_array<T> source, int width, const vector<size_t> &indices)
+{
+    boost::shared_array<T> target(new T[width * indices.size()]);
+
+    #pragma omp parallel for
+    for(long i = 0; i < (long)indices.size(); i++)
+    {
+        for(int j = 0; j < width; j++)
+        {
+            target[width * i + j] = source[width * indices[i] + j];
+        }
+    }
+    return target;
+}
+
+/// Averages the entries of the runs of points [first[v], first[v + 1])
+/// of the given order. Every entry consists of width values.
+template<typename T>
+boost::shared_array<T> average(boost::shared_array<T> source, int width,
+        const vector<std::pair<uint64_t, size_t> > &order, const vector<size_t> &first)
+{
+    size_t numRuns = first.size() - 1;
+    boost::shared_array<T> target(new T[width * numRuns]);
+    double rounding = std::numeric_limits<T>::is_integer ? 0.5 : 0.0;
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(long v = 0; v < (long)numRuns; v++)
+    {
+        double sum[3] = {0.0, 0.0, 0.0};
+        for(size_t i = first[v]; i < first[v + 1]; i++)
+        {
+            for(int j = 0; j < width; j++)
+            {
+                sum[j] += source[width * order[i].second + j];
+            }
+        }
+
+        double count = first[v + 1] - first[v];
+        for(int j = 0; j < width; j++)
+        {
+            target[width * v + j] = (T)(sum[j] / count + rounding);
+        }
+    }
+    return target;
+}
+
+} /* anonymous namespace */
+
+PointFilter::PointFilter(PointBufferPtr buffer, string searchTreeName)
+    : m_buffer(buffer), m_searchTreeName(searchTreeName)
+{
+}
+
+PointFilter::~PointFilter()
+{
+}
+
+void PointFilter::createSearchTree()
+{
+    size_t n;
+    m_buffer->getPointArray(n);
+
+    if(m_searchTreeName == "flann" || m_searchTreeName == "FLANN")
+    {
+#ifdef _USE_PCL_
+        m_searchTree = SearchTree<Vertex<float> >::Ptr(new SearchTreeFlann<Vertex<float> >(m_buffer, n));
+        return;
+#else
+        cout << timestamp << "Warning: PCL is not installed. Using STANN search tree in PointFilter." << endl;
+#endif
+    }
+    else if(m_searchTreeName == "nanoflann" || m_searchTreeName == "NANOFLANN")
+    {
+        m_searchTree = SearchTree<Vertex<float> >::Ptr(new SearchTreeNanoflann<Vertex<float> >(m_buffer, n));
+        return;
+    }
+#ifdef _USE_NABO
+    else if(m_searchTreeName == "nabo" || m_searchTreeName == "NABO")
+    {
+        m_searchTree = SearchTree<Vertex<float> >::Ptr(new SearchTreeNabo<Vertex<float> >(m_buffer, n));
+        return;
+    }
+#endif
+    else if(m_searchTreeName != "stann" && m_searchTreeName != "STANN")
+    {
+        cout << timestamp << "Unknown search tree " << m_searchTreeName << ". Using STANN search tree in PointFilter." << endl;
+    }
+
+    m_searchTree = SearchTree<Vertex<float> >::Ptr(new SearchTreeStann<Vertex<float> >(m_buffer, n));
+}
+
+void PointFilter::applyOutlierRemoval(int meank, float thresh)
+{
+    size_t n;
+    floatArr points = m_buffer->getPointArray(n);
+    if(n < 2 || meank < 1)
+    {
+        return;
+    }
+
+    createSearchTree();
+
+    // The point itself is found as its own nearest neighbor with
+    // distance 0, so one additional neighbor is searched.
+    int k = meank + 1;
+    vector<float> meanDistances(n);
+    long numBlocks = (n + m_blockSize - 1) / m_blockSize;
+
+    string comment = timestamp.getElapsedTime() + "Calculating mean neighbor distances ";
+    ProgressBar progress(numBlocks, comment);
+
+    #pragma omp parallel
+    {
+        vector<ulong> indices(m_blockSize * k);
+        vector<float> distances(m_blockSize * k);
+        vector<int> found(m_blockSize);
+
+        #pragma omp for schedule(dynamic)
+        for(long b = 0; b < numBlocks; b++)
+        {
+            size_t first = b * m_blockSize;
+            size_t count = std::min(m_blockSize, n - first);
+            m_searchTree->kSearchBatch(points.get() + 3 * first, count, k, &indices[0], &distances[0], &found[0]);
+
+            for(size_t i = 0; i < count; i++)
+            {
+                double sum = 0.0;
+                for(int j = 0; j < found[i]; j++)
+                {
+                    sum += sqrt(distances[i * k + j]);
+                }
+                meanDistances[first + i] = found[i] > 1 ? sum / (found[i] - 1) : 0.0f;
+            }
+            ++progress;
+        }
+    }
+    cout << endl;
+
+    // Mean and standard deviation of the mean distances
+    double sum = 0.0;
+    double squares = 0.0;
+    #pragma omp parallel for reduction(+:sum,squares)
+    for(long i = 0; i < (long)n; i++)
+    {
+        sum += meanDistances[i];
+        squares += (double)meanDistances[i] * meanDistances[i];
+    }
+    double mean = sum / n;
+    double deviation = sqrt(std::max(0.0, (squares - sum * sum / n) / (n - 1)));
+    double limit = mean + thresh * deviation;
+
+    vector<size_t> inliers;
+    inliers.reserve(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        if(meanDistances[i] <= limit)
+        {
+            inliers.push_back(i);
+        }
+    }
+
+    cout << timestamp << "Statistical outlier removal: mean distance " << mean << ", deviation " << deviation
+         << ". Removed " << n - inliers.size() << " of " << n << " points." << endl;
+    select(inliers);
+}
+
+void PointFilter::applyRadiusOutlierRemoval(float radius, int minNeighbors)
+{
+    size_t n;
+    floatArr points = m_buffer->getPointArray(n);
+    if(n == 0 || minNeighbors < 1)
+    {
+        return;
+    }
+
+    createSearchTree();
+
+    // A point is kept if its minNeighbors nearest neighbors apart from
+    // itself lie within the radius
+    int k = minNeighbors + 1;
+    float squaredRadius = radius * radius;
+    vector<unsigned char> keep(n);
+    long numBlocks = (n + m_blockSize - 1) / m_blockSize;
+
+    string comment = timestamp.getElapsedTime() + "Counting neighbors ";
+    ProgressBar progress(numBlocks, comment);
+
+    #pragma omp parallel
+    {
+        vector<ulong> indices(m_blockSize * k);
+        vector<float> distances(m_blockSize * k);
+        vector<int> found(m_blockSize);
+
+        #pragma omp for schedule(dynamic)
+        for(long b = 0; b < numBlocks; b++)
+        {
+            size_t first = b * m_blockSize;
+            size_t count = std::min(m_blockSize, n - first);
+            m_searchTree->kSearchBatch(points.get() + 3 * first, count, k, &indices[0], &distances[0], &found[0]);
+
+            for(size_t i = 0; i < count; i++)
+            {
+                int inside = 0;
+                for(int j = 0; j < found[i]; j++)
+                {
+                    if(distances[i * k + j] <= squaredRadius)
+                    {
+                        inside++;
+                    }
+                }
+                keep[first + i] = inside >= k;
+            }
+            ++progress;
+        }
+    }
+    cout << endl;
+
+    vector<size_t> inliers;
+    inliers.reserve(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        if(keep[i])
+        {
+            inliers.push_back(i);
+        }
+    }
+
+    cout << timestamp << "Radius outlier removal: Removed " << n - inliers.size() << " of " << n << " points." << endl;
+    select(inliers);
+}
+
+void PointFilter::applyVoxelGrid(float voxelsize)
+{
+    size_t n;
+    floatArr points = m_buffer->getPointArray(n);
+    if(n == 0 || voxelsize <= 0)
+    {
+        return;
+    }
+
+    float min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for(size_t i = 0; i < n; i++)
+    {
+        for(int a = 0; a < 3; a++)
+        {
+            min[a] = std::min(min[a], points[3 * i + a]);
+            max[a] = std::max(max[a], points[3 * i + a]);
+        }
+    }
+
+    // Voxel positions are packed into 21 bits per dimension
+    const uint64_t mask = (1 << 21) - 1;
+    for(int a = 0; a < 3; a++)
+    {
+        if((max[a] - min[a]) / voxelsize >= mask)
+        {
+            cout << timestamp << "Voxel grid filter: Voxelsize " << voxelsize << " is too small for the extent of the points." << endl;
+            return;
+        }
+    }
+
+    // Sort the points by their voxel keys
+    vector<std::pair<uint64_t, size_t> > order(n);
+    #pragma omp parallel for
+    for(long i = 0; i < (long)n; i++)
+    {
+        uint64_t key = 0;
+        for(int a = 0; a < 3; a++)
+        {
+            uint64_t p = (uint64_t)((points[3 * i + a] - min[a]) / voxelsize);
+            key = (key << 21) | (p & mask);
+        }
+        order[i] = std::make_pair(key, (size_t)i);
+    }
+    parallelSort(order);
+
+    // Points with equal keys lie in the same voxel
+    vector<size_t> first;
+    for(size_t i = 0; i < n; i++)
+    {
+        if(i == 0 || order[i].first != order[i - 1].first)
+        {
+            first.push_back(i);
+        }
+    }
+    first.push_back(n);
+    size_t numVoxels = first.size() - 1;
+
+    size_t numNormals, numColors, numIntensities, numConfidences, numTimes;
+    floatArr normals = m_buffer->getPointNormalArray(numNormals);
+    ucharArr colors = m_buffer->getPointColorArray(numColors);
+    floatArr intensities = m_buffer->getPointIntensityArray(numIntensities);
+    floatArr confidences = m_buffer->getPointConfidenceArray(numConfidences);
+    doubleArr times = m_buffer->getPointTimeArray(numTimes);
+
+    PointBufferPtr buffer(new PointBuffer);
+    buffer->setPointArray(average(points, 3, order, first), numVoxels);
+
+    if(normals && numNormals == n)
+    {
+        floatArr centroidNormals = average(normals, 3, order, first);
+
+        #pragma omp parallel for
+        for(long v = 0; v < (long)numVoxels; v++)
+        {
+            float* normal = centroidNormals.get() + 3 * v;
+            float length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if(length > 0)
+            {
+                normal[0] /= length;
+                normal[1] /= length;
+                normal[2] /= length;
+            }
+        }
+        buffer->setPointNormalArray(centroidNormals, numVoxels);
+    }
+    if(colors && numColors == n)
+    {
+        buffer->setPointColorArray(average(colors, 3, order, first), numVoxels);
+    }
+    if(intensities && numIntensities == n)
+    {
+        buffer->setPointIntensityArray(average(intensities, 1, order, first), numVoxels);
+    }
+    if(confidences && numConfidences == n)
+    {
+        buffer->setPointConfidenceArray(average(confidences, 1, order, first), numVoxels);
+    }
+    if(times && numTimes == n)
+    {
+        buffer->setPointTimeArray(average(times, 1, order, first), numVoxels);
+    }
+
+    cout << timestamp << "Voxel grid filter: Reduced " << n << " points to " << numVoxels << " centroids." << endl;
+
+    m_buffer = buffer;
+    m_searchTree.reset();
+}
+
+void PointFilter::select(const vector<size_t> &indices)
+{
+    size_t n, numNormals, numColors, numIntensities, numConfidences, numTimes;
+    floatArr points = m_buffer->getPointArray(n);
+    floatArr normals = m_buffer->getPointNormalArray(numNormals);
+    ucharArr colors = m_buffer->getPointColorArray(numColors);
+    floatArr intensities = m_buffer->getPointIntensityArray(numIntensities);
+    floatArr confidences = m_buffer->getPointConfidenceArray(numConfidences);
+    doubleArr times = m_buffer->getPointTimeArray(numTimes);
+
+    PointBufferPtr buffer(new PointBuffer);
+    size_t m = indices.size();
+    buffer->setPointArray(gather(points, 3, indices), m);
+
+    if(normals && numNormals == n)
+    {
+        buffer->setPointNormalArray(gather(normals, 3, indices), m);
+    }
+    if(colors && numColors == n)
+    {
+        buffer->setPointColorArray(gather(colors, 3, indices), m);
+    }
+    if(intensities && numIntensities == n)
+    {
+        buffer->setPointIntensityArray(gather(intensities, 1, indices), m);
+    }
+    if(confidences && numConfidences == n)
+    {
+        buffer->setPointConfidenceArray(gather(confidences, 1, indices), m);
+    }
+    if(times && numTimes == n)
+    {
+        buffer->setPointTimeArray(gather(times, 1, indices), m);
+    }
+
+    m_buffer = buffer;
+    m_searchTree.reset();
+}
+
+PointBufferPtr PointFilter::getPointBuffer()
+{
+    return m_buffer;
+}
+
+} /* namespace lvr */
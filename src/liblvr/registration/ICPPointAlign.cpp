@@ -27,6 +27,7 @@
 #include "io/Timestamp.hpp"
 
 #include <fstream>
+#include <algorithm>
 using std::ofstream;
 
 namespace lvr
@@ -47,15 +48,8 @@ ICPPointAlign::ICPPointAlign(PointBufferPtr model, PointBufferPtr data, Matrix4f
     size_t n;
     floatArr o_points = data->getPointArray(n);
     floatArr t_points(new float[3 * n]);
-    
-    for(size_t i = 0; i < numPoints; i++)
-    {
-        Vertexf v(o_points[3 * i], o_points[3 * i + 1], o_points[3 * i + 2]);
-        Vertexf t = transform * v;
-        t_points[3 * i    ] = t[0];
-        t_points[3 * i + 1] = t[1];
-        t_points[3 * i + 2] = t[2];
-    }
+    std::copy(o_points.get(), o_points.get() + 3 * n, t_points.get());
+    transform.transformPoints(t_points.get(), n);
     m_dataCloud->setPointArray(t_points, n);
 
     // Create search tree
@@ -120,6 +114,7 @@ void ICPPointAlign::getPointPairs(PointPairVector& pairs, Vertexf& centroid_m, V
     bool ok;
     Matrix4f transformInv = m_transformation.inv(ok);
     floatArr dataPoints = m_dataCloud->getPointArray(n);
+    floatArr modelPoints = m_modelCloud->getPointArray(n);
     sum = 0;
 
     #pragma omp parallel
@@ -127,7 +122,9 @@ void ICPPointAlign::getPointPairs(PointPairVector& pairs, Vertexf& centroid_m, V
         PointPairVector privatePairs;
         Vertexf centroid_mP;
         Vertexf centroid_dP;
-        vector<Vertexf> neighbors;
+        float query[3];
+        ulong index;
+        float distance;
 
         #pragma omp for nowait //fill vec_private in parallel
         for(int i = 0; i < m_dataCloud->getNumPoints(); i++)
@@ -141,14 +138,16 @@ void ICPPointAlign::getPointPairs(PointPairVector& pairs, Vertexf& centroid_m, V
             Vertexf s = transformInv * t;
 
             // Get closest point to "inverse query point"
-            neighbors.clear();
-            m_searchTree->kSearch(s, 1, neighbors);
+            query[0] = s[0];
+            query[1] = s[1];
+            query[2] = s[2];
 
             // If closest point was found, transform back to the corresponding
             // position in the data reference frame
-            if(neighbors.size())
+            if(m_searchTree->kSearch(query, 1, &index, &distance))
             {
-                Vertexf closest = m_transformation * neighbors[0];
+                Vertexf neighbor(modelPoints[index * 3], modelPoints[index * 3 + 1], modelPoints[index * 3 + 2]);
+                Vertexf closest = m_transformation * neighbor;
                 if( (closest - t).length() < m_maxDistanceMatch)
                 {
                     centroid_dP += closest;
@@ -0,0 +1,355 @@
+/* Copyright (C) 2011 Uni Osnabrück
+ * This file is part of the LAS VEGAS Reconstruction Toolkit,
+ *
+ * LAS VEGAS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LAS VEGAS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+
+/*
+ * TextureIndex.cpp
+ *
+ *  @date 18.10.2026
+ */
+
+#include "texture/TextureIndex.hpp"
+#include "texture/ImageProcessor.hpp"
+#include "texture/Statistics.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+namespace lvr {
+
+TextureIndex::TextureIndex(TextureIO* tio)
+{
+	m_tio = tio;
+
+	//Use the statistical value with the largest weighted standard
+	//deviation as key
+	m_statsKey = -1;
+	float bestSpread = -1;
+	for (int d = 0; d < 14; d++)
+	{
+		if (!(Statistics::m_coeffs[d] > 0))
+		{
+			continue;
+		}
+
+		double sum = 0, sumSq = 0;
+		size_t n = 0;
+		for (size_t i = 0; i < m_tio->m_textures.size(); i++)
+		{
+			float* stats = m_tio->m_textures[i]->m_stats;
+			if (stats && std::isfinite(stats[d]))
+			{
+				sum += stats[d];
+				sumSq += stats[d] * stats[d];
+				n++;
+			}
+		}
+
+		float spread = Statistics::m_coeffs[d];
+		if (n > 1)
+		{
+			double mean = sum / n;
+			spread *= sqrt(std::max(0.0, sumSq / n - mean * mean));
+		}
+
+		if (spread > bestSpread)
+		{
+			bestSpread = spread;
+			m_statsKey = d;
+		}
+	}
+
+	for (size_t i = 0; i < m_tio->m_textures.size(); i++)
+	{
+		add(i);
+	}
+}
+
+float TextureIndex::calcSignature(Texture* t, std::vector<float> &histogram, std::vector<float> &ccv)
+{
+	int numColors = t->m_numCCVColors;
+	int numPix = t->m_width * t->m_height;
+
+	histogram.clear();
+	ccv.clear();
+	if (numColors == 0)
+	{
+		return 0;
+	}
+
+	//The values are calculated exactly like in ImageProcessor::compareTexturesHist
+	//and CCV::compareTo, so the distances do not change
+	double key = 0;
+	for (int i = 0; i < numColors * 2 * 3; i += 2)
+	{
+		int col = t->m_CCV[i + 0] + t->m_CCV[i + 1];
+		histogram.push_back(col * 1.0f / numPix);
+
+		//weighted sum of the histogram entries. The difference of the keys
+		//of two textures is not greater than their histogram distance.
+		key += (double)((i / 2) % numColors) / numColors * histogram.back();
+	}
+
+	//CCV::fromArray stores the beta value of color c with color c + 1
+	for (int channel = 0; channel < 3; channel++)
+	{
+		unsigned long* arr = &t->m_CCV[channel * numColors * 2];
+		for (int c = 0; c <= numColors; c++)
+		{
+			int alpha = c < numColors ? (int)arr[2 * c + 0] : 0;
+			int beta  = c > 0 ? (int)arr[2 * (c - 1) + 1] : 0;
+			ccv.push_back(alpha / (1.0f * numPix));
+			ccv.push_back(beta  / (1.0f * numPix));
+		}
+	}
+
+	return std::isfinite(key) ? key : FLT_MAX;
+}
+
+void TextureIndex::add(size_t index)
+{
+	Texture* t = m_tio->m_textures[index];
+
+	std::vector<float> histogram, ccv;
+	float colorKey = calcSignature(t, histogram, ccv);
+
+	m_histogramOffsets.push_back(m_histograms.size());
+	m_histograms.insert(m_histograms.end(), histogram.begin(), histogram.end());
+	m_ccvOffsets.push_back(m_ccvs.size());
+	m_ccvs.insert(m_ccvs.end(), ccv.begin(), ccv.end());
+
+	m_hasStats.push_back(t->m_stats != 0);
+	for (int d = 0; d < 14; d++)
+	{
+		m_stats.push_back(t->m_stats ? t->m_stats[d] : 0);
+	}
+
+	Bucket &bucket = m_buckets[std::make_pair(t->m_textureClass, t->m_numCCVColors)];
+
+	std::pair<float, size_t> entry(colorKey, index);
+	bucket.colorKeys.insert(std::upper_bound(bucket.colorKeys.begin(), bucket.colorKeys.end(), entry), entry);
+
+	if (m_statsKey >= 0 && t->m_stats && std::isfinite(t->m_stats[m_statsKey]))
+	{
+		entry.first = t->m_stats[m_statsKey];
+		bucket.statsKeys.insert(std::upper_bound(bucket.statsKeys.begin(), bucket.statsKeys.end(), entry), entry);
+	}
+	else
+	{
+		bucket.unsortedStats.push_back(index);
+	}
+}
+
+size_t TextureIndex::countRange(const std::vector<std::pair<float, size_t> > &keys, float key, float range)
+{
+	if (!(range >= 0))
+	{
+		return 0;
+	}
+	std::vector<std::pair<float, size_t> >::const_iterator first = std::lower_bound(keys.begin(), keys.end(),
+			std::make_pair(key - range, (size_t)0));
+	std::vector<std::pair<float, size_t> >::const_iterator last = std::upper_bound(first, keys.end(),
+			std::make_pair(key + range, std::numeric_limits<size_t>::max()));
+	return last - first;
+}
+
+void TextureIndex::collectRange(const std::vector<std::pair<float, size_t> > &keys, float key, float range,
+		std::vector<size_t> &candidates)
+{
+	if (!(range >= 0))
+	{
+		return;
+	}
+	std::vector<std::pair<float, size_t> >::const_iterator first = std::lower_bound(keys.begin(), keys.end(),
+			std::make_pair(key - range, (size_t)0));
+	std::vector<std::pair<float, size_t> >::const_iterator last = std::upper_bound(first, keys.end(),
+			std::make_pair(key + range, std::numeric_limits<size_t>::max()));
+	for (; first != last; ++first)
+	{
+		candidates.push_back(first->second);
+	}
+}
+
+bool TextureIndex::evaluate(size_t index, Texture* refTexture, const float* refHistogram, const float* refCCV,
+		float colorThreshold, float statsThreshold, float featureThreshold,
+		bool useCrossCorr, float &distance)
+{
+	Texture* t = m_tio->m_textures[index];
+	distance = 0;
+
+	//filter by histogram and CCV
+	if (colorThreshold != FLT_MAX)
+	{
+		if (t->m_numCCVColors != refTexture->m_numCCVColors)
+		{
+			return false;
+		}
+
+		const float* histogram = &m_histograms[0] + m_histogramOffsets[index];
+		float dist = 0;
+		for (int i = 0; i < t->m_numCCVColors * 3; i++)
+		{
+			dist += fabs(histogram[i] - refHistogram[i]);
+		}
+		if (dist > colorThreshold)
+		{
+			return false;
+		}
+		distance += dist;
+
+		const float* ccv = &m_ccvs[0] + m_ccvOffsets[index];
+		dist = 0;
+		int numValues = t->m_numCCVColors ? (t->m_numCCVColors + 1) * 2 * 3 : 0;
+		for (int i = 0; i < numValues; i += 2)
+		{
+			dist += fabs(ccv[i + 0] - refCCV[i + 0]) + fabs(ccv[i + 1] - refCCV[i + 1]);
+		}
+		if (dist > colorThreshold)
+		{
+			return false;
+		}
+		distance += dist;
+	}
+
+	//filter by stats
+	if (statsThreshold != FLT_MAX && refTexture->m_stats)
+	{
+		if (!m_hasStats[index])
+		{
+			return false;
+		}
+
+		float dist = Statistics::textureVectorDistance(&m_stats[14 * index], refTexture->m_stats);
+		if (dist > statsThreshold)
+		{
+			return false;
+		}
+		distance += dist;
+	}
+
+	//filter by features
+	if (featureThreshold != FLT_MAX)
+	{
+		float dist = ImageProcessor::compareTexturesSURF(t, refTexture);
+		if (dist > featureThreshold)
+		{
+			return false;
+		}
+		distance += dist;
+	}
+
+	if (useCrossCorr)
+	{
+		distance += ImageProcessor::compareTexturesCrossCorr(t, refTexture);
+	}
+
+	return true;
+}
+
+int TextureIndex::findBestMatch(Texture* refTexture, unsigned short int textureClass,
+		float colorThreshold, float statsThreshold, float featureThreshold,
+		bool useCrossCorr, float &distance)
+{
+	std::vector<float> refHistogram, refCCV;
+	float refColorKey = calcSignature(refTexture, refHistogram, refCCV);
+	refHistogram.push_back(0);
+	refCCV.push_back(0);
+
+	bool colorFilter = colorThreshold != FLT_MAX;
+	bool statsFilter = statsThreshold != FLT_MAX && refTexture->m_stats
+			&& m_statsKey >= 0 && Statistics::m_coeffs[m_statsKey] > 0
+			&& std::isfinite(refTexture->m_stats[m_statsKey]);
+
+	//The key ranges are slightly enlarged to account for rounding errors
+	float colorRange = colorThreshold * (1 + 1e-4f) + 1e-4f;
+	float statsRefKey = statsFilter ? refTexture->m_stats[m_statsKey] : 0;
+	float statsRange = statsFilter ? statsThreshold / Statistics::m_coeffs[m_statsKey] * (1 + 1e-4f) : 0;
+
+	//Textures with a different number of CCV colors never pass the color filter
+	std::map<std::pair<unsigned short int, unsigned char>, Bucket>::iterator first, last;
+	if (colorFilter)
+	{
+		first = m_buckets.lower_bound(std::make_pair(textureClass, refTexture->m_numCCVColors));
+		last = m_buckets.upper_bound(std::make_pair(textureClass, refTexture->m_numCCVColors));
+	}
+	else
+	{
+		first = m_buckets.lower_bound(std::make_pair(textureClass, (unsigned char)0));
+		last = m_buckets.upper_bound(std::make_pair(textureClass, (unsigned char)255));
+	}
+
+	//Collect the candidates from the smaller key range
+	std::vector<size_t> candidates;
+	for (; first != last; ++first)
+	{
+		Bucket &bucket = first->second;
+
+		size_t colorCount = colorFilter
+				? countRange(bucket.colorKeys, refColorKey, colorRange)
+				: bucket.colorKeys.size();
+		size_t statsCount = statsFilter
+				? countRange(bucket.statsKeys, statsRefKey, statsRange) + bucket.unsortedStats.size()
+				: bucket.colorKeys.size();
+
+		if (statsCount < colorCount)
+		{
+			collectRange(bucket.statsKeys, statsRefKey, statsRange, candidates);
+			candidates.insert(candidates.end(), bucket.unsortedStats.begin(), bucket.unsortedStats.end());
+		}
+		else if (colorFilter)
+		{
+			collectRange(bucket.colorKeys, refColorKey, colorRange, candidates);
+		}
+		else
+		{
+			for (size_t i = 0; i < bucket.colorKeys.size(); i++)
+			{
+				candidates.push_back(bucket.colorKeys[i].second);
+			}
+		}
+	}
+	std::sort(candidates.begin(), candidates.end());
+
+	//Evaluate the candidates
+	std::vector<float> distances(candidates.size());
+	std::vector<char> passed(candidates.size());
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < (int)candidates.size(); i++)
+	{
+		passed[i] = evaluate(candidates[i], refTexture, &refHistogram[0], &refCCV[0],
+				colorThreshold, statsThreshold, featureThreshold, useCrossCorr, distances[i]);
+	}
+
+	//Use the texture with the smallest distance
+	int best = -1;
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		if (passed[i] && (best == -1 || distances[i] < distance))
+		{
+			best = candidates[i];
+			distance = distances[i];
+		}
+	}
+
+	return best;
+}
+
+}
@@ -11,6 +11,10 @@
 #include <stdio.h>
 #include <mpi.h>
 #include <unistd.h>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
 
 // Las vegas Toolkit
 #include "io/PointBuffer.hpp"
@@ -20,6 +24,11 @@
 #include "geometry/ColorVertex.hpp"
 #include "geometry/Normal.hpp"
 #include "reconstruction/AdaptiveKSearchSurface.hpp"
+#include "reconstruction/PointsetGrid.hpp"
+#include "reconstruction/FastBox.hpp"
+#include "reconstruction/BilinearFastBox.hpp"
+#include "reconstruction/SharpBox.hpp"
+#include "reconstruction/TiledMeshWriter.hpp"
 #include "io/Progress.hpp"
 
 #include <boost/program_options.hpp>
@@ -27,6 +36,331 @@
 using namespace lvr;
 namespace po = boost::program_options;
 
+typedef Normal<float> cNormal;
+typedef PointsetSurface<cVertex> psSurface;
+
+
+/**
+ * @brief Determines the lattice cells that are polygonized for a
+ *        partition. A cell belongs to the partition that contains its
+ *        center, so adjacent partitions get adjacent cell ranges. The
+ *        ranges of the outer partitions are extended to the cells that
+ *        are created around the outermost points.
+ *
+ * @param leaf      The partition
+ * @param bb        The global bounding box
+ * @param origin    The global lattice origin
+ * @param voxelsize The voxelsize of the lattice
+ * @param first     Receives the first lattice position of the range
+ * @param last      Receives the lattice position behind the range
+ */
+void getCellRange(MPINode<cVertex>* leaf, BoundingBox<cVertex> &bb, cVertex origin, float voxelsize, int first[3], int last[3])
+{
+	for (int a = 0; a < 3; a++)
+	{
+		first[a] = (int)ceil((leaf->m_minvertex[a] - origin[a]) / voxelsize);
+		last[a]  = (int)ceil((leaf->m_maxvertex[a] - origin[a]) / voxelsize);
+
+		if (leaf->m_minvertex[a] <= bb.getMin()[a])
+		{
+			first[a] = 0;
+		}
+
+		if (leaf->m_maxvertex[a] >= bb.getMax()[a])
+		{
+			last[a] = (int)ceil((bb.getMax()[a] - origin[a]) / voxelsize) + 3;
+		}
+	}
+}
+
+
+/**
+ * @brief Sends the points of a partition followed by its halo points to
+ *        the given client.
+ *
+ * @param leaf      The partition
+ * @param number    The number of the partition
+ * @param halo      Global indices of the halo points
+ * @param points    All points
+ * @param first     First lattice position of the cell range of the partition
+ * @param last      Lattice position behind the cell range
+ * @param client    Rank of the client
+ */
+void sendPartition(MPINode<cVertex>* leaf, int number, const vector<size_t> &halo, coord3fArr points,
+		const int first[3], const int last[3], int client)
+{
+	int numPoints = leaf->getnumpoints();
+	int header[9] = {number, numPoints, (int)halo.size(),
+			first[0], first[1], first[2], last[0], last[1], last[2]};
+
+	vector<float> data;
+	data.reserve(3 * (numPoints + halo.size()));
+
+	coord3fArr leafPoints = leaf->getPoints();
+	for (int i = 0; i < numPoints; i++)
+	{
+		data.push_back(leafPoints[i][0]);
+		data.push_back(leafPoints[i][1]);
+		data.push_back(leafPoints[i][2]);
+	}
+
+	for (size_t i = 0; i < halo.size(); i++)
+	{
+		data.push_back(points[halo[i]][0]);
+		data.push_back(points[halo[i]][1]);
+		data.push_back(points[halo[i]][2]);
+	}
+
+	MPI::COMM_WORLD.Send(header, 9, MPI::INT, client, 2);
+	MPI::COMM_WORLD.Send(data.empty() ? 0 : &data[0], data.size(), MPI::FLOAT, client, 1);
+
+	// the points of the partition are not needed anymore
+	leaf->node_points.reset();
+}
+
+
+/**
+ * @brief Sends the triangles of a partition to the master. The header
+ *        is sent with tag 7, the vertices, edge keys and faces follow
+ *        with tag 8.
+ */
+void sendFragment(const MeshFragment &fragment, int number)
+{
+	int header[9] = {number, (int)fragment.keys.size(), (int)fragment.faces.size(),
+			fragment.first[0], fragment.first[1], fragment.first[2],
+			fragment.last[0], fragment.last[1], fragment.last[2]};
+
+	MPI::COMM_WORLD.Send(header, 9, MPI::INT, 0, 7);
+	if (header[1] > 0)
+	{
+		MPI::COMM_WORLD.Send(&fragment.vertices[0], fragment.vertices.size(), MPI::FLOAT, 0, 8);
+		MPI::COMM_WORLD.Send(&fragment.keys[0], fragment.keys.size(), MPI::UNSIGNED_LONG_LONG, 0, 8);
+	}
+	if (header[2] > 0)
+	{
+		MPI::COMM_WORLD.Send(&fragment.faces[0], fragment.faces.size(), MPI::UNSIGNED, 0, 8);
+	}
+}
+
+
+/**
+ * @brief Receives the triangles of a partition from the given client.
+ *
+ * @return The number of the partition
+ */
+int recvFragment(MeshFragment &fragment, int client)
+{
+	int header[9];
+	MPI::COMM_WORLD.Recv(header, 9, MPI::INT, client, 7);
+
+	fragment.vertices.resize(3 * header[1]);
+	fragment.keys.resize(header[1]);
+	fragment.faces.resize(header[2]);
+	for (int a = 0; a < 3; a++)
+	{
+		fragment.first[a] = header[3 + a];
+		fragment.last[a]  = header[6 + a];
+	}
+
+	if (header[1] > 0)
+	{
+		MPI::COMM_WORLD.Recv(&fragment.vertices[0], fragment.vertices.size(), MPI::FLOAT, client, 8);
+		MPI::COMM_WORLD.Recv(&fragment.keys[0], fragment.keys.size(), MPI::UNSIGNED_LONG_LONG, client, 8);
+	}
+	if (header[2] > 0)
+	{
+		MPI::COMM_WORLD.Recv(&fragment.faces[0], fragment.faces.size(), MPI::UNSIGNED, client, 8);
+	}
+
+	return header[0];
+}
+
+
+/**
+ * @brief Replaces the distances of the corners on the border of a
+ *        partition by the values the master knows from adjacent
+ *        partitions. The lattice keys of the corners are sent with tag 9,
+ *        their distances and invalid flags with tag 10. The master
+ *        answers with the consistent values with tag 11.
+ */
+template<typename BoxT>
+void exchangeBorderCorners(HashGrid<cVertex, BoxT>* grid, cVertex origin, float voxelsize,
+		const int first[3], const int last[3])
+{
+	vector<QueryPoint<cVertex> >& qp = grid->getQueryPoints();
+
+	vector<size_t> indices;
+	vector<uint64_t> keys;
+	TiledMeshWriter<cVertex, BoxT>::getBorderCorners(grid, origin, voxelsize, first, last, indices, keys);
+
+	// keep the buffers valid if there are no border corners
+	size_t n = indices.size();
+	vector<float> distances(n + 1);
+	vector<unsigned char> invalid(n + 1);
+	keys.resize(n + 1);
+	for (size_t i = 0; i < n; i++)
+	{
+		distances[i] = qp[indices[i]].m_distance;
+		invalid[i] = qp[indices[i]].m_invalid;
+	}
+
+	MPI::COMM_WORLD.Send(&keys[0], n, MPI::UNSIGNED_LONG_LONG, 0, 9);
+	MPI::COMM_WORLD.Send(&distances[0], n, MPI::FLOAT, 0, 10);
+	MPI::COMM_WORLD.Send(&invalid[0], n, MPI::UNSIGNED_CHAR, 0, 10);
+	MPI::COMM_WORLD.Recv(&distances[0], n, MPI::FLOAT, 0, 11);
+	MPI::COMM_WORLD.Recv(&invalid[0], n, MPI::UNSIGNED_CHAR, 0, 11);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		qp[indices[i]].m_distance = distances[i];
+		qp[indices[i]].m_invalid = invalid[i];
+	}
+}
+
+
+/**
+ * @brief A border corner request of a client (see
+ *        \ref exchangeBorderCorners) that the master has received but
+ *        not answered yet.
+ */
+struct BorderRequest
+{
+	/// Rank of the client that waits for the answer
+	int                     client;
+
+	/// Lattice keys of the corners
+	vector<uint64_t>        keys;
+
+	/// Distances of the corners
+	vector<float>           distances;
+
+	/// Invalid flags of the corners
+	vector<unsigned char>   invalid;
+};
+
+
+/**
+ * @brief Receives the border corners of a client (see
+ *        \ref exchangeBorderCorners).
+ */
+void recvBorderCorners(BorderRequest &request, int client, size_t n)
+{
+	request.client = client;
+	request.keys.resize(n + 1);
+	request.distances.resize(n + 1);
+	request.invalid.resize(n + 1);
+
+	MPI::COMM_WORLD.Recv(&request.keys[0], n, MPI::UNSIGNED_LONG_LONG, client, 9);
+	MPI::COMM_WORLD.Recv(&request.distances[0], n, MPI::FLOAT, client, 10);
+	MPI::COMM_WORLD.Recv(&request.invalid[0], n, MPI::UNSIGNED_CHAR, client, 10);
+	request.keys.resize(n);
+}
+
+
+/**
+ * @brief Returns whether the closed cell ranges of two partitions
+ *        touch, i.e., whether they can share border corners.
+ *
+ * @param a     First and last lattice position of the first range
+ * @param b     First and last lattice position of the second range
+ */
+bool rangesTouch(const int a[6], const int b[6])
+{
+	for (int i = 0; i < 3; i++)
+	{
+		if (a[i] > b[3 + i] || b[i] > a[3 + i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+/**
+ * @brief Answers the pending border corner requests of the clients.
+ *        The distance of a corner is defined by the partition with the
+ *        lowest number that contains it, so the seams do not depend on
+ *        the order in which the clients finish. A request is therefore
+ *        only answered after all touching partitions with lower numbers
+ *        have been answered. Those were sent out before, so they never
+ *        wait for the request and the clients cannot deadlock.
+ *
+ * @param writer    Stores the corner distances that are already defined
+ * @param pending   The requests by partition number
+ * @param ranges    The cell ranges of all partitions
+ * @param answered  Flags of the partitions whose corners are defined.
+ *                  Partitions without points have to be flagged, too.
+ */
+template<typename BoxT>
+void answerBorderCorners(TiledMeshWriter<cVertex, BoxT> &writer, map<int, BorderRequest> &pending,
+		const vector<int> &ranges, vector<bool> &answered)
+{
+	// Answering a request can only release requests of partitions with
+	// higher numbers, so a single pass in order suffices
+	typename map<int, BorderRequest>::iterator it = pending.begin();
+	while (it != pending.end())
+	{
+		int p = it->first;
+		bool ready = true;
+		for (int q = 0; q < p && ready; q++)
+		{
+			ready = answered[q] || !rangesTouch(&ranges[6 * q], &ranges[6 * p]);
+		}
+		if (!ready)
+		{
+			++it;
+			continue;
+		}
+
+		BorderRequest &request = it->second;
+		size_t n = request.keys.size();
+		size_t shared = writer.shareBorderCorners(request.keys, request.distances, request.invalid,
+				&ranges[6 * p], &ranges[6 * p + 3]);
+
+		MPI::COMM_WORLD.Send(&request.distances[0], n, MPI::FLOAT, request.client, 11);
+		MPI::COMM_WORLD.Send(&request.invalid[0], n, MPI::UNSIGNED_CHAR, request.client, 11);
+		std::cout << timestamp << "Client " << request.client << " took " << shared << " of "
+			  << n << " border distances from adjacent partitions." << std::endl;
+
+		answered[p] = true;
+		pending.erase(it++);
+	}
+}
+
+
+/**
+ * @brief Computes the distance values of a partition and polygonizes
+ *        the cells of its range. The grid reaches from the global
+ *        lattice origin to the end of the range plus the overlap, so
+ *        its lattice lines up with the lattices of all other partitions.
+ *        The distances on the border of the range are exchanged with
+ *        the master before the cells are polygonized.
+ */
+template<typename BoxT>
+void reconstructPartition(psSurface::Ptr surface, cVertex origin, float voxelsize, int tileOverlap,
+		const int first[3], const int last[3], MeshFragment &fragment)
+{
+	BilinearFastBox<cVertex, cNormal>::m_surface = surface;
+	SharpBox<cVertex, cNormal>::m_surface = surface;
+
+	cVertex v_max;
+	for (int a = 0; a < 3; a++)
+	{
+		v_max[a] = origin[a] + (last[a] + tileOverlap + 1) * voxelsize;
+	}
+
+	BoundingBox<cVertex> bb;
+	bb.expand(origin);
+	bb.expand(v_max);
+
+	PointsetGrid<cVertex, BoxT> grid(voxelsize, surface, bb, true);
+	grid.calcDistanceValues();
+	exchangeBorderCorners<BoxT>(&grid, origin, voxelsize, first, last);
+
+	TiledMeshWriter<cVertex, BoxT>::extractTile(&grid, origin, voxelsize, first, last, fragment);
+}
+
 
 int main (int argc , char *argv[]) {
       int count_serv = 0;  
@@ -40,6 +374,10 @@ int main (int argc , char *argv[]) {
       long int max_points, min_points;
       bool ransac;
       bool median;
+      float overlap;
+      float voxelsize;
+      int tileOverlap;
+      string decomposition;
       
       // get all options
       po::options_description desc("Allowed options");
@@ -52,6 +390,11 @@ int main (int argc , char *argv[]) {
 	("file"      , po::value<string>()->default_value("noinput"), "Inputfile")
 	("median"    , "Use the Median for segmenting the pointcloud")
 	("ransac"    , "Use RANSAC based normal estimation")
+	("overlap"   , po::value<float>(&overlap)->default_value(-1), "Width of the halo of neighboring points that is sent with each partition. Negative values use the radius of the k-neighborhoods.")
+	("reconstruct", "Reconstruct a mesh from the partitions instead of estimating normals only")
+	("voxelsize" , po::value<float>(&voxelsize)->default_value(10), "Voxelsize of the grid used for the reconstruction")
+	("decomposition", po::value<string>(&decomposition)->default_value("PMC"), "Defines the type of decomposition that is used for the voxels (Standard Marching Cubes (MC), Planar Marching Cubes (PMC), Standard Marching Cubes with sharp feature detection (SF))")
+	("tileOverlap", po::value<int>(&tileOverlap)->default_value(10), "Number of cells behind the cell range of a partition that are contained in its grid")
       ;
       
       po::variables_map vm;
@@ -81,6 +424,13 @@ int main (int argc , char *argv[]) {
 	median = false;
       }
 
+      bool reconstruct = vm.count("reconstruct") > 0;
+      if (reconstruct && decomposition != "MC" && decomposition != "PMC" && decomposition != "SF")
+      {
+	cout << "Decomposition " << decomposition << " is not supported." << endl;
+	return 1;
+      }
+
 	// Kd Tree
         // A list for all Nodes with less than MAX_POINTS
         std::list<MPINode<ColorVertex<float, unsigned char> > *> m_nodelist;
@@ -126,11 +476,11 @@ int main (int argc , char *argv[]) {
 	char con_msg[128];
 	float expansion_bounding[6];
 
+	// Lattice origin of the reconstruction. It is shared by all
+	// partitions, so the lattice points line up across the ranks.
+	float lattice_origin[3];
 
-	//if send this, +1 because this the Master in MPI has the rank 0 but for all Indizes this is more pleasant
-	int client_serv_data = 0;
 
-	int count = 1;
 	int progress = 0;
 
 
@@ -146,12 +496,15 @@ int main (int argc , char *argv[]) {
 	// returns the name of the processor (computer on which it runs)
 	MPI::Get_processor_name(processor_name, namelen);
 
+	if (numprocs < 2)
+	{
+		std::cout << timestamp << "At least two processes are needed." << std::endl;
+		MPI_Finalize();
+		return 1;
+	}
 
-	MPI::Request status[numprocs-1];
 	// Master-Process
 	if (rank == 0){
-		int * int_numpoint = new int[numprocs - 1];
-		int * tmp_int = new int[1];
 	  
 		// read the point cloud
 		if (  vm["file"].as<string>() != "noinput" ) m_model = io_factory.readModel( vm["file"].as<string>() );
@@ -213,136 +566,177 @@ int main (int argc , char *argv[]) {
 		{
 		    MPI::COMM_WORLD.Send(expansion_bounding, 6, MPI::FLOAT, i, 5);
 		}
-			
-
-/*************************************** Connection is successful *****************/
-
-
-		//allocate array for all normals dynamically
-		float ** normals = new float*[numprocs - 1];
-
-		//allocate array for global indices dynamically
-		long unsigned int ** Indizes = new long unsigned int*[numprocs - 1];
-
-		// array for which clients serv the data
-		int laufvariable[numprocs - 1];
-
-
-		typename std::list<MPINode<cVertex>*>::	iterator it= m_nodelist.begin();
-
-
-		// a buffer to store all the normals
-		float * m_normal = new float[3 * static_cast<unsigned int>(m_loader->getNumPoints())];
 
+		// Move the lattice origin below all points, so that all lattice
+		// positions including the extruded cells are positive
+		cVertex origin = tmp_min;
+		for (int a = 0; a < 3; a++)
+		{
+			origin[a] -= 2 * voxelsize;
+			lattice_origin[a] = origin[a];
+		}
 
-		// Send all data packets
-		while ( it  != m_nodelist.end() )
+		if (reconstruct)
 		{
+			for ( i = 1; i < numprocs; i++)
+			{
+				MPI::COMM_WORLD.Send(lattice_origin, 3, MPI::FLOAT, i, 6);
+			}
+		}
+			
 
+/*************************************** Connection is successful *****************/
 
-		        // get the next points in row
-			m_points = (*it)->getPoints();
 
-			// send the number of points that will follow
-			int_numpoint[client_serv_data] = (*it)->getnumpoints();
-			tmp_int[0] = int_numpoint[client_serv_data];
-			
-			MPI::COMM_WORLD.Send(tmp_int, 1, MPI::INT, client_serv_data + 1, 2);
-			
-			// allokiere normal array dynamically
-			normals[client_serv_data] = new float [3 * int_numpoint[client_serv_data]];
+		// Determine the width of the halos. Each partition is sent with
+		// the points of the neighboring partitions within this distance,
+		// so normals at partition borders are estimated from complete
+		// neighborhoods.
+		if (overlap < 0)
+		{
+			int k = std::max(kn, std::max(ki, kd));
+			overlap = MPITree.estimateNeighborhoodRadius(k);
+		}
 
-			// get the indices for the original sequence
-			Indizes[client_serv_data] = (*it)->indizes.get();
+		// The grid of a partition has to contain the cells of its range
+		// and the overlap cells
+		if (reconstruct)
+		{
+			overlap = std::max(overlap, (tileOverlap + 1) * voxelsize);
+		}
+		std::cout << timestamp << "Sending " << m_nodelist.size() << " partitions with halos of width " << overlap << "." << std::endl;
+		MPITree.initHalos(overlap);
 
-			laufvariable[client_serv_data] = (*it)->getnumpoints();
+		// a buffer to store all the normals
+		size_t numPoints = m_loader->getNumPoints();
+		float * m_normal = reconstruct ? 0 : new float[3 * numPoints]();
 
+		// The triangles of all partitions are merged into a single mesh.
+		// Vertices on the partition borders are welded by their lattice
+		// edge. The box type is not used for merging.
+		TiledMeshWriter<cVertex, FastBox<cVertex, cNormal> > writer("triangle_mesh.ply", origin, voxelsize);
+		MeshFragment fragment;
 
-			// send Data
-			MPI::Request req2 = MPI::COMM_WORLD.Isend(m_points.get(), 3 *  int_numpoint[client_serv_data], MPI::FLOAT, client_serv_data + 1, 1);
+		m_points = m_loader->getIndexedPointArray(m_numpoint);
 
+		// the partition that is processed by each client
+		vector<int> partition(numprocs, -1);
+		vector<MPINode<cVertex>*> leaves(m_nodelist.begin(), m_nodelist.end());
 
-			// Reciev Normals
-			MPI::Request tmp;
-			tmp = MPI::COMM_WORLD.Irecv(normals[client_serv_data], 3 * int_numpoint[client_serv_data], MPI::FLOAT, client_serv_data + 1, 4);
-			status[client_serv_data] = tmp;
+		// the cell ranges of all partitions and the border corner
+		// requests that wait for partitions with lower numbers
+		vector<int> ranges(6 * leaves.size());
+		for (size_t l = 0; l < leaves.size(); l++)
+		{
+			getCellRange(leaves[l], tmp_BoundingBox, origin, voxelsize, &ranges[6 * l], &ranges[6 * l + 3]);
+		}
+		vector<bool> answered(leaves.size(), false);
+		map<int, BorderRequest> pending;
 
+		size_t next = 0;
+		int active = 0;
+		vector<size_t> halo;
+		vector<float> normals;
 
-			req2.Wait();
+		// Each idle client gets the next partition. The partitions are
+		// sorted by size, so the largest ones are processed first.
+		for (i = 1; i < numprocs; i++)
+		{
+			if (next < leaves.size())
+			{
+				partition[i] = next;
+				MPITree.getHalo(next, halo);
+				sendPartition(leaves[next], next, halo, m_points, &ranges[6 * next], &ranges[6 * next + 3], i);
+				next++;
+				active++;
+			}
+			else
+			{
+				int end[9] = {-1, 0, 0, 0, 0, 0, 0, 0, 0};
+				MPI::COMM_WORLD.Send(end, 9, MPI::INT, i, 2);
+			}
+		}
 
+		while (active > 0)
+		{
+			// Recieve the result of the next finished client
+			MPI::Status status;
+			MPI::COMM_WORLD.Probe(MPI::ANY_SOURCE, MPI::ANY_TAG, status);
+			int client = status.Get_source();
 
-/*******************************store Normals  **************/
+			// a client asks for the distances on the border of its partition
+			if (status.Get_tag() == 9)
+			{
+				size_t n = status.Get_count(MPI::UNSIGNED_LONG_LONG);
+				recvBorderCorners(pending[partition[client]], client, n);
+				answerBorderCorners(writer, pending, ranges, answered);
+				continue;
+			}
+			MPINode<cVertex>* leaf = leaves[partition[client]];
 
+			if (reconstruct)
+			{
+				// merge the triangles into the mesh
+				recvFragment(fragment, client);
+				writer.addFragment(fragment);
 
-			if (count >= numprocs - 1)
+				// partitions without points send no border corners
+				if (!answered[partition[client]])
+				{
+					answered[partition[client]] = true;
+					answerBorderCorners(writer, pending, ranges, answered);
+				}
+			}
+			else
 			{
-				std::cout << timestamp << "Master is waiting until another Process is ready." << std::endl;
-				client_serv_data = MPI::Request::Waitany( numprocs - 1, status);
+				normals.resize(status.Get_count(MPI::FLOAT));
+				MPI::COMM_WORLD.Recv(normals.empty() ? 0 : &normals[0], normals.size(), MPI::FLOAT, client, 4);
 
-				progress++;
 				// store normals on correct position
-				for (int x = 0; x < laufvariable[client_serv_data] ; x ++)
+				boost::shared_array<size_t> indizes = leaf->getIndizes();
+				for (size_t x = 0; x < normals.size() / 3; x++)
 				{
-					int n_buffer_pos = 3 * Indizes[client_serv_data][x];
-
-					m_normal[n_buffer_pos]     = normals[client_serv_data][3 * x];
-					m_normal[n_buffer_pos + 1] = normals[client_serv_data][ (3 * x) + 1];
-					m_normal[n_buffer_pos + 2] = normals[client_serv_data][ (3 * x) + 2];
+					size_t n_buffer_pos = 3 * indizes[x];
 
+					m_normal[n_buffer_pos]     = normals[3 * x];
+					m_normal[n_buffer_pos + 1] = normals[(3 * x) + 1];
+					m_normal[n_buffer_pos + 2] = normals[(3 * x) + 2];
 				}
-				normals[client_serv_data][0] = 0;
-
-
-				count++;
-				it++;
-
-				std::cout << timestamp << progress << " / " << m_nodelist.size() << " packages done." << std::endl;
+			}
+			leaf->indizes.reset();
 
+			progress++;
+			std::cout << timestamp << progress << " / " << leaves.size() << " packages done." << std::endl;
 
-			}// end if
+			// send the next partition or terminate the client
+			if (next < leaves.size())
+			{
+				partition[client] = next;
+				MPITree.getHalo(next, halo);
+				sendPartition(leaves[next], next, halo, m_points, &ranges[6 * next], &ranges[6 * next + 3], client);
+				next++;
+			}
 			else
 			{
-				count++;
-				it++;
-				client_serv_data++;
-				client_serv_data = (client_serv_data % (numprocs - 1));
+				int end[9] = {-1, 0, 0, 0, 0, 0, 0, 0, 0};
+				MPI::COMM_WORLD.Send(end, 9, MPI::INT, client, 2);
+				active--;
 			}
-		}// End while
-
-		std::cout << timestamp << "Waiting for the last results..." << std::endl;
-		//store all data which is still not stored
-		MPI::Request::Waitall( numprocs - 1, status);
+		}
 
 		std::cout << timestamp << "All Processes are done." << std::endl;
 
-		client_serv_data = 0;
-		for (int y = 0 ; y < numprocs - 1 ; y++)
+		if (reconstruct)
 		{
-
-			// check if some data is in there
-			if (normals[client_serv_data][0] != 0)
-			{
-				// store normals on correct position
-				for (int x = 0; x < laufvariable[client_serv_data] ; x ++)
-				{
-					int n_buffer_pos = 3 * Indizes[client_serv_data][x];
-
-					m_normal[n_buffer_pos]     = normals[client_serv_data][3 * x];
-					m_normal[n_buffer_pos + 1] = normals[client_serv_data][ (3 * x) + 1];
-					m_normal[n_buffer_pos + 2] = normals[client_serv_data][ (3 * x) + 2];
-
-				}
-			}
-			client_serv_data++;
+			writer.finalize();
+			std::cout << timestamp << "End of Programm." << std::endl;
+			MPI_Finalize();
+			return 0;
 		}
 
-		
-
 		//Points put back into proper shape for PointBufferPtr
 		boost::shared_array<float> norm (m_normal);
 
-		long unsigned int tmp = static_cast<unsigned int>(m_loader->getNumPoints());
-		
 		std::cout << timestamp << "Interpolating normals..." << std::endl;
 
 		// set normals
@@ -364,23 +758,6 @@ int main (int argc , char *argv[]) {
 		
 		std::cout << timestamp << "End of Programm." << std::endl;
 		
-		// Complete connection
-		int end[1] = {-1};
-		int j = 1;
-		for (j = 1 ; j < numprocs ; j++)
-		{
-			MPI::COMM_WORLD.Send(end , 1, MPI::INT, j, 2);
-		}
-
-
-		
-		for (int i = 0 ; i < (numprocs -1) ; i++)
-		{
-			delete [] normals[i];
-		}
-
-		delete [] normals;
-
 	}// Ende If
 /**********************************************************************************************************/
 	// Slave-Process
@@ -399,67 +776,103 @@ int main (int argc , char *argv[]) {
 
 		MPI::COMM_WORLD.Send(con_msg, 128, MPI::CHAR, 0, 0);
 		MPI::COMM_WORLD.Recv(expansion_bounding, 6, MPI::FLOAT, 0, 5);
+		if (reconstruct)
+		{
+			MPI::COMM_WORLD.Recv(lattice_origin, 3, MPI::FLOAT, 0, 6);
+		}
+		cVertex origin(lattice_origin[0], lattice_origin[1], lattice_origin[2]);
+		MeshFragment fragment;
 /************************************ Connection is successful *******************/
 
 		// Loop for receiving the data, -1 cancels operation
 		while(true)
 		{
-		  
-		  MPI::COMM_WORLD.Recv(&c_sizepackage, 1, MPI::INT, 0, 2);
+			// partition number, number of points, number of halo points
+			// and the cell range of the partition
+			int header[9];
+			MPI::COMM_WORLD.Recv(header, 9, MPI::INT, 0, 2);
+
 			//termination condition
-			if (c_sizepackage == -1)
+			if (header[0] == -1)
 			{
 				break;
 			}
-			else
+
+			count_serv++;
+			c_sizepackage = header[1] + header[2];
+
+			// Recv the data. The halo points follow the points of the partition.
+			boost::shared_array<float> punkte(new float[3 * c_sizepackage]);
+			MPI::COMM_WORLD.Recv(punkte.get(), 3 * c_sizepackage, MPI::FLOAT, 0, 1);
+
+			// A partition without any points yields no normals and no triangles
+			if (c_sizepackage == 0)
 			{
-	
-				count_serv++;
+				std::cout << timestamp << "Client " << rank << " skips the empty partition " << header[0] << "." << std::endl;
+				if (reconstruct)
+				{
+					fragment.clear();
+					for (int a = 0; a < 3; a++)
+					{
+						fragment.first[a] = header[3 + a];
+						fragment.last[a]  = header[6 + a];
+					}
+					sendFragment(fragment, header[0]);
+				}
+				else
+				{
+					MPI::COMM_WORLD.Send((float*)0, 0, MPI::FLOAT, 0, 4);
+				}
+				continue;
+			}
 
-			
-				// Recv the data
-				float * tmp = new float[3 * c_sizepackage];
-				MPI::Request client_req2 = MPI::COMM_WORLD.Irecv(tmp, 3 * c_sizepackage, MPI::FLOAT, 0, 1);
+			PointBufferPtr pointcloud(new PointBuffer());
+			pointcloud->setPointArray(punkte, c_sizepackage);
 
-				// wait till transmission complete
-				client_req2.Wait();
+			// Set search options for normal estimation and distance evaluation
+			psSurface::Ptr surface(new AdaptiveKSearchSurface<cVertex, cNormal>(pointcloud, "STANN", kn, ki, kd, ransac));
 
-				// Points put back into proper shape for PointBufferPtr
-				boost::shared_array<float> punkte (tmp);
+			// set global Bounding-Box
+			surface->expandBoundingBox(expansion_bounding[0], expansion_bounding[1], expansion_bounding[2],
+						      expansion_bounding[3], expansion_bounding[4], expansion_bounding[5]);
 
+			// calculate the normals
+			std::cout << timestamp << "Client " << rank << " calculates surface normals with " << header[1]
+				  << " points and " << header[2] << " halo points." <<  std::endl;
+			surface->calculateSurfaceNormals();
 
-				// The factory requires a model to save.
-				// The model in turn requires a Pointbuffer and a Meshbuffer (can be emtpy).
-				// The Pointbuffer contains the Indexlist.
-				PointBufferPtr pointcloud(new PointBuffer());
-				pointcloud->setPointArray(punkte, c_sizepackage);
+			if (reconstruct)
+			{
+				std::cout << timestamp << "Client " << rank << " reconstructs partition " << header[0] << "." << std::endl;
+				if (decomposition == "MC")
+				{
+					reconstructPartition<FastBox<cVertex, cNormal> >(surface, origin, voxelsize, tileOverlap, header + 3, header + 6, fragment);
+				}
+				else if (decomposition == "PMC")
+				{
+					reconstructPartition<BilinearFastBox<cVertex, cNormal> >(surface, origin, voxelsize, tileOverlap, header + 3, header + 6, fragment);
+				}
+				else
+				{
+					reconstructPartition<SharpBox<cVertex, cNormal> >(surface, origin, voxelsize, tileOverlap, header + 3, header + 6, fragment);
+				}
 
-				PointsetSurface<ColorVertex<float, unsigned char> >* surface;
-				
-				// Set search options for normal estimation and distance evaluation
-				surface = new AdaptiveKSearchSurface<ColorVertex<float, unsigned char>, Normal<float> >(pointcloud, "STANN", kn, ki, kd, ransac);
-			
-				// set global Bounding-Box
-				surface->expandBoundingBox(expansion_bounding[0], expansion_bounding[1], expansion_bounding[2],
-							      expansion_bounding[3], expansion_bounding[4], expansion_bounding[5]);
-				
-				
-				
-				// calculate the normals
-				std::cout << timestamp << "Client " << rank << " calculates surface normals with " << c_sizepackage << " points." <<  std::endl;
-				surface->calculateSurfaceNormals();
-				//cerr << ts.getElapsedTimeInMs() << endl;
-
-
-				pointcloud = surface->pointBuffer();
-				size_t size_normal;
-				c_normals = pointcloud->getIndexedPointNormalArray(size_normal);
+				// The boxes must not keep the surface of this partition
+				BilinearFastBox<cVertex, cNormal>::m_surface.reset();
+				SharpBox<cVertex, cNormal>::m_surface.reset();
+
+				sendFragment(fragment, header[0]);
 				std::cout << timestamp << "Client " << rank << " finished the package." << std::endl;
+				continue;
+			}
 
-				// send the normals back to the Masterprocess
-				MPI::COMM_WORLD.Send(c_normals.get(), 3 * c_sizepackage, MPI::FLOAT, 0, 4);
+			pointcloud = surface->pointBuffer();
+			size_t size_normal;
+			c_normals = pointcloud->getIndexedPointNormalArray(size_normal);
+			std::cout << timestamp << "Client " << rank << " finished the package." << std::endl;
 
-			}
+			// send the normals of the partition back to the Masterprocess
+			MPI::COMM_WORLD.Send(c_normals.get(), 3 * header[1], MPI::FLOAT, 0, 4);
 		}
 
 	}// End else
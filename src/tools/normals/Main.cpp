@@ -21,6 +21,7 @@
 // Program options for this tool
 #include "Options.hpp"
 #include "io/AsciiIO.hpp"
+#include "io/AsciiParser.hpp"
 #include "io/Timestamp.hpp"
 #include "io/Progress.hpp"
 #include "io/DataStruct.hpp"
@@ -39,6 +40,7 @@
 
 #include <iostream>
 #include <string>
+#include <algorithm>
 using std::cout;
 using std::endl;
 using std::string;
@@ -108,31 +110,42 @@ void interpolateNormals(PointBufferPtr pc, size_t numPoints, int n)
     string comment = timestamp.getElapsedTime() + "Interpolating normals ";
     ProgressBar progress(numPoints, comment);
 
-    #pragma omp parallel for schedule(static)
-    for(int i = 0; i < numPoints; i++)
+    #pragma omp parallel
     {
-        // Create search tree
-        vector< ulong > indices;
-        vector< double > distances;
+        size_t done = 0;
 
-        Vertex<float> vertex(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
-        tree->kSearch( vertex, n, indices, distances);
-
-        // Do interpolation
-        Normal<float> normal(normals[3 * i], normals[3 * i + 1], normals[3 * i + 2]);
-        for(int j = 0; j < indices.size(); j++)
+        #pragma omp for schedule(static)
+        for(int i = 0; i < numPoints; i++)
         {
-            normal += Normal<float>(normals[3 * indices[j]], normals[3 * indices[j] + 1], normals[3 * indices[j] + 2]);
+            // Create search tree
+            vector< ulong > indices;
+            vector< double > distances;
+
+            Vertex<float> vertex(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+            tree->kSearch( vertex, n, indices, distances);
+
+            // Do interpolation
+            Normal<float> normal(normals[3 * i], normals[3 * i + 1], normals[3 * i + 2]);
+            for(int j = 0; j < indices.size(); j++)
+            {
+                normal += Normal<float>(normals[3 * indices[j]], normals[3 * indices[j] + 1], normals[3 * indices[j] + 2]);
+            }
+            normal.normalize();
+
+            // Save results in buffer (I know i should use a seperate buffer, but for testing it
+            // should be OK to save the interpolated values directly into the input buffer)
+            normals[3 * i]      = normal.x;
+            normals[3 * i + 1]  = normal.y;
+            normals[3 * i + 2]  = normal.z;
+
+            // Finished points are reported in batches
+            if(++done == 256)
+            {
+                progress += done;
+                done = 0;
+            }
         }
-        normal.normalize();
-
-        // Save results in buffer (I know i should use a seperate buffer, but for testing it
-        // should be OK to save the interpolated values directly into the input buffer)
-        normals[3 * i]      = normal.x;
-        normals[3 * i + 1]  = normal.y;
-        normals[3 * i + 2]  = normal.z;
-
-        ++progress;
+        progress += done;
     }
     cout << endl;
 }
@@ -227,7 +240,7 @@ int main(int argc, char** argv)
 	        size_t numPointsToRead = totalPointCount;
 	        if(target > 0)
 	        {
-	           skipPoints = (int)totalPointCount / target;
+	           skipPoints = std::max((size_t)1, totalPointCount / target);
 	           numPointsToRead = target;
 
 	        }
@@ -239,7 +252,7 @@ int main(int argc, char** argv)
 
 	        cout << timestamp << "Reducing number of points to " << target << ". Writing every " << skipPoints << "th point." << endl;
 	        size_t pointsRead = 0;
-	        size_t counter;
+	        size_t counter = 0;
 	        for(int i = firstScan; i <= lastScan; i++)
 	        {
 	            char scanFileName[100];
@@ -285,44 +298,51 @@ int main(int argc, char** argv)
 	            string scanFile = scanFilePath.string().c_str();
 	            cout << timestamp << "Processing " << scanFile << endl;
 
-	            // Open scan file
-	            ifstream in(scanFilePath.c_str());
-	            float x, y, z, nx, ny, nz;
-	            do
+	            // Parse the scan file. The first six columns contain the point
+	            // and its normal
+	            AsciiParser parser(scanFile);
+	            AsciiLayout layout;
+	            layout.nx = 3;
+	            layout.ny = 4;
+	            layout.nz = 5;
+	            PointBufferPtr scan = parser.read(layout, 0);
+
+	            size_t numScanPoints;
+	            floatArr scanPoints = scan->getPointArray(numScanPoints);
+	            floatArr scanNormals = scan->getPointNormalArray(numScanPoints);
+	            size_t scanStart = pointsRead;
+	            for(size_t p = 0; p < numScanPoints && pointsRead < numPointsToRead; p++)
 	            {
-	                in >> x >> y >> z >> nx >> ny >> nz;
 	                if(counter % skipPoints == 0)
 	                {
-	                    // Transform normal according to pose
-	                    Normal<float> normal(nx, ny, nz);
-	                    Vertex<float> point(x, y, z);
-	                    normal = transform * normal;
-	                    point = transform * point;
-
 	                    // Write data into buffer
-	                    points[pointsRead * 3]     = point.x;
-	                    points[pointsRead * 3 + 1] = point.y;
-	                    points[pointsRead * 3 + 2] = point.z;
+	                    points[pointsRead * 3]     = scanPoints[3 * p];
+	                    points[pointsRead * 3 + 1] = scanPoints[3 * p + 1];
+	                    points[pointsRead * 3 + 2] = scanPoints[3 * p + 2];
 
-	                    normals[pointsRead * 3]     = normal.x;
-	                    normals[pointsRead * 3 + 1] = normal.y;
-	                    normals[pointsRead * 3 + 2] = normal.z;
+	                    normals[pointsRead * 3]     = scanNormals[3 * p];
+	                    normals[pointsRead * 3 + 1] = scanNormals[3 * p + 1];
+	                    normals[pointsRead * 3 + 2] = scanNormals[3 * p + 2];
 	                    pointsRead++;
 	                }
 	                counter++;
-	            } while(in.good() && pointsRead < numPointsToRead);
+	            }
+
+	            // Transform the selected points and normals according to pose
+	            transform.transformPoints(points.get() + 3 * scanStart, pointsRead - scanStart);
+	            transform.transformNormals(normals.get() + 3 * scanStart, pointsRead - scanStart);
 
 	        }
 	        cout << timestamp << "Read " << pointsRead << " from " << numPointsToRead << " requested." << endl;
 
 
 	        PointBufferPtr pc = PointBufferPtr( new PointBuffer );
-	        pc->setPointArray(points, numPointsToRead);
-	        pc->setPointNormalArray(normals, numPointsToRead);
+	        pc->setPointArray(points, pointsRead);
+	        pc->setPointNormalArray(normals, pointsRead);
 
 	        if(options.getInterpolation() > 0)
 	        {
-	            interpolateNormals(pc, numPointsToRead, options.getInterpolation());
+	            interpolateNormals(pc, pointsRead, options.getInterpolation());
 	        }
 	        ModelPtr model(new Model(pc));
 
@@ -157,6 +157,10 @@
 #include "texture/Statistics.hpp"
 #include "geometry/QuadricVertexCosts.hpp"
 #include "reconstruction/SharpBox.hpp"
+#include "reconstruction/TiledMeshWriter.hpp"
+#include "io/PointTiles.hpp"
+#include "io/Metrics.hpp"
+#include "io/LasIO.hpp"
 
 // PCL related includes
 #ifdef _USE_PCL_
@@ -165,6 +169,7 @@
 
 
 #include <iostream>
+#include <algorithm>
 
 
 using namespace lvr;
@@ -178,6 +183,319 @@ typedef AdaptiveKSearchSurface<ColorVertex<float, unsigned char>, Normal<float>
 typedef PCLKSurface<ColorVertex<float, unsigned char> , Normal<float> > pclSurface;
 #endif
 
+/**
+ * @brief   Creates the point set surface that is selected in the options
+ *          for the given points. Returns an empty pointer if the selected
+ *          point cloud manager is not available.
+ */
+psSurface::Ptr createSurface(reconstruct::Options &options, PointBufferPtr p_loader)
+{
+	// Create a point cloud manager
+	string pcm_name = options.getPCM();
+	psSurface::Ptr surface;
+
+	// Create point set surface object
+	if(pcm_name == "PCL")
+	{
+#ifdef _USE_PCL_
+		surface = psSurface::Ptr( new pclSurface(p_loader));
+#else 
+		cout << timestamp << "Can't create a PCL point set surface without PCL installed." << endl;
+		exit(-1);
+#endif
+	}
+	else if(pcm_name == "STANN" || pcm_name == "FLANN" || pcm_name == "NABO" || pcm_name == "NANOFLANN")
+	{
+		akSurface* aks = new akSurface(
+				p_loader, pcm_name,
+				options.getKn(),
+				options.getKi(),
+				options.getKd(),
+				options.useRansac(),
+				options.getScanPoseFile()
+		);
+
+		surface = psSurface::Ptr(aks);
+		// Set RANSAC flag
+		if(options.useRansac())
+		{
+			aks->useRansac(true);
+		}
+		// Set PCA flag
+		if(options.usePCA())
+		{
+			aks->usePCA(true);
+		}
+	}
+	else
+	{
+		cout << timestamp << "Unable to create PointCloudManager." << endl;
+		cout << timestamp << "Unknown option '" << pcm_name << "'." << endl;
+		cout << timestamp << "Available PCMs are: " << endl;
+		cout << timestamp << "STANN, STANN_RANSAC";
+#ifdef _USE_PCL_
+		cout << ", PCL";
+#endif
+#ifdef _USE_NABO
+		cout << ", Nabo";
+#endif
+		cout << endl;
+		return psSurface::Ptr();
+	}
+
+	// Set search options for normal estimation and distance evaluation
+	surface->setKd(options.getKd());
+	surface->setKi(options.getKi());
+	surface->setKn(options.getKn());
+
+	return surface;
+}
+
+/**
+ * @brief   Creates the reconstruction grid and calculates the signed
+ *          distances. If a checkpoint is given to resume from, the grid
+ *          is restored from it instead. If a checkpoint file is set, the
+ *          calculated grid is written to it.
+ */
+template<typename BoxT>
+PointsetGrid<cVertex, BoxT>* createGrid(reconstruct::Options &options, psSurface::Ptr &surface,
+		float resolution, bool useVoxelsize)
+{
+	PointsetGrid<cVertex, BoxT>* grid;
+	if(options.getResumeFile() != "")
+	{
+		Metrics::instance().begin("grid");
+		grid = new PointsetGrid<cVertex, BoxT>(options.getResumeFile(), surface, options.blockedGrid());
+		Metrics::instance().end("grid", grid->getNumberOfCells());
+		if(grid->getNumberOfCells() == 0)
+		{
+			cout << timestamp << "IO Error: Unable to resume from " << options.getResumeFile() << endl;
+			exit(-1);
+		}
+		return grid;
+	}
+
+	Metrics::instance().begin("grid");
+	grid = new PointsetGrid<cVertex, BoxT>(resolution, surface, surface->getBoundingBox(), useVoxelsize,
+			options.blockedGrid(), options.parallelGrid());
+	grid->setExtrusion(options.extrude());
+	Metrics::instance().end("grid", grid->getNumberOfCells());
+
+	Metrics::instance().begin("sdf");
+	grid->calcDistanceValues();
+	Metrics::instance().end("sdf", grid->getNumberOfCells());
+
+	if(options.getCheckpointFile() != "")
+	{
+		Metrics::instance().begin("checkpoint");
+		grid->saveCheckpoint(options.getCheckpointFile(), options.compressCheckpoint());
+		Metrics::instance().end("checkpoint", grid->getNumberOfCells());
+	}
+	return grid;
+}
+
+/**
+ * @brief   Reconstructs the tiles one after another. The grids of all
+ *          tiles share the lattice origin, but only the cells of the
+ *          tile itself are polygonized. The overlap points are used for
+ *          normal estimation and distance evaluation only.
+ */
+template<typename BoxT>
+void reconstructTiles(reconstruct::Options &options, PointTiles &tiles,
+		cVertex origin, float voxelsize, int tileCells)
+{
+	TiledMeshWriter<cVertex, BoxT> writer("triangle_mesh.ply", origin, voxelsize);
+
+	for(size_t t = 0; t < tiles.numTiles(); t++)
+	{
+		int tile[3];
+		tiles.getTile(t, tile[0], tile[1], tile[2]);
+		cout << timestamp << "Reconstructing tile " << t + 1 << " of " << tiles.numTiles()
+			 << " (" << tiles.numPoints(t) << " points)." << endl;
+
+		// Too few points for normal estimation
+		if(tiles.numPoints(t) < (size_t)options.getKn())
+		{
+			cout << timestamp << "Skipping tile." << endl;
+			continue;
+		}
+
+		PointBufferPtr buffer = tiles.loadTile(t);
+		if(!buffer)
+		{
+			continue;
+		}
+
+		psSurface::Ptr surface = createSurface(options, buffer);
+		if(!surface)
+		{
+			return;
+		}
+
+		if(!buffer->hasPointNormals() || options.recalcNormals())
+		{
+			Metrics::instance().begin("normals");
+			surface->calculateSurfaceNormals();
+			Metrics::instance().end("normals", tiles.numPoints(t));
+		}
+
+		BilinearFastBox<cVertex, cNormal>::m_surface = surface;
+		SharpBox<cVertex, cNormal>::m_surface = surface;
+
+		// Cell range of the tile. The grid has to contain the overlap.
+		int first[3];
+		int last[3];
+		cVertex v_max;
+		for(int a = 0; a < 3; a++)
+		{
+			first[a] = tile[a] * tileCells;
+			last[a] = first[a] + tileCells;
+			v_max[a] = origin[a] + (last[a] + options.getTileOverlap() + 1) * voxelsize;
+		}
+
+		BoundingBox<cVertex> bb;
+		bb.expand(origin);
+		bb.expand(v_max);
+
+		Metrics::instance().begin("grid");
+		PointsetGrid<cVertex, BoxT> grid(voxelsize, surface, bb, true,
+				options.blockedGrid(), options.parallelGrid());
+		grid.setExtrusion(options.extrude());
+		Metrics::instance().end("grid", grid.getNumberOfCells());
+
+		Metrics::instance().begin("sdf");
+		grid.calcDistanceValues();
+		Metrics::instance().end("sdf", grid.getNumberOfCells());
+
+		size_t numFaces = writer.numFaces();
+		Metrics::instance().begin("mc");
+		writer.addTile(&grid, first, last);
+		Metrics::instance().end("mc", writer.numFaces() - numFaces);
+	}
+
+	Metrics::instance().begin("io");
+	writer.finalize();
+	Metrics::instance().end("io", writer.numFaces());
+}
+
+/**
+ * @brief   Collects the bounding box of streamed points
+ */
+class BoundingBoxHandler : public PointChunkHandler
+{
+public:
+	BoundingBoxHandler() : m_numPoints(0) {}
+
+	void addChunk(const float* points, const float* normals, size_t n)
+	{
+		for(size_t i = 0; i < n; i++)
+		{
+			m_boundingBox.expand(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+		}
+		m_numPoints += n;
+	}
+
+	BoundingBox<cVertex>	m_boundingBox;
+	size_t					m_numPoints;
+};
+
+/**
+ * @brief   Returns the filter for LAS input that is given on the command line
+ */
+LasFilter getLasFilter(const reconstruct::Options &options)
+{
+	LasFilter filter;
+	float lasMin[3], lasMax[3];
+	if(options.getLasBox(lasMin, lasMax))
+	{
+		filter.useBoundingBox = true;
+		for(int i = 0; i < 3; i++)
+		{
+			filter.min[i] = lasMin[i];
+			filter.max[i] = lasMax[i];
+		}
+	}
+	filter.everyNth = std::max(1, options.getLasEveryNth());
+	return filter;
+}
+
+/**
+ * @brief   Out-of-core reconstruction. The input file is streamed twice:
+ *          once to get the bounding box and once to distribute the
+ *          points into overlapping tiles on disk, so the whole point
+ *          cloud is never held in memory. Afterwards the tiles are
+ *          reconstructed one after another and the triangles are
+ *          streamed into a single mesh file.
+ *
+ * @return  False if the input file could not be read
+ */
+bool reconstructTiled(reconstruct::Options &options)
+{
+	string filename = options.getInputFileName();
+	LasFilter lasFilter = getLasFilter(options);
+
+	Metrics::instance().begin("io");
+	BoundingBoxHandler bounds;
+	if(!ModelFactory::readPointChunks(filename, bounds, lasFilter) || bounds.m_numPoints == 0)
+	{
+		return false;
+	}
+	Metrics::instance().end("io", bounds.m_numPoints);
+
+	BoundingBox<cVertex> bb = bounds.m_boundingBox;
+	size_t numPoints = bounds.m_numPoints;
+
+	float voxelsize = options.getVoxelsize();
+	if(options.getIntersections() > 0)
+	{
+		voxelsize = bb.getLongestSide() / options.getIntersections();
+	}
+	int tileCells = std::max(1, (int)(options.getTileSize() / voxelsize + 0.5));
+
+	// Move the lattice origin below all points, so that all lattice
+	// positions including the extruded cells are positive
+	cVertex origin = bb.getMin();
+	float o[3];
+	for(int a = 0; a < 3; a++)
+	{
+		origin[a] -= 2 * voxelsize;
+		o[a] = origin[a];
+	}
+
+	cout << timestamp << "Distributing " << numPoints << " points into tiles of "
+		 << tileCells << " cells." << endl;
+
+	Metrics::instance().begin("tiling");
+	PointTiles tiles("tiles", o, voxelsize, tileCells, options.getTileOverlap());
+	if(!ModelFactory::readPointChunks(filename, tiles, lasFilter))
+	{
+		return false;
+	}
+	tiles.flush();
+	Metrics::instance().end("tiling", numPoints);
+
+	cout << timestamp << "Created " << tiles.numTiles() << " tiles." << endl;
+
+	string decomposition = options.getDecomposition();
+	if(decomposition == "MC")
+	{
+		reconstructTiles<FastBox<cVertex, cNormal> >(options, tiles, origin, voxelsize, tileCells);
+	}
+	else if(decomposition == "PMC")
+	{
+		reconstructTiles<BilinearFastBox<cVertex, cNormal> >(options, tiles, origin, voxelsize, tileCells);
+	}
+	else if(decomposition == "SF")
+	{
+		reconstructTiles<SharpBox<cVertex, cNormal> >(options, tiles, origin, voxelsize, tileCells);
+	}
+	else
+	{
+		cout << timestamp << "Decomposition " << decomposition << " is not supported for tiles." << endl;
+	}
+	return true;
+}
+
 /**
  * @brief   Main entry point for the LSSR surface executable
  */
@@ -199,8 +517,25 @@ int main(int argc, char** argv)
 
 		std::cout << options << std::endl;
 
+		// Out-of-core reconstruction. The input is streamed into tiles.
+		if(options.getTileSize() > 0)
+		{
+			if(!reconstructTiled(options))
+			{
+				cout << timestamp << "IO Error: Unable to parse " << options.getInputFileName() << endl;
+				exit(-1);
+			}
+			if(options.getMetricsFile() != "")
+			{
+				Metrics::instance().writeJSON(options.getMetricsFile());
+			}
+			cout << timestamp << "Program end." << endl;
+			return 0;
+		}
+
 		// Create a point loader object
-		ModelPtr model = ModelFactory::readModel( options.getInputFileName() );
+		Metrics::instance().begin("io");
+		ModelPtr model = ModelFactory::readModel( options.getInputFileName(), getLasFilter(options) );
 		PointBufferPtr p_loader;
 
 		// Parse loaded data
@@ -210,66 +545,28 @@ int main(int argc, char** argv)
 			exit(-1);
 		}
 		p_loader = model->m_pointCloud;
-
-		// Create a point cloud manager
-		string pcm_name = options.getPCM();
-		psSurface::Ptr surface;
+		Metrics::instance().end("io", p_loader ? p_loader->getNumPoints() : 0);
 
 		// Create point set surface object
-		if(pcm_name == "PCL")
+		psSurface::Ptr surface = createSurface(options, p_loader);
+		if(!surface)
 		{
-#ifdef _USE_PCL_
-			surface = psSurface::Ptr( new pclSurface(p_loader));
-#else 
-			cout << timestamp << "Can't create a PCL point set surface without PCL installed." << endl;
-			exit(-1);
-#endif
+			return 0;
 		}
-		else if(pcm_name == "STANN" || pcm_name == "FLANN" || pcm_name == "NABO" || pcm_name == "NANOFLANN")
-		{
-			akSurface* aks = new akSurface(
-					p_loader, pcm_name,
-					options.getKn(),
-					options.getKi(),
-					options.getKd(),
-					options.useRansac(),
-					options.getScanPoseFile()
-			);
 
-			surface = psSurface::Ptr(aks);
-			// Set RANSAC flag
-			if(options.useRansac())
-			{
-				aks->useRansac(true);
-			}
-		}
-		else
+		// Calculate normals if necessary. When resuming from a checkpoint
+		// the distances are already known and only the sharp feature
+		// decomposition needs normals.
+		if(options.getResumeFile() != "" && options.getDecomposition() != "SF")
 		{
-			cout << timestamp << "Unable to create PointCloudManager." << endl;
-			cout << timestamp << "Unknown option '" << pcm_name << "'." << endl;
-			cout << timestamp << "Available PCMs are: " << endl;
-			cout << timestamp << "STANN, STANN_RANSAC";
-#ifdef _USE_PCL_
-			cout << ", PCL";
-#endif
-#ifdef _USE_NABO
-			cout << ", Nabo";
-#endif
-			cout << endl;
-			return 0;
+			cout << timestamp << "Resuming from checkpoint. Skipping normal estimation." << endl;
 		}
-
-		// Set search options for normal estimation and distance evaluation
-		surface->setKd(options.getKd());
-		surface->setKi(options.getKi());
-		surface->setKn(options.getKn());
-
-		// Calculate normals if necessary
-		if(!surface->pointBuffer()->hasPointNormals()
+		else if(!surface->pointBuffer()->hasPointNormals()
 				|| (surface->pointBuffer()->hasPointNormals() && options.recalcNormals()))
 		{
-		    Timestamp ts;
+			Metrics::instance().begin("normals");
 			surface->calculateSurfaceNormals();
+			Metrics::instance().end("normals", surface->pointBuffer()->getNumPoints());
 		}
 		else
 		{
@@ -383,38 +680,32 @@ int main(int argc, char** argv)
 		FastReconstructionBase<ColorVertex<float, unsigned char>, Normal<float> >* reconstruction;
 		if(decomposition == "MC")
 		{
-			grid = new PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize);
-			grid->setExtrusion(options.extrude());
-			PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, FastBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
-			ps_grid->calcDistanceValues();
-
-			reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, FastBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
-
+			PointsetGrid<cVertex, FastBox<cVertex, cNormal> >* ps_grid =
+					createGrid<FastBox<cVertex, cNormal> >(options, surface, resolution, useVoxelsize);
+			grid = ps_grid;
+			reconstruction = new FastReconstruction<cVertex, cNormal, FastBox<cVertex, cNormal> >(ps_grid, options.parallelExtraction());
 		}
 		else if(decomposition == "PMC")
 		{
-			grid = new PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize);
-			grid->setExtrusion(options.extrude());
-			BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> >::m_surface = surface;
-			PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
-			ps_grid->calcDistanceValues();
-
-			reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, BilinearFastBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
-
+			BilinearFastBox<cVertex, cNormal>::m_surface = surface;
+			PointsetGrid<cVertex, BilinearFastBox<cVertex, cNormal> >* ps_grid =
+					createGrid<BilinearFastBox<cVertex, cNormal> >(options, surface, resolution, useVoxelsize);
+			grid = ps_grid;
+			reconstruction = new FastReconstruction<cVertex, cNormal, BilinearFastBox<cVertex, cNormal> >(ps_grid, options.parallelExtraction());
 		}
 		else if(decomposition == "SF")
 		{
-			SharpBox<ColorVertex<float, unsigned char>, Normal<float> >::m_surface = surface;
-			grid = new PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > >(resolution, surface, surface->getBoundingBox(), useVoxelsize);
-			grid->setExtrusion(options.extrude());
-			PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > >* ps_grid = static_cast<PointsetGrid<ColorVertex<float, unsigned char>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> > > *>(grid);
-			ps_grid->calcDistanceValues();
-			reconstruction = new FastReconstruction<ColorVertex<float, unsigned char> , Normal<float>, SharpBox<ColorVertex<float, unsigned char>, Normal<float> >  >(ps_grid);
+			SharpBox<cVertex, cNormal>::m_surface = surface;
+			PointsetGrid<cVertex, SharpBox<cVertex, cNormal> >* ps_grid =
+					createGrid<SharpBox<cVertex, cNormal> >(options, surface, resolution, useVoxelsize);
+			grid = ps_grid;
+			reconstruction = new FastReconstruction<cVertex, cNormal, SharpBox<cVertex, cNormal> >(ps_grid, options.parallelExtraction());
 		}
 
-		
 		// Create mesh
+		Metrics::instance().begin("mc");
 		reconstruction->getMesh(mesh);
+		Metrics::instance().end("mc", mesh.meshSize());
 		
 		// Save grid to file
 		if(options.saveGrid())
@@ -428,6 +719,7 @@ int main(int argc, char** argv)
 		}
 
 		// Optimize mesh
+		Metrics::instance().begin("optimization");
 		mesh.cleanContours(options.getCleanContourIterations());
 		mesh.setClassifier(options.getClassifier());
 		mesh.getClassifier().setMinRegionSize(options.getSmallRegionThreshold());
@@ -438,7 +730,8 @@ int main(int argc, char** argv)
 					options.getNormalThreshold(),
 					options.getMinPlaneSize(),
 					options.getSmallRegionThreshold(),
-					true);
+					true,
+					options.parallelPlanes());
 
 			mesh.fillHoles(options.getFillHoles());
 			mesh.optimizePlaneIntersections();
@@ -446,8 +739,9 @@ int main(int argc, char** argv)
 
 			if(options.getNumEdgeCollapses())
 			{
-				QuadricVertexCosts<ColorVertex<float, unsigned char> , Normal<float> > c = QuadricVertexCosts<ColorVertex<float, unsigned char> , Normal<float> >(true);
-				mesh.reduceMeshByCollapse(options.getNumEdgeCollapses(), c);
+				QuadricVertexCosts<ColorVertex<float, unsigned char> , Normal<float> > c = QuadricVertexCosts<ColorVertex<float, unsigned char> , Normal<float> >(options.getEdgeCollapseMethod() == "QUADRIC_TRI");
+				float maxError = options.getEdgeCollapseError() > 0 ? options.getEdgeCollapseError() : std::numeric_limits<float>::max();
+				mesh.reduceMeshByCollapse(options.getNumEdgeCollapses(), c, maxError);
 			}
 		}
 		else if(options.clusterPlanes())
@@ -455,8 +749,10 @@ int main(int argc, char** argv)
 			mesh.clusterRegions(options.getNormalThreshold(), options.getMinPlaneSize());
 			mesh.fillHoles(options.getFillHoles());
 		}
+		Metrics::instance().end("optimization", mesh.meshSize());
 
 		// Save triangle mesh
+		Metrics::instance().begin("finalize");
 		if ( options.retesselate() )
 		{
 			mesh.finalizeAndRetesselate(options.generateTextures(), options.getLineFusionThreshold());
@@ -474,12 +770,14 @@ int main(int argc, char** argv)
 
 		// Create output model and save to file
 		ModelPtr m( new Model( mesh.meshBuffer() ) );
+		Metrics::instance().end("finalize", mesh.meshSize());
 
 		if(options.saveOriginalData())
 		{
 			m->m_pointCloud = model->m_pointCloud;
 		}
 		cout << timestamp << "Saving mesh." << endl;
+		Metrics::instance().begin("io");
 		ModelFactory::saveModel( m, "triangle_mesh.ply");
 
 		// Save obj model if textures were generated
@@ -487,6 +785,12 @@ int main(int argc, char** argv)
 		{
 			ModelFactory::saveModel( m, "triangle_mesh.obj");
 		}		
+		Metrics::instance().end("io");
+
+		if(options.getMetricsFile() != "")
+		{
+			Metrics::instance().writeJSON(options.getMetricsFile());
+		}
 		cout << timestamp << "Program end." << endl;
 
 	}
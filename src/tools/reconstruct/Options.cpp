@@ -43,12 +43,19 @@ Options::Options(int argc, char** argv)
 		        ("inputFile", value< vector<string> >(), "Input file name. Supported formats are ASCII (.pts, .xyz) and .ply")
 		        ("voxelsize,v", value<float>(&m_voxelsize)->default_value(10), "Voxelsize of grid used for reconstruction.")
 		        ("noExtrusion", "Do not extend grid. Can be used  to avoid artefacts in dense data sets but. Disabling will possibly create additional holes in sparse data sets.")
+		        ("parallelExtraction", "Calculate the triangles of the grid cells in parallel. The resulting mesh is the same as in serial extraction.")
+		        ("parallelGrid", "Build the grid in parallel from the sorted cell keys of all points.")
+		        ("blockedGrid", "Store the grid cells in memory blocks addressed by a sparse brick index instead of a hash map. Improves memory locality for large grids.")
+		        ("tileSize", value<float>(&m_tileSize)->default_value(0), "Reconstruct the point cloud out-of-core in cubic tiles of the given edge length. The input is streamed into tiles that are stored on disk and processed one after another. The resulting mesh is written to triangle_mesh.ply without further optimization.")
+		        ("tileOverlap", value<int>(&m_tileOverlap)->default_value(10), "Number of grid cells that neighboring tiles share. Should cover the neighborhoods used for normal estimation and distance evaluation.")
 		        ("intersections,i", value<int>(&m_intersections)->default_value(-1), "Number of intersections used for reconstruction. If other than -1, voxelsize will calculated automatically.")
 		        ("pcm,p", value<string>(&m_pcm)->default_value("FLANN"), "Point cloud manager used for point handling and normal estimation. Choose from {STANN, PCL, NABO}.")
                 ("ransac", "Set this flag for RANSAC based normal estimation.")
+                ("pca", "Set this flag to fit tangent planes by principal component analysis of the neighborhood. Handles planes of any orientation.")
 		        ("decomposition,d", value<string>(&m_pcm)->default_value("PMC"), "Defines the type of decomposition that is used for the voxels (Standard Marching Cubes (MC), Planar Marching Cubes (PMC), Standard Marching Cubes with sharp feature detection (SF) or Tetraeder (MT) decomposition. Choose from {MC, PMC, MT, SF}")
 		        ("optimizePlanes,o", "Shift all triangle vertices of a cluster onto their shared plane")
                 ("clusterPlanes,c", "Cluster planar regions based on normal threshold, do not shift vertices into regression plane.")
+                ("parallelPlanes", "Find the regions of --optimizePlanes and fit their planes in parallel. The regions may differ slightly from the serial region growing, but do not depend on the number of threads.")
 		        ("cleanContours", value<int>(&m_cleanContourIterations)->default_value(0), "Remove noise artifacts from contours. Same values are between 2 and 4")
                 ("planeIterations", value<int>(&m_planeIterations)->default_value(3), "Number of iterations for plane optimization")
                 ("fillHoles,f", value<int>(&m_fillHoles)->default_value(30), "Maximum size for hole filling")
@@ -60,6 +67,8 @@ Options::Options(int argc, char** argv)
 		        ("saveGrid,g", "Writes the generated grid to a file called 'fastgrid.grid. The result can be rendered with qviewer.")
 		        ("saveOriginalData,s", "Save the original points and the estimated normals together with the reconstruction into one file ('triangle_mesh.ply')")
 		        ("scanPoseFile", value<string>()->default_value(""), "ASCII file containing scan positions that can be used to flip normals")
+		        ("lasBox", value< vector<float> >()->multitoken(), "Only read the points of LAS files within the box given by minimum and maximum corner (x1 y1 z1 x2 y2 z2).")
+		        ("lasEveryNth", value<int>()->default_value(1), "Only read every n-th point of LAS files.")
 		        ("kd", value<int>(&m_kd)->default_value(5), "Number of normals used for distance function evaluation")
 		        ("ki", value<int>(&m_ki)->default_value(10), "Number of normals used in the normal interpolation process")
 		        ("kn", value<int>(&m_kn)->default_value(10), "Size of k-neighborhood used for normal estimation")
@@ -73,10 +82,15 @@ Options::Options(int argc, char** argv)
 		        ("depth", value<int>(&m_depth)->default_value(100), "Maximum recursion depth for region growing.")
 		        ("recalcNormals,r", "Always estimate normals, even if given in .ply file.")
 		        ("threads", value<int>(&m_numThreads)->default_value( lvr::OpenMPConfig::getNumThreads() ), "Number of threads")
+		        ("metrics", value<string>()->default_value(""), "Write the wall clock time, CPU time, peak memory usage and number of processed items of each reconstruction phase to the given JSON file.")
+		        ("checkpoint", value<string>()->default_value(""), "Write the grid with the calculated signed distances to the given binary checkpoint file.")
+		        ("compressCheckpoint", "Write the checkpoint in the compressed layout with delta encoded keys.")
+		        ("resume", value<string>()->default_value(""), "Restore the grid from the given checkpoint file instead of estimating normals and distances. The decomposition has to be the same as the one of the run that wrote the checkpoint.")
 		        ("sft", value<float>(&m_sft)->default_value(0.9), "Sharp feature threshold when using sharp feature decomposition")
 		        ("sct", value<float>(&m_sct)->default_value(0.7), "Sharp corner threshold when using sharp feature decomposition")
 		        ("ecm", value<string>(&m_ecm)->default_value("QUADRIC"), "Edge collapse method for mesh reduction. Choose from QUADRIC, QUADRIC_TRI, MELAX, SHORTEST")
 				("ecc", value<int>(&m_numEdgeCollapses)->default_value(0), "Edge collapse count. Number of edges to collapse for mesh reduction.")
+				("ece", value<float>(&m_edgeCollapseError)->default_value(0), "Maximum quadric error of an edge collapse. Mesh reduction stops before the first collapse with a larger error. 0 means no limit.")
 		        ("tp", value<string>(&m_texturePack)->default_value(""), "Path to texture pack")
 		        ("co", value<string>(&m_statsCoeffs)->default_value(""), "Coefficents file for texture matching based on statistics")
 		        ("nsc", value<unsigned int>(&m_numStatsColors)->default_value(16), "Number of colors for texture statistics")
@@ -115,6 +129,26 @@ int Options::getNumThreads() const
 	return m_variables["threads"].as<int>();
 }
 
+string Options::getMetricsFile() const
+{
+	return m_variables["metrics"].as<string>();
+}
+
+string Options::getCheckpointFile() const
+{
+	return m_variables["checkpoint"].as<string>();
+}
+
+bool Options::compressCheckpoint() const
+{
+	return m_variables.count("compressCheckpoint");
+}
+
+string Options::getResumeFile() const
+{
+	return m_variables["resume"].as<string>();
+}
+
 int Options::getKi() const
 {
     return m_variables["ki"].as<int>();
@@ -171,11 +205,43 @@ string Options::getScanPoseFile() const
 	return (m_variables["scanPoseFile"].as<string>());
 }
 
+bool Options::getLasBox(float min[3], float max[3]) const
+{
+	if(!m_variables.count("lasBox"))
+	{
+		return false;
+	}
+
+	vector<float> box = m_variables["lasBox"].as< vector<float> >();
+	if(box.size() != 6)
+	{
+		cout << "Warning: --lasBox needs six values. Ignoring it." << endl;
+		return false;
+	}
+
+	for(int i = 0; i < 3; i++)
+	{
+		min[i] = box[i];
+		max[i] = box[i + 3];
+	}
+	return true;
+}
+
+int Options::getLasEveryNth() const
+{
+	return m_variables["lasEveryNth"].as<int>();
+}
+
 int Options::getNumEdgeCollapses() const
 {
 	return (m_variables["ecc"].as<int>());
 }
 
+float Options::getEdgeCollapseError() const
+{
+	return (m_variables["ece"].as<float>());
+}
+
 int    Options::getDanglingArtifacts() const
 {
     return (m_variables["rda"].as<int> ());
@@ -257,6 +323,11 @@ bool Options::useRansac() const
     return (m_variables.count("ransac"));
 }
 
+bool Options::usePCA() const
+{
+    return (m_variables.count("pca"));
+}
+
 bool Options::saveOriginalData() const
 {
     return (m_variables.count("saveOriginalData"));
@@ -268,6 +339,11 @@ bool Options::optimizePlanes() const
         || m_variables.count("retesselate");
 }
 
+bool Options::parallelPlanes() const
+{
+	return m_variables.count("parallelPlanes");
+}
+
 bool Options::clusterPlanes() const
 {
 	return m_variables.count("clusterPlanes");
@@ -285,6 +361,31 @@ bool Options::extrude() const
     }
 }
 
+bool Options::parallelExtraction() const
+{
+    return m_variables.count("parallelExtraction");
+}
+
+bool Options::parallelGrid() const
+{
+    return m_variables.count("parallelGrid");
+}
+
+bool Options::blockedGrid() const
+{
+    return m_variables.count("blockedGrid");
+}
+
+float Options::getTileSize() const
+{
+    return m_variables["tileSize"].as<float>();
+}
+
+int Options::getTileOverlap() const
+{
+    return m_variables["tileOverlap"].as<int>();
+}
+
 bool  Options::colorRegions() const
 {
     return m_variables.count("colorRegions");
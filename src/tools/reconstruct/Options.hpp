@@ -68,6 +68,30 @@ public:
 	 */
 	int 	getNumThreads() const;
 
+	/**
+	 * @brief	Returns the name of the JSON file for the phase metrics
+	 * 			or an empty string
+	 */
+	string	getMetricsFile() const;
+
+	/**
+	 * @brief	Returns the name of the grid checkpoint file that is
+	 * 			written after the distance calculation or an empty string
+	 */
+	string	getCheckpointFile() const;
+
+	/**
+	 * @brief	Returns true if the checkpoint is written in the
+	 * 			compressed layout
+	 */
+	bool	compressCheckpoint() const;
+
+	/**
+	 * @brief	Returns the name of the grid checkpoint file to resume
+	 * 			from or an empty string
+	 */
+	string	getResumeFile() const;
+
 	/**
 	 * @brief	Prints a usage message to stdout.
 	 */
@@ -113,6 +137,11 @@ public:
 	 */
 	bool 	optimizePlanes() const;
 
+	/**
+	 * @brief 	Returns true if the planes are optimized in parallel
+	 */
+	bool 	parallelPlanes() const;
+
 	/**
 	 * @brief 	Indicates whether to save the used points
 	 * 			together with the interpolated normals.
@@ -130,6 +159,11 @@ public:
      */
     bool    useRansac() const;
 
+    /**
+     * @brief   If true, tangent planes are fitted by principal component analysis
+     */
+    bool    usePCA() const;
+
     /**
      * @brief   True if texture analysis is enabled
      */
@@ -189,6 +223,18 @@ public:
 	 */
 	string 	getScanPoseFile() const;
 
+	/**
+	 * @brief	Returns the bounding box filter for LAS files
+	 *
+	 * @return	False if no box filter is set
+	 */
+	bool	getLasBox(float min[3], float max[3]) const;
+
+	/**
+	 * @brief	Returns n, if only every n-th point of LAS files is read
+	 */
+	int		getLasEveryNth() const;
+
 	/**
 	 * @brief   Returns the number of intersections. If the return value
 	 *          is positive it will be used for reconstruction instead of
@@ -275,11 +321,42 @@ public:
      */
     bool extrude() const;
 
+    /**
+     * @brief   Whether to extract the triangles of the grid cells in parallel
+     */
+    bool parallelExtraction() const;
+
+    /**
+     * @brief   Whether to build the grid in parallel
+     */
+    bool parallelGrid() const;
+
+    /**
+     * @brief   Whether to store the grid cells in blocked storage
+     */
+    bool blockedGrid() const;
+
+    /**
+     * @brief   Edge length of the tiles for out-of-core reconstruction.
+     *          Values <= 0 disable tiling.
+     */
+    float getTileSize() const;
+
+    /**
+     * @brief   Number of grid cells that neighboring tiles share
+     */
+    int getTileOverlap() const;
+
     /**
      * @brief 	Number of edge collapses
      */
     int getNumEdgeCollapses() const;
 
+    /**
+     * @brief 	Maximum quadric error of an edge collapse, 0 if unlimited
+     */
+    float getEdgeCollapseError() const;
+
 
 
 
@@ -315,6 +392,12 @@ private:
 	/// The set voxelsize
 	float 				            m_voxelsize;
 
+	/// The edge length of the reconstruction tiles
+	float                           m_tileSize;
+
+	/// The number of overlapping cells of neighboring tiles
+	int                             m_tileOverlap;
+
 	/// The number of uesed threads
 	int				                m_numThreads;
 
@@ -393,6 +476,9 @@ private:
 	/// Number of edge collapses
 	int								m_numEdgeCollapses;
 
+	/// Maximum quadric error of an edge collapse
+	float							m_edgeCollapseError;
+
 	
 	///Path to texture pack
 	string m_texturePack;
@@ -445,6 +531,32 @@ inline ostream& operator<<(ostream& os, const Options &o)
 	    cout << "##### Voxelsize \t\t: " << o.getVoxelsize() << endl;
 	}
 	cout << "##### Number of threads \t: "    << o.getNumThreads()      << endl;
+	if(o.getMetricsFile() != "")
+	{
+	    cout << "##### Metrics file \t\t: " << o.getMetricsFile() << endl;
+	}
+	if(o.getCheckpointFile() != "")
+	{
+	    cout << "##### Checkpoint file \t\t: " << o.getCheckpointFile() << endl;
+	    if(o.compressCheckpoint())
+	    {
+	        cout << "##### Compress checkpoint \t: YES" << endl;
+	    }
+	}
+	if(o.getResumeFile() != "")
+	{
+	    cout << "##### Resume from \t\t: " << o.getResumeFile() << endl;
+	}
+	float lasMin[3], lasMax[3];
+	if(o.getLasBox(lasMin, lasMax))
+	{
+	    cout << "##### LAS box\t\t\t: " << lasMin[0] << " " << lasMin[1] << " " << lasMin[2]
+	         << " / " << lasMax[0] << " " << lasMax[1] << " " << lasMax[2] << endl;
+	}
+	if(o.getLasEveryNth() > 1)
+	{
+	    cout << "##### LAS every n-th point\t: " << o.getLasEveryNth() << endl;
+	}
 	cout << "##### Point cloud manager \t: " << o.getPCM()             << endl;
 	if(o.useRansac())
 	{
@@ -454,6 +566,10 @@ inline ostream& operator<<(ostream& os, const Options &o)
 	{
 	    cout << "##### Use RANSAC\t\t: NO" << endl;
 	}
+	if(o.usePCA())
+	{
+	    cout << "##### Use PCA\t\t\t: YES" << endl;
+	}
 
 	cout << "##### Voxel decomposition: \t: " << o.getDecomposition()   << endl;
 	cout << "##### Classifier:\t\t: "         << o.getClassifier()      << endl;
@@ -465,6 +581,23 @@ inline ostream& operator<<(ostream& os, const Options &o)
 	{
 	    cout << "##### Dump classification\t: NO" << endl;
 	}
+	if(o.parallelExtraction())
+	{
+	    cout << "##### Parallel extraction\t: YES" << endl;
+	}
+	if(o.parallelGrid())
+	{
+	    cout << "##### Parallel grid\t\t: YES" << endl;
+	}
+	if(o.blockedGrid())
+	{
+	    cout << "##### Blocked grid\t\t: YES" << endl;
+	}
+	if(o.getTileSize() > 0)
+	{
+	    cout << "##### Tile size\t\t\t: " << o.getTileSize() << endl;
+	    cout << "##### Tile overlap\t\t: " << o.getTileOverlap() << endl;
+	}
 	cout << "##### k_n \t\t\t: "              << o.getKn()              << endl;
 	cout << "##### k_i \t\t\t: "              << o.getKi()              << endl;
 	cout << "##### k_d \t\t\t: "              << o.getKd()              << endl;
@@ -507,6 +640,10 @@ inline ostream& operator<<(ostream& os, const Options &o)
 		cout << "##### Plane iterations\t\t: " << o.getPlaneIterations() << endl;
 		cout << "##### Normal threshold \t\t: " << o.getNormalThreshold() << endl;
 		cout << "##### Region threshold\t\t: " << o.getSmallRegionThreshold() << endl;
+		if(o.parallelPlanes())
+		{
+			cout << "##### Parallel planes \t\t: YES" << endl;
+		}
 	}
 	if(o.saveNormals())
 	{
@@ -546,6 +683,10 @@ inline ostream& operator<<(ostream& os, const Options &o)
 	{
 		cout << "##### Edge collapse method: \t\t: " << o.getEdgeCollapseMethod() << endl;
 		cout << "##### Number of edge collapses\t: " << o.getNumEdgeCollapses() << endl;
+		if(o.getEdgeCollapseError() > 0)
+		{
+			cout << "##### Edge collapse error\t: " << o.getEdgeCollapseError() << endl;
+		}
 	}
 
 
@@ -21,6 +21,7 @@
 
 #include "io/Timestamp.hpp"
 #include "io/ModelFactory.hpp"
+#include "reconstruction/PointFilter.hpp"
 #ifdef _USE_PCL_
 #include "reconstruction/PCLFiltering.hpp"
 #endif
@@ -55,29 +56,49 @@ int main(int argc, char** argv)
 			if(m->m_pointCloud)
 			{
 
-#ifdef _USE_PCL_
-				PCLFiltering filter(m->m_pointCloud);
+				PointBufferPtr pb = m->m_pointCloud;
 
-				// Apply filters
-				if(options.removeOutliers())
+				// Apply the native filters
+				PointFilter filter(pb, options.searchTree());
+				if(options.removeOutliers() && !options.usePCL())
 				{
-					filter.applyOutlierRemoval(options. sorMeanK(), options.sorDevThreshold());
+					filter.applyOutlierRemoval(options.sorMeanK(), options.sorDevThreshold());
 				}
 
+				if(options.rorRadius() > 0)
+				{
+					filter.applyRadiusOutlierRemoval(options.rorRadius(), options.rorMinNeighbors());
+				}
 
-				if(options.mlsDistance() > 0)
+				if(options.voxelsize() > 0)
 				{
-					filter.applyMLSProjection(options.mlsDistance());
+					filter.applyVoxelGrid(options.voxelsize());
 				}
+				pb = filter.getPointBuffer();
 
-				PointBufferPtr pb( filter.getPointBuffer() );
-				ModelPtr out_model( new Model( pb ) );
+				// The MLS projection is only available with PCL
+				if((options.removeOutliers() && options.usePCL()) || options.mlsDistance() > 0)
+				{
+#ifdef _USE_PCL_
+					PCLFiltering pclFilter(pb);
+					if(options.removeOutliers() && options.usePCL())
+					{
+						pclFilter.applyOutlierRemoval(options.sorMeanK(), options.sorDevThreshold());
+					}
+
+					if(options.mlsDistance() > 0)
+					{
+						pclFilter.applyMLSProjection(options.mlsDistance());
+					}
+					pb = pclFilter.getPointBuffer();
+#else
+					cout << timestamp << "Can't create a PCL Filter without PCL installed." << endl;
+					exit(-1);
+#endif
+				}
 
+				ModelPtr out_model( new Model( pb ) );
 				ModelFactory::saveModel(out_model, options.outputFile());
-#else 
-				cout << timestamp << "Can't create a PCL Filter without PCL installed." << endl;
-				exit(-1);
-#endif
 			}
 		}
 		else
@@ -42,6 +42,11 @@ Options::Options(int argc, char** argv) : m_descr("Supported options")
 	    ("mlsDistance,m", value<float>()->default_value(0), "Max distance for MLS reconstruction.")
 	    ("sorThresh,t", value<float>()->default_value(1.0), "Std. deviation threshold for outlier removal.")
 	    ("sorMeank,k", value<int>()->default_value(50), "k value mean calculation for outlier removal.")
+	    ("rorRadius", value<float>()->default_value(0), "Radius for radius outlier removal. 0 disables the filter.")
+	    ("rorMinNeighbors", value<int>()->default_value(5), "Minimal number of neighbors within the radius for radius outlier removal.")
+	    ("voxelsize,v", value<float>()->default_value(0), "Replace the points in each voxel of the given size by their centroid. 0 disables the filter.")
+	    ("searchTree", value<string>()->default_value("STANN"), "Search tree used for the outlier removal (STANN, FLANN, NANOFLANN or NABO).")
+	    ("pcl", "Use the PCL implementation of the statistical outlier removal.")
 		;
 
 	m_pdescr.add("inputFile", -1);
@@ -92,6 +97,31 @@ float Options::mlsDistance() const
     return (m_variables["mlsDistance"].as< float>());
 }
 
+float Options::rorRadius() const
+{
+    return (m_variables["rorRadius"].as< float>());
+}
+
+int Options::rorMinNeighbors() const
+{
+    return (m_variables["rorMinNeighbors"].as<int>());
+}
+
+float Options::voxelsize() const
+{
+    return (m_variables["voxelsize"].as< float>());
+}
+
+string Options::searchTree() const
+{
+    return (m_variables["searchTree"].as< string>());
+}
+
+bool Options::usePCL() const
+{
+    return (m_variables.count("pcl"));
+}
+
 bool Options::printUsage() const
 {
   if(!m_variables.count("inputFile"))
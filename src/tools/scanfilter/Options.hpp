@@ -79,6 +79,32 @@ public:
 	 */
 	bool    removeOutliers() const;
 
+	/**
+	 * @brief   Returns the radius for radius outlier removal
+	 */
+	float   rorRadius() const;
+
+	/**
+	 * @brief   Returns the minimal number of neighbors within the radius
+	 *          for radius outlier removal
+	 */
+	int     rorMinNeighbors() const;
+
+	/**
+	 * @brief   Returns the voxel size for centroid downsampling
+	 */
+	float   voxelsize() const;
+
+	/**
+	 * @brief   Returns the name of the search tree for the outlier removal
+	 */
+	string  searchTree() const;
+
+	/**
+	 * @brief   True if the PCL outlier removal should be used
+	 */
+	bool    usePCL() const;
+
 	/**
 	 * @brief   Retuns the input file
 	 */
@@ -140,6 +166,16 @@ inline ostream& operator<<(ostream& os, const Options &o)
 	{
 	    cout << "##### Apply outlier removal\t: NO" << endl;
 	}
+	if( o.rorRadius() > 0)
+	{
+	    cout << "##### Radius outlier removal\t: " << o.rorRadius() << endl;
+	    cout << "##### Minimal neighbors\t\t: " << o.rorMinNeighbors() << endl;
+	}
+	if( o.voxelsize() > 0)
+	{
+	    cout << "##### Voxel grid filter\t\t: " << o.voxelsize() << endl;
+	}
+	cout << "##### Search tree\t\t: " << o.searchTree() << endl;
 	return os;
 }
 
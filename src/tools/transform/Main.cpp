@@ -32,6 +32,7 @@
 #include "io/Timestamp.hpp"
 #include <iostream>
 #include <cmath>
+#include <cfloat>
 
 using namespace lvr;
 using std::cout;
@@ -139,6 +140,24 @@ int main(int argc, char **argv)
       mat = Matrix4<float>(Vertex3f(x, y, z), Vertex3f(r1, r2, r3));
     }
 
+    // The scaling is applied after the transformation, so it is folded
+    // into the rows of the matrix that is applied to the coordinates.
+    // Normals are transformed with its inverse transpose.
+    float scale[3];
+    scale[0] = options.anyScaleX() ? options.getScaleX() : 1.0f;
+    scale[1] = options.anyScaleY() ? options.getScaleY() : 1.0f;
+    scale[2] = options.anyScaleZ() ? options.getScaleZ() : 1.0f;
+
+    Matrix4<float> scaled(mat);
+    for(int i = 0; i < 4; i++)
+    {
+      for(int a = 0; a < 3; a++)
+        scaled.set(4 * i + a, mat[4 * i + a] * scale[a]);
+    }
+
+    float bbMin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float bbMax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
     // Get point buffer
     if(model->m_pointCloud)
     {
@@ -146,17 +165,15 @@ int main(int argc, char **argv)
 
       cout << timestamp << "Using points" << endl;
       did_anything = true;
-      coord3fArr points = p_buffer->getIndexedPointArray(num);
       cout << mat;
-      for(size_t i = 0; i < num; i++)
-      {
-        Vertex<float> v(points[i][0], points[i][1], points[i][2]);
-        v = mat * v;
-        points[i][0] = options.anyScaleX() ? v[0] * options.getScaleX() : v[0];
-        points[i][1] = options.anyScaleY() ? v[1] * options.getScaleY() : v[1];
-        points[i][2] = options.anyScaleZ() ? v[2] * options.getScaleZ() : v[2];
-      }
-      p_buffer->setIndexedPointArray(points, num);
+
+      floatArr points = p_buffer->getPointArray(num);
+      if(points)
+        scaled.transformPoints(points.get(), num, bbMin, bbMax);
+
+      floatArr normals = p_buffer->getPointNormalArray(num);
+      if(normals)
+        scaled.transformNormals(normals.get(), num);
     }
 
     // Get mesh buffer
@@ -166,17 +183,20 @@ int main(int argc, char **argv)
 
       cout << timestamp << "Using meshes" << endl;
       did_anything = true;
-      coord3fArr points = m_buffer->getIndexedVertexArray(num);
 
-      for(size_t i = 0; i < num; i++)
-      {
-        Vertex<float> v(points[i][0], points[i][1], points[i][2]);
-        v = mat * v;
-        points[i][0] = options.anyScaleX() ? v[0] * options.getScaleX() : v[0];
-        points[i][1] = options.anyScaleY() ? v[1] * options.getScaleY() : v[1];
-        points[i][2] = options.anyScaleZ() ? v[2] * options.getScaleZ() : v[2];
-      }
-      m_buffer->setIndexedVertexArray(points, num);
+      floatArr points = m_buffer->getVertexArray(num);
+      if(points)
+        scaled.transformPoints(points.get(), num, bbMin, bbMax);
+
+      floatArr normals = m_buffer->getVertexNormalArray(num);
+      if(normals)
+        scaled.transformNormals(normals.get(), num);
+    }
+
+    if(did_anything && bbMin[0] <= bbMax[0])
+    {
+      cout << timestamp << "Bounding box: (" << bbMin[0] << ", " << bbMin[1] << ", " << bbMin[2]
+           << ") - (" << bbMax[0] << ", " << bbMax[1] << ", " << bbMax[2] << ")" << endl;
     }
 
     if(!did_anything)